@@ -4,13 +4,13 @@ import argparse
 import datetime
 import os
 import sys
-import tempfile
 from progress.bar import Bar
 
 from props import root, getNode
 
 sys.path.append("../src")
 from comms.packet_id import *
+import comms.flight_log
 import comms.packer
 
 import commands
@@ -50,6 +50,8 @@ def logical_category(id):
         return 'raven'
     elif id == EVENT_PACKET_V1:
         return 'event'
+    elif id == PROFILE_PACKET_V1:
+        return 'profile'
     else:
         return 'unknown-packet-id'
 
@@ -92,6 +94,9 @@ def generate_record(category, index, delim=','):
     elif category == 'event':
         record = comms.packer.pack_event_text(index, delim)
         return record
+    elif category == 'profile':
+        record = comms.packer.pack_profile_text(index, delim)
+        return record
     # elif category == 'error':
     #     error_node = getNode("/autopilot/errors", True)
     #     data = [ '%.4f' % error_node.getFloat('timestamp'),
@@ -100,7 +105,10 @@ def generate_record(category, index, delim=','):
 
 argparser = argparse.ArgumentParser(description='aura export')
 argparser.add_argument('--flight', help='load specified flight log')
-argparser.add_argument('--skip-seconds', help='seconds to skip when processing flight log')
+argparser.add_argument('--skip-seconds', type=float, help='seconds to skip when processing flight log')
+argparser.add_argument('--start', type=float, help='export from this log time (sec)')
+argparser.add_argument('--end', type=float, help='export up to this log time (sec)')
+argparser.add_argument('--category', action='append', help='export only this category (gps, imu, air, filter, ...), may be repeated')
 
 args = argparser.parse_args()
 
@@ -119,20 +127,23 @@ if args.flight:
         filename = args.flight
     print "filename:", filename
     if filename.endswith('.gz'):
-        (fd, filetmp) = tempfile.mkstemp()
-        command = 'zcat ' + filename + ' > ' + filetmp
-        print command
-        os.system(command)
-        fd = open(filetmp, 'r')
+        # only the blocks of the requested time window and categories
+        # are decompressed
+        log = comms.flight_log.FlightLog(filename)
+        start = args.start
+        if args.skip_seconds:
+            start = log.start_time() + args.skip_seconds
+        ids = None
+        if args.category:
+            ids = [ id for id in range(256)
+                    if logical_category(id) in args.category ]
+        print 'blocks:', len(log.blocks), 'log time: %.1f - %.1f' % (log.start_time(), log.end_time())
+        full = log.read(start, args.end, ids)
+        log.close()
     else:
         fd = open(filename, 'r')
+        full = fd.read()
 
-    full = fd.read()
-
-    if filename.endswith('.gz'):
-        # remove temporary file name
-        os.remove(filetmp)
-        
     divs = 500
     size = len(full)
     chunk_size = size / divs
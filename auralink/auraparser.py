@@ -2,13 +2,17 @@ import datetime
 import sys
 
 sys.path.append("../src")
+from props import getNode
 from comms.packet_id import *
+import comms.compact
 import comms.packer
 import comms.serial_parser
 
 parser = None
 f = None
 
+link_node = getNode('/comms/remote_link', True)
+
 def init():
     global parser
     parser = comms.serial_parser.serial_parser()
@@ -17,7 +21,19 @@ def init():
 def update(ser):
     global parser
     pkt_id = parser.read(ser)
-    if pkt_id >= 0:
+    if pkt_id == COMPACT_PACKET_V1:
+        # expand, acknowledge keyframes, and log the original packet
+        (pkt_id, payload, ack) = comms.compact.decode(parser.payload)
+        if ack != None:
+            ser.write(ack)
+        link_node.setFloat('compact_ratio', comms.compact.get_ratio())
+        link_node.setInt('compact_dropped', comms.compact.dropped)
+        if payload != None:
+            parse_msg(pkt_id, payload)
+            (cksum0, cksum1) = comms.packer.compute_cksum(pkt_id, payload,
+                                                          len(payload))
+            log_msg(f, pkt_id, len(payload), payload, cksum0, cksum1)
+    elif pkt_id >= 0:
         parse_msg(pkt_id, parser.payload)
         log_msg(f, pkt_id, parser.pkt_len, parser.payload,
                 parser.cksum_lo, parser.cksum_hi)
@@ -111,6 +127,14 @@ def parse_msg(id, buf):
         index = comms.packer.unpack_raven_v1(buf)
     elif id == EVENT_PACKET_V1:
         index = comms.packer.unpack_event_v1(buf)
+    elif id == PROFILE_PACKET_V1:
+        index = comms.packer.unpack_profile_v1(buf)
+    elif id == COMPACT_PACKET_V1:
+        (id, payload, ack) = comms.compact.decode(buf)
+        if payload != None:
+            index = parse_msg(id, payload)
+        else:
+            index = 0
     else:
         print "Unknown packet id:", id
         index = 0
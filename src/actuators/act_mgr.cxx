@@ -51,10 +51,26 @@ static pyPropertyNode ap_node;
 static pyPropertyNode signal_node;
 static vector<pyPropertyNode> sections;
 
+// pre-resolved handles for Actuator_update()
+static PropertyHandle<double> flight_aileron, flight_elevator, flight_rudder;
+static PropertyHandle<double> flight_flaps, flight_gear;
+static PropertyHandle<double> engine_throttle;
+static PropertyHandle<double> pilot_aileron, pilot_elevator, pilot_rudder;
+static PropertyHandle<double> pilot_flaps, pilot_gear, pilot_throttle;
+static PropertyHandle<double> act_aileron, act_elevator, act_rudder;
+static PropertyHandle<double> act_flaps, act_gear, act_throttle;
+static PropertyHandle<double> act_timestamp;
+static PropertyHandle<bool> act_throttle_safety;
+static PropertyHandle<bool> signal_running;
+static PropertyHandle<double> signal_value;
+static PropertyHandle<string> signal_inject_node;
+static PropertyHandle<bool> ap_master_switch;
+static PropertyHandle<string> ap_mode;
+static PropertyHandle<string> ap_flight_mode;
+
 static myprofile debug_act1;
 static myprofile debug_act2;
 
-static int remote_link_skip = 0;
 static int logging_skip = 0;
 
 void Actuator_init() {
@@ -68,10 +84,35 @@ void Actuator_init() {
     pilot_node = pyGetNode("/sensors/pilot_input", true);
     act_node = pyGetNode("/actuators", true);
     ap_node = pyGetNode("/autopilot", true);
+
+    flight_aileron = flight_node.getHandle<double>("aileron");
+    flight_elevator = flight_node.getHandle<double>("elevator");
+    flight_rudder = flight_node.getHandle<double>("rudder");
+    flight_flaps = flight_node.getHandle<double>("flaps");
+    flight_gear = flight_node.getHandle<double>("gear");
+    engine_throttle = engine_node.getHandle<double>("throttle");
+    pilot_aileron = pilot_node.getHandle<double>("aileron");
+    pilot_elevator = pilot_node.getHandle<double>("elevator");
+    pilot_rudder = pilot_node.getHandle<double>("rudder");
+    pilot_flaps = pilot_node.getHandle<double>("flaps");
+    pilot_gear = pilot_node.getHandle<double>("gear");
+    pilot_throttle = pilot_node.getHandle<double>("throttle");
+    act_aileron = act_node.getHandle<double>("aileron");
+    act_elevator = act_node.getHandle<double>("elevator");
+    act_rudder = act_node.getHandle<double>("rudder");
+    act_flaps = act_node.getHandle<double>("flaps");
+    act_gear = act_node.getHandle<double>("gear");
+    act_throttle = act_node.getHandle<double>("throttle");
+    act_timestamp = act_node.getHandle<double>("timestamp");
+    act_throttle_safety = act_node.getHandle<bool>("throttle_safety");
+    signal_running = signal_node.getHandle<bool>("running");
+    signal_value = signal_node.getHandle<double>("value");
+    signal_inject_node = signal_node.getHandle<string>("inject");
+    ap_master_switch = ap_node.getHandle<bool>("master_switch");
+    ap_mode = ap_node.getHandle<string>("mode");
+    ap_flight_mode = ap_node.getHandle<string>("flight_mode");
     
-    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
     pyPropertyNode logging_node = pyGetNode("/config/logging", true);
-    remote_link_skip = remote_link_node.getDouble("actuator_skip");
     logging_skip = logging_node.getDouble("actuator_skip");
 
     // traverse configured modules
@@ -130,30 +171,30 @@ void Actuator_init() {
 static void set_actuator_values_ap() {
     double signal_val = 0.0;
     string signal_inject = "";
-    if ( signal_node.getBool("running") ) {
-	signal_val = signal_node.getDouble("value");
-	signal_inject = signal_node.getString("inject");
+    if ( signal_running.get() ) {
+	signal_val = signal_value.get();
+	signal_inject = signal_inject_node.get();
     }
     
-    float aileron = flight_node.getDouble("aileron");
+    float aileron = flight_aileron.get();
     if ( signal_inject == "aileron" ) { aileron += signal_val; }
-    act_node.setDouble( "aileron", aileron );
+    act_aileron.set( aileron );
 
-    float elevator = flight_node.getDouble("elevator");
+    float elevator = flight_elevator.get();
     if ( signal_inject == "elevator" ) { elevator += signal_val; }
-    act_node.setDouble( "elevator", elevator );
+    act_elevator.set( elevator );
 
     // rudder
-    float rudder = flight_node.getDouble("rudder");
+    float rudder = flight_rudder.get();
     if ( signal_inject == "rudder" ) { rudder += signal_val; }
-    act_node.setDouble( "rudder", rudder );
+    act_rudder.set( rudder );
 
-    double flaps = flight_node.getDouble("flaps");
+    double flaps = flight_flaps.get();
     if ( signal_inject == "flaps" ) { flaps += signal_val; }
-    act_node.setDouble("flaps", flaps );
+    act_flaps.set( flaps );
 
-    double gear = flight_node.getDouble("gear");
-    act_node.setDouble("gear", gear );
+    double gear = flight_gear.get();
+    act_gear.set( gear );
 
     // CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!!
     // CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!! CAUTION!!!
@@ -211,31 +252,31 @@ static void set_actuator_values_ap() {
 
     // throttle
 
-    double throttle = engine_node.getDouble("throttle");
+    double throttle = engine_throttle.get();
     if ( signal_inject == "throttle" ) { throttle += signal_val; }
-    act_node.setDouble("throttle", throttle );
+    act_throttle.set( throttle );
 
     static bool sas_throttle_override = false;
 
     if ( !sas_throttle_override ) {
-	if ( ap_node.getString("mode") == "sas" ) {
+	if ( ap_mode.get() == "sas" ) {
 	    // in sas mode require a sequence of zero throttle, full
 	    // throttle, and zero throttle again before throttle pass
 	    // through can become active under 100' AGL
 
 	    static int sas_throttle_state = 0;
 	    if ( sas_throttle_state == 0 ) {
-		if ( engine_node.getDouble("throttle") < 0.05 ) {
+		if ( engine_throttle.get() < 0.05 ) {
 		    // wait for zero throttle
 		    sas_throttle_state = 1;
 		}
 	    } else if ( sas_throttle_state == 1 ) {
-		if ( engine_node.getDouble("throttle") > 0.95 ) {
+		if ( engine_throttle.get() > 0.95 ) {
 		    // next wait for full throttle
 		    sas_throttle_state = 2;
 		}
 	    } else if ( sas_throttle_state == 2 ) {
-		if ( engine_node.getDouble("throttle") < 0.05 ) {
+		if ( engine_throttle.get() < 0.05 ) {
 		    // next wait for zero throttle again.  Throttle pass
 		    // through is now live, even under 100' AGL
 		    sas_throttle_state = 3;
@@ -251,8 +292,8 @@ static void set_actuator_values_ap() {
     // elevation is the pressure altitude we recorded with the system
     // started up.
     if ( ! sas_throttle_override ) {
-	if ( act_node.getBool("throttle_safety") ) {
-	    act_node.setDouble("throttle", 0.0 );
+	if ( act_throttle_safety.get() ) {
+	    act_throttle.set( 0.0 );
 	}
     }
 
@@ -271,34 +312,34 @@ static void set_actuator_values_pilot_pass_through() {
     // directly on APM2/Aura3 hardware.
     double signal_val = 0.0;
     string signal_inject = "";
-    if ( signal_node.getBool("running") ) {
-	signal_val = signal_node.getDouble("value");
-	signal_inject = signal_node.getString("inject");
+    if ( signal_running.get() ) {
+	signal_val = signal_value.get();
+	signal_inject = signal_inject_node.get();
     }
     
-    float aileron = pilot_node.getDouble("aileron");
+    float aileron = pilot_aileron.get();
     if ( signal_inject == "aileron" ) { aileron += signal_val; }
-    act_node.setDouble( "aileron", aileron );
+    act_aileron.set( aileron );
 
-    float elevator = pilot_node.getDouble("elevator");
+    float elevator = pilot_elevator.get();
     if ( signal_inject == "elevator" ) { elevator += signal_val; }
-    act_node.setDouble( "elevator", elevator );
+    act_elevator.set( elevator );
 
     // rudder
-    float rudder = pilot_node.getDouble("rudder");
+    float rudder = pilot_rudder.get();
     if ( signal_inject == "rudder" ) { rudder += signal_val; }
-    act_node.setDouble( "rudder", rudder );
+    act_rudder.set( rudder );
 
-    double flaps = pilot_node.getDouble("flaps");
+    double flaps = pilot_flaps.get();
     if ( signal_inject == "flaps" ) { flaps += signal_val; }
-    act_node.setDouble("flaps", flaps );
+    act_flaps.set( flaps );
 
-    double gear = pilot_node.getDouble("gear");
-    act_node.setDouble("gear", gear );
+    double gear = pilot_gear.get();
+    act_gear.set( gear );
 
-    double throttle = pilot_node.getDouble("throttle");
+    double throttle = pilot_throttle.get();
     if ( signal_inject == "throttle" ) { throttle += signal_val; }
-    act_node.setDouble("throttle", throttle );
+    act_throttle.set( throttle );
 }
 
 
@@ -308,9 +349,9 @@ bool Actuator_update() {
     // printf("Actuator_update()\n");
 
     // time stamp for logging
-    act_node.setDouble( "timestamp", get_Time() );
-    if ( ap_node.getBool("master_switch") ) {
-	string mode = ap_node.getString("flight_mode");
+    act_timestamp.set( get_Time() );
+    if ( ap_master_switch.get() ) {
+	string mode = ap_flight_mode.get();
 	if ( mode == "pilot_pass_through" ) {
 	    set_actuator_values_pilot_pass_through();
 	} else {
@@ -320,7 +361,6 @@ bool Actuator_update() {
 
     debug_act1.stop();
 
-    static int remote_link_count = 0;
     static int logging_count = 0;
 
     bool fresh_data = true; // always true
@@ -355,11 +395,9 @@ bool Actuator_update() {
 		   module.c_str());
 	}
 	if ( fresh_data ) {
-	    bool send_remote_link = false;
-	    if ( remote_link_count < 0 ) {
-		send_remote_link = true;
-		remote_link_count = remote_link_skip;
-	    }
+	    // the primary section goes out from the frame snapshot
+	    // (see comms/remote_link.hxx)
+	    bool send_remote_link = i > 0 && remote_link->is_open();
 	
 	    bool send_logging = false;
 	    if ( logging_count < 0 ) {
@@ -382,7 +420,6 @@ bool Actuator_update() {
 
 
     if ( fresh_data ) {
-        remote_link_count--;
         logging_count--;
     }
 
@@ -0,0 +1,343 @@
+//
+// compact.cxx - compact (delta/quantized) telemetry encoding for the
+// remote link
+//
+// This code is released into the public domain.
+//
+
+#include <math.h>
+#include <string.h>
+
+#include "comms/packet_id.hxx"
+#include "util/serial_framer.hxx"
+
+#include "compact.hxx"
+
+
+// The packets this handles: struct layout (must match packer.py) and
+// the default quantization (power of ten exponent) of each float and
+// double field, in field order.  The first field is always the
+// section index.
+static const struct {
+    uint8_t id;
+    const char *fmt;
+    struct {
+	const char *name;
+	int exp;
+    } quant[AuraCompactEncoder::MAX_QUANT];
+} formats[] = {
+    { GPS_PACKET_V3, "<BdddfhhhdBHHHB",
+      { {"timestamp", -3}, {"latitude_deg", -7}, {"longitude_deg", -7},
+	{"altitude_m", -2}, {"unix_time_sec", -3} } },
+    { IMU_PACKET_V3, "<BdfffffffffhB",
+      { {"timestamp", -3}, {"p_rad_sec", -4}, {"q_rad_sec", -4},
+	{"r_rad_sec", -4}, {"ax_mps_sec", -3}, {"ay_mps_sec", -3},
+	{"az_mps_sec", -3}, {"hx", -3}, {"hy", -3}, {"hz", -3} } },
+    { AIRDATA_PACKET_V5, "<BdHhhffhHBBB",
+      { {"timestamp", -3}, {"altitude_smoothed_m", -2},
+	{"altitude_true_m", -2} } },
+    { FILTER_PACKET_V3, "<BdddfhhhhhhhhhhhhBB",
+      { {"timestamp", -3}, {"latitude_deg", -7}, {"longitude_deg", -7},
+	{"altitude_m", -2} } },
+    { ACTUATOR_PACKET_V2, "<BdhhHhhhhhB", { {"timestamp", -3} } },
+    { PILOT_INPUT_PACKET_V2, "<BdhhhhhhhhB", { {"timestamp", -3} } },
+    { AP_STATUS_PACKET_V5, "<BdBhhHHhhHHddHHB",
+      { {"frame_time", -3}, {"wp_longitude_deg", -7},
+	{"wp_latitude_deg", -7} } },
+    { SYSTEM_HEALTH_PACKET_V4, "<BdHHHHHH", { {"timestamp", -3} } },
+    { PAYLOAD_PACKET_V2, "<BdH", { {"timestamp", -3} } }
+};
+static const int NUM_FORMATS = sizeof(formats) / sizeof(formats[0]);
+
+static const int MAX_PAYLOAD = 255;
+
+
+static int field_size( char c ) {
+    switch ( c ) {
+    case 'B': return 1;
+    case 'H': case 'h': return 2;
+    case 'f': return 4;
+    case 'd': return 8;
+    }
+    return 0;
+}
+
+static inline uint64_t zigzag( int64_t v ) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int put_varint( uint8_t *buf, int64_t v ) {
+    uint64_t u = zigzag( v );
+    int n = 0;
+    while ( u >= 0x80 ) {
+	buf[n++] = (uint8_t)(u | 0x80);
+	u >>= 7;
+    }
+    buf[n++] = (uint8_t)u;
+    return n;
+}
+
+// room for the header, the exponents or the mask, and the longest
+// varints
+static const int WORK_SIZE = 4 + AuraCompactEncoder::MAX_FIELDS
+    + AuraCompactEncoder::MAX_FIELDS * 10;
+
+
+AuraCompactEncoder::AuraCompactEncoder():
+    keyframe_sec(2.0),
+    use_ack(true),
+    full_bytes(0),
+    compact_bytes(0),
+    keyframes(0),
+    deltas(0)
+{
+    for ( int i = 0; i < 256; i++ ) {
+	format_of[i] = -1;
+    }
+    memset( exps, 0, sizeof(exps) );
+    for ( int f = 0; f < NUM_FORMATS; f++ ) {
+	format_of[formats[f].id] = f;
+	for ( int i = 0; i < MAX_QUANT && formats[f].quant[i].name; i++ ) {
+	    exps[formats[f].id][i] = formats[f].quant[i].exp;
+	}
+    }
+}
+
+
+int AuraCompactEncoder::num_quantized( uint8_t packet_id ) const {
+    int f = format_of[packet_id];
+    if ( f < 0 ) {
+	return 0;
+    }
+    int n = 0;
+    while ( n < MAX_QUANT && formats[f].quant[n].name ) {
+	n++;
+    }
+    return n;
+}
+
+const char *AuraCompactEncoder::quantized_name( uint8_t packet_id,
+						int i ) const
+{
+    if ( i < 0 || i >= num_quantized(packet_id) ) {
+	return NULL;
+    }
+    return formats[format_of[packet_id]].quant[i].name;
+}
+
+void AuraCompactEncoder::set_quantum( uint8_t packet_id, int i,
+				      double quantum )
+{
+    if ( i < 0 || i >= num_quantized(packet_id) || quantum <= 0.0 ) {
+	return;
+    }
+    int exp = (int)floor( log10(quantum) + 0.5 );
+    if ( exp < -12 ) exp = -12;
+    if ( exp > 12 ) exp = 12;
+    exps[packet_id][i] = exp;
+}
+
+
+AuraCompactEncoder::stream *
+AuraCompactEncoder::get_stream( uint8_t id, uint8_t index, bool create ) {
+    for ( unsigned int i = 0; i < streams.size(); i++ ) {
+	if ( streams[i].id == id && streams[i].index == index ) {
+	    return &streams[i];
+	}
+    }
+    if ( ! create ) {
+	return NULL;
+    }
+    stream s;
+    s.id = id;
+    s.index = index;
+    s.next_seq = 0;
+    s.last_key_time = -1.0;
+    s.have_ref = false;
+    s.num_sent = 0;
+    streams.push_back( s );
+    return &streams.back();
+}
+
+
+// every field after the index as an integer, returns the number of
+// fields.  -1 if the payload doesn't match the format or a value
+// doesn't quantize.
+int AuraCompactEncoder::quantize( int format, const uint8_t *payload,
+				  int len, int64_t *q ) const
+{
+    const char *fmt = formats[format].fmt + 1;	// skip '<'
+    const int8_t *e = exps[formats[format].id];
+    int pos = 0;
+    int n = 0;
+    for ( int i = 0; fmt[i]; i++ ) {
+	int size = field_size( fmt[i] );
+	if ( pos + size > len ) {
+	    return -1;
+	}
+	const uint8_t *p = payload + pos;
+	pos += size;
+	if ( i == 0 ) {
+	    continue;		// section index (in the header)
+	}
+	if ( n >= MAX_FIELDS ) {
+	    return -1;
+	}
+	switch ( fmt[i] ) {
+	case 'B': q[n] = p[0]; break;
+	case 'H': { uint16_t v; memcpy( &v, p, 2 ); q[n] = v; break; }
+	case 'h': { int16_t v; memcpy( &v, p, 2 ); q[n] = v; break; }
+	case 'f': case 'd': {
+	    double v;
+	    if ( fmt[i] == 'f' ) {
+		float fv;
+		memcpy( &fv, p, 4 );
+		v = fv;
+	    } else {
+		memcpy( &v, p, 8 );
+	    }
+	    double scaled = v * pow( 10.0, -(*e++) );
+	    if ( ! (fabs(scaled) < 4.0e18) ) {
+		return -1;	// nan, inf or too big for the exponent
+	    }
+	    q[n] = llround( scaled );
+	    break;
+	}
+	default:
+	    return -1;
+	}
+	n++;
+    }
+    return (pos == len) ? n : -1;
+}
+
+
+int AuraCompactEncoder::encode( const uint8_t *pkt, int len, uint8_t *out,
+				double now )
+{
+    if ( len < 7 || pkt[3] + 6 != len ) {
+	return 0;
+    }
+    uint8_t id = pkt[2];
+    int format = format_of[id];
+    if ( format < 0 ) {
+	return 0;
+    }
+    const uint8_t *payload = pkt + 4;
+    int64_t q[MAX_FIELDS];
+    int nfields = quantize( format, payload, pkt[3], q );
+    if ( nfields < 0 ) {
+	return 0;
+    }
+    int nquant = num_quantized( id );
+    stream *s = get_stream( id, payload[0], true );
+
+    // too many keyframes since the reference, its sequence number is
+    // about to be reused
+    if ( s->have_ref && (uint8_t)(s->next_seq - s->ref.seq) >= 128 ) {
+	s->have_ref = false;
+    }
+
+    uint8_t key[WORK_SIZE];
+    int key_len = 0;
+    key[key_len++] = id;
+    key[key_len++] = s->index;
+    key[key_len++] = s->next_seq;
+    key[key_len++] = 1;
+    for ( int i = 0; i < nquant; i++ ) {
+	key[key_len++] = (uint8_t)exps[id][i];
+    }
+    for ( int i = 0; i < nfields; i++ ) {
+	key_len += put_varint( key + key_len, q[i] );
+    }
+
+    uint8_t delta[WORK_SIZE];
+    int delta_len = WORK_SIZE;
+    if ( s->have_ref ) {
+	delta_len = 0;
+	delta[delta_len++] = id;
+	delta[delta_len++] = s->index;
+	delta[delta_len++] = s->ref.seq;
+	delta[delta_len++] = 0;
+	uint8_t *mask = delta + delta_len;
+	int mask_len = (nfields + 7) / 8;
+	memset( mask, 0, mask_len );
+	delta_len += mask_len;
+	for ( int i = 0; i < nfields; i++ ) {
+	    if ( q[i] != s->ref.q[i] ) {
+		mask[i / 8] |= 1 << (i % 8);
+		delta_len += put_varint( delta + delta_len,
+					 q[i] - s->ref.q[i] );
+	    }
+	}
+    }
+
+    // decide everything before touching the keyframe state: once it
+    // is updated the caller must send what we return
+    bool keyframe_due = ! s->have_ref
+	|| now - s->last_key_time >= keyframe_sec
+	|| delta_len >= key_len;
+    const uint8_t *body = keyframe_due ? key : delta;
+    int body_len = keyframe_due ? key_len : delta_len;
+    if ( body_len > MAX_PAYLOAD || body_len + 6 >= len ) {
+	return 0;		// no smaller than the original, send it as is
+    }
+
+    if ( keyframe_due ) {
+	keyframe &k = s->sent[s->next_seq % HISTORY];
+	k.seq = s->next_seq;
+	memcpy( k.q, q, sizeof(k.q) );
+	if ( s->num_sent < HISTORY ) {
+	    s->num_sent++;
+	}
+	if ( ! use_ack ) {
+	    s->ref = k;
+	    s->have_ref = true;
+	}
+	s->next_seq++;
+	s->last_key_time = now;
+	keyframes++;
+    } else {
+	deltas++;
+    }
+
+    out[0] = START_OF_MSG0;
+    out[1] = START_OF_MSG1;
+    out[2] = COMPACT_PACKET_V1;
+    out[3] = body_len;
+    memcpy( out + 4, body, body_len );
+    fletcher8( out + 2, body_len + 2, out + 4 + body_len,
+	       out + 5 + body_len );
+
+    full_bytes += len;
+    compact_bytes += body_len + 6;
+    return body_len + 6;
+}
+
+
+void AuraCompactEncoder::ack( uint8_t packet_id, uint8_t index,
+			      uint8_t seq )
+{
+    stream *s = get_stream( packet_id, index, false );
+    if ( s == NULL ) {
+	return;
+    }
+    keyframe &k = s->sent[seq % HISTORY];
+    int age = (uint8_t)(s->next_seq - seq);
+    if ( age < 1 || age > s->num_sent || k.seq != seq ) {
+	return;			// not one of the recent keyframes
+    }
+    if ( s->have_ref && (int8_t)(seq - s->ref.seq) <= 0 ) {
+	return;			// already have this or a newer one
+    }
+    s->ref = k;
+    s->have_ref = true;
+}
+
+
+void AuraCompactEncoder::end_window() {
+    full_bytes = 0;
+    compact_bytes = 0;
+    keyframes = 0;
+    deltas = 0;
+}
@@ -0,0 +1,116 @@
+//
+// compact.hxx - compact (delta/quantized) telemetry encoding for the
+// remote link
+//
+// Re-encodes the fixed layout state packets (gps v3, imu v3, airdata
+// v5, filter v3, actuator v2, pilot v2, ap status v5, health v4,
+// payload v2) as a COMPACT_PACKET_V1 that the ground expands back into
+// the original payload (comms/compact.py.)  The struct layout of each
+// packet (same format strings as packer.py) drives the encoding:
+//
+//  - every field becomes an integer: the integer fields as is, the
+//    float and double fields quantized to a power of ten (lat/lon to
+//    1e-7 deg, timestamps to 1 msec, ... configurable per field.)
+//  - a keyframe carries the quantization exponents and all values as
+//    zigzag varints.
+//  - a delta names the keyframe it is relative to and carries a
+//    bitmask of the fields that differ from it plus the differences
+//    as zigzag varints.  Deltas never chain, so a lost packet costs
+//    just that packet.
+//
+// A keyframe goes out when there is no reference yet, every
+// keyframe_sec, or when a delta wouldn't be smaller.  With acks on,
+// deltas are relative to the newest keyframe the ground has
+// acknowledged (COMPACT_ACK_PACKET_V1 on the uplink), otherwise to the
+// newest keyframe sent.
+//
+// Payload layout (after the usual framing):
+//   source packet id, section index, keyframe sequence, flags
+//   keyframe (flags & 1): int8 exponent per quantized field, values
+//   delta: field bitmask (1 bit per field after the index), values
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_COMPACT_HXX
+#define _AURA_COMPACT_HXX
+
+#include <stdint.h>
+
+#include <vector>
+using std::vector;
+
+
+class AuraCompactEncoder {
+
+public:
+
+    static const int MAX_FIELDS = 24;
+    static const int MAX_QUANT = 12;
+    static const int HISTORY = 8;	// unacknowledged keyframes kept
+
+    AuraCompactEncoder();
+    ~AuraCompactEncoder() {}
+
+    inline void set_keyframe_sec( double sec ) { keyframe_sec = sec; }
+    inline void set_ack( bool ack ) { use_ack = ack; }
+
+    // quantized (float/double) fields of a packet id, by name.
+    // Quantum is rounded to a power of ten.
+    int num_quantized( uint8_t packet_id ) const;
+    const char *quantized_name( uint8_t packet_id, int i ) const;
+    void set_quantum( uint8_t packet_id, int i, double quantum );
+
+    // framed packet in, framed compact packet out.  Returns 0 if the
+    // packet id isn't handled or the compact packet wouldn't be
+    // smaller (send it as is.)  A non-zero result must be sent: a
+    // keyframe is recorded as sent here.
+    int encode( const uint8_t *pkt, int len, uint8_t *out, double now );
+
+    // the ground received keyframe 'seq' of this id and section
+    void ack( uint8_t packet_id, uint8_t index, uint8_t seq );
+
+    // statistics (since the last end_window())
+    inline unsigned long get_full_bytes() const { return full_bytes; }
+    inline unsigned long get_compact_bytes() const { return compact_bytes; }
+    inline unsigned long get_keyframes() const { return keyframes; }
+    inline unsigned long get_deltas() const { return deltas; }
+    void end_window();
+
+private:
+
+    struct keyframe {
+	uint8_t seq;
+	int64_t q[MAX_FIELDS];
+    };
+
+    struct stream {
+	uint8_t id;
+	uint8_t index;
+	uint8_t next_seq;
+	double last_key_time;	// newest keyframe sent
+	bool have_ref;
+	keyframe ref;		// deltas are relative to this one
+	keyframe sent[HISTORY];	// waiting for an ack
+	int num_sent;
+    };
+
+    int format_of[256];
+    int8_t exps[256][MAX_QUANT];
+    vector<stream> streams;
+
+    double keyframe_sec;
+    bool use_ack;
+
+    unsigned long full_bytes;
+    unsigned long compact_bytes;
+    unsigned long keyframes;
+    unsigned long deltas;
+
+    stream *get_stream( uint8_t id, uint8_t index, bool create );
+    int quantize( int format, const uint8_t *payload, int len,
+		  int64_t *q ) const;
+};
+
+
+#endif // _AURA_COMPACT_HXX
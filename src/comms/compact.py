@@ -0,0 +1,114 @@
+# compact.py - ground side decoder for the compact (delta/quantized)
+# telemetry packets (see compact.hxx for the encoding.)
+#
+# decode() expands a COMPACT_PACKET_V1 payload back into the payload
+# of the original packet so it can go through the usual packer.py
+# unpack functions and into the flight log unchanged.
+
+import struct
+
+from packet_id import *
+import packer
+
+# must match the format table in compact.cxx
+formats = {
+    GPS_PACKET_V3: packer.gps_v3_fmt,
+    IMU_PACKET_V3: packer.imu_v3_fmt,
+    AIRDATA_PACKET_V5: packer.airdata_v5_fmt,
+    FILTER_PACKET_V3: packer.filter_v3_fmt,
+    ACTUATOR_PACKET_V2: packer.act_v2_fmt,
+    PILOT_INPUT_PACKET_V2: packer.pilot_v2_fmt,
+    AP_STATUS_PACKET_V5: packer.ap_status_v5_fmt,
+    SYSTEM_HEALTH_PACKET_V4: packer.system_health_v4_fmt,
+    PAYLOAD_PACKET_V2: packer.payload_v2_fmt,
+}
+
+# keyframes received: (packet id, index) -> { seq: (exps, values) }
+keyframes = {}
+
+# statistics
+compact_bytes = 0
+full_bytes = 0
+dropped = 0
+
+def read_varint(buf, pos):
+    result = 0
+    shift = 0
+    while True:
+        b = ord(buf[pos]); pos += 1
+        result |= (b & 0x7f) << shift
+        shift += 7
+        if b < 0x80:
+            break
+    # zigzag
+    return (result >> 1) ^ -(result & 1), pos
+
+# returns (packet id, payload, ack): payload is None if this is a
+# delta against a keyframe we never received, ack is the framed
+# COMPACT_ACK_PACKET_V1 to send back for a keyframe (else None.)
+def decode(buf):
+    global compact_bytes
+    global full_bytes
+    global dropped
+
+    pkt_id, index, seq, flags = struct.unpack('<BBBB', buf[0:4])
+    if not pkt_id in formats:
+        return (pkt_id, None, None)
+    fmt = formats[pkt_id]
+    types = fmt[2:]             # skip '<' and the index
+    nquant = types.count('f') + types.count('d')
+    pos = 4
+    stream = keyframes.setdefault((pkt_id, index), {})
+    if flags & 1:
+        exps = struct.unpack('<%db' % nquant, buf[pos:pos+nquant])
+        pos += nquant
+        values = []
+        for t in types:
+            v, pos = read_varint(buf, pos)
+            values.append(v)
+        # the encoder never references a keyframe 128 or more behind
+        # its newest one (seq is 8 bits), drop those so a delta against
+        # a lost keyframe counts as dropped instead of decoding against
+        # an old one with the same seq
+        for old in stream.keys():
+            if (seq - old) & 0xff >= 128:
+                del stream[old]
+        stream[seq] = (exps, values)
+        ack = pack_ack(pkt_id, index, seq)
+    else:
+        if not seq in stream:
+            dropped += 1
+            return (pkt_id, None, None)
+        exps, ref = stream[seq]
+        nmask = (len(types) + 7) / 8
+        mask = [ord(c) for c in buf[pos:pos+nmask]]
+        pos += nmask
+        values = list(ref)
+        for i in range(len(types)):
+            if mask[i / 8] & (1 << (i % 8)):
+                d, pos = read_varint(buf, pos)
+                values[i] += d
+        ack = None
+
+    # back to the original field values
+    fields = [index]
+    q = 0
+    for i, t in enumerate(types):
+        if t == 'f' or t == 'd':
+            fields.append(values[i] * 10.0 ** exps[q])
+            q += 1
+        else:
+            fields.append(values[i])
+    payload = struct.pack(fmt, *fields)
+    compact_bytes += len(buf) + 6
+    full_bytes += len(payload) + 6
+    return (pkt_id, payload, ack)
+
+def pack_ack(pkt_id, index, seq):
+    buf = struct.pack('<BBB', pkt_id, index, seq)
+    return packer.wrap_packet(COMPACT_ACK_PACKET_V1, buf)
+
+def get_ratio():
+    if compact_bytes == 0:
+        return 0.0
+    return float(full_bytes) / compact_bytes
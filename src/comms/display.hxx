@@ -17,8 +17,14 @@ public:
     pyModuleDisplay();
     ~pyModuleDisplay() {}
 
+    bool init(const char *import_name);
     bool show(const char *message);
     void status_summary();
+
+private:
+
+    PyObject *pFuncShow;
+    PyObject *pFuncStatusSummary;
 };
 
 #endif // _AURA_DISPLAY_HXX
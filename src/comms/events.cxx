@@ -1,33 +1,27 @@
 #include "events.hxx"
 
-pyModuleEventLog::pyModuleEventLog()
+pyModuleEventLog::pyModuleEventLog():
+    pFuncLog(NULL)
 {
 }
 
-bool pyModuleEventLog::log(const char *header, const char *message)
+bool pyModuleEventLog::init(const char *import_name)
 {
-    if (pModuleObj == NULL) {
-	printf("ERROR: events.init() failed\n");
-	return false;
-    }
-    PyObject *pFuncLog = PyObject_GetAttrString(pModuleObj, "log");
-    if ( pFuncLog == NULL || ! PyCallable_Check(pFuncLog) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'log()'\n");
-	return false;
+    bool result = pyModuleBase::init(import_name);
+    if ( pModuleObj != NULL ) {
+	pFuncLog = get_method("log");
     }
+    return result;
+}
 
-    // FIXME decref pFuncLog
-    
-    PyObject *pValue = PyObject_CallFunction(pFuncLog, (char *)"ss", header, message);
-    if (pValue != NULL) {
-	bool result = PyObject_IsTrue(pValue);
-	Py_DECREF(pValue);
-	return result;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
+bool pyModuleEventLog::log(const char *header, const char *message,
+			   bool send_to_remote)
+{
+    if ( pFuncLog == NULL ) {
+	printf("ERROR: events.init() failed\n");
 	return false;
     }
-    return false;
+    return check_result( PyObject_CallFunction(pFuncLog, (char *)"ssi",
+					       header, message,
+					       (int)send_to_remote) );
 }
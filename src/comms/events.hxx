@@ -15,7 +15,13 @@ public:
     pyModuleEventLog();
     ~pyModuleEventLog() {}
 
-    bool log(const char *header, const char *message);
+    bool init(const char *import_name);
+    bool log(const char *header, const char *message,
+	     bool send_to_remote=false);
+
+private:
+
+    PyObject *pFuncLog;
 };
 
 #endif // _AURA_EVENTS_HXX
@@ -0,0 +1,209 @@
+# flight_log.py - random access reader for flight.dat.gz (see
+# log_blocks.hxx for the layout.)
+#
+# The log is a series of independently compressed blocks with an index
+# of their time span and packet counts, so a time window or a single
+# message class can be pulled out without decompressing the rest.
+# Logs written before the block format (one plain gzip stream) still
+# open, they just read as a single block.
+#
+#   log = flight_log.FlightLog('flight.dat.gz')
+#   buf = log.read(start=120.0, end=180.0, ids=[GPS_PACKET_V3])
+#
+# read() returns the framed packets (the same bytes zcat would produce
+# for that part of the log) so the usual parsers work unchanged.
+
+import gzip
+import os
+import struct
+import zlib
+
+from serial_parser import START_OF_MSG0, START_OF_MSG1
+
+VERSION = 1
+
+GZ_HEADER_SIZE = 12             # including the extra length
+GZ_TRAILER_SIZE = 8
+LOCATOR_SIZE = GZ_HEADER_SIZE + 4 + 17 + 2 + GZ_TRAILER_SIZE
+
+class Block:
+    def __init__(self, offset, t0=0.0, t1=0.0, counts=None):
+        self.offset = offset
+        self.t0 = t0
+        self.t1 = t1
+        self.counts = counts    # packet id -> number of packets
+        if self.counts == None:
+            self.counts = {}
+
+# the time span and counts shared by the block headers and the index
+# entries, returns (block, bytes used)
+def parse_block_info(offset, data, pos):
+    t0, t1, n = struct.unpack_from('<ddH', data, pos)
+    pos += 18
+    counts = {}
+    for i in range(n):
+        id, count = struct.unpack_from('<BI', data, pos)
+        counts[id] = count
+        pos += 5
+    return (Block(offset, t0, t1, counts), pos)
+
+# iterate over the framed packets in buf: (id, payload, frame)
+def frames(buf):
+    pos = 0
+    while pos + 4 <= len(buf):
+        if ord(buf[pos]) != START_OF_MSG0 or ord(buf[pos+1]) != START_OF_MSG1:
+            pos += 1
+            continue
+        id = ord(buf[pos+2])
+        size = ord(buf[pos+3])
+        end = pos + 4 + size + 2
+        if end > len(buf):
+            break
+        yield (id, buf[pos+4:pos+4+size], buf[pos:end])
+        pos = end
+
+class FlightLog:
+    def __init__(self, filename):
+        self.filename = filename
+        self.f = open(filename, 'rb')
+        self.f.seek(0, os.SEEK_END)
+        self.size = self.f.tell()
+        self.blocks = []
+        self.indexed = self.read_footer() or self.scan_headers()
+        if not self.indexed:
+            self.blocks = [ Block(0) ]
+
+    def close(self):
+        self.f.close()
+
+    # (header size, extra subfields) of the gzip member at offset, None
+    # if there isn't one with an extra field
+    def read_member_header(self, offset):
+        self.f.seek(offset)
+        hdr = self.f.read(GZ_HEADER_SIZE)
+        if len(hdr) < GZ_HEADER_SIZE or hdr[0:4] != '\x1f\x8b\x08\x04':
+            return None
+        xlen = struct.unpack_from('<H', hdr, 10)[0]
+        extra = self.f.read(xlen)
+        if len(extra) < xlen:
+            return None
+        fields = {}
+        pos = 0
+        while pos + 4 <= xlen:
+            sublen = struct.unpack_from('<H', extra, pos + 2)[0]
+            fields[extra[pos:pos+2]] = extra[pos+4:pos+4+sublen]
+            pos += 4 + sublen
+        return (GZ_HEADER_SIZE + xlen, fields)
+
+    def read_footer(self):
+        if self.size < LOCATOR_SIZE:
+            return False
+        result = self.read_member_header(self.size - LOCATOR_SIZE)
+        if result == None or not 'AL' in result[1]:
+            return False
+        data = result[1]['AL']
+        if len(data) < 17 or ord(data[0]) != VERSION:
+            return False
+        offset, members, count = struct.unpack_from('<QII', data, 1)
+        blocks = []
+        for m in range(members):
+            result = self.read_member_header(offset)
+            if result == None or not 'AI' in result[1]:
+                return False
+            data = result[1]['AI']
+            if ord(data[0]) != VERSION:
+                return False
+            n = struct.unpack_from('<H', data, 1)[0]
+            pos = 3
+            for i in range(n):
+                block_offset = struct.unpack_from('<Q', data, pos)[0]
+                (block, pos) = parse_block_info(block_offset, data, pos + 8)
+                blocks.append(block)
+            offset += result[0] + 2 + GZ_TRAILER_SIZE
+        if len(blocks) != count:
+            return False
+        self.blocks = blocks
+        return True
+
+    # no footer (the log wasn't closed): walk the block headers
+    def scan_headers(self):
+        blocks = []
+        offset = 0
+        while True:
+            result = self.read_member_header(offset)
+            if result == None or not 'AB' in result[1]:
+                break
+            data = result[1]['AB']
+            if ord(data[0]) != VERSION:
+                break
+            deflate_len = struct.unpack_from('<I', data, 1)[0]
+            next = offset + result[0] + deflate_len + GZ_TRAILER_SIZE
+            if next > self.size:
+                break           # truncated
+            (block, pos) = parse_block_info(offset, data, 5)
+            blocks.append(block)
+            offset = next
+        self.blocks = blocks
+        return len(blocks) > 0
+
+    # first block that may hold packets at or after time t
+    def find_block(self, t):
+        if not self.indexed:
+            return 0
+        # only roughly in time order, so no binary search
+        i = 0
+        while i < len(self.blocks) and self.blocks[i].t1 < t:
+            i += 1
+        return i
+
+    # decompressed contents of block i
+    def read_block(self, i):
+        if not self.indexed:
+            f = gzip.open(self.filename, 'rb')
+            buf = f.read()
+            f.close()
+            return buf
+        block = self.blocks[i]
+        (hdr_len, fields) = self.read_member_header(block.offset)
+        deflate_len = struct.unpack_from('<I', fields['AB'], 1)[0]
+        self.f.seek(block.offset + hdr_len)
+        return zlib.decompressobj(-15).decompress(self.f.read(deflate_len))
+
+    # time span of the log (0, 0 for a log without an index)
+    def start_time(self):
+        return self.blocks[0].t0
+    def end_time(self):
+        return self.blocks[-1].t1
+
+    # the framed packets between start and end (seconds, log time) of
+    # the given packet ids (default everything.)  Blocks outside the
+    # window or without any of the ids aren't decompressed; inside a
+    # block packets are trimmed by their timestamp.
+    def read(self, start=None, end=None, ids=None):
+        first = 0
+        if start != None:
+            first = self.find_block(start)
+        result = []
+        for i in range(first, len(self.blocks)):
+            block = self.blocks[i]
+            if self.indexed:
+                if end != None and block.t0 > end:
+                    continue
+                if ids != None and not [id for id in ids if id in block.counts]:
+                    continue
+            buf = self.read_block(i)
+            if ids == None and start == None and end == None:
+                result.append(buf)
+                continue
+            for (id, payload, frame) in frames(buf):
+                if ids != None and not id in ids:
+                    continue
+                if (start != None or end != None) and len(payload) >= 9:
+                    # every logged packet has its timestamp after the
+                    # index byte
+                    t = struct.unpack_from('<d', payload, 1)[0]
+                    if (start != None and t < start) \
+                       or (end != None and t > end):
+                        continue
+                result.append(frame)
+        return ''.join(result)
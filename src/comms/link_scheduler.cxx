@@ -0,0 +1,348 @@
+//
+// link_scheduler.cxx - byte budgeted telemetry scheduler for the
+// remote link
+//
+// This code is released into the public domain.
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "link_scheduler.hxx"
+
+
+AuraLinkScheduler::AuraLinkScheduler():
+    default_class(0),
+    fifo_head(0),
+    fifo_count(0),
+    fifo_dropped(0),
+    encoder(NULL),
+    fd(-1),
+    bytes_per_sec(0.0),
+    credit(0.0),
+    last_time(-1.0),
+    out_head(0),
+    out_tail(0),
+    window_bytes(0)
+{
+    for ( int i = 0; i < 256; i++ ) {
+	class_of[i] = -1;
+    }
+
+    // the control thread may wait on the main thread here, lend it
+    // our priority while it does
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_setprotocol( &attr, PTHREAD_PRIO_INHERIT );
+    pthread_mutex_init( &lock, &attr );
+    pthread_mutexattr_destroy( &attr );
+}
+
+AuraLinkScheduler::~AuraLinkScheduler() {
+    pthread_mutex_destroy( &lock );
+}
+
+
+int AuraLinkScheduler::add_class( const string &name, int priority,
+				  double rate_hz, bool queued )
+{
+    link_class c;
+    c.name = name;
+    c.priority = priority;
+    c.period = (rate_hz > 0.0) ? 1.0 / rate_hz : 0.0;
+    c.queued = queued;
+    c.next_time = 0.0;
+    c.next_slot = 0;
+    memset( &c.stats, 0, sizeof(c.stats) );
+    classes.push_back( c );
+    return classes.size() - 1;
+}
+
+void AuraLinkScheduler::map_id( uint8_t packet_id, int cls ) {
+    class_of[packet_id] = cls;
+}
+
+
+void AuraLinkScheduler::open( int fd, double bytes_per_sec ) {
+    this->fd = fd;
+    this->bytes_per_sec = bytes_per_sec;
+    if ( fd >= 0 ) {
+	fcntl( fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK );
+    }
+}
+
+
+void AuraLinkScheduler::send( const uint8_t *buf, int size, double now ) {
+    if ( fd < 0 || size < 4 || size > MAX_PACKET
+	 || default_class >= (int)classes.size() )
+    {
+	return;
+    }
+    uint8_t id = buf[2];
+    int cls = class_of[id];
+    if ( cls < 0 ) {
+	cls = default_class;
+    }
+    if ( ! classes[cls].queued && classes[cls].period <= 0.0 ) {
+	return;
+    }
+
+    pthread_mutex_lock( &lock );
+    if ( classes[cls].queued ) {
+	if ( fifo_count == FIFO_SIZE ) {
+	    // full, make room by dropping the oldest
+	    fifo_head = (fifo_head + 1) % FIFO_SIZE;
+	    fifo_count--;
+	    fifo_dropped++;
+	}
+	queued_packet &p = fifo[(fifo_head + fifo_count) % FIFO_SIZE];
+	p.cls = cls;
+	p.stamp = now;
+	p.len = size;
+	memcpy( p.buf, buf, size );
+	fifo_count++;
+    } else {
+	send_state( cls, buf, size, now );
+    }
+    pthread_mutex_unlock( &lock );
+}
+
+// (lock held)
+void AuraLinkScheduler::send_state( int cls, const uint8_t *buf, int size,
+				    double now )
+{
+    uint8_t id = buf[2];
+
+    // newest value wins: overwrite the slot of this id and section
+    // (the first payload byte is the section index)
+    uint8_t index = (size > 6) ? buf[4] : 0;
+    state_slot *slot = NULL;
+    for ( unsigned int i = 0; i < slots.size(); i++ ) {
+	if ( slots[i].id == id && slots[i].index == index ) {
+	    slot = &slots[i];
+	    break;
+	}
+    }
+    if ( slot == NULL ) {
+	// first packet of its kind (the only allocation)
+	state_slot s;
+	s.cls = cls;
+	s.id = id;
+	s.index = index;
+	s.fresh = false;
+	slots.push_back( s );
+	slot = &slots.back();
+    }
+    if ( slot->fresh ) {
+	classes[cls].stats.coalesced++;
+    } else {
+	// latency counts from the oldest data waiting in the slot
+	slot->stamp = now;
+    }
+    memcpy( slot->buf, buf, size );
+    slot->len = size;
+    slot->fresh = true;
+}
+
+
+bool AuraLinkScheduler::is_pending( uint8_t packet_id, uint8_t index ) const
+{
+    bool result = false;
+    pthread_mutex_lock( &lock );
+    for ( unsigned int i = 0; i < slots.size(); i++ ) {
+	if ( slots[i].id == packet_id && slots[i].index == index ) {
+	    result = slots[i].fresh;
+	    break;
+	}
+    }
+    pthread_mutex_unlock( &lock );
+    return result;
+}
+
+size_t AuraLinkScheduler::get_queued_events() const {
+    pthread_mutex_lock( &lock );
+    size_t result = fifo_count;
+    pthread_mutex_unlock( &lock );
+    return result;
+}
+
+unsigned long AuraLinkScheduler::get_dropped_events() const {
+    pthread_mutex_lock( &lock );
+    unsigned long result = fifo_dropped;
+    pthread_mutex_unlock( &lock );
+    return result;
+}
+
+
+// the fresh slot of the most urgent due class (lowest priority value,
+// then the longest overdue), round robin over the sections of a
+// class.  Returns -1 if nothing is due.
+int AuraLinkScheduler::pick_slot( double now ) {
+    int best_cls = -1;
+    for ( unsigned int i = 0; i < slots.size(); i++ ) {
+	if ( ! slots[i].fresh ) {
+	    continue;
+	}
+	int cls = slots[i].cls;
+	const link_class &c = classes[cls];
+	if ( c.next_time > now || cls == best_cls ) {
+	    continue;
+	}
+	if ( best_cls < 0 || c.priority < classes[best_cls].priority
+	     || ( c.priority == classes[best_cls].priority
+		  && c.next_time < classes[best_cls].next_time ) )
+	{
+	    best_cls = cls;
+	}
+    }
+    if ( best_cls < 0 ) {
+	return -1;
+    }
+
+    link_class &c = classes[best_cls];
+    unsigned int n = slots.size();
+    for ( unsigned int k = 0; k < n; k++ ) {
+	unsigned int i = (c.next_slot + k) % n;
+	if ( slots[i].fresh && slots[i].cls == best_cls ) {
+	    c.next_slot = i + 1;
+	    return i;
+	}
+    }
+    return -1;
+}
+
+
+// copy a whole packet into the output ring, false if it doesn't fit
+bool AuraLinkScheduler::commit( int cls, const uint8_t *buf, int len,
+				double latency )
+{
+    if ( OUT_SIZE - (out_head - out_tail) < (size_t)len ) {
+	return false;
+    }
+    for ( int i = 0; i < len; i++ ) {
+	out[(out_head + i) & (OUT_SIZE - 1)] = buf[i];
+    }
+    out_head += len;
+    credit -= len;
+
+    class_stats &s = classes[cls].stats;
+    s.sent++;
+    s.latency_sum += latency;
+    if ( latency > s.latency_max ) {
+	s.latency_max = latency;
+    }
+    return true;
+}
+
+
+void AuraLinkScheduler::write_out() {
+    while ( out_head != out_tail ) {
+	size_t pos = out_tail & (OUT_SIZE - 1);
+	size_t len = out_head - out_tail;
+	if ( len > OUT_SIZE - pos ) {
+	    len = OUT_SIZE - pos;	// up to the end of the buffer
+	}
+	ssize_t result = write( fd, out + pos, len );
+	if ( result <= 0 ) {
+	    // EAGAIN: the driver buffer is full, try again next frame
+	    break;
+	}
+	out_tail += result;
+	window_bytes += result;
+	if ( (size_t)result < len ) {
+	    break;
+	}
+    }
+}
+
+
+void AuraLinkScheduler::update( double now ) {
+    if ( fd < 0 ) {
+	return;
+    }
+
+    // accrue the budget, allowing at most a quarter second (or one
+    // full size packet) of burst after an idle spell
+    if ( last_time >= 0.0 && now > last_time ) {
+	credit += bytes_per_sec * (now - last_time);
+	double burst = bytes_per_sec * 0.25;
+	if ( burst < MAX_PACKET ) {
+	    burst = MAX_PACKET;
+	}
+	if ( credit > burst ) {
+	    credit = burst;
+	}
+    }
+    last_time = now;
+
+    // Whole packets only.  A packet may take the credit negative, the
+    // debt is paid back before anything else goes out so the average
+    // rate stays within the budget.
+    pthread_mutex_lock( &lock );
+    while ( credit > 0.0 ) {
+	if ( fifo_count > 0 ) {
+	    // events and replies first, in order
+	    const queued_packet &p = fifo[fifo_head];
+	    if ( ! commit( p.cls, p.buf, p.len, now - p.stamp ) ) {
+		break;
+	    }
+	    fifo_head = (fifo_head + 1) % FIFO_SIZE;
+	    fifo_count--;
+	    continue;
+	}
+
+	int i = pick_slot( now );
+	if ( i < 0 ) {
+	    break;
+	}
+	state_slot &s = slots[i];
+	const uint8_t *buf = s.buf;
+	int len = s.len;
+	uint8_t compact[MAX_PACKET];
+	if ( encoder != NULL ) {
+	    // only encode what is sure to go out, the encoder keeps
+	    // track of what the ground has seen.  The compact packet may
+	    // be the raw one or any size up to MAX_PACKET.
+	    if ( OUT_SIZE - (out_head - out_tail) < (size_t)MAX_PACKET ) {
+		break;
+	    }
+	    int n = encoder->encode( s.buf, s.len, compact, now );
+	    if ( n > 0 ) {
+		buf = compact;
+		len = n;
+	    }
+	}
+	if ( ! commit( s.cls, buf, len, now - s.stamp ) ) {
+	    break;
+	}
+	s.fresh = false;
+
+	link_class &c = classes[s.cls];
+	c.next_time += c.period;
+	if ( c.next_time < now ) {
+	    // fell behind (budget or no data), don't try to catch up
+	    c.next_time = now;
+	}
+    }
+    pthread_mutex_unlock( &lock );
+
+    write_out();
+}
+
+
+void AuraLinkScheduler::end_window( vector<class_stats> *stats ) {
+    pthread_mutex_lock( &lock );
+    if ( stats != NULL ) {
+	stats->resize( classes.size() );
+    }
+    for ( unsigned int i = 0; i < classes.size(); i++ ) {
+	if ( stats != NULL ) {
+	    (*stats)[i] = classes[i].stats;
+	}
+	memset( &classes[i].stats, 0, sizeof(classes[i].stats) );
+    }
+    pthread_mutex_unlock( &lock );
+    window_bytes = 0;
+}
@@ -0,0 +1,179 @@
+//
+// link_scheduler.hxx - byte budgeted telemetry scheduler for the
+// remote link
+//
+// The radio modem carries far less than the flight code produces, so
+// instead of every module throttling itself with a skip counter, all
+// outgoing packets go through here.  Packets are grouped into message
+// classes by packet id, each with a priority and a target rate:
+//
+//  - state classes (imu, gps, filter, ap status, ...) keep only the
+//    newest packet per id and section index.  A packet that is
+//    replaced before it goes out is counted as coalesced, never
+//    queued behind its own successor.
+//  - queued classes (events, command replies) share a fixed size
+//    fifo that goes out ahead of any state class.  When it is full
+//    (a long link outage) the oldest packet is dropped and counted.
+//
+// update() hands out a byte budget (bytes_per_sec) to the due classes
+// in priority order and copies whole packets into an output ring,
+// which is written to the (non-blocking) fd as fast as the driver
+// accepts it.  A slow or stalled link backs up the ring, not the
+// caller.  With an encoder set, state packets are re-encoded
+// (compact.hxx) as they go into the ring, so the budget is spent on
+// the compact size.
+//
+// The control thread queues packets while the main thread runs
+// update() without the python interpreter lock, so the slots and the
+// fifo are guarded by a priority inheriting mutex of their own.  It is
+// held only to copy a packet in or out, never across the write() to
+// the fd.  Both are preallocated (a state slot once per id and
+// section), so send() doesn't allocate on the control thread.  update(), the statistics and the encoder belong to the
+// main thread.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_LINK_SCHEDULER_HXX
+#define _AURA_LINK_SCHEDULER_HXX
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "compact.hxx"
+
+
+class AuraLinkScheduler {
+
+public:
+
+    // per class statistics, accumulated since the last end_window()
+    struct class_stats {
+	unsigned long sent;		// packets written to the output ring
+	unsigned long coalesced;	// replaced before they were sent
+	// sec from the first unsent update of a slot (or a queued
+	// packet) until it goes into the output ring, i.e. how long the
+	// class waited for its turn on the link
+	double latency_sum;
+	double latency_max;
+    };
+
+    AuraLinkScheduler();
+    ~AuraLinkScheduler();
+
+    // define a message class, returns its number.  Lower priority
+    // values go first.  rate_hz <= 0 disables a state class.
+    int add_class( const string &name, int priority, double rate_hz,
+		   bool queued );
+    void map_id( uint8_t packet_id, int cls );
+
+    // packets with an id that isn't mapped go to this class
+    inline void set_default_class( int cls ) { default_class = cls; }
+
+    // compact encoding of the state packets (NULL = off)
+    inline void set_encoder( AuraCompactEncoder *e ) { encoder = e; }
+
+    // start writing to fd (set non-blocking here)
+    void open( int fd, double bytes_per_sec );
+    inline bool is_open() const { return fd >= 0; }
+
+    // queue a framed packet (sync, id, len, payload, checksum), any
+    // thread
+    void send( const uint8_t *buf, int size, double now );
+
+    // true if a packet with this id and index is waiting to go out,
+    // any thread
+    bool is_pending( uint8_t packet_id, uint8_t index ) const;
+
+    // spend the budget accrued since the last call and write as much
+    // of the output ring as the fd takes
+    void update( double now );
+
+    // statistics
+    inline int num_classes() const { return classes.size(); }
+    inline const string &get_name( int cls ) const {
+	return classes[cls].name;
+    }
+    inline double get_bytes_per_sec() const { return bytes_per_sec; }
+    inline unsigned long get_window_bytes() const { return window_bytes; }
+    size_t get_queued_events() const;
+    unsigned long get_dropped_events() const;	// since open
+    inline size_t get_ring_bytes() const { return out_head - out_tail; }
+
+    // copy the per class statistics of the window (if stats isn't
+    // NULL) and reset the window counters
+    void end_window( vector<class_stats> *stats=NULL );
+
+private:
+
+    static const int MAX_PACKET = 256 + 6;
+    static const size_t OUT_SIZE = 2048;	// power of two
+    static const int FIFO_SIZE = 64;		// queued packets
+
+    struct link_class {
+	string name;
+	int priority;
+	double period;		// sec between packets (0 = off)
+	bool queued;
+	double next_time;
+	unsigned int next_slot;	// round robin over the sections
+	class_stats stats;
+    };
+
+    // newest packet of one id and section
+    struct state_slot {
+	int cls;
+	uint8_t id;
+	uint8_t index;
+	bool fresh;
+	double stamp;
+	int len;
+	uint8_t buf[MAX_PACKET];
+    };
+
+    struct queued_packet {
+	int cls;
+	double stamp;
+	int len;
+	uint8_t buf[MAX_PACKET];
+    };
+
+    mutable pthread_mutex_t lock;	// slots, fifo and class stats
+
+    vector<link_class> classes;
+    int class_of[256];
+    int default_class;
+    vector<state_slot> slots;
+
+    // queued packets, oldest at fifo_head
+    queued_packet fifo[FIFO_SIZE];
+    int fifo_head;
+    int fifo_count;
+    unsigned long fifo_dropped;
+
+    AuraCompactEncoder *encoder;
+
+    int fd;
+    double bytes_per_sec;
+    double credit;
+    double last_time;
+
+    // output ring (free running counters)
+    uint8_t out[OUT_SIZE];
+    size_t out_head;
+    size_t out_tail;
+    unsigned long window_bytes;
+
+    void send_state( int cls, const uint8_t *buf, int size, double now );
+    int pick_slot( double now );
+    bool commit( int cls, const uint8_t *buf, int len, double latency );
+    void write_out();
+};
+
+
+#endif // _AURA_LINK_SCHEDULER_HXX
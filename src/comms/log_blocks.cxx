@@ -0,0 +1,538 @@
+//
+// log_blocks.cxx - chunked, indexed flight log container
+//
+// This code is released into the public domain.
+//
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "comms/packet_id.hxx"
+
+#include "log_blocks.hxx"
+
+
+static const uint8_t VERSION = 1;
+
+// gzip member header with an extra field: magic, deflate, FEXTRA,
+// no mtime, default compression, unknown os
+static const uint8_t GZ_HEADER[10] = {
+    0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff
+};
+static const int GZ_HEADER_SIZE = 12;	// including the extra length
+static const int GZ_TRAILER_SIZE = 8;	// crc32, uncompressed size
+
+// the deflate data of the index members: a final block (BFINAL=1)
+// with fixed Huffman codes (BTYPE=01) holding only the end of block
+// code
+static const uint8_t EMPTY_DEFLATE[2] = { 3, 0 };
+
+static const int LOCATOR_DATA = 1 + 8 + 4 + 4;
+static const int LOCATOR_SIZE
+    = GZ_HEADER_SIZE + 4 + LOCATOR_DATA + sizeof(EMPTY_DEFLATE)
+    + GZ_TRAILER_SIZE;
+
+// an extra subfield holds at most 64k
+static const int MAX_SUBFIELD = 65535 - 4;
+
+// blocks are closed at this size even if block_sec hasn't passed so a
+// runaway producer can't grow one without bound
+static const size_t MAX_BLOCK = 4 * 1024 * 1024;
+
+
+// little endian field helpers
+static void put_u16( string *s, uint16_t v ) {
+    s->push_back( v & 0xff );
+    s->push_back( v >> 8 );
+}
+
+static void put_u32( string *s, uint32_t v ) {
+    for ( int i = 0; i < 4; i++ ) {
+	s->push_back( (v >> (8 * i)) & 0xff );
+    }
+}
+
+static void put_u64( string *s, uint64_t v ) {
+    for ( int i = 0; i < 8; i++ ) {
+	s->push_back( (v >> (8 * i)) & 0xff );
+    }
+}
+
+static void put_f64( string *s, double v ) {
+    uint64_t u;
+    memcpy( &u, &v, sizeof(u) );
+    put_u64( s, u );
+}
+
+static uint64_t get_le( const uint8_t *p, int size ) {
+    uint64_t v = 0;
+    for ( int i = size - 1; i >= 0; i-- ) {
+	v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static double get_f64( const uint8_t *p ) {
+    uint64_t u = get_le( p, 8 );
+    double v;
+    memcpy( &v, &u, sizeof(v) );
+    return v;
+}
+
+// block times and counts, the part the block headers and the index
+// entries share
+static void put_block_info( string *s, const AuraLogBlock &b ) {
+    put_f64( s, b.t0 );
+    put_f64( s, b.t1 );
+    put_u16( s, b.counts.size() );
+    for ( unsigned int i = 0; i < b.counts.size(); i++ ) {
+	s->push_back( b.counts[i].first );
+	put_u32( s, b.counts[i].second );
+    }
+}
+
+// returns the bytes used or 0 if the data is short
+static int get_block_info( const uint8_t *p, int len, AuraLogBlock *b ) {
+    if ( len < 18 ) {
+	return 0;
+    }
+    b->t0 = get_f64( p );
+    b->t1 = get_f64( p + 8 );
+    int n = get_le( p + 16, 2 );
+    if ( len < 18 + 5 * n ) {
+	return 0;
+    }
+    b->counts.clear();
+    for ( int i = 0; i < n; i++ ) {
+	const uint8_t *c = p + 18 + 5 * i;
+	b->counts.push_back( pair<uint8_t, uint32_t>(c[0], get_le(c + 1, 4)) );
+    }
+    return 18 + 5 * n;
+}
+
+
+uint32_t AuraLogBlock::count( uint8_t id ) const {
+    for ( unsigned int i = 0; i < counts.size(); i++ ) {
+	if ( counts[i].first == id ) {
+	    return counts[i].second;
+	}
+    }
+    return 0;
+}
+
+
+AuraLogBlockWriter::AuraLogBlockWriter():
+    fp(NULL),
+    block_sec(2.0),
+    offset(0),
+    t0(0.0),
+    t1(0.0)
+{
+    memset( counts, 0, sizeof(counts) );
+}
+
+AuraLogBlockWriter::~AuraLogBlockWriter() {
+    close();
+}
+
+bool AuraLogBlockWriter::open( const string &filename, double block_sec ) {
+    fp = fopen( filename.c_str(), "wb" );
+    if ( fp == NULL ) {
+	return false;
+    }
+    this->block_sec = block_sec;
+    offset = 0;
+    data.clear();
+    blocks.clear();
+    return true;
+}
+
+void AuraLogBlockWriter::add( const uint8_t *buf, int len, double time ) {
+    if ( fp == NULL || len <= 0 ) {
+	return;
+    }
+    if ( ! data.empty()
+	 && (time >= t0 + block_sec || data.size() + len > MAX_BLOCK) )
+    {
+	flush_block();
+    }
+    // packets are added roughly in time order, the span covers the
+    // odd late one too
+    if ( data.empty() ) {
+	t0 = t1 = time;
+    } else if ( time < t0 ) {
+	t0 = time;
+    } else if ( time > t1 ) {
+	t1 = time;
+    }
+    data.append( (const char *)buf, len );
+    // every message is one framed packet
+    if ( len > 2 && buf[0] == START_OF_MSG0 && buf[1] == START_OF_MSG1 ) {
+	counts[buf[2]]++;
+    }
+}
+
+void AuraLogBlockWriter::write_member( const string &extra,
+				       const uint8_t *deflate,
+				       int deflate_len, uint32_t crc,
+				       uint32_t size )
+{
+    string hdr( (const char *)GZ_HEADER, sizeof(GZ_HEADER) );
+    put_u16( &hdr, extra.size() );
+    hdr.append( extra );
+    string trailer;
+    put_u32( &trailer, crc );
+    put_u32( &trailer, size );
+    fwrite( hdr.data(), hdr.size(), 1, fp );
+    fwrite( deflate, deflate_len, 1, fp );
+    fwrite( trailer.data(), trailer.size(), 1, fp );
+    offset += hdr.size() + deflate_len + trailer.size();
+}
+
+void AuraLogBlockWriter::flush_block() {
+    if ( fp == NULL || data.empty() ) {
+	return;
+    }
+
+    // raw deflate (the gzip wrapping is ours)
+    z_stream zs;
+    memset( &zs, 0, sizeof(zs) );
+    deflateInit2( &zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+		  Z_DEFAULT_STRATEGY );
+    deflated.resize( deflateBound(&zs, data.size()) );
+    zs.next_in = (Bytef *)data.data();
+    zs.avail_in = data.size();
+    zs.next_out = (Bytef *)&deflated[0];
+    zs.avail_out = deflated.size();
+    deflate( &zs, Z_FINISH );
+    int deflate_len = zs.total_out;
+    deflateEnd( &zs );
+    uint32_t crc = crc32( 0L, (const Bytef *)data.data(), data.size() );
+
+    AuraLogBlock b;
+    b.offset = offset;
+    b.t0 = t0;
+    b.t1 = t1;
+    for ( int id = 0; id < 256; id++ ) {
+	if ( counts[id] > 0 ) {
+	    b.counts.push_back( pair<uint8_t, uint32_t>(id, counts[id]) );
+	}
+    }
+
+    string sub;
+    sub.push_back( VERSION );
+    put_u32( &sub, deflate_len );
+    put_block_info( &sub, b );
+    string extra = "AB";
+    put_u16( &extra, sub.size() );
+    extra.append( sub );
+    write_member( extra, (const uint8_t *)deflated.data(), deflate_len,
+		  crc, data.size() );
+    // a whole block reaches the os at a time, a crash loses at most
+    // the block being collected
+    fflush( fp );
+
+    blocks.push_back( b );
+    data.clear();
+    memset( counts, 0, sizeof(counts) );
+}
+
+void AuraLogBlockWriter::flush_due( double time ) {
+    if ( ! data.empty() && time >= t0 + block_sec ) {
+	flush_block();
+    }
+}
+
+void AuraLogBlockWriter::close() {
+    if ( fp == NULL ) {
+	return;
+    }
+    flush_block();
+
+    // index, split over as many members as the subfield size needs
+    uint64_t index_offset = offset;
+    uint32_t index_members = 0;
+    unsigned int i = 0;
+    while ( i < blocks.size() || index_members == 0 ) {
+	string entries;
+	int n = 0;
+	while ( i < blocks.size() && n < 65535 ) {
+	    string e;
+	    put_u64( &e, blocks[i].offset );
+	    put_block_info( &e, blocks[i] );
+	    if ( 3 + entries.size() + e.size() > (size_t)MAX_SUBFIELD ) {
+		break;
+	    }
+	    entries.append( e );
+	    n++;
+	    i++;
+	}
+	string extra = "AI";
+	put_u16( &extra, 3 + entries.size() );
+	extra.push_back( VERSION );
+	put_u16( &extra, n );
+	extra.append( entries );
+	write_member( extra, EMPTY_DEFLATE, sizeof(EMPTY_DEFLATE), 0, 0 );
+	index_members++;
+    }
+
+    string extra = "AL";
+    put_u16( &extra, LOCATOR_DATA );
+    extra.push_back( VERSION );
+    put_u64( &extra, index_offset );
+    put_u32( &extra, index_members );
+    put_u32( &extra, blocks.size() );
+    write_member( extra, EMPTY_DEFLATE, sizeof(EMPTY_DEFLATE), 0, 0 );
+
+    fclose( fp );
+    fp = NULL;
+}
+
+
+// read the gzip member header at offset: the size of the header and
+// the extra field.  False if there is no member with an extra field
+// there.
+static bool read_member_header( int fd, uint64_t offset, int *hdr_len,
+				string *extra )
+{
+    uint8_t hdr[GZ_HEADER_SIZE];
+    if ( pread(fd, hdr, sizeof(hdr), offset) != (ssize_t)sizeof(hdr) ) {
+	return false;
+    }
+    if ( hdr[0] != 0x1f || hdr[1] != 0x8b || hdr[2] != 8 || hdr[3] != 4 ) {
+	return false;
+    }
+    int xlen = get_le( hdr + 10, 2 );
+    extra->resize( xlen );
+    if ( xlen > 0
+	 && pread(fd, &(*extra)[0], xlen, offset + sizeof(hdr)) != xlen )
+    {
+	return false;
+    }
+    *hdr_len = sizeof(hdr) + xlen;
+    return true;
+}
+
+// the data of subfield id in a gzip extra field
+static bool find_subfield( const string &extra, const char *id,
+			   const uint8_t **data, int *len )
+{
+    const uint8_t *p = (const uint8_t *)extra.data();
+    int left = extra.size();
+    while ( left >= 4 ) {
+	int sublen = get_le( p + 2, 2 );
+	if ( sublen > left - 4 ) {
+	    return false;
+	}
+	if ( p[0] == id[0] && p[1] == id[1] ) {
+	    *data = p + 4;
+	    *len = sublen;
+	    return true;
+	}
+	p += 4 + sublen;
+	left -= 4 + sublen;
+    }
+    return false;
+}
+
+
+AuraLogReader::AuraLogReader():
+    fd(-1),
+    indexed(false),
+    file_size(0)
+{
+}
+
+AuraLogReader::~AuraLogReader() {
+    close();
+}
+
+bool AuraLogReader::open( const string &filename ) {
+    close();
+    fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 ) {
+	printf("Cannot open: %s\n", filename.c_str());
+	return false;
+    }
+    struct stat st;
+    if ( fstat(fd, &st) != 0 ) {
+	close();
+	return false;
+    }
+    this->filename = filename;
+    file_size = st.st_size;
+
+    if ( read_footer() || scan_headers() ) {
+	indexed = true;
+	return true;
+    }
+
+    // plain gzip (or uncompressed) log from before the block format,
+    // readable only as a whole
+    blocks.clear();
+    AuraLogBlock b;
+    b.offset = 0;
+    b.t0 = b.t1 = 0.0;
+    blocks.push_back( b );
+    indexed = false;
+    return true;
+}
+
+void AuraLogReader::close() {
+    if ( fd >= 0 ) {
+	::close( fd );
+	fd = -1;
+    }
+    blocks.clear();
+    indexed = false;
+}
+
+// the fast path: locator -> index members
+bool AuraLogReader::read_footer() {
+    if ( file_size < (uint64_t)LOCATOR_SIZE ) {
+	return false;
+    }
+    int hdr_len;
+    string extra;
+    const uint8_t *p;
+    int len;
+    if ( ! read_member_header(fd, file_size - LOCATOR_SIZE, &hdr_len, &extra)
+	 || ! find_subfield(extra, "AL", &p, &len)
+	 || len < LOCATOR_DATA || p[0] != VERSION )
+    {
+	return false;
+    }
+    uint64_t offset = get_le( p + 1, 8 );
+    uint32_t members = get_le( p + 9, 4 );
+    uint32_t count = get_le( p + 13, 4 );
+
+    blocks.clear();
+    for ( uint32_t m = 0; m < members; m++ ) {
+	if ( ! read_member_header(fd, offset, &hdr_len, &extra)
+	     || ! find_subfield(extra, "AI", &p, &len)
+	     || len < 3 || p[0] != VERSION )
+	{
+	    return false;
+	}
+	int n = get_le( p + 1, 2 );
+	int pos = 3;
+	for ( int i = 0; i < n; i++ ) {
+	    if ( pos + 8 > len ) {
+		return false;
+	    }
+	    AuraLogBlock b;
+	    b.offset = get_le( p + pos, 8 );
+	    int used = get_block_info( p + pos + 8, len - pos - 8, &b );
+	    if ( used == 0 ) {
+		return false;
+	    }
+	    blocks.push_back( b );
+	    pos += 8 + used;
+	}
+	offset += hdr_len + sizeof(EMPTY_DEFLATE) + GZ_TRAILER_SIZE;
+    }
+    return blocks.size() == count;
+}
+
+// no footer (the writer never closed the file): hop from block header
+// to block header.  A truncated last block is left out.
+bool AuraLogReader::scan_headers() {
+    blocks.clear();
+    uint64_t offset = 0;
+    int hdr_len;
+    string extra;
+    const uint8_t *p;
+    int len;
+    while ( read_member_header(fd, offset, &hdr_len, &extra)
+	    && find_subfield(extra, "AB", &p, &len) )
+    {
+	if ( len < 5 || p[0] != VERSION ) {
+	    break;
+	}
+	uint32_t deflate_len = get_le( p + 1, 4 );
+	uint64_t next = offset + hdr_len + deflate_len + GZ_TRAILER_SIZE;
+	AuraLogBlock b;
+	b.offset = offset;
+	if ( next > file_size || get_block_info(p + 5, len - 5, &b) == 0 ) {
+	    break;
+	}
+	blocks.push_back( b );
+	offset = next;
+    }
+    return ! blocks.empty();
+}
+
+int AuraLogReader::find_block( double t ) const {
+    if ( ! indexed ) {
+	return 0;
+    }
+    // the blocks are only roughly in time order (a late packet can
+    // stretch a block's span past the next one's), so no binary
+    // search.  There are only a few hundred blocks in a long flight.
+    int i = 0;
+    while ( i < (int)blocks.size() && blocks[i].t1 < t ) {
+	i++;
+    }
+    return i;
+}
+
+bool AuraLogReader::read_block( int i, string *data ) const {
+    data->clear();
+    if ( fd < 0 || i < 0 || i >= (int)blocks.size() ) {
+	return false;
+    }
+
+    if ( ! indexed ) {
+	gzFile f = gzopen( filename.c_str(), "rb" );
+	if ( f == NULL ) {
+	    return false;
+	}
+	char buf[65536];
+	int n;
+	while ( (n = gzread(f, buf, sizeof(buf))) > 0 ) {
+	    data->append( buf, n );
+	}
+	gzclose( f );
+	return n == 0;
+    }
+
+    int hdr_len;
+    string extra;
+    const uint8_t *p;
+    int len;
+    if ( ! read_member_header(fd, blocks[i].offset, &hdr_len, &extra)
+	 || ! find_subfield(extra, "AB", &p, &len) || len < 5 )
+    {
+	return false;
+    }
+    uint32_t deflate_len = get_le( p + 1, 4 );
+    string in( deflate_len + GZ_TRAILER_SIZE, '\0' );
+    ssize_t want = in.size();
+    if ( pread(fd, &in[0], want, blocks[i].offset + hdr_len) != want ) {
+	return false;
+    }
+    const uint8_t *trailer = (const uint8_t *)in.data() + deflate_len;
+    uint32_t crc = get_le( trailer, 4 );
+    uint32_t size = get_le( trailer + 4, 4 );
+
+    data->resize( size );
+    z_stream zs;
+    memset( &zs, 0, sizeof(zs) );
+    inflateInit2( &zs, -15 );
+    zs.next_in = (Bytef *)in.data();
+    zs.avail_in = deflate_len;
+    zs.next_out = (Bytef *)&(*data)[0];
+    zs.avail_out = size;
+    int result = inflate( &zs, Z_FINISH );
+    inflateEnd( &zs );
+    if ( result != Z_STREAM_END || zs.total_out != size
+	 || crc32(0L, (const Bytef *)data->data(), size) != crc )
+    {
+	data->clear();
+	return false;
+    }
+    return true;
+}
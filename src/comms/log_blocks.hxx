@@ -0,0 +1,136 @@
+//
+// log_blocks.hxx - chunked, indexed flight log container
+//
+// flight.dat.gz is written as a series of independently compressed
+// blocks of block_sec seconds each (framed packets inside, exactly as
+// before) followed by a footer index.  Every block is its own gzip
+// member and the index lives in the header extra fields of empty
+// members, so the file is still a valid gzip stream: zcat, gzread()
+// and the python gzip module see the same packet stream as always.
+//
+// Layout (all little endian, gzip extra subfield ids in quotes):
+//
+//   block member 'AB': version, deflate size (u32), earliest and
+//     latest time (f64), number of ids (u16), { id (u8), count (u32)
+//     } ...  then the raw deflate data, crc32 and size
+//   index members 'AI': version, entries (u16), { offset (u64),
+//     earliest and latest time (f64), number of ids (u16), { id,
+//     count } ... } ...  (as many members as it takes, each < 64k)
+//   locator member 'AL': version, offset of the first index member
+//     (u64), index members (u32), blocks (u32).  Fixed size, always
+//     the last LOCATOR_SIZE bytes of the file.
+//
+// Times are the packets' own timestamps (the get_Time() clock, see
+// log_writer.cxx), a block spans its earliest to its latest packet.
+// A file without a footer (the writer didn't get to close it) is
+// indexed by hopping from block header to block header, a plain gzip
+// file (older logs) reads as a single block.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_LOG_BLOCKS_HXX
+#define _AURA_LOG_BLOCKS_HXX
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+using std::pair;
+using std::string;
+using std::vector;
+
+
+struct AuraLogBlock {
+    uint64_t offset;		// of the gzip member in the file
+    double t0, t1;		// earliest and latest packet time
+    vector< pair<uint8_t, uint32_t> > counts;	// packets per id
+
+    uint32_t count( uint8_t id ) const;
+};
+
+
+class AuraLogBlockWriter {
+
+public:
+
+    AuraLogBlockWriter();
+    ~AuraLogBlockWriter();
+
+    bool open( const string &filename, double block_sec );
+    inline bool is_open() const { return fp != NULL; }
+
+    // add one framed packet, starts a new block when the current one
+    // spans block_sec
+    void add( const uint8_t *buf, int len, double time );
+
+    // compress and write the current block (if any)
+    void flush_block();
+
+    // flush the current block if it is block_sec old (so a quiet
+    // stream still reaches the file)
+    void flush_due( double time );
+
+    // last block, index and locator
+    void close();
+
+private:
+
+    FILE *fp;
+    double block_sec;
+    uint64_t offset;		// bytes written so far
+
+    string data;		// current block, uncompressed
+    double t0, t1;
+    uint32_t counts[256];
+    string deflated;
+
+    vector<AuraLogBlock> blocks;
+
+    void write_member( const string &extra, const uint8_t *deflate,
+		       int deflate_len, uint32_t crc, uint32_t size );
+};
+
+
+// Reading is thread safe once open() returns: read_block() can be
+// called for different blocks in parallel.
+class AuraLogReader {
+
+public:
+
+    AuraLogReader();
+    ~AuraLogReader();
+
+    bool open( const string &filename );
+    void close();
+
+    // false for a plain gzip log (one block, no times or counts)
+    inline bool is_indexed() const { return indexed; }
+
+    inline int num_blocks() const { return blocks.size(); }
+    inline const AuraLogBlock &get_block( int i ) const {
+	return blocks[i];
+    }
+
+    // first block that may contain packets at or after time t
+    int find_block( double t ) const;
+
+    // decompressed packets of block i (replaces *data)
+    bool read_block( int i, string *data ) const;
+
+private:
+
+    int fd;
+    string filename;
+    bool indexed;
+    uint64_t file_size;
+    vector<AuraLogBlock> blocks;
+
+    bool read_footer();
+    bool scan_headers();
+};
+
+
+#endif // _AURA_LOG_BLOCKS_HXX
@@ -0,0 +1,163 @@
+//
+// log_writer.cxx - asynchronous binary flight data writer
+//
+// This code is released into the public domain.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util/timing.h"
+
+#include "log_writer.hxx"
+
+
+// largest single message we will ever be asked to log
+static const int MAX_MSG = 2048;
+
+// how long the writer sleeps when there is nothing to do (usec)
+static const int IDLE_USEC = 10000;
+
+
+AuraLogWriter::AuraLogWriter():
+    running(false),
+    started(false),
+    enable_udp(false),
+    dropped(0),
+    high_water(0),
+    bytes_written(0)
+{
+}
+
+AuraLogWriter::~AuraLogWriter() {
+    stop();
+}
+
+bool AuraLogWriter::open_file( const string &filename, double block_sec ) {
+    if ( ! fdata.open( filename, block_sec ) ) {
+	printf("Cannot open: %s\n", filename.c_str());
+	return false;
+    }
+    printf("Logging to: %s\n", filename.c_str());
+    return true;
+}
+
+bool AuraLogWriter::open_udp( const string &hostname, int port ) {
+    if ( ! sock.open( false ) ) {
+	printf("Error opening logging socket\n");
+	return false;
+    }
+    if ( sock.connect( hostname.c_str(), port ) < 0 ) {
+	printf("Error connecting logging socket: %s:%d\n",
+	       hostname.c_str(), port);
+	sock.close();
+	return false;
+    }
+    sock.setBlocking( false );
+    enable_udp = true;
+    return true;
+}
+
+bool AuraLogWriter::start( size_t ring_size ) {
+    if ( started ) {
+	return true;
+    }
+    if ( ! ring.init( ring_size ) ) {
+	printf("Log writer: cannot allocate %ld byte ring\n", (long)ring_size);
+	return false;
+    }
+    running = true;
+    if ( pthread_create( &thread, NULL, thread_main, this ) != 0 ) {
+	printf("Log writer: cannot create writer thread\n");
+	running = false;
+	return false;
+    }
+    started = true;
+    return true;
+}
+
+void AuraLogWriter::stop() {
+    if ( started ) {
+	running = false;
+	pthread_join( thread, NULL );
+	started = false;
+    }
+    fdata.close();
+    if ( enable_udp ) {
+	sock.close();
+	enable_udp = false;
+    }
+}
+
+bool AuraLogWriter::push( const uint8_t *buf, int size ) {
+    if ( ! started || size > MAX_MSG ) {
+	dropped++;
+	return false;
+    }
+    if ( ! ring.push( buf, size ) ) {
+	dropped++;
+	return false;
+    }
+    size_t used = ring.used();
+    if ( used > high_water ) {
+	high_water = used;
+    }
+    return true;
+}
+
+void *AuraLogWriter::thread_main( void *arg ) {
+    ((AuraLogWriter *)arg)->run();
+    return NULL;
+}
+
+// the time a framed packet is indexed under: its own timestamp (every
+// logged packet carries one right after the index byte), or the drain
+// time for anything that doesn't look like it
+static double packet_time( const uint8_t *msg, int len, double fallback ) {
+    if ( len < 4 + 9 + 2 ) {
+	return fallback;
+    }
+    double t;
+    memcpy( &t, msg + 4 + 1, sizeof(t) );
+    if ( ! isfinite(t) || t <= 0.0 ) {
+	return fallback;
+    }
+    return t;
+}
+
+// empty the ring into the outputs, returns the number of bytes
+// consumed
+int AuraLogWriter::drain() {
+    static uint8_t msg[MAX_MSG];
+    double current_time = get_Time();
+    int total = 0;
+    while ( true ) {
+	int len = ring.pop( msg, MAX_MSG );
+	if ( len == 0 ) {
+	    break;
+	} else if ( len < 0 ) {
+	    continue;		// oversized, can't happen via push()
+	}
+	if ( enable_udp ) {
+	    sock.send( msg, len, 0 );
+	}
+	fdata.add( msg, len, packet_time( msg, len, current_time ) );
+	total += len;
+    }
+    bytes_written.fetch_add( total, std::memory_order_relaxed );
+    return total;
+}
+
+void AuraLogWriter::run() {
+    while ( running ) {
+	drain();
+	// a block reaches the file every block_sec, so a crash loses at
+	// most block_sec of data
+	fdata.flush_due( get_Time() );
+	usleep( IDLE_USEC );
+    }
+    // final drain after the producer has stopped
+    drain();
+}
@@ -0,0 +1,84 @@
+//
+// log_writer.hxx - asynchronous binary flight data writer
+//
+// The main loop hands packed messages to push() which only copies
+// them into a lock free ring.  A background thread drains the ring
+// in batches, compresses into flight.dat.gz (framed packets in
+// independently compressed, indexed blocks, see log_blocks.hxx) and
+// optionally forwards each message to a udp listener.  Slow storage
+// can no longer stall the control loop: if the ring fills up
+// messages are dropped and counted instead.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_LOG_WRITER_HXX
+#define _AURA_LOG_WRITER_HXX
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+using std::string;
+
+#include "util/netSocket.h"
+#include "util/spsc_ring.hxx"
+
+#include "log_blocks.hxx"
+
+
+class AuraLogWriter {
+
+public:
+
+    AuraLogWriter();
+    ~AuraLogWriter();
+
+    // configure outputs (call before start())
+    bool open_file( const string &filename, double block_sec );
+    bool open_udp( const string &hostname, int port );
+
+    // start/stop the writer thread.  stop() drains anything still
+    // queued, writes the last block and the index and closes the
+    // outputs.
+    bool start( size_t ring_size );
+    void stop();
+
+    // producer side (one thread at a time: callers hold the python
+    // interpreter lock)
+    bool push( const uint8_t *buf, int size );
+
+    // statistics (safe to read from the producer thread)
+    inline unsigned long get_dropped() const { return dropped; }
+    inline unsigned long get_high_water() const { return high_water; }
+    inline unsigned long get_bytes_written() const {
+	return bytes_written.load(std::memory_order_relaxed);
+    }
+    inline size_t get_queued() const { return ring.used(); }
+
+private:
+
+    SPSCRing ring;
+    pthread_t thread;
+    std::atomic<bool> running;
+    bool started;
+
+    AuraLogBlockWriter fdata;
+    netSocket sock;
+    bool enable_udp;
+
+    // producer owned counters
+    unsigned long dropped;
+    unsigned long high_water;
+
+    // consumer owned counters
+    std::atomic<unsigned long> bytes_written;
+
+    static void *thread_main( void *arg );
+    void run();
+    int drain();
+};
+
+
+#endif // _AURA_LOG_WRITER_HXX
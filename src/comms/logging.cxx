@@ -4,109 +4,122 @@
 #include "logging.hxx"
 
 
-pyModuleLogging::pyModuleLogging()
+pyModuleLogging::pyModuleLogging():
+    pPending( NULL ),
+    pFuncWriteConfigs( NULL )
 {
 }
 
-bool pyModuleLogging::open(const char *path)
+bool pyModuleLogging::init(const char *import_name)
 {
-    if (pModuleObj == NULL) {
-	printf("ERROR: events.init() failed\n");
-	return false;
+    // python side creates the flight directory
+    bool result = pyModuleBase::init(import_name);
+    if ( pModuleObj != NULL ) {
+	pFuncWriteConfigs = get_method("write_configs");
+	pPending = PyObject_GetAttrString(pModuleObj, "pending");
+	if ( pPending != NULL && ! PyList_Check(pPending) ) {
+	    Py_DECREF(pPending);
+	    pPending = NULL;
+	}
+	if ( pPending == NULL ) {
+	    PyErr_Clear();
+	    printf("ERROR: logging.pending not found, python messages will not be logged\n");
+	}
     }
-    PyObject *pFuncOpen = PyObject_GetAttrString(pModuleObj, "open");
-    if ( pFuncOpen == NULL || ! PyCallable_Check(pFuncOpen) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'open()'\n");
-	return false;
+
+    pyPropertyNode logging_node = pyGetNode( "/config/logging", true );
+    pyPropertyNode stats_node = pyGetNode( "/comms/logging", true );
+    dropped_h = stats_node.getHandle<long>("dropped_messages");
+    high_water_h = stats_node.getHandle<long>("high_water_bytes");
+    queued_h = stats_node.getHandle<long>("queued_bytes");
+    bytes_written_h = stats_node.getHandle<long>("bytes_written");
+
+    // optional tuning: seconds of data per compressed log block (also
+    // the most a crash can lose, flush_sec is the old name) and ring
+    // size (kb)
+    double block_sec = 2.0;
+    if ( logging_node.hasChild("block_sec") ) {
+	block_sec = logging_node.getDouble("block_sec");
+    } else if ( logging_node.hasChild("flush_sec") ) {
+	block_sec = logging_node.getDouble("flush_sec");
+    }
+    long ring_kb = 256;
+    if ( logging_node.hasChild("ring_kb") ) {
+	ring_kb = logging_node.getLong("ring_kb");
+    }
+
+    bool outputs = false;
+    string flight_dir = logging_node.getString("flight_dir");
+    if ( flight_dir != "" ) {
+	SGPath file = flight_dir;
+	file.append( "flight.dat.gz" );
+	if ( writer.open_file( file.str(), block_sec ) ) {
+	    outputs = true;
+	}
+    }
+    string hostname = logging_node.getString("hostname");
+    int port = logging_node.getLong("port");
+    if ( hostname != "" && port > 0 ) {
+	if ( writer.open_udp( hostname, port ) ) {
+	    outputs = true;
+	}
+    }
+    if ( outputs ) {
+	writer.start( ring_kb * 1024 );
     }
 
-    // FIXME decref pFuncOpen
-    
-    PyObject *pValue = PyObject_CallFunction(pFuncOpen, (char *)"s", path);
-    if (pValue != NULL) {
-	bool result = PyObject_IsTrue(pValue);
-	Py_DECREF(pValue);
-	return result;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
+    return result;
+}
+
+bool pyModuleLogging::open(const char *path)
+{
+    PyObject *pFuncOpen = get_method("open");
+    if ( pFuncOpen == NULL ) {
+	printf("ERROR: logging.init() failed\n");
 	return false;
     }
-    return false;
+    return check_result( PyObject_CallFunction(pFuncOpen, (char *)"s", path) );
 }
 
+// publish the writer statistics (the actual file i/o happens on the
+// writer thread)
 void pyModuleLogging::update() {
-    if (pModuleObj == NULL) {
-	printf("ERROR: import logging module failed\n");
-	return;
-    }
-    PyObject *pFuncLog = PyObject_GetAttrString(pModuleObj, "update");
-    if ( pFuncLog == NULL || ! PyCallable_Check(pFuncLog) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'update_configs()'\n");
-	return;
-    }
-    PyObject *pResult = PyObject_CallFunction(pFuncLog, NULL);
-    if (pResult != NULL) {
-	Py_DECREF(pResult);
-	return;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
-	return;
+    // move any messages queued by python code into the writer
+    if ( pPending != NULL && PyList_GET_SIZE(pPending) > 0 ) {
+	Py_ssize_t n = PyList_GET_SIZE(pPending);
+	for ( Py_ssize_t i = 0; i < n; i++ ) {
+	    PyObject *item = PyList_GET_ITEM(pPending, i);
+	    if ( PyString_Check(item) ) {
+		writer.push( (uint8_t *)PyString_AS_STRING(item),
+			     PyString_GET_SIZE(item) );
+	    }
+	}
+	PyList_SetSlice(pPending, 0, n, NULL);
     }
+
+    dropped_h.set( writer.get_dropped() );
+    high_water_h.set( writer.get_high_water() );
+    queued_h.set( writer.get_queued() );
+    bytes_written_h.set( writer.get_bytes_written() );
 }
 
 
-// FIXME: close log file!
 bool pyModuleLogging::close()
 {
+    writer.stop();
     return true;
 }
 
 void pyModuleLogging::log_message( uint8_t *buf, int size ) {
-    if (pModuleObj == NULL) {
-	printf("ERROR: import logging module failed\n");
-	return;
-    }
-    PyObject *pFuncLog = PyObject_GetAttrString(pModuleObj, "log_message");
-    if ( pFuncLog == NULL || ! PyCallable_Check(pFuncLog) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'log_message()'\n");
-	return;
-    }
-    PyObject *pResult = PyObject_CallFunction(pFuncLog, (char *)"s#", buf, size);
-    if (pResult != NULL) {
-	Py_DECREF(pResult);
-	return;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
-	return;
-    }
+    writer.push( buf, size );
 }
 
 void pyModuleLogging::write_configs() {
-    if (pModuleObj == NULL) {
+    if ( pFuncWriteConfigs == NULL ) {
 	printf("ERROR: import logging module failed\n");
 	return;
     }
-    PyObject *pFuncLog = PyObject_GetAttrString(pModuleObj, "write_configs");
-    if ( pFuncLog == NULL || ! PyCallable_Check(pFuncLog) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'write_configs()'\n");
-	return;
-    }
-    PyObject *pResult = PyObject_CallFunction(pFuncLog, NULL);
-    if (pResult != NULL) {
-	Py_DECREF(pResult);
-	return;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
-	return;
-    }
+    check_result( PyObject_CallFunction(pFuncWriteConfigs, NULL) );
 }
 
 
@@ -9,6 +9,12 @@
 
 #include "python/pymodule.hxx"
 
+#include "log_writer.hxx"
+
+// The python module still owns the flight directory creation and the
+// config snapshots, but the binary data stream is written natively by
+// a background thread (see log_writer.hxx.)
+
 class pyModuleLogging: public pyModuleBase {
 
 public:
@@ -17,6 +23,7 @@ public:
     pyModuleLogging();
     ~pyModuleLogging() {}
 
+    bool init(const char *import_name);
     bool open(const char *path);
     void update();
     bool close();
@@ -24,6 +31,17 @@ public:
     void log_message( uint8_t *buf, int size );
 
     void write_configs();
+
+private:
+
+    AuraLogWriter writer;
+    PyObject *pPending;		// logging.pending (messages from python)
+    PyObject *pFuncWriteConfigs;
+
+    PropertyHandle<long> dropped_h;
+    PropertyHandle<long> high_water_h;
+    PropertyHandle<long> queued_h;
+    PropertyHandle<long> bytes_written_h;
 };
 
 // sort of a hack for now, but pure C let's me pass in a property node
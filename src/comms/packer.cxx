@@ -1,8 +1,129 @@
 #include "packer.hxx"
 
+#include <math.h>
+#include <stdio.h>
 #include <string.h>		// memcpy()
 
-pyModulePacker::pyModulePacker()
+#include "init/frame_state.hxx"
+#include "packet_id.hxx"
+
+static const double m2ft = 1.0 / 0.3048;
+
+
+// Little endian payload writer.  Each put_*() matches the
+// corresponding python struct.pack() '<' format code (B, h, H, L, f, d)
+// and integer conversions follow python int() (truncate) or
+// int(round()) (round half away from zero) as used in packer.py.
+// The payload is written after the 4 byte header so the finished
+// packet can be framed in place.
+class PackBuf {
+
+public:
+
+    PackBuf( uint8_t *_buf ): buf(_buf), len(4) {}
+
+    inline void put_u8( long val ) { buf[len++] = (uint8_t)val; }
+    inline void put_i16( long val ) { put_u16( (uint16_t)(int16_t)val ); }
+    inline void put_u16( long val ) {
+	buf[len++] = (uint8_t)(val & 0xff);
+	buf[len++] = (uint8_t)((val >> 8) & 0xff);
+    }
+    inline void put_u32( long val ) {
+	put_u16( val & 0xffff );
+	put_u16( (val >> 16) & 0xffff );
+    }
+    // 1 byte length followed by the characters (python '%ds')
+    inline void put_str( const string &val ) {
+	put_u8( val.length() );
+	memcpy( buf + len, val.data(), val.length() );
+	len += val.length();
+    }
+    inline void put_f32( double val ) {
+	float f = (float)val;
+	memcpy( buf + len, &f, 4 );
+	len += 4;
+    }
+    inline void put_f64( double val ) {
+	memcpy( buf + len, &val, 8 );
+	len += 8;
+    }
+
+    // wrap payload in header bytes, id, length, payload, and compute
+    // checksums.  Returns the total packet size.
+    int wrap( uint8_t packet_id );
+
+private:
+
+    uint8_t *buf;
+    int len;
+};
+
+int PackBuf::wrap( uint8_t packet_id ) {
+    int size = len - 4;
+    buf[0] = START_OF_MSG0;
+    buf[1] = START_OF_MSG1;
+    buf[2] = packet_id;
+    buf[3] = (uint8_t)size;
+
+    // simple 2-byte checksum
+    uint8_t c0 = 0;
+    uint8_t c1 = 0;
+    c0 += packet_id;
+    c1 += c0;
+    c0 += (uint8_t)size;
+    c1 += c0;
+    for ( int i = 0; i < size; i++ ) {
+	c0 += buf[4 + i];
+	c1 += c0;
+    }
+    buf[len++] = c0;
+    buf[len++] = c1;
+    return len;
+}
+
+// Little endian payload reader, the inverse of PackBuf.  The caller
+// checks the payload size against the format before reading.
+class UnpackBuf {
+
+public:
+
+    UnpackBuf( const uint8_t *_buf ): buf(_buf), len(0) {}
+
+    inline long get_u8() { return buf[len++]; }
+    inline long get_i16() { return (int16_t)get_u16(); }
+    inline long get_u16() {
+	long val = buf[len] | (buf[len+1] << 8);
+	len += 2;
+	return val;
+    }
+    inline double get_f32() {
+	float f;
+	memcpy( &f, buf + len, 4 );
+	len += 4;
+	return f;
+    }
+    inline double get_f64() {
+	double val;
+	memcpy( &val, buf + len, 8 );
+	len += 8;
+	return val;
+    }
+
+private:
+
+    const uint8_t *buf;
+    int len;
+};
+
+// python int() and int(round())
+static inline long trunc_l( double val ) { return (long)val; }
+static inline long round_l( double val ) { return (long)round(val); }
+
+
+pyModulePacker::pyModulePacker():
+    shared_bound( false ),
+    imu_timestamp( 0.0 ),
+    active_node( NULL )
 {
 }
 
@@ -12,20 +133,16 @@ int pyModulePacker::pack(int index, const char *pack_function, uint8_t *buf) {
 	printf("ERROR: import packer failed\n");
 	return 0;
     }
-    PyObject *pFuncLog = PyObject_GetAttrString(pModuleObj, pack_function);
-    if ( pFuncLog == NULL || ! PyCallable_Check(pFuncLog) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function '%s()'\n", pack_function);
+    PyObject *pFuncLog = get_method(pack_function);
+    if ( pFuncLog == NULL ) {
 	return 0;
     }
     PyObject *pResult = PyObject_CallFunction(pFuncLog, (char *)"i", index);
     if (pResult != NULL) {
-	PyObject *pStr = PyObject_Str(pResult);
-	if ( pStr != NULL ) {
-	    char *ptr = PyString_AsString(pStr);
-	    len = PyString_Size(pStr);
+	if ( PyString_Check(pResult) ) {
+	    char *ptr = PyString_AsString(pResult);
+	    len = PyString_Size(pResult);
 	    memcpy((char *)buf, ptr, len);
-	    Py_DECREF(pStr);
 	}
 	Py_DECREF(pResult);
 	return len;
@@ -37,42 +154,699 @@ int pyModulePacker::pack(int index, const char *pack_function, uint8_t *buf) {
     return 0;
 }
 
+
+// property binding (done once on first use of each index)
+
+void pyModulePacker::bind_shared() {
+    if ( shared_bound ) {
+	return;
+    }
+    PropertyNode *vel_node = PropertyGetNode("/velocity", true);
+    PropertyNode *pos_node = PropertyGetNode("/position", true);
+    PropertyNode *pos_pressure_node = PropertyGetNode("/position/pressure", true);
+    PropertyNode *pos_combined_node = PropertyGetNode("/position/combined", true);
+    PropertyNode *wind_node = PropertyGetNode("/filters/wind", true);
+    PropertyNode *remote_link_node = PropertyGetNode("/comms/remote_link", true);
+    PropertyNode *act_node = PropertyGetNode("/actuators", true);
+    PropertyNode *status_node = PropertyGetNode("/status", true);
+    PropertyNode *apm2_node = PropertyGetNode("/sensors/APM2", true);
+    PropertyNode *payload_node = PropertyGetNode("/payload", true);
+    PropertyNode *ap_node = PropertyGetNode("/autopilot", true);
+    PropertyNode *targets_node = PropertyGetNode("/autopilot/targets", true);
+    PropertyNode *task_node = PropertyGetNode("/task", true);
+    PropertyNode *route_node = PropertyGetNode("/task/route", true);
+    PropertyNode *home_node = PropertyGetNode("/task/home", true);
+    PropertyNode *circle_node = PropertyGetNode("/task/circle", true);
+    active_node = PropertyGetNode("/task/route/active", true);
+
+    vel_airspeed_smoothed_kt
+	= PropertyHandle<double>(vel_node, "airspeed_smoothed_kt");
+    vel_pressure_vertical_speed_fps
+	= PropertyHandle<double>(vel_node, "pressure_vertical_speed_fps");
+    pos_pressure_altitude_smoothed_m
+	= PropertyHandle<double>(pos_pressure_node, "altitude_smoothed_m");
+    pos_combined_altitude_true_m
+	= PropertyHandle<double>(pos_combined_node, "altitude_true_m");
+    wind_dir_deg = PropertyHandle<double>(wind_node, "wind_dir_deg");
+    wind_speed_kt = PropertyHandle<double>(wind_node, "wind_speed_kt");
+    pitot_scale_factor
+	= PropertyHandle<double>(wind_node, "pitot_scale_factor");
+    remote_link_sequence_num
+	= PropertyHandle<long>(remote_link_node, "sequence_num");
+    remote_link_wp_counter
+	= PropertyHandle<long>(remote_link_node, "wp_counter");
+    act_timestamp = PropertyHandle<double>(act_node, "timestamp");
+    act_aileron = PropertyHandle<double>(act_node, "aileron");
+    act_elevator = PropertyHandle<double>(act_node, "elevator");
+    act_throttle = PropertyHandle<double>(act_node, "throttle");
+    act_rudder = PropertyHandle<double>(act_node, "rudder");
+    act_channel5 = PropertyHandle<double>(act_node, "channel5");
+    act_flaps = PropertyHandle<double>(act_node, "flaps");
+    act_channel7 = PropertyHandle<double>(act_node, "channel7");
+    act_channel8 = PropertyHandle<double>(act_node, "channel8");
+    status_frame_time = PropertyHandle<double>(status_node, "frame_time");
+    status_system_load_avg
+	= PropertyHandle<double>(status_node, "system_load_avg");
+    apm2_board_vcc = PropertyHandle<double>(apm2_node, "board_vcc");
+    apm2_extern_volts = PropertyHandle<double>(apm2_node, "extern_volts");
+    apm2_extern_cell_volts
+	= PropertyHandle<double>(apm2_node, "extern_cell_volts");
+    apm2_extern_amps = PropertyHandle<double>(apm2_node, "extern_amps");
+    apm2_extern_current_mah
+	= PropertyHandle<double>(apm2_node, "extern_current_mah");
+    payload_trigger_num = PropertyHandle<double>(payload_node, "trigger_num");
+    ap_master_switch = PropertyHandle<bool>(ap_node, "master_switch");
+    ap_pilot_pass_through = PropertyHandle<bool>(ap_node, "pilot_pass_through");
+    route_target_waypoint_idx
+	= PropertyHandle<long>(route_node, "target_waypoint_idx");
+    active_route_size = PropertyHandle<long>(active_node, "route_size");
+    targets_groundtrack_deg
+	= PropertyHandle<double>(targets_node, "groundtrack_deg");
+    targets_roll_deg = PropertyHandle<double>(targets_node, "roll_deg");
+    targets_altitude_agl_ft
+	= PropertyHandle<double>(targets_node, "altitude_agl_ft");
+    targets_pitch_deg = PropertyHandle<double>(targets_node, "pitch_deg");
+    targets_airspeed_kt = PropertyHandle<double>(targets_node, "airspeed_kt");
+    pos_altitude_ground_m = PropertyHandle<double>(pos_node, "altitude_ground_m");
+    task_flight_timer = PropertyHandle<double>(task_node, "flight_timer");
+    circle_lon_deg = PropertyHandle<double>(circle_node, "longitude_deg");
+    circle_lat_deg = PropertyHandle<double>(circle_node, "latitude_deg");
+    home_lon_deg = PropertyHandle<double>(home_node, "longitude_deg");
+    home_lat_deg = PropertyHandle<double>(home_node, "latitude_deg");
+
+    shared_bound = true;
+}
+
+void pyModulePacker::bind_gps(int index) {
+    while ( (int)gps.size() <= index ) {
+	PropertyNode *node = PropertyRoot()->getChild("sensors", true)
+	    ->getChild("gps", (int)gps.size(), true);
+	gps_handles h;
+	h.timestamp = PropertyHandle<double>(node, "timestamp");
+	h.lat_deg = PropertyHandle<double>(node, "latitude_deg");
+	h.lon_deg = PropertyHandle<double>(node, "longitude_deg");
+	h.alt_m = PropertyHandle<double>(node, "altitude_m");
+	h.vn_ms = PropertyHandle<double>(node, "vn_ms");
+	h.ve_ms = PropertyHandle<double>(node, "ve_ms");
+	h.vd_ms = PropertyHandle<double>(node, "vd_ms");
+	h.unix_time_sec = PropertyHandle<double>(node, "unix_time_sec");
+	h.satellites = PropertyHandle<long>(node, "satellites");
+	h.horiz_accuracy_m = PropertyHandle<double>(node, "horiz_accuracy_m");
+	h.vert_accuracy_m = PropertyHandle<double>(node, "vert_accuracy_m");
+	h.pdop = PropertyHandle<double>(node, "pdop");
+	h.fixType = PropertyHandle<long>(node, "fixType");
+	gps.push_back(h);
+    }
+}
+
+void pyModulePacker::bind_imu(int index) {
+    while ( (int)imu.size() <= index ) {
+	PropertyNode *node = PropertyRoot()->getChild("sensors", true)
+	    ->getChild("imu", (int)imu.size(), true);
+	imu_handles h;
+	h.timestamp = PropertyHandle<double>(node, "timestamp");
+	h.p = PropertyHandle<double>(node, "p_rad_sec");
+	h.q = PropertyHandle<double>(node, "q_rad_sec");
+	h.r = PropertyHandle<double>(node, "r_rad_sec");
+	h.ax = PropertyHandle<double>(node, "ax_mps_sec");
+	h.ay = PropertyHandle<double>(node, "ay_mps_sec");
+	h.az = PropertyHandle<double>(node, "az_mps_sec");
+	h.hx = PropertyHandle<double>(node, "hx");
+	h.hy = PropertyHandle<double>(node, "hy");
+	h.hz = PropertyHandle<double>(node, "hz");
+	h.temp_C = PropertyHandle<double>(node, "temp_C");
+	imu.push_back(h);
+    }
+}
+
+void pyModulePacker::bind_airdata(int index) {
+    while ( (int)airdata.size() <= index ) {
+	PropertyNode *node = PropertyRoot()->getChild("sensors", true)
+	    ->getChild("airdata", (int)airdata.size(), true);
+	airdata_handles h;
+	h.timestamp = PropertyHandle<double>(node, "timestamp");
+	h.pressure_mbar = PropertyHandle<double>(node, "pressure_mbar");
+	h.temp_degC = PropertyHandle<double>(node, "temp_degC");
+	h.status = PropertyHandle<long>(node, "status");
+	for ( int i = 0; i < 10; i++ ) {
+	    h.pots[i] = PropertyHandle<long>(node, "pots", i);
+	}
+	h.diff_pa = PropertyHandle<double>(node, "diff_pa");
+	h.rpm0 = PropertyHandle<double>(node, "rpm0");
+	h.rpm1 = PropertyHandle<double>(node, "rpm1");
+	airdata.push_back(h);
+    }
+}
+
+void pyModulePacker::bind_filter(int index) {
+    while ( (int)filter.size() <= index ) {
+	PropertyNode *node = PropertyRoot()->getChild("filters", true)
+	    ->getChild("filter", (int)filter.size(), true);
+	filter_handles h;
+	h.timestamp = PropertyHandle<double>(node, "timestamp");
+	h.lat_deg = PropertyHandle<double>(node, "latitude_deg");
+	h.lon_deg = PropertyHandle<double>(node, "longitude_deg");
+	h.alt_m = PropertyHandle<double>(node, "altitude_m");
+	h.vn_ms = PropertyHandle<double>(node, "vn_ms");
+	h.ve_ms = PropertyHandle<double>(node, "ve_ms");
+	h.vd_ms = PropertyHandle<double>(node, "vd_ms");
+	h.roll_deg = PropertyHandle<double>(node, "roll_deg");
+	h.pitch_deg = PropertyHandle<double>(node, "pitch_deg");
+	h.heading_deg = PropertyHandle<double>(node, "heading_deg");
+	h.p_bias = PropertyHandle<double>(node, "p_bias");
+	h.q_bias = PropertyHandle<double>(node, "q_bias");
+	h.r_bias = PropertyHandle<double>(node, "r_bias");
+	h.ax_bias = PropertyHandle<double>(node, "ax_bias");
+	h.ay_bias = PropertyHandle<double>(node, "ay_bias");
+	h.az_bias = PropertyHandle<double>(node, "az_bias");
+	filter.push_back(h);
+    }
+}
+
+void pyModulePacker::bind_pilot(int index) {
+    while ( (int)pilot.size() <= index ) {
+	PropertyNode *node = PropertyRoot()->getChild("sensors", true)
+	    ->getChild("pilot_input", (int)pilot.size(), true);
+	node->setLen("channel", 8, 0.0);
+	pilot_handles h;
+	h.timestamp = PropertyHandle<double>(node, "timestamp");
+	for ( int i = 0; i < 8; i++ ) {
+	    h.channel[i] = PropertyHandle<double>(node, "channel", i);
+	}
+	pilot.push_back(h);
+    }
+}
+
+// profile sections are indexed in /status/profile child order (same
+// as packer.py) and appear as the profilers publish them
+bool pyModulePacker::bind_profile(int index) {
+    if ( index < (int)profile.size() ) {
+	return true;
+    }
+    PropertyNode *parent = PropertyRoot()->getChild("status", true)
+	->getChild("profile", true);
+    vector<string> names = parent->getChildren();
+    if ( index >= (int)names.size() ) {
+	return false;
+    }
+    while ( (int)profile.size() <= index ) {
+	profile_handles h;
+	h.name = names[profile.size()];
+	PropertyNode *node = parent->getChild(h.name.c_str(), true);
+	h.count = PropertyHandle<long>(node, "count");
+	h.p50_ms = PropertyHandle<double>(node, "p50_ms");
+	h.p90_ms = PropertyHandle<double>(node, "p90_ms");
+	h.p99_ms = PropertyHandle<double>(node, "p99_ms");
+	h.p999_ms = PropertyHandle<double>(node, "p999_ms");
+	h.max_ms = PropertyHandle<double>(node, "max_ms");
+	h.overruns = PropertyHandle<long>(node, "overruns");
+	profile.push_back(h);
+    }
+    return true;
+}
+
+
+// native packers (formats are documented in packer.py).  The primary
+// sensor, filter and actuator formats are written from the frame
+// snapshot structures, so the property tree and the snapshot versions
+// of a packer can't drift apart.
+
+// gps_v3_fmt = '<BdddfhhhdBHHHB'
+static int write_gps( int index, const AuraFrameState::gps_state &g,
+		      uint8_t *buf )
+{
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( g.timestamp );
+    p.put_f64( g.lat_deg );
+    p.put_f64( g.lon_deg );
+    p.put_f32( g.alt_m );
+    p.put_i16( trunc_l(g.vn_ms * 100) );
+    p.put_i16( trunc_l(g.ve_ms * 100) );
+    p.put_i16( trunc_l(g.vd_ms * 100) );
+    p.put_f64( g.unix_time_sec );
+    p.put_u8( g.satellites );
+    p.put_u16( trunc_l(g.horiz_accuracy_m * 100) );
+    p.put_u16( trunc_l(g.vert_accuracy_m * 100) );
+    p.put_u16( trunc_l(g.pdop * 100) );
+    p.put_u8( g.fix_type );
+    return p.wrap( GPS_PACKET_V3 );
+}
+
+// imu_v3_fmt = '<BdfffffffffhB'
+static int write_imu( int index, const AuraFrameState::imu_state &m,
+		      uint8_t *buf )
+{
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( m.timestamp );
+    p.put_f32( m.p );
+    p.put_f32( m.q );
+    p.put_f32( m.r );
+    p.put_f32( m.ax );
+    p.put_f32( m.ay );
+    p.put_f32( m.az );
+    p.put_f32( m.hx );
+    p.put_f32( m.hy );
+    p.put_f32( m.hz );
+    p.put_i16( round_l(m.temp_C * 10.0) );
+    p.put_u8( 0 );
+    return p.wrap( IMU_PACKET_V3 );
+}
+
+// airdata_v5_fmt = '<BdHhhffhHBBB'
+static int write_airdata( int index, const AuraFrameState::airdata_state &a,
+			  uint8_t *buf )
+{
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( a.timestamp );
+    p.put_u16( trunc_l(a.pressure_mbar * 10.0) );
+    p.put_i16( trunc_l(a.temp_degC * 100.0) );
+    p.put_i16( trunc_l(a.airspeed_smoothed_kt * 100.0) );
+    p.put_f32( a.altitude_smoothed_m );
+    p.put_f32( a.altitude_true_m );
+    p.put_i16( trunc_l(a.vertical_speed_fps * 60 * 10) );
+    p.put_u16( trunc_l(a.wind_dir_deg * 100) );
+    p.put_u8( trunc_l(a.wind_speed_kt * 4) );
+    p.put_u8( trunc_l(a.pitot_scale_factor * 100) );
+    p.put_u8( a.status );
+    return p.wrap( AIRDATA_PACKET_V5 );
+}
+
+// act_v2_fmt = '<BdhhHhhhhhB'
+static int write_actuator( const AuraFrameState::act_state &a, uint8_t *buf )
+{
+    PackBuf p(buf);
+    p.put_u8( 0 );		// always zero for now
+    p.put_f64( a.timestamp );
+    p.put_i16( trunc_l(a.aileron * 20000) );
+    p.put_i16( trunc_l(a.elevator * 20000) );
+    p.put_u16( trunc_l(a.throttle * 60000) );
+    p.put_i16( trunc_l(a.rudder * 20000) );
+    p.put_i16( trunc_l(a.channel5 * 20000) );
+    p.put_i16( trunc_l(a.flaps * 20000) );
+    p.put_i16( trunc_l(a.channel7 * 20000) );
+    p.put_i16( trunc_l(a.channel8 * 20000) );
+    p.put_u8( 0 );
+    return p.wrap( ACTUATOR_PACKET_V2 );
+}
+
+// filter_v3_fmt = '<BdddfhhhhhhhhhhhhBB'
+static int write_filter( int index, const AuraFrameState::filter_state &f,
+			 long sequence_num, uint8_t *buf )
+{
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( f.timestamp );
+    p.put_f64( f.lat_deg );
+    p.put_f64( f.lon_deg );
+    p.put_f32( f.alt_m );
+    p.put_i16( trunc_l(f.vn_ms * 100) );
+    p.put_i16( trunc_l(f.ve_ms * 100) );
+    p.put_i16( trunc_l(f.vd_ms * 100) );
+    p.put_i16( trunc_l(f.roll_deg * 10) );
+    p.put_i16( trunc_l(f.pitch_deg * 10) );
+    p.put_i16( trunc_l(f.heading_deg * 10) );
+    p.put_i16( round_l(f.p_bias * 1000.0) );
+    p.put_i16( round_l(f.q_bias * 1000.0) );
+    p.put_i16( round_l(f.r_bias * 1000.0) );
+    p.put_i16( round_l(f.ax_bias * 1000.0) );
+    p.put_i16( round_l(f.ay_bias * 1000.0) );
+    p.put_i16( round_l(f.az_bias * 1000.0) );
+    p.put_u8( sequence_num );
+    p.put_u8( 0 );
+    return p.wrap( FILTER_PACKET_V3 );
+}
+
 int pyModulePacker::pack_gps(int index, uint8_t *buf) {
-    return pack(index, "pack_gps_v3", buf);
+    bind_gps(index);
+    const gps_handles &h = gps[index];
+    AuraFrameState::gps_state g = {};
+    g.timestamp = h.timestamp.get();
+    g.lat_deg = h.lat_deg.get();
+    g.lon_deg = h.lon_deg.get();
+    g.alt_m = h.alt_m.get();
+    g.vn_ms = h.vn_ms.get();
+    g.ve_ms = h.ve_ms.get();
+    g.vd_ms = h.vd_ms.get();
+    g.unix_time_sec = h.unix_time_sec.get();
+    g.satellites = h.satellites.get();
+    g.horiz_accuracy_m = h.horiz_accuracy_m.get();
+    g.vert_accuracy_m = h.vert_accuracy_m.get();
+    g.pdop = h.pdop.get();
+    g.fix_type = h.fixType.get();
+    return write_gps( index, g, buf );
 }
 
 int pyModulePacker::pack_imu(int index, uint8_t *buf) {
-    return pack(index, "pack_imu_v3", buf);
+    bind_imu(index);
+    const imu_handles &h = imu[index];
+    imu_timestamp = h.timestamp.get();
+    AuraFrameState::imu_state m = {};
+    m.timestamp = imu_timestamp;
+    m.p = h.p.get();
+    m.q = h.q.get();
+    m.r = h.r.get();
+    m.ax = h.ax.get();
+    m.ay = h.ay.get();
+    m.az = h.az.get();
+    m.hx = h.hx.get();
+    m.hy = h.hy.get();
+    m.hz = h.hz.get();
+    m.temp_C = h.temp_C.get();
+    return write_imu( index, m, buf );
 }
 
 int pyModulePacker::pack_airdata(int index, uint8_t *buf) {
-    return pack(index, "pack_airdata_v5", buf);
+    bind_shared();
+    bind_airdata(index);
+    const airdata_handles &h = airdata[index];
+    AuraFrameState::airdata_state a = {};
+    a.timestamp = h.timestamp.get();
+    a.pressure_mbar = h.pressure_mbar.get();
+    a.temp_degC = h.temp_degC.get();
+    a.airspeed_smoothed_kt = vel_airspeed_smoothed_kt.get();
+    a.altitude_smoothed_m = pos_pressure_altitude_smoothed_m.get();
+    a.altitude_true_m = pos_combined_altitude_true_m.get();
+    a.vertical_speed_fps = vel_pressure_vertical_speed_fps.get();
+    a.wind_dir_deg = wind_dir_deg.get();
+    a.wind_speed_kt = wind_speed_kt.get();
+    a.pitot_scale_factor = pitot_scale_factor.get();
+    a.status = h.status.get();
+    return write_airdata( index, a, buf );
 }
 
+// system_health_v4_fmt = '<BdHHHHHH'
 int pyModulePacker::pack_health(int index, uint8_t *buf) {
-    return pack(index, "pack_system_health_v4", buf);
+    bind_shared();
+    long dekamah = trunc_l(apm2_extern_current_mah.get() / 10);
+    if ( dekamah > 65535 ) {
+	dekamah = 65535;	// prevent overflowing the structure
+    }
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( status_frame_time.get() );
+    p.put_u16( trunc_l(status_system_load_avg.get() * 100) );
+    p.put_u16( trunc_l(apm2_board_vcc.get() * 1000) );
+    p.put_u16( trunc_l(apm2_extern_volts.get() * 1000) );
+    p.put_u16( trunc_l(apm2_extern_cell_volts.get() * 1000) );
+    p.put_u16( trunc_l(apm2_extern_amps.get() * 1000) );
+    p.put_u16( dekamah );
+    return p.wrap( SYSTEM_HEALTH_PACKET_V4 );
 }
 
+// pilot_v2_fmt = '<BdhhhhhhhhB'
 int pyModulePacker::pack_pilot(int index, uint8_t *buf) {
-    return pack(index, "pack_pilot_v2", buf);
+    bind_pilot(index);
+    const pilot_handles &h = pilot[index];
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( h.timestamp.get() );
+    for ( int i = 0; i < 8; i++ ) {
+	p.put_i16( trunc_l(h.channel[i].get() * 20000) );
+    }
+    p.put_u8( 0 );
+    return p.wrap( PILOT_INPUT_PACKET_V2 );
 }
 
 int pyModulePacker::pack_actuator(int index, uint8_t *buf) {
-    return pack(index, "pack_act_v2", buf);
+    if ( index > 0 ) {
+	return 0;
+    }
+    bind_shared();
+    AuraFrameState::act_state a = {};
+    a.timestamp = act_timestamp.get();
+    a.aileron = act_aileron.get();
+    a.elevator = act_elevator.get();
+    a.throttle = act_throttle.get();
+    a.rudder = act_rudder.get();
+    a.channel5 = act_channel5.get();
+    a.flaps = act_flaps.get();
+    a.channel7 = act_channel7.get();
+    a.channel8 = act_channel8.get();
+    return write_actuator( a, buf );
 }
 
 int pyModulePacker::pack_filter(int index, uint8_t *buf) {
-    return pack(index, "pack_filter_v3", buf);
+    bind_shared();
+    bind_filter(index);
+    const filter_handles &h = filter[index];
+    AuraFrameState::filter_state f = {};
+    f.timestamp = h.timestamp.get();
+    f.lat_deg = h.lat_deg.get();
+    f.lon_deg = h.lon_deg.get();
+    f.alt_m = h.alt_m.get();
+    f.vn_ms = h.vn_ms.get();
+    f.ve_ms = h.ve_ms.get();
+    f.vd_ms = h.vd_ms.get();
+    f.roll_deg = h.roll_deg.get();
+    f.pitch_deg = h.pitch_deg.get();
+    f.heading_deg = h.heading_deg.get();
+    f.p_bias = h.p_bias.get();
+    f.q_bias = h.q_bias.get();
+    f.r_bias = h.r_bias.get();
+    f.ax_bias = h.ax_bias.get();
+    f.ay_bias = h.ay_bias.get();
+    f.az_bias = h.az_bias.get();
+    return write_filter( index, f, remote_link_sequence_num.get(), buf );
+}
+
+// index 0 packets from a frame snapshot
+int pyModulePacker::pack_gps(const AuraFrameState &s, uint8_t *buf) {
+    return write_gps( 0, s.gps, buf );
+}
+
+int pyModulePacker::pack_imu(const AuraFrameState &s, uint8_t *buf) {
+    return write_imu( 0, s.imu, buf );
+}
+
+int pyModulePacker::pack_airdata(const AuraFrameState &s, uint8_t *buf) {
+    return write_airdata( 0, s.airdata, buf );
 }
 
+int pyModulePacker::pack_actuator(const AuraFrameState &s, uint8_t *buf) {
+    return write_actuator( s.act, buf );
+}
+
+int pyModulePacker::pack_filter(const AuraFrameState &s, long sequence_num,
+				uint8_t *buf)
+{
+    return write_filter( 0, s.filter, sequence_num, buf );
+}
+
+// payload_v2_fmt = '<BdH'
 int pyModulePacker::pack_payload(int index, uint8_t *buf) {
-    return pack(index, "pack_payload_v2", buf);
+    bind_shared();
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( status_frame_time.get() );
+    p.put_u16( trunc_l(payload_trigger_num.get()) );
+    return p.wrap( PAYLOAD_PACKET_V2 );
 }
 
+// ap_status_v5_fmt = '<BdBhhHHhhHHddHHB'
 int pyModulePacker::pack_ap(int index, uint8_t *buf) {
-    return pack(index, "pack_ap_status_v5", buf);
+    bind_shared();
+
+    // status flags (up to 8 could be supported)
+    uint8_t flags = 0;
+    if ( ap_master_switch.get() ) {
+	flags |= (1 << 0);
+    }
+    if ( ap_pilot_pass_through.get() ) {
+	flags |= (1 << 1);
+    }
+
+    // handle the counter dance between the control module and the
+    // packer.  This allows us to trickle down routes to the ground
+    // station, but we don't want onboard logging to affect the
+    // counter state.
+    long counter = remote_link_wp_counter.get();
+    long route_size = active_route_size.get();
+    if ( counter >= route_size + 2 ) {
+	counter = 0;
+	remote_link_wp_counter.set( 0 );
+    }
+
+    double target_agl_ft = targets_altitude_agl_ft.get();
+    double ground_m = pos_altitude_ground_m.get();
+    double target_msl_ft = ground_m * m2ft + target_agl_ft;
+
+    double wp_lon = 0.0;
+    double wp_lat = 0.0;
+    long wp_index = 0;
+    if ( route_size > 0 && counter < route_size ) {
+	wp_index = counter;
+	PropertyNode *wp_node = active_node->getChild("wpt", (int)wp_index);
+	if ( wp_node != NULL ) {
+	    wp_lon = wp_node->getDouble("longitude_deg");
+	    wp_lat = wp_node->getDouble("latitude_deg");
+	}
+    } else if ( counter == route_size ) {
+	wp_lon = circle_lon_deg.get();
+	wp_lat = circle_lat_deg.get();
+	wp_index = 65534;
+    } else if ( counter == route_size + 1 ) {
+	wp_lon = home_lon_deg.get();
+	wp_lat = home_lat_deg.get();
+	wp_index = 65535;
+    }
+
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( status_frame_time.get() );
+    p.put_u8( flags );
+    p.put_i16( round_l(targets_groundtrack_deg.get() * 10) );
+    p.put_i16( round_l(targets_roll_deg.get() * 10) );
+    p.put_u16( round_l(target_msl_ft) );
+    p.put_u16( round_l(ground_m) );
+    p.put_i16( round_l(targets_pitch_deg.get() * 10) );
+    p.put_i16( round_l(targets_airspeed_kt.get() * 10) );
+    p.put_u16( round_l(task_flight_timer.get()) );
+    p.put_u16( route_target_waypoint_idx.get() );
+    p.put_f64( wp_lon );
+    p.put_f64( wp_lat );
+    p.put_u16( wp_index );
+    p.put_u16( route_size );
+    p.put_u8( remote_link_sequence_num.get() & 0xff );
+    return p.wrap( AP_STATUS_PACKET_V5 );
 }
 
+// raven_v1_fmt = '<BdHHHHHHHHHHffffB'
 int pyModulePacker::pack_raven(int index, uint8_t *buf) {
-    return pack(index, "pack_raven_v1", buf);
+    bind_airdata(index);
+    const airdata_handles &h = airdata[index];
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( imu_timestamp );
+    for ( int i = 0; i < 10; i++ ) {
+	p.put_u16( h.pots[i].get() );
+    }
+    p.put_f32( h.diff_pa.get() );
+    p.put_f32( h.pressure_mbar.get() );
+    p.put_f32( h.rpm0.get() );
+    p.put_f32( h.rpm1.get() );
+    p.put_u8( 0 );
+    return p.wrap( RAVEN_PACKET_V1 );
+}
+
+// milliseconds to a saturated 16 bit microsecond count
+static inline long ms_to_us16( double ms ) {
+    long us = round_l(ms * 1000);
+    if ( us > 65535 ) us = 65535;
+    if ( us < 0 ) us = 0;
+    return us;
+}
+
+// profile_v1_fmt = '<BdLHHHHHLB%ds' (section name at the end)
+int pyModulePacker::pack_profile(int index, uint8_t *buf) {
+    if ( ! bind_profile(index) ) {
+	return 0;
+    }
+    bind_shared();
+    const profile_handles &h = profile[index];
+    PackBuf p(buf);
+    p.put_u8( index );
+    p.put_f64( status_frame_time.get() );
+    p.put_u32( h.count.get() );
+    p.put_u16( ms_to_us16(h.p50_ms.get()) );
+    p.put_u16( ms_to_us16(h.p90_ms.get()) );
+    p.put_u16( ms_to_us16(h.p99_ms.get()) );
+    p.put_u16( ms_to_us16(h.p999_ms.get()) );
+    p.put_u16( ms_to_us16(h.max_ms.get()) );
+    p.put_u32( h.overruns.get() );
+    p.put_str( h.name );
+    return p.wrap( PROFILE_PACKET_V1 );
+}
+
+
+// native unpackers (sensor packets only)
+
+// gps_v3_fmt = '<BdddfhhhdBHHHB'
+int pyModulePacker::unpack_gps(const uint8_t *payload, int len) {
+    if ( len != 51 ) {
+	return -1;
+    }
+    UnpackBuf u(payload);
+    int index = u.get_u8();
+    bind_gps(index);
+    gps_handles &h = gps[index];
+    h.timestamp.set( u.get_f64() );
+    h.lat_deg.set( u.get_f64() );
+    h.lon_deg.set( u.get_f64() );
+    h.alt_m.set( u.get_f32() );
+    h.vn_ms.set( u.get_i16() / 100.0 );
+    h.ve_ms.set( u.get_i16() / 100.0 );
+    h.vd_ms.set( u.get_i16() / 100.0 );
+    h.unix_time_sec.set( u.get_f64() );
+    h.satellites.set( u.get_u8() );
+    h.horiz_accuracy_m.set( u.get_u16() / 100.0 );
+    h.vert_accuracy_m.set( u.get_u16() / 100.0 );
+    h.pdop.set( u.get_u16() / 100.0 );
+    h.fixType.set( u.get_u8() );
+    return index;
+}
+
+// imu_v3_fmt = '<BdfffffffffhB'
+int pyModulePacker::unpack_imu(const uint8_t *payload, int len) {
+    if ( len != 48 ) {
+	return -1;
+    }
+    UnpackBuf u(payload);
+    int index = u.get_u8();
+    bind_imu(index);
+    imu_handles &h = imu[index];
+    h.timestamp.set( u.get_f64() );
+    h.p.set( u.get_f32() );
+    h.q.set( u.get_f32() );
+    h.r.set( u.get_f32() );
+    h.ax.set( u.get_f32() );
+    h.ay.set( u.get_f32() );
+    h.az.set( u.get_f32() );
+    h.hx.set( u.get_f32() );
+    h.hy.set( u.get_f32() );
+    h.hz.set( u.get_f32() );
+    h.temp_C.set( u.get_i16() / 10.0 );
+    return index;
+}
+
+// airdata_v5_fmt = '<BdHhhffhHBBB'
+int pyModulePacker::unpack_airdata(const uint8_t *payload, int len) {
+    if ( len != 30 ) {
+	return -1;
+    }
+    bind_shared();
+    UnpackBuf u(payload);
+    int index = u.get_u8();
+    bind_airdata(index);
+    airdata_handles &h = airdata[index];
+    h.timestamp.set( u.get_f64() );
+    h.pressure_mbar.set( u.get_u16() / 10.0 );
+    h.temp_degC.set( u.get_i16() / 100.0 );
+    vel_airspeed_smoothed_kt.set( u.get_i16() / 100.0 );
+    pos_pressure_altitude_smoothed_m.set( u.get_f32() );
+    pos_combined_altitude_true_m.set( u.get_f32() );
+    vel_pressure_vertical_speed_fps.set( (u.get_i16() / 10.0) / 60.0 );
+    wind_dir_deg.set( u.get_u16() / 100.0 );
+    wind_speed_kt.set( u.get_u8() / 4.0 );
+    pitot_scale_factor.set( u.get_u8() / 100.0 );
+    h.status.set( u.get_u8() );
+    return index;
+}
+
+// pilot_v2_fmt = '<BdhhhhhhhhB'
+int pyModulePacker::unpack_pilot(const uint8_t *payload, int len) {
+    if ( len != 26 ) {
+	return -1;
+    }
+    UnpackBuf u(payload);
+    int index = u.get_u8();
+    bind_pilot(index);
+    pilot_handles &h = pilot[index];
+    h.timestamp.set( u.get_f64() );
+    for ( int i = 0; i < 8; i++ ) {
+	h.channel[i].set( u.get_i16() / 20000.0 );
+    }
+    return index;
 }
@@ -1,13 +1,23 @@
 #ifndef _AURA_PACKER_HXX
 #define _AURA_PACKER_HXX
 
-// import a python module and call it's init() and update() routines
-// requires imported python modules to follow some basic rules to play
-// nice.  (see examples in the code for now.)
+// Telemetry/log message packer.  The pack_*() routines serialize
+// directly from the property tree into the caller's buffer (no heap
+// allocation or python calls after the first call for a given
+// index.)  The wire format is byte for byte identical to the
+// corresponding functions in packer.py.  The python module is still
+// imported so python code (events, remote_link, etc.) can use it and
+// pack() can call any python pack function by name.
 
 #include "python/pymodule.hxx"
 #include "python/pyprops.hxx"
 
+#include <stdint.h>
+#include <vector>
+using std::vector;
+
+#include "init/frame_state.hxx"
+
 class pyModulePacker: public pyModuleBase {
 
 public:
@@ -16,7 +26,10 @@ public:
     pyModulePacker();
     ~pyModulePacker() {}
 
+    // call the named function in packer.py (reference implementation)
     int pack(int index, const char *pack_function, uint8_t *buf);
+
+    // native packers (returns total packet size including framing)
     int pack_gps(int index, uint8_t *buf);
     int pack_imu(int index, uint8_t *buf);
     int pack_airdata(int index, uint8_t *buf);
@@ -27,6 +40,105 @@ public:
     int pack_payload(int index, uint8_t *buf);
     int pack_ap(int index, uint8_t *buf);
     int pack_raven(int index, uint8_t *buf);
+    int pack_profile(int index, uint8_t *buf); // 0 if no such section
+
+    // the primary (index 0) packets from a frame snapshot instead of
+    // the property tree, for packing on another thread than the one
+    // that writes the values (see init/frame_state.hxx).  Same bytes
+    // as the property versions for the same values.
+    int pack_gps(const AuraFrameState &s, uint8_t *buf);
+    int pack_imu(const AuraFrameState &s, uint8_t *buf);
+    int pack_airdata(const AuraFrameState &s, uint8_t *buf);
+    int pack_actuator(const AuraFrameState &s, uint8_t *buf);
+    int pack_filter(const AuraFrameState &s, long sequence_num,
+		    uint8_t *buf);
+
+    // native unpackers for the sensor packets (mirror the matching
+    // unpack_*() functions in packer.py, used for log replay.)  The
+    // payload excludes the framing.  Returns the sensor index or -1
+    // if the payload size doesn't match the format.
+    int unpack_gps(const uint8_t *payload, int len);
+    int unpack_imu(const uint8_t *payload, int len);
+    int unpack_airdata(const uint8_t *payload, int len);
+    int unpack_pilot(const uint8_t *payload, int len);
+
+private:
+
+    struct gps_handles {
+	PropertyHandle<double> timestamp, lat_deg, lon_deg, alt_m;
+	PropertyHandle<double> vn_ms, ve_ms, vd_ms, unix_time_sec;
+	PropertyHandle<long> satellites, fixType;
+	PropertyHandle<double> horiz_accuracy_m, vert_accuracy_m, pdop;
+    };
+    struct imu_handles {
+	PropertyHandle<double> timestamp, p, q, r, ax, ay, az, hx, hy, hz;
+	PropertyHandle<double> temp_C;
+    };
+    struct airdata_handles {
+	PropertyHandle<double> timestamp, pressure_mbar, temp_degC;
+	PropertyHandle<long> status;
+	PropertyHandle<long> pots[10];
+	PropertyHandle<double> diff_pa, rpm0, rpm1;
+    };
+    struct filter_handles {
+	PropertyHandle<double> timestamp, lat_deg, lon_deg, alt_m;
+	PropertyHandle<double> vn_ms, ve_ms, vd_ms;
+	PropertyHandle<double> roll_deg, pitch_deg, heading_deg;
+	PropertyHandle<double> p_bias, q_bias, r_bias;
+	PropertyHandle<double> ax_bias, ay_bias, az_bias;
+    };
+    struct pilot_handles {
+	PropertyHandle<double> timestamp;
+	PropertyHandle<double> channel[8];
+    };
+    struct profile_handles {
+	string name;
+	PropertyHandle<long> count, overruns;
+	PropertyHandle<double> p50_ms, p90_ms, p99_ms, p999_ms, max_ms;
+    };
+
+    vector<gps_handles> gps;
+    vector<imu_handles> imu;
+    vector<airdata_handles> airdata;
+    vector<filter_handles> filter;
+    vector<pilot_handles> pilot;
+    vector<profile_handles> profile;
+
+    // shared (non-indexed) values
+    bool shared_bound;
+    double imu_timestamp;	// most recent packed imu time (for raven)
+    PropertyHandle<double> vel_airspeed_smoothed_kt;
+    PropertyHandle<double> vel_pressure_vertical_speed_fps;
+    PropertyHandle<double> pos_pressure_altitude_smoothed_m;
+    PropertyHandle<double> pos_combined_altitude_true_m;
+    PropertyHandle<double> wind_dir_deg, wind_speed_kt, pitot_scale_factor;
+    PropertyHandle<long> remote_link_sequence_num, remote_link_wp_counter;
+    PropertyHandle<double> act_timestamp, act_aileron, act_elevator;
+    PropertyHandle<double> act_throttle, act_rudder, act_channel5;
+    PropertyHandle<double> act_flaps, act_channel7, act_channel8;
+    PropertyHandle<double> status_frame_time, status_system_load_avg;
+    PropertyHandle<double> apm2_board_vcc, apm2_extern_volts;
+    PropertyHandle<double> apm2_extern_cell_volts, apm2_extern_amps;
+    PropertyHandle<double> apm2_extern_current_mah;
+    PropertyHandle<double> payload_trigger_num;
+    PropertyHandle<bool> ap_master_switch, ap_pilot_pass_through;
+    PropertyHandle<long> route_target_waypoint_idx, active_route_size;
+    PropertyHandle<double> targets_groundtrack_deg, targets_roll_deg;
+    PropertyHandle<double> targets_altitude_agl_ft, targets_pitch_deg;
+    PropertyHandle<double> targets_airspeed_kt;
+    PropertyHandle<double> pos_altitude_ground_m;
+    PropertyHandle<double> task_flight_timer;
+    PropertyHandle<double> circle_lon_deg, circle_lat_deg;
+    PropertyHandle<double> home_lon_deg, home_lat_deg;
+    PropertyNode *active_node;
+
+    void bind_shared();
+    void bind_gps(int index);
+    void bind_imu(int index);
+    void bind_airdata(int index);
+    void bind_filter(int index);
+    void bind_pilot(int index);
+    bool bind_profile(int index);
 };
 
 #endif // _AURA_PACKER_HXX
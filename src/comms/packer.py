@@ -85,6 +85,10 @@ payload_v2_fmt = "<BdH"
 
 raven_v1_fmt = "<BdHHHHHHHHHHffffB"
 
+profile_node = getNode("/status/profile", True)
+# profile_v1_fmt = "<BdLHHHHHLB%ds"
+# variable length (section name at the end), times are microseconds
+
 event_node = getNode("/status/event", True)
 # event_v1_fmt = "<BdB%ds"
 # this packet will be variable length so size and fmt string are dynamic
@@ -1157,6 +1161,70 @@ def unpack_raven_v1(buf):
 
     return index
 
+# milliseconds to a saturated 16 bit microsecond count
+def ms_to_us16(ms):
+    us = int(round(ms * 1000))
+    if us > 65535: us = 65535
+    if us < 0: us = 0
+    return us
+
+def pack_profile_v1(index):
+    names = profile_node.getChildren()
+    if index >= len(names):
+        return ''
+    name = names[index]
+    node = profile_node.getChild(name, True)
+    profile_v1_fmt = '<BdLHHHHHLB%ds' % len(name)
+    buf = struct.pack(profile_v1_fmt,
+                      index,
+                      status_node.getFloat('frame_time'),
+                      node.getInt("count"),
+                      ms_to_us16(node.getFloat("p50_ms")),
+                      ms_to_us16(node.getFloat("p90_ms")),
+                      ms_to_us16(node.getFloat("p99_ms")),
+                      ms_to_us16(node.getFloat("p999_ms")),
+                      ms_to_us16(node.getFloat("max_ms")),
+                      node.getInt("overruns"),
+                      len(name),
+                      name)
+    return wrap_packet(PROFILE_PACKET_V1, buf)
+
+def pack_profile_text(index, delim=','):
+    names = profile_node.getChildren()
+    if index >= len(names):
+        return ''
+    node = profile_node.getChild(names[index], True)
+    data = [ '%.4f' % node.getFloat('timestamp'),
+             '%s' % names[index],
+             '%d' % node.getInt('count'),
+             '%.3f' % node.getFloat('p50_ms'),
+             '%.3f' % node.getFloat('p90_ms'),
+             '%.3f' % node.getFloat('p99_ms'),
+             '%.3f' % node.getFloat('p999_ms'),
+             '%.3f' % node.getFloat('max_ms'),
+             '%d' % node.getInt('overruns') ]
+    return delim.join(data)
+
+def unpack_profile_v1(buf):
+    hdr_fmt = "<BdLHHHHHLB"
+    hdr_size = struct.calcsize(hdr_fmt)
+    result = struct.unpack(hdr_fmt, buf[:hdr_size])
+    index = result[0]
+    size = result[9]
+    name = struct.unpack("%ds" % size, buf[hdr_size:hdr_size+size])[0]
+
+    node = profile_node.getChild(name, True)
+    node.setFloat("timestamp", result[1])
+    node.setInt("count", result[2])
+    node.setFloat("p50_ms", result[3] / 1000.0)
+    node.setFloat("p90_ms", result[4] / 1000.0)
+    node.setFloat("p99_ms", result[5] / 1000.0)
+    node.setFloat("p999_ms", result[6] / 1000.0)
+    node.setFloat("max_ms", result[7] / 1000.0)
+    node.setInt("overruns", result[8])
+
+    return index
+
 def pack_event_v1(message):
     global imu_timestamp
 
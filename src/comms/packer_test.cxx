@@ -0,0 +1,276 @@
+// packer_test.cxx - check the native packer against packer.py
+//
+// Fills the property tree with a series of pseudo random (but
+// repeatable) states and packs every message type with both the
+// python reference functions and the native packer.  Any byte
+// difference is reported.  The python output stream is also compared
+// against a saved golden file so changes to the wire format itself
+// are caught.
+//
+// usage: packer_test <aura src dir> <golden file> [--write]
+//   e.g. (from src/comms) ./packer_test .. packer_test.golden
+//
+// This code is released into the public domain.
+
+#include "python/python_sys.hxx"
+#include "python/pyprops.hxx"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+using std::string;
+
+#include "packer.hxx"
+
+
+static unsigned int seed = 12345;
+
+// repeatable uniform random value in [lo, hi)
+static double rnd( double lo, double hi ) {
+    seed = seed * 1103515245 + 12345;
+    double u = ((seed >> 8) & 0xffffff) / 16777216.0;
+    return lo + (hi - lo) * u;
+}
+
+static void set_state( int n ) {
+    for ( int i = 0; i < 2; i++ ) {
+	pyPropertyNode gps = pyGetNode("/sensors", true).getChild("gps", i, true);
+	gps.setDouble("timestamp", rnd(0, 10000));
+	gps.setDouble("latitude_deg", rnd(-90, 90));
+	gps.setDouble("longitude_deg", rnd(-180, 180));
+	gps.setDouble("altitude_m", rnd(0, 3000));
+	gps.setDouble("vn_ms", rnd(-50, 50));
+	gps.setDouble("ve_ms", rnd(-50, 50));
+	gps.setDouble("vd_ms", rnd(-50, 50));
+	gps.setDouble("unix_time_sec", rnd(1.5e9, 1.6e9));
+	gps.setLong("satellites", (long)rnd(0, 20));
+	gps.setDouble("horiz_accuracy_m", rnd(0, 50));
+	gps.setDouble("vert_accuracy_m", rnd(0, 50));
+	gps.setDouble("pdop", rnd(0, 10));
+	gps.setLong("fixType", (long)rnd(0, 4));
+
+	pyPropertyNode imu = pyGetNode("/sensors", true).getChild("imu", i, true);
+	imu.setDouble("timestamp", rnd(0, 10000));
+	imu.setDouble("p_rad_sec", rnd(-5, 5));
+	imu.setDouble("q_rad_sec", rnd(-5, 5));
+	imu.setDouble("r_rad_sec", rnd(-5, 5));
+	imu.setDouble("ax_mps_sec", rnd(-20, 20));
+	imu.setDouble("ay_mps_sec", rnd(-20, 20));
+	imu.setDouble("az_mps_sec", rnd(-20, 20));
+	imu.setDouble("hx", rnd(-1, 1));
+	imu.setDouble("hy", rnd(-1, 1));
+	imu.setDouble("hz", rnd(-1, 1));
+	// exercise the round half away from zero cases too
+	imu.setDouble("temp_C", (n % 3 == 0) ? -21.25 : rnd(-20, 60));
+
+	pyPropertyNode air = pyGetNode("/sensors", true).getChild("airdata", i, true);
+	air.setDouble("timestamp", rnd(0, 10000));
+	air.setDouble("pressure_mbar", rnd(800, 1100));
+	air.setDouble("temp_degC", rnd(-20, 50));
+	air.setLong("status", (long)rnd(0, 2));
+	air.setDouble("diff_pa", rnd(0, 1000));
+	air.setDouble("rpm0", rnd(0, 10000));
+	air.setDouble("rpm1", rnd(0, 10000));
+	air.setLen("pots", 10, 0.0);
+	for ( int j = 0; j < 10; j++ ) {
+	    air.getHandle<long>("pots", j).set( (long)rnd(0, 4096) );
+	}
+
+	pyPropertyNode filt = pyGetNode("/filters", true).getChild("filter", i, true);
+	filt.setDouble("timestamp", rnd(0, 10000));
+	filt.setDouble("latitude_deg", rnd(-90, 90));
+	filt.setDouble("longitude_deg", rnd(-180, 180));
+	filt.setDouble("altitude_m", rnd(0, 3000));
+	filt.setDouble("vn_ms", rnd(-50, 50));
+	filt.setDouble("ve_ms", rnd(-50, 50));
+	filt.setDouble("vd_ms", rnd(-50, 50));
+	filt.setDouble("roll_deg", rnd(-180, 180));
+	filt.setDouble("pitch_deg", rnd(-90, 90));
+	filt.setDouble("heading_deg", rnd(0, 360));
+	filt.setDouble("p_bias", (n % 3 == 0) ? 0.0125 : rnd(-0.1, 0.1));
+	filt.setDouble("q_bias", rnd(-0.1, 0.1));
+	filt.setDouble("r_bias", rnd(-0.1, 0.1));
+	filt.setDouble("ax_bias", rnd(-1, 1));
+	filt.setDouble("ay_bias", rnd(-1, 1));
+	filt.setDouble("az_bias", rnd(-1, 1));
+
+	pyPropertyNode pilot = pyGetNode("/sensors", true).getChild("pilot_input", i, true);
+	pilot.setDouble("timestamp", rnd(0, 10000));
+	pilot.setLen("channel", 8, 0.0);
+	for ( int j = 0; j < 8; j++ ) {
+	    pilot.setDouble("channel", j, rnd(-1, 1));
+	}
+    }
+
+    pyPropertyNode vel = pyGetNode("/velocity", true);
+    vel.setDouble("airspeed_smoothed_kt", rnd(0, 100));
+    vel.setDouble("pressure_vertical_speed_fps", rnd(-50, 50));
+    pyGetNode("/position/pressure", true).setDouble("altitude_smoothed_m", rnd(0, 3000));
+    pyGetNode("/position/combined", true).setDouble("altitude_true_m", rnd(0, 3000));
+    pyPropertyNode wind = pyGetNode("/filters/wind", true);
+    wind.setDouble("wind_dir_deg", rnd(0, 359));
+    wind.setDouble("wind_speed_kt", rnd(0, 60));
+    wind.setDouble("pitot_scale_factor", rnd(0.75, 1.25));
+
+    pyPropertyNode act = pyGetNode("/actuators", true);
+    act.setDouble("timestamp", rnd(0, 10000));
+    act.setDouble("aileron", rnd(-1, 1));
+    act.setDouble("elevator", rnd(-1, 1));
+    act.setDouble("throttle", rnd(0, 1));
+    act.setDouble("rudder", rnd(-1, 1));
+    act.setDouble("channel5", rnd(-1, 1));
+    act.setDouble("flaps", rnd(-1, 1));
+    act.setDouble("channel7", rnd(-1, 1));
+    act.setDouble("channel8", rnd(-1, 1));
+
+    pyPropertyNode status = pyGetNode("/status", true);
+    status.setDouble("frame_time", rnd(0, 10000));
+    status.setDouble("system_load_avg", rnd(0, 4));
+    pyPropertyNode apm2 = pyGetNode("/sensors/APM2", true);
+    apm2.setDouble("board_vcc", rnd(4.5, 5.5));
+    apm2.setDouble("extern_volts", rnd(0, 25));
+    apm2.setDouble("extern_cell_volts", rnd(3, 4.2));
+    apm2.setDouble("extern_amps", rnd(0, 60));
+    apm2.setDouble("extern_current_mah", (n % 4 == 0) ? 700000 : rnd(0, 20000));
+    pyGetNode("/payload", true).setDouble("trigger_num", (long)rnd(0, 1000));
+
+    pyPropertyNode ap = pyGetNode("/autopilot", true);
+    ap.setBool("master_switch", n % 2);
+    ap.setBool("pilot_pass_through", n % 3 == 1);
+    pyPropertyNode targets = pyGetNode("/autopilot/targets", true);
+    targets.setDouble("groundtrack_deg", rnd(0, 360));
+    targets.setDouble("roll_deg", rnd(-45, 45));
+    targets.setDouble("altitude_agl_ft", rnd(0, 1000));
+    targets.setDouble("pitch_deg", rnd(-20, 20));
+    targets.setDouble("airspeed_kt", rnd(0, 60));
+    pyGetNode("/position", true).setDouble("altitude_ground_m", rnd(0, 1500));
+    pyGetNode("/task", true).setDouble("flight_timer", rnd(0, 10000));
+    pyGetNode("/task/route", true).setLong("target_waypoint_idx", n % 3);
+    pyPropertyNode active = pyGetNode("/task/route/active", true);
+    active.setLong("route_size", 3);
+    for ( int j = 0; j < 3; j++ ) {
+	pyPropertyNode wpt = active.getChild("wpt", j, true);
+	wpt.setDouble("longitude_deg", rnd(-180, 180));
+	wpt.setDouble("latitude_deg", rnd(-90, 90));
+    }
+    pyPropertyNode circle = pyGetNode("/task/circle", true);
+    circle.setDouble("longitude_deg", rnd(-180, 180));
+    circle.setDouble("latitude_deg", rnd(-90, 90));
+    pyPropertyNode home = pyGetNode("/task/home", true);
+    home.setDouble("longitude_deg", rnd(-180, 180));
+    home.setDouble("latitude_deg", rnd(-90, 90));
+    pyPropertyNode link = pyGetNode("/comms/remote_link", true);
+    link.setLong("wp_counter", n % 7);
+    link.setLong("sequence_num", n % 256);
+    const char *sections[] = { "imu", "filter" };
+    for ( int j = 0; j < 2; j++ ) {
+	pyPropertyNode prof = pyGetNode("/status/profile", true)
+	    .getChild(sections[j], true);
+	prof.setLong("count", (long)rnd(0, 4e9));
+	prof.setDouble("p50_ms", rnd(0, 5));
+	prof.setDouble("p90_ms", rnd(0, 10));
+	prof.setDouble("p99_ms", rnd(0, 20));
+	prof.setDouble("p999_ms", rnd(0, 50));
+	prof.setDouble("max_ms", rnd(0, 100)); // exercise the clamp
+	prof.setLong("overruns", (long)rnd(0, 1e6));
+    }
+}
+
+
+int main(int argc, char **argv) {
+    if ( argc < 3 ) {
+	printf("usage: %s <aura src dir> <golden file> [--write]\n", argv[0]);
+	return 1;
+    }
+    bool write_golden = argc > 3 && strcmp(argv[3], "--write") == 0;
+
+    AuraPythonInit(argc, argv, argv[1]);
+    pyPropsInit();
+
+    pyModulePacker packer;
+    packer.init("comms.packer");
+
+    struct {
+	const char *py_func;
+	int (pyModulePacker::*pack)(int index, uint8_t *buf);
+	int max_index;
+    } messages[] = {
+	{ "pack_gps_v3", &pyModulePacker::pack_gps, 2 },
+	{ "pack_imu_v3", &pyModulePacker::pack_imu, 2 },
+	{ "pack_airdata_v5", &pyModulePacker::pack_airdata, 2 },
+	{ "pack_raven_v1", &pyModulePacker::pack_raven, 2 },
+	{ "pack_system_health_v4", &pyModulePacker::pack_health, 1 },
+	{ "pack_pilot_v2", &pyModulePacker::pack_pilot, 2 },
+	{ "pack_act_v2", &pyModulePacker::pack_actuator, 2 },
+	{ "pack_filter_v3", &pyModulePacker::pack_filter, 2 },
+	{ "pack_payload_v2", &pyModulePacker::pack_payload, 1 },
+	{ "pack_ap_status_v5", &pyModulePacker::pack_ap, 1 },
+	{ "pack_profile_v1", &pyModulePacker::pack_profile, 2 },
+    };
+    int num_messages = sizeof(messages) / sizeof(messages[0]);
+
+    string golden;
+    int count = 0;
+    int failures = 0;
+    for ( int n = 0; n < 20; n++ ) {
+	set_state(n);
+	for ( int m = 0; m < num_messages; m++ ) {
+	    for ( int i = 0; i < messages[m].max_index; i++ ) {
+		uint8_t py_buf[256];
+		uint8_t native_buf[256];
+		int py_len = packer.pack(i, messages[m].py_func, py_buf);
+		int native_len = (packer.*messages[m].pack)(i, native_buf);
+		count++;
+		if ( py_len != native_len
+		     || memcmp(py_buf, native_buf, py_len) != 0 )
+		{
+		    printf("FAIL: state %d %s(%d) python len = %d native len = %d\n",
+			   n, messages[m].py_func, i, py_len, native_len);
+		    for ( int j = 0; j < py_len || j < native_len; j++ ) {
+			printf("  %3d: %3d %3d%s\n", j,
+			       j < py_len ? py_buf[j] : -1,
+			       j < native_len ? native_buf[j] : -1,
+			       (j < py_len && j < native_len
+				&& py_buf[j] == native_buf[j]) ? "" : " <--");
+		    }
+		    failures++;
+		}
+		golden.append((char *)py_buf, py_len);
+	    }
+	}
+    }
+    printf("compared %d messages, %d failures\n", count, failures);
+
+    if ( write_golden ) {
+	FILE *fp = fopen(argv[2], "wb");
+	if ( fp == NULL ) {
+	    printf("cannot create: %s\n", argv[2]);
+	    return 1;
+	}
+	fwrite(golden.data(), 1, golden.length(), fp);
+	fclose(fp);
+	printf("wrote %d bytes to %s\n", (int)golden.length(), argv[2]);
+    } else {
+	FILE *fp = fopen(argv[2], "rb");
+	if ( fp == NULL ) {
+	    printf("cannot open: %s\n", argv[2]);
+	    return 1;
+	}
+	string saved;
+	char buf[4096];
+	size_t len;
+	while ( (len = fread(buf, 1, sizeof(buf), fp)) > 0 ) {
+	    saved.append(buf, len);
+	}
+	fclose(fp);
+	if ( saved != golden ) {
+	    printf("FAIL: output does not match golden file %s\n", argv[2]);
+	    failures++;
+	} else {
+	    printf("golden file matches (%d bytes)\n", (int)saved.length());
+	}
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+//
+// packet_id.hxx - shared packet id definitions (mirrors packet_id.py)
+//
+// note: this id is encoded as a single byte in the binary packet
+// format so the max id number we can assign is 255.  As long as we
+// have numbers available, it is best to add new packet id's instead
+// of changing or reusing numbers to maximize backwards compatibility
+// with older binary log files.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_PACKET_ID_HXX
+#define _AURA_PACKET_ID_HXX
+
+#include <stdint.h>
+
+const uint8_t START_OF_MSG0 = 147;
+const uint8_t START_OF_MSG1 = 224;
+
+const uint8_t GPS_PACKET_V1 = 0;
+const uint8_t GPS_PACKET_V2 = 16;
+const uint8_t GPS_PACKET_V3 = 26;
+
+const uint8_t IMU_PACKET_V1 = 1;
+const uint8_t IMU_PACKET_V2 = 15;
+const uint8_t IMU_PACKET_V3 = 17;
+
+const uint8_t FILTER_PACKET_V1 = 2;
+const uint8_t FILTER_PACKET_V2 = 22;
+const uint8_t FILTER_PACKET_V3 = 31;
+
+const uint8_t ACTUATOR_PACKET_V1 = 3;
+const uint8_t ACTUATOR_PACKET_V2 = 21;
+
+const uint8_t PILOT_INPUT_PACKET_V1 = 4;
+const uint8_t PILOT_INPUT_PACKET_V2 = 20;
+
+const uint8_t AP_STATUS_PACKET_V1 = 5;
+const uint8_t AP_STATUS_PACKET_V2 = 10;
+const uint8_t AP_STATUS_PACKET_V3 = 24;
+const uint8_t AP_STATUS_PACKET_V4 = 30;
+const uint8_t AP_STATUS_PACKET_V5 = 32;
+
+const uint8_t AIRDATA_PACKET_V3 = 9;
+const uint8_t AIRDATA_PACKET_V4 = 13;
+const uint8_t AIRDATA_PACKET_V5 = 18;
+
+const uint8_t SYSTEM_HEALTH_PACKET_V2 = 11;
+const uint8_t SYSTEM_HEALTH_PACKET_V3 = 14;
+const uint8_t SYSTEM_HEALTH_PACKET_V4 = 19;
+
+const uint8_t PAYLOAD_PACKET_V1 = 12;
+const uint8_t PAYLOAD_PACKET_V2 = 23;
+
+const uint8_t EVENT_PACKET_V1 = 27;
+
+const uint8_t COMMAND_PACKET_V1 = 28;
+
+const uint8_t RAVEN_PACKET_V1 = 25;
+const uint8_t REMOTE_JOYSTICK_V1 = 29;
+
+const uint8_t PROFILE_PACKET_V1 = 33;
+
+const uint8_t COMPACT_PACKET_V1 = 34;
+const uint8_t COMPACT_ACK_PACKET_V1 = 35;
+
+#endif // _AURA_PACKET_ID_HXX
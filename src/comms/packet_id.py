@@ -28,7 +28,7 @@ AP_STATUS_PACKET_V1 = 5
 AP_STATUS_PACKET_V2 = 10
 AP_STATUS_PACKET_V3 = 24
 AP_STATUS_PACKET_V4 = 30
-AP_STATUS_PACKET_V5 = 32        # last id assigned
+AP_STATUS_PACKET_V5 = 32
 
 AIRDATA_PACKET_V3 = 9
 AIRDATA_PACKET_V4 = 13
@@ -47,3 +47,8 @@ COMMAND_PACKET_V1 = 28
 
 RAVEN_PACKET_V1 = 25
 REMOTE_JOYSTICK_V1 = 29
+
+PROFILE_PACKET_V1 = 33
+
+COMPACT_PACKET_V1 = 34
+COMPACT_ACK_PACKET_V1 = 35      # last id assigned
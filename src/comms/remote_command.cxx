@@ -0,0 +1,313 @@
+//
+// remote_command.cxx - execute the text commands sent up by the
+// ground station
+//
+// This code is released into the public domain.
+//
+
+#include "python/pyprops.hxx"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "init/globals.hxx"
+#include "util/strutils.hxx"
+
+#include "remote_command.hxx"
+
+
+static pyPropertyNode home_node;
+static pyPropertyNode route_node;
+static pyPropertyNode task_node;
+static pyPropertyNode targets_node;
+static pyPropertyNode pos_node;
+static pyPropertyNode reconfig_node;
+
+// route upload in progress (route, route_cont ... route_end)
+static vector<string> route_request;
+
+
+void remote_command_init() {
+    home_node = pyGetNode( "/task/home", true );
+    route_node = pyGetNode( "/task/route", true );
+    task_node = pyGetNode( "/task", true );
+    targets_node = pyGetNode( "/autopilot/targets", true );
+    pos_node = pyGetNode( "/position", true );
+    reconfig_node = pyGetNode( "/autopilot/reconfig", true );
+}
+
+
+// the whole token must be a number (the ground station sends %f
+// style values, a garbled command shouldn't become zeros)
+static bool to_double( const string &token, double *value ) {
+    const char *start = token.c_str();
+    char *end;
+    *value = strtod( start, &end );
+    return end != start && *end == '\0';
+}
+
+static bool to_doubles( const vector<string> &tokens, unsigned int first,
+			unsigned int count, double *values )
+{
+    if ( first + count > tokens.size() ) {
+	return false;
+    }
+    for ( unsigned int i = 0; i < count; i++ ) {
+	if ( ! to_double( tokens[first + i], &values[i] ) ) {
+	    return false;
+	}
+    }
+    return true;
+}
+
+
+// split a property path into its parent node and the leaf name (a
+// bare name is a child of the root)
+static pyPropertyNode parent_node( const string &path, string *name ) {
+    size_t pos = path.rfind( '/' );
+    string node_path = "/";
+    if ( pos != string::npos && pos > 0 ) {
+	node_path = path.substr( 0, pos );
+    }
+    *name = path.substr( pos + 1 );
+    return pyGetNode( node_path, true );
+}
+
+
+static bool cmd_heartbeat( const vector<string> &tokens,
+			   const string &command )
+{
+    // no action needed
+    return true;
+}
+
+static bool cmd_home( const vector<string> &tokens, const string &command ) {
+    // lon, lat, alt_ft (not used), azimuth_deg
+    double v[4];
+    if ( ! to_doubles( tokens, 1, 4, v ) ) {
+	return false;
+    }
+    home_node.setDouble( "longitude_deg", v[0] );
+    home_node.setDouble( "latitude_deg", v[1] );
+    home_node.setDouble( "azimuth_deg", v[3] );
+    home_node.setBool( "valid", true );
+    return true;
+}
+
+static bool cmd_route( const vector<string> &tokens, const string &command ) {
+    route_request.assign( tokens.begin() + 1, tokens.end() );
+    return true;
+}
+
+static bool cmd_route_cont( const vector<string> &tokens,
+			    const string &command )
+{
+    route_request.insert( route_request.end(), tokens.begin() + 1,
+			  tokens.end() );
+    return true;
+}
+
+static bool cmd_route_end( const vector<string> &tokens,
+			   const string &command )
+{
+    string request;
+    for ( unsigned int i = 0; i < route_request.size(); i++ ) {
+	if ( i > 0 ) {
+	    request += ",";
+	}
+	request += route_request[i];
+    }
+    route_node.setString( "route_request", request );
+    task_node.setString( "command_request", "task,route" );
+    return true;
+}
+
+static bool cmd_task( const vector<string> &tokens, const string &command ) {
+    task_node.setString( "command_request", command );
+    return true;
+}
+
+static bool cmd_ap( const vector<string> &tokens, const string &command ) {
+    double value;
+    if ( ! to_double( tokens[2], &value ) ) {
+	return false;
+    }
+    if ( tokens[1] == "agl-ft" ) {
+	targets_node.setDouble( "altitude_agl_ft", value );
+    } else if ( tokens[1] == "msl-ft" ) {
+	targets_node.setDouble( "target_msl_ft", value );
+    } else if ( tokens[1] == "speed-kt" ) {
+	targets_node.setDouble( "airspeed_kt", value );
+    } else {
+	return false;
+    }
+    return true;
+}
+
+static bool cmd_fcs_update( const vector<string> &tokens,
+			    const string &command )
+{
+    return remote_command_fcs_update( command );
+}
+
+static bool cmd_get( const vector<string> &tokens, const string &command ) {
+    string name;
+    pyPropertyNode node = parent_node( tokens[1], &name );
+    string value = node.getString( name.c_str() );
+    if ( value == "" ) {
+	value = "undefined";
+    }
+    string reply = tokens[1] + "," + value;
+    events->log( "get", reply.c_str(), true );
+    return true;
+}
+
+static bool cmd_set( const vector<string> &tokens, const string &command ) {
+    if ( tokens[1][0] != '/' ) {
+	// expecting a full path name to set
+	return false;
+    }
+    string name;
+    pyPropertyNode node = parent_node( tokens[1], &name );
+    string value = tokens[2];
+    for ( unsigned int i = 3; i < tokens.size(); i++ ) {
+	value += " " + tokens[i];
+    }
+    node.setString( name.c_str(), value );
+
+    // the autopilot copies its config (see AuraAutopilot::reconfigure()),
+    // any write under /config/autopilot asks it to reread it
+    if ( tokens[1].compare( 0, 18, "/config/autopilot/" ) == 0 ) {
+	reconfig_node.setLong( "request",
+			       reconfig_node.getLong("request") + 1 );
+    }
+    return true;
+}
+
+static bool cmd_lookat( const vector<string> &tokens,
+			const string &command )
+{
+    // la,ned,north,east,down or la,wgs84,lon,lat,(unused)
+    double v[3];
+    int count = (tokens[1] == "wgs84") ? 2 : 3;
+    if ( ! to_doubles( tokens, 2, count, v ) ) {
+	return false;
+    }
+    pyPropertyNode point_node = pyGetNode( "/pointing", true );
+    if ( tokens[1] == "ned" ) {
+	// set ned-vector lookat mode
+	point_node.setString( "lookat_mode", "ned_vector" );
+	pyPropertyNode vector_node = pyGetNode( "/pointing/vector", true );
+	vector_node.setDouble( "north", v[0] );
+	vector_node.setDouble( "east", v[1] );
+	vector_node.setDouble( "down", v[2] );
+    } else if ( tokens[1] == "wgs84" ) {
+	// set wgs84 lookat mode (on the ground)
+	point_node.setString( "lookat_mode", "wgs84" );
+	pyPropertyNode wgs84_node = pyGetNode( "/pointing/wgs84", true );
+	wgs84_node.setDouble( "longitude_deg", v[0] );
+	wgs84_node.setDouble( "latitude_deg", v[1] );
+	wgs84_node.setDouble( "altitude_m",
+			      pos_node.getDouble("altitude_ground_m") );
+    } else {
+	return false;
+    }
+    return true;
+}
+
+
+// first token -> handler, with the allowed token counts (max < 0 for
+// no limit)
+typedef bool (*command_handler)( const vector<string> &tokens,
+				 const string &command );
+static const struct {
+    const char *name;
+    int min_tokens;
+    int max_tokens;
+    command_handler handler;
+} commands[] = {
+    { "hb",         1,  1, cmd_heartbeat },
+    { "home",       5,  5, cmd_home },
+    { "route",      5, -1, cmd_route },
+    { "route_cont", 5, -1, cmd_route_cont },
+    { "route_end",  1,  1, cmd_route_end },
+    { "task",       1, -1, cmd_task },
+    { "ap",         3,  3, cmd_ap },
+    { "fcs-update", 1, -1, cmd_fcs_update },
+    { "get",        2,  2, cmd_get },
+    { "set",        3, -1, cmd_set },
+    { "la",         5,  5, cmd_lookat }
+};
+
+
+bool remote_command_execute( const string &command ) {
+    if ( command == "" ) {
+	// no valid tokens
+	return false;
+    }
+    vector<string> tokens = split( command, "," );
+    int n = sizeof(commands) / sizeof(commands[0]);
+    for ( int i = 0; i < n; i++ ) {
+	if ( tokens[0] == commands[i].name ) {
+	    int count = tokens.size();
+	    if ( count < commands[i].min_tokens
+		 || ( commands[i].max_tokens >= 0
+		      && count > commands[i].max_tokens ) )
+	    {
+		return false;
+	    }
+	    return commands[i].handler( tokens, command );
+	}
+    }
+    return false;
+}
+
+
+bool remote_command_fcs_update( const string &command ) {
+    vector<string> tokens = split( command, "," );
+    if ( tokens.size() > 0 && tokens[0] == "fcs-update" ) {
+	// remove initial keyword if it exists
+	tokens.erase( tokens.begin() );
+    }
+    if ( tokens.size() != 7 && tokens.size() != 10 ) {
+	return false;
+    }
+
+    double index;
+    double gains[9];
+    if ( ! to_double( tokens[0], &index )
+	 || ! to_doubles( tokens, 1, tokens.size() - 1, gains ) )
+    {
+	return false;
+    }
+
+    char path[64];
+    snprintf( path, sizeof(path), "/config/autopilot/component[%d]/config",
+	      (int)index );
+    pyPropertyNode config = pyGetNode( path, false );
+    if ( config.isNull() ) {
+	return false;
+    }
+
+    static const char *pid_names[] = {
+	"Kp", "Ti", "Td", "u_min", "u_max", "u_trim"
+    };
+    static const char *pid_vel_names[] = {
+	"Kp", "beta", "alpha", "gamma", "Ti", "Td", "u_min", "u_max", "u_trim"
+    };
+    const char **names = (tokens.size() == 7) ? pid_names : pid_vel_names;
+    for ( unsigned int i = 1; i < tokens.size(); i++ ) {
+	config.setDouble( names[i-1], gains[i-1] );
+    }
+
+    // the autopilot copies its gains, ask it to reread them
+    reconfig_node.setLong( "request", reconfig_node.getLong("request") + 1 );
+
+    return true;
+}
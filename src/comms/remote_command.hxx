@@ -0,0 +1,42 @@
+//
+// remote_command.hxx - execute the text commands sent up by the
+// ground station (payload of a COMMAND_PACKET_V1)
+//
+// A command is a comma separated list, the first token selects the
+// handler:
+//
+//   hb                                heart beat
+//   home,lon,lat,alt_ft,azimuth_deg   set the home location
+//   route,... route_cont,... route_end
+//                                     upload a route in pieces
+//   task,...                          mission task request
+//   ap,agl-ft|msl-ft|speed-kt,value   autopilot target
+//   fcs-update,index,gains...         autopilot gains (see below)
+//   get,/abs/path                     reply with a 'get' event
+//   set,/abs/path,value               set a property
+//   la,ned,n,e,d  la,wgs84,lon,lat,x  pointing target
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_REMOTE_COMMAND_HXX
+#define _AURA_REMOTE_COMMAND_HXX
+
+#include <string>
+using std::string;
+
+
+// bind the property nodes (call once at startup)
+void remote_command_init();
+
+// returns false if the command isn't recognized or malformed
+bool remote_command_execute( const string &command );
+
+// fcs-update,index,Kp,Ti,Td,u_min,u_max,u_trim (pid) or
+// fcs-update,index,Kp,beta,alpha,gamma,Ti,Td,u_min,u_max,u_trim
+// (pid_vel): write the gains of /config/autopilot/component[index]
+// and ask the autopilot to reread them
+bool remote_command_fcs_update( const string &command );
+
+
+#endif // _AURA_REMOTE_COMMAND_HXX
@@ -1,109 +1,376 @@
 #include "python/pyprops.hxx"
 
+#include <stdio.h>
+
+#include "comms/packet_id.hxx"
+#include "init/frame_state.hxx"
+#include "init/globals.hxx"
+#include "util/timing.h"
+
+#include "remote_command.hxx"
 #include "remote_link.hxx"
 
-pyModuleRemoteLink::pyModuleRemoteLink()
+
+// Default message classes.  The skip entries are the per module
+// remote_link settings this replaces (packets were sent every skip+1
+// frames of the 100hz main loop), still honored if the config has
+// them and no <name>_hz setting.
+static const int SKIP_FRAME_HZ = 100;
+static const struct {
+    const char *name;
+    uint8_t packet_id;
+    int priority;		// lower goes first
+    double rate_hz;
+    const char *skip;
+} class_defaults[] = {
+    { "ap",       AP_STATUS_PACKET_V5,     1, 2.0, "autopilot_skip" },
+    { "filter",   FILTER_PACKET_V3,        2, 4.0, "filter_skip" },
+    { "gps",      GPS_PACKET_V3,           3, 1.0, "gps_skip" },
+    { "airdata",  AIRDATA_PACKET_V5,       4, 2.0, "airdata_skip" },
+    { "health",   SYSTEM_HEALTH_PACKET_V4, 5, 1.0, NULL },
+    { "actuator", ACTUATOR_PACKET_V2,      6, 2.0, "actuator_skip" },
+    { "pilot",    PILOT_INPUT_PACKET_V2,   7, 2.0, "pilot_skip" },
+    { "imu",      IMU_PACKET_V3,           8, 1.0, "imu_skip" },
+    { "payload",  PAYLOAD_PACKET_V2,       9, 1.0, "payload_skip" }
+};
+
+
+pyModuleRemoteLink::pyModuleRemoteLink():
+    compact_on(false),
+    stats_time(0.0),
+    last_sequence_num(-1),
+    state_serial(0),
+    sent_imu(0.0),
+    sent_gps(0.0),
+    sent_airdata(0.0),
+    sent_filter(0.0),
+    sent_act(0.0),
+    pPending(NULL)
 {
 }
 
-void pyModuleRemoteLink::send_message( uint8_t *buf, int size ) {
-    if (pModuleObj == NULL) {
-	printf("ERROR: import logging module failed\n");
+bool pyModuleRemoteLink::init(const char *import_name)
+{
+    // python side opens the device
+    bool result = pyModuleBase::init(import_name);
+    int fd = -1;
+    if ( pModuleObj != NULL ) {
+	pPending = PyObject_GetAttrString(pModuleObj, "pending");
+	if ( pPending != NULL && ! PyList_Check(pPending) ) {
+	    Py_DECREF(pPending);
+	    pPending = NULL;
+	}
+	if ( pPending == NULL ) {
+	    PyErr_Clear();
+	    printf("ERROR: remote_link.pending not found, python messages will not be sent\n");
+	}
+	PyObject *pFuncFileno = get_method("fileno");
+	if ( pFuncFileno != NULL ) {
+	    PyObject *pValue = PyObject_CallFunction(pFuncFileno, NULL);
+	    if ( pValue != NULL ) {
+		fd = PyInt_AsLong(pValue);
+		Py_DECREF(pValue);
+	    } else {
+		PyErr_Print();
+	    }
+	}
+    }
+
+    pyPropertyNode stats_node = pyGetNode( "/comms/remote_link", true );
+    utilization_h = stats_node.getHandle<double>("utilization");
+    bytes_per_sec_h = stats_node.getHandle<double>("bytes_per_sec");
+    queued_events_h = stats_node.getHandle<long>("queued_events");
+    dropped_events_h = stats_node.getHandle<long>("dropped_events");
+    queued_bytes_h = stats_node.getHandle<long>("queued_bytes");
+    uplink_packets_h = stats_node.getHandle<long>("uplink_packets");
+    uplink_errors_h = stats_node.getHandle<long>("uplink_errors");
+    remote_link_node = stats_node;
+    sequence_num_h = stats_node.getHandle<long>("sequence_num");
+    status_node = pyGetNode( "/status", true );
+
+    setup_classes();
+    setup_compact();
+
+    // byte budget
+    pyPropertyNode config_node = pyGetNode( "/config/remote_link", true );
+    double bytes_per_sec = 1200.0;
+    if ( config_node.hasChild("bytes_per_sec") ) {
+	bytes_per_sec = config_node.getDouble("bytes_per_sec");
+    } else if ( config_node.hasChild("write_bytes_per_frame") ) {
+	bytes_per_sec = config_node.getDouble("write_bytes_per_frame")
+	    * SKIP_FRAME_HZ;
+    }
+    if ( fd >= 0 ) {
+	scheduler.open( fd, bytes_per_sec );
+	uplink.open( fd );
+	uplink.set_handler( COMMAND_PACKET_V1, command_handler, this );
+	uplink.set_handler( COMPACT_ACK_PACKET_V1, ack_handler, this );
+    }
+    remote_command_init();
+    stats_time = get_Time();
+
+    return result;
+}
+
+
+// the default classes, adjusted by /config/remote_link/<name>_hz and
+// <name>_priority, plus the never dropped event queue
+void pyModuleRemoteLink::setup_classes() {
+    pyPropertyNode config_node = pyGetNode( "/config/remote_link", true );
+    pyPropertyNode stats_node = pyGetNode( "/comms/remote_link", true );
+
+    int event_class = scheduler.add_class( "event", 0, 0.0, true );
+    scheduler.map_id( EVENT_PACKET_V1, event_class );
+
+    int n = sizeof(class_defaults) / sizeof(class_defaults[0]);
+    for ( int i = 0; i < n; i++ ) {
+	string name = class_defaults[i].name;
+	double rate_hz = class_defaults[i].rate_hz;
+	int priority = class_defaults[i].priority;
+	const char *skip = class_defaults[i].skip;
+	if ( config_node.hasChild( (name + "_hz").c_str() ) ) {
+	    rate_hz = config_node.getDouble( (name + "_hz").c_str() );
+	} else if ( skip != NULL && config_node.hasChild(skip) ) {
+	    rate_hz = SKIP_FRAME_HZ / (config_node.getDouble(skip) + 1.0);
+	}
+	if ( config_node.hasChild( (name + "_priority").c_str() ) ) {
+	    priority = config_node.getLong( (name + "_priority").c_str() );
+	}
+	int cls = scheduler.add_class( name, priority, rate_hz, false );
+	scheduler.map_id( class_defaults[i].packet_id, cls );
+    }
+
+    // anything else is low priority state at 1hz
+    int other_class = scheduler.add_class( "other", 10, 1.0, false );
+    scheduler.set_default_class( other_class );
+
+    class_h.resize( scheduler.num_classes() );
+    for ( int i = 0; i < scheduler.num_classes(); i++ ) {
+	pyPropertyNode node
+	    = stats_node.getChild( scheduler.get_name(i).c_str(), true );
+	class_h[i].rate_hz = node.getHandle<double>("rate_hz");
+	class_h[i].latency_ms = node.getHandle<double>("latency_ms");
+	class_h[i].max_latency_ms = node.getHandle<double>("max_latency_ms");
+	class_h[i].coalesced = node.getHandle<long>("coalesced");
+    }
+}
+
+
+// /config/remote_link/compact: enable, keyframe_sec, ack and the
+// quantum of any float field as <class>/<field> (rounded to a power
+// of ten, e.g. filter/altitude_m = 0.1)
+void pyModuleRemoteLink::setup_compact() {
+    pyPropertyNode config_node = pyGetNode( "/config/remote_link/compact",
+					    true );
+    compact_on = config_node.getBool("enable");
+    if ( ! compact_on ) {
 	return;
     }
-    PyObject *pFuncLog = PyObject_GetAttrString(pModuleObj, "send_message");
-    if ( pFuncLog == NULL || ! PyCallable_Check(pFuncLog) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'send_message()'\n");
+    if ( config_node.hasChild("keyframe_sec") ) {
+	compact.set_keyframe_sec( config_node.getDouble("keyframe_sec") );
+    }
+    if ( config_node.hasChild("ack") ) {
+	compact.set_ack( config_node.getBool("ack") );
+    }
+    int n = sizeof(class_defaults) / sizeof(class_defaults[0]);
+    for ( int i = 0; i < n; i++ ) {
+	if ( ! config_node.hasChild(class_defaults[i].name) ) {
+	    continue;
+	}
+	pyPropertyNode node
+	    = config_node.getChild( class_defaults[i].name, true );
+	uint8_t id = class_defaults[i].packet_id;
+	for ( int j = 0; j < compact.num_quantized(id); j++ ) {
+	    const char *field = compact.quantized_name( id, j );
+	    if ( node.hasChild(field) ) {
+		compact.set_quantum( id, j, node.getDouble(field) );
+	    }
+	}
+    }
+    scheduler.set_encoder( &compact );
+
+    pyPropertyNode stats_node = pyGetNode( "/comms/remote_link/compact",
+					   true );
+    compact_ratio_h = stats_node.getHandle<double>("ratio");
+    keyframes_per_sec_h = stats_node.getHandle<double>("keyframes_per_sec");
+    deltas_per_sec_h = stats_node.getHandle<double>("deltas_per_sec");
+}
+
+
+void pyModuleRemoteLink::send_message( uint8_t *buf, int size ) {
+    if ( scheduler.is_open() ) {
+	scheduler.send( buf, size, get_Time() );
+    }
+}
+
+// read, parse, and execute incoming commands
+int pyModuleRemoteLink::command()
+{
+    return uplink.update();
+}
+
+void pyModuleRemoteLink::command_handler( const uint8_t *payload, int len,
+					  void *arg )
+{
+    ((pyModuleRemoteLink *)arg)->execute( payload, len );
+}
+
+// COMPACT_ACK_PACKET_V1: packet id, section index, keyframe sequence
+void pyModuleRemoteLink::ack_handler( const uint8_t *payload, int len,
+				      void *arg )
+{
+    if ( len == 3 ) {
+	((pyModuleRemoteLink *)arg)->compact.ack( payload[0], payload[1],
+						  payload[2] );
+    }
+}
+
+// COMMAND_PACKET_V1: sequence number, message length, message
+void pyModuleRemoteLink::execute( const uint8_t *payload, int len )
+{
+    if ( len < 2 || payload[1] > len - 2 ) {
+	printf("remote link: malformed command packet (%d bytes)\n", len);
 	return;
     }
-    PyObject *pResult = PyObject_CallFunction(pFuncLog, (char *)"s#", buf, size);
-    if (pResult != NULL) {
-	Py_DECREF(pResult);
+    int sequence = payload[0];
+    string message( (const char *)payload + 2, payload[1] );
+
+    // ignore repeated commands (including roll over logic)
+    if ( sequence != last_sequence_num ) {
+	// execute command
+	char msg[300];
+	snprintf( msg, sizeof(msg), "executed: (%d) %s", sequence,
+		  message.c_str() );
+	events->log( "remote command", msg );
+	remote_command_execute( message );
+
+	// register that we've received this message correctly
+	remote_link_node.setLong( "sequence_num", sequence );
+	last_sequence_num = sequence;
+	remote_link_node.setDouble( "last_message_sec",
+				    status_node.getDouble("frame_time") );
+    }
+}
+
+
+// move the python messages into the scheduler and publish the link
+// statistics once a second (interpreter lock held)
+void pyModuleRemoteLink::update()
+{
+    if ( ! scheduler.is_open() ) {
 	return;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
+    }
+    double now = get_Time();
+
+    if ( pPending != NULL && PyList_GET_SIZE(pPending) > 0 ) {
+	Py_ssize_t n = PyList_GET_SIZE(pPending);
+	for ( Py_ssize_t i = 0; i < n; i++ ) {
+	    PyObject *item = PyList_GET_ITEM(pPending, i);
+	    if ( PyString_Check(item) ) {
+		scheduler.send( (uint8_t *)PyString_AS_STRING(item),
+				PyString_GET_SIZE(item), now );
+	    }
+	}
+	PyList_SetSlice(pPending, 0, n, NULL);
+    }
+
+    send_frame_state( now );
+
+    if ( now >= stats_time + 1.0 ) {
+	publish_stats( now );
+    }
+}
+
+// The primary imu, gps, airdata, filter and actuator packets are
+// packed here from the newest frame snapshot (the control thread only
+// logs them), each when its timestamp has moved.  A section that has
+// never been updated (timestamp 0) isn't sent.
+void pyModuleRemoteLink::send_frame_state( double now )
+{
+    uint32_t serial = frame_state.load( &state );
+    if ( serial == state_serial ) {
 	return;
     }
+    state_serial = serial;
+
+    uint8_t buf[256];
+    int size;
+    if ( state.imu.timestamp != sent_imu ) {
+	sent_imu = state.imu.timestamp;
+	size = packer->pack_imu( state, buf );
+	scheduler.send( buf, size, now );
+    }
+    if ( state.gps.timestamp != sent_gps ) {
+	sent_gps = state.gps.timestamp;
+	size = packer->pack_gps( state, buf );
+	scheduler.send( buf, size, now );
+    }
+    if ( state.airdata.timestamp != sent_airdata ) {
+	sent_airdata = state.airdata.timestamp;
+	size = packer->pack_airdata( state, buf );
+	scheduler.send( buf, size, now );
+    }
+    if ( state.filter.timestamp != sent_filter ) {
+	sent_filter = state.filter.timestamp;
+	size = packer->pack_filter( state, sequence_num_h.get(), buf );
+	scheduler.send( buf, size, now );
+    }
+    if ( state.act.timestamp != sent_act ) {
+	sent_act = state.act.timestamp;
+	size = packer->pack_actuator( state, buf );
+	scheduler.send( buf, size, now );
+    }
 }
 
-bool pyModuleRemoteLink::command()
+// send what the budget allows.  Touches only the scheduler and the
+// encoder, so the main thread calls this without the interpreter lock.
+void pyModuleRemoteLink::flush()
 {
-    if (pModuleObj == NULL) {
-	printf("ERROR: remote_link.init() failed\n");
-	return false;
-    }
-    PyObject *pFuncOpen = PyObject_GetAttrString(pModuleObj, "command");
-    if ( pFuncOpen == NULL || ! PyCallable_Check(pFuncOpen) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'command()'\n");
-	return false;
-    }
-
-    // FIXME decref pFuncOpen
-    
-    PyObject *pValue = PyObject_CallFunction(pFuncOpen, NULL);
-    if (pValue != NULL) {
-	bool result = PyObject_IsTrue(pValue);
-	Py_DECREF(pValue);
-	return result;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
-	return false;
-    }
-    return false;
+    if ( scheduler.is_open() ) {
+	scheduler.update( get_Time() );
+    }
 }
 
 
-bool pyModuleRemoteLink::flush_serial()
-{
-    if (pModuleObj == NULL) {
-	printf("ERROR: remote_link.init() failed\n");
-	return false;
-    }
-    PyObject *pFuncOpen = PyObject_GetAttrString(pModuleObj, "flush_serial");
-    if ( pFuncOpen == NULL || ! PyCallable_Check(pFuncOpen) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'flush_serial()'\n");
-	return false;
-    }
-
-    // FIXME decref pFuncOpen
-    
-    PyObject *pValue = PyObject_CallFunction(pFuncOpen, NULL);
-    if (pValue != NULL) {
-	bool result = PyObject_IsTrue(pValue);
-	Py_DECREF(pValue);
-	return result;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
-	return false;
-    }
-    return false;
+void pyModuleRemoteLink::publish_stats( double now ) {
+    double window = now - stats_time;
+    stats_time = now;
+
+    double bytes_per_sec = scheduler.get_window_bytes() / window;
+    bytes_per_sec_h.set( bytes_per_sec );
+    if ( scheduler.get_bytes_per_sec() > 0.0 ) {
+	utilization_h.set( bytes_per_sec / scheduler.get_bytes_per_sec() );
+    }
+    queued_events_h.set( scheduler.get_queued_events() );
+    dropped_events_h.set( scheduler.get_dropped_events() );
+    queued_bytes_h.set( scheduler.get_ring_bytes() );
+    uplink_packets_h.set( uplink.get_packets() );
+    uplink_errors_h.set( uplink.get_cksum_errors() );
+
+    if ( compact_on ) {
+	// full size of the packets sent compact / their compact size
+	if ( compact.get_compact_bytes() > 0 ) {
+	    compact_ratio_h.set( (double)compact.get_full_bytes()
+				 / compact.get_compact_bytes() );
+	}
+	keyframes_per_sec_h.set( compact.get_keyframes() / window );
+	deltas_per_sec_h.set( compact.get_deltas() / window );
+	compact.end_window();
+    }
+
+    scheduler.end_window( &window_stats );
+    for ( int i = 0; i < scheduler.num_classes(); i++ ) {
+	const AuraLinkScheduler::class_stats &s = window_stats[i];
+	class_h[i].rate_hz.set( s.sent / window );
+	if ( s.sent > 0 ) {
+	    class_h[i].latency_ms.set( s.latency_sum * 1000.0 / s.sent );
+	}
+	class_h[i].max_latency_ms.set( s.latency_max * 1000.0 );
+	class_h[i].coalesced.set( class_h[i].coalesced.get() + s.coalesced );
+    }
 }
 
+
 bool pyModuleRemoteLink::decode_fcs_update( const char *buf ) {
-    if (pModuleObj == NULL) {
-	printf("ERROR: import logging module failed\n");
-	return false;
-    }
-    PyObject *pFuncLog = PyObject_GetAttrString(pModuleObj, "decode_fcs_update");
-    if ( pFuncLog == NULL || ! PyCallable_Check(pFuncLog) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("ERROR: cannot find function 'decode_fcs_update()'\n");
-	return false;
-    }
-    PyObject *pResult = PyObject_CallFunction(pFuncLog, (char *)"s", buf);
-    if (pResult != NULL) {
-	bool result = PyObject_IsTrue(pResult);
-	Py_DECREF(pResult);
-	return result;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
-	return false;
-    }
+    return remote_command_fcs_update( buf );
 }
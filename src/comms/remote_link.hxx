@@ -13,23 +13,92 @@
 #include <string>
 #include <vector>
 
+#include "init/frame_state.hxx"
+
+#include "compact.hxx"
+#include "link_scheduler.hxx"
+#include "uplink.hxx"
+
+// The python module still opens the serial device.  Outgoing
+// telemetry is scheduled and written natively (see
+// link_scheduler.hxx), the message rates, priorities and the byte
+// budget come from /config/remote_link.  Incoming command packets are
+// decoded (uplink.hxx) and executed (remote_command.hxx) natively
+// too.  /config/remote_link/compact/enable turns on the compact
+// telemetry encoding (compact.hxx), the ground side decoder is
+// comms/compact.py.  The primary imu, gps, airdata, filter and
+// actuator packets are packed by update() from the frame snapshot
+// (init/frame_state.hxx), the sensor managers only send the other
+// sections.
+
 class pyModuleRemoteLink: public pyModuleBase {
 
 public:
-    
+
     // constructor / destructor
     pyModuleRemoteLink();
     ~pyModuleRemoteLink() {}
 
+    bool init(const char *import_name);
     // bool open();
+    inline bool is_open() const { return scheduler.is_open(); }
     void send_message( uint8_t *buf, int size );
-    bool command();
-    bool flush_serial();
+    bool is_pending( uint8_t packet_id, uint8_t index ) const {
+	return scheduler.is_pending( packet_id, index );
+    }
+    int command();		// returns the number of packets handled
+    void update();		// once per main loop frame
+    void flush();		// after update(), without the python lock
     bool decode_fcs_update( const char *buf );
 
 private:
 
-    bool remote_link_on;
+    AuraLinkScheduler scheduler;
+    AuraUplink uplink;
+    AuraCompactEncoder compact;
+    bool compact_on;
+    double stats_time;
+    int last_sequence_num;
+
+    // newest frame snapshot and the timestamps last sent from it
+    AuraFrameState state;
+    uint32_t state_serial;
+    double sent_imu, sent_gps, sent_airdata, sent_filter, sent_act;
+
+    PyObject *pPending;		// remote_link.pending (messages from python)
+
+    pyPropertyNode remote_link_node;
+    pyPropertyNode status_node;
+
+    PropertyHandle<long> sequence_num_h;
+    PropertyHandle<double> utilization_h;
+    PropertyHandle<double> bytes_per_sec_h;
+    PropertyHandle<long> queued_events_h;
+    PropertyHandle<long> dropped_events_h;
+    PropertyHandle<long> queued_bytes_h;
+    PropertyHandle<long> uplink_packets_h;
+    PropertyHandle<long> uplink_errors_h;
+    PropertyHandle<double> compact_ratio_h;
+    PropertyHandle<double> keyframes_per_sec_h;
+    PropertyHandle<double> deltas_per_sec_h;
+
+    struct class_handles {
+	PropertyHandle<double> rate_hz;
+	PropertyHandle<double> latency_ms;
+	PropertyHandle<double> max_latency_ms;
+	PropertyHandle<long> coalesced;
+    };
+    std::vector<class_handles> class_h;
+    std::vector<AuraLinkScheduler::class_stats> window_stats;
+
+    static void command_handler( const uint8_t *payload, int len,
+				 void *arg );
+    void execute( const uint8_t *payload, int len );
+    static void ack_handler( const uint8_t *payload, int len, void *arg );
+    void setup_classes();
+    void setup_compact();
+    void send_frame_state( double now );
+    void publish_stats( double now );
 };
 
 #endif // _AURA_REMOTE_LINK_HXX
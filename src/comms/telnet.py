@@ -160,10 +160,16 @@ class ChatHandler(asynchat.async_chat):
                     node = getNode(tmppath, True)
                     name = tmp[-1]
                 else:
+                    tmppath = self.path
                     node = getNode(self.path, True)
                     name = tokens[1]
 		value = ' '.join(tokens[2:])
 		node.setString(name, value)
+                # the autopilot copies its config, ask it to reread it
+                if (tmppath + '/').startswith('/config/autopilot/'):
+                    reconfig_node = getNode('/autopilot/reconfig', True)
+                    reconfig_node.setInt('request',
+                                         reconfig_node.getInt('request') + 1)
 		if self.prompt:
 		    # now fetch and write out the new value as confirmation
 		    # of the change
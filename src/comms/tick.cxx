@@ -0,0 +1,54 @@
+#include "tick.hxx"
+
+pyModuleTick::pyModuleTick():
+    pFuncAdd(NULL),
+    pElapsed(NULL)
+{
+}
+
+bool pyModuleTick::init(const char *import_name)
+{
+    bool result = pyModuleBase::init(import_name);
+    if ( pModuleObj != NULL ) {
+	pFuncAdd = get_method("add");
+	pElapsed = PyObject_GetAttrString(pModuleObj, "elapsed");
+	if ( pElapsed != NULL && ! PyList_Check(pElapsed) ) {
+	    Py_DECREF(pElapsed);
+	    pElapsed = NULL;
+	}
+	if ( pElapsed == NULL ) {
+	    PyErr_Clear();
+	}
+    }
+    return result;
+}
+
+int pyModuleTick::add( pyModuleBase *module, const char *name, bool pass_dt )
+{
+    if ( pFuncAdd == NULL ) {
+	printf("ERROR: tick.init() failed\n");
+	return -1;
+    }
+    PyObject *pFunc = module->get_method(name);
+    if ( pFunc == NULL ) {
+	return -1;
+    }
+    PyObject *pValue = PyObject_CallFunction(pFuncAdd, (char *)"OO", pFunc,
+					     pass_dt ? Py_True : Py_False);
+    if ( pValue == NULL ) {
+	PyErr_Print();
+	printf("ERROR: call failed (%s)\n", module_name.c_str());
+	return -1;
+    }
+    int slot = PyInt_AsLong(pValue);
+    Py_DECREF(pValue);
+    return slot;
+}
+
+double pyModuleTick::get_elapsed( int slot )
+{
+    if ( pElapsed == NULL || slot < 0 || slot >= PyList_GET_SIZE(pElapsed) ) {
+	return 0.0;
+    }
+    return PyFloat_AsDouble( PyList_GET_ITEM(pElapsed, slot) );
+}
@@ -0,0 +1,37 @@
+#ifndef _AURA_TICK_HXX
+#define _AURA_TICK_HXX
+
+// Per frame python work.  The update functions of the python modules
+// that run every frame (telnet, mission) are
+// registered here once at startup, then update() enters the
+// interpreter a single time per frame and tick.py calls them in
+// order.  The time spent in each one is available afterwards for the
+// profilers.
+
+#include "python/pymodule.hxx"
+
+class pyModuleTick: public pyModuleBase {
+
+public:
+
+    // constructor / destructor
+    pyModuleTick();
+    ~pyModuleTick() {}
+
+    bool init(const char *import_name);
+
+    // append the named function of 'module' to the per frame list.
+    // Returns the slot number, or -1 if the module (or function)
+    // isn't available.
+    int add( pyModuleBase *module, const char *name, bool pass_dt );
+
+    // seconds spent in the given slot during the last update()
+    double get_elapsed( int slot );
+
+private:
+
+    PyObject *pFuncAdd;
+    PyObject *pElapsed;		// tick.elapsed
+};
+
+#endif // _AURA_TICK_HXX
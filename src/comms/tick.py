@@ -0,0 +1,40 @@
+# tick.py - per frame python work
+
+import time
+import traceback
+
+# The main loop registers the update functions of the python modules
+# it runs every frame (see tick.hxx) and then calls update() once per
+# frame, so the interpreter is entered once instead of once per
+# module.  Each function is called in registration order with the
+# same error isolation as a separate call from C++: an exception is
+# printed and the remaining functions still run.
+
+funcs = []
+pass_dt = []
+
+# seconds spent in each function during the most recent update().
+# The native side reads this list in place, so never rebind it.
+elapsed = []
+
+def init():
+    return True
+
+def add(func, with_dt):
+    funcs.append(func)
+    pass_dt.append(with_dt)
+    elapsed.append(0.0)
+    return len(funcs) - 1
+
+def update(dt):
+    for i in range(len(funcs)):
+        start = time.time()
+        try:
+            if pass_dt[i]:
+                funcs[i](dt)
+            else:
+                funcs[i]()
+        except:
+            traceback.print_exc()
+        elapsed[i] = time.time() - start
+    return True
@@ -0,0 +1,68 @@
+//
+// uplink.cxx - packet decoder for the remote link uplink
+//
+// This code is released into the public domain.
+//
+
+#include <fcntl.h>
+#include <string.h>
+
+#include "comms/packet_id.hxx"
+
+#include "uplink.hxx"
+
+
+AuraUplink::AuraUplink():
+    fd(-1),
+    unhandled(0)
+{
+    memset( handlers, 0, sizeof(handlers) );
+}
+
+
+void AuraUplink::open( int fd ) {
+    this->fd = fd;
+    if ( fd >= 0 ) {
+	fcntl( fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK );
+	framer.init( fd, START_OF_MSG0, START_OF_MSG1 );
+    }
+}
+
+
+void AuraUplink::set_handler( uint8_t packet_id, uplink_handler handler,
+			      void *arg )
+{
+    handlers[packet_id].handler = handler;
+    handlers[packet_id].arg = arg;
+}
+
+
+// hand every complete frame in the buffer to its handler
+int AuraUplink::dispatch() {
+    int count = 0;
+    uint8_t id;
+    int len;
+    const uint8_t *payload;
+    while ( framer.next_view( &id, &len, &payload ) ) {
+	if ( handlers[id].handler != NULL ) {
+	    handlers[id].handler( payload, len, handlers[id].arg );
+	    count++;
+	} else {
+	    unhandled++;
+	}
+    }
+    return count;
+}
+
+
+int AuraUplink::update() {
+    if ( fd < 0 ) {
+	return 0;
+    }
+    int count = 0;
+    do {
+	framer.fill();
+	count += dispatch();
+    } while ( framer.more() );
+    return count;
+}
@@ -0,0 +1,68 @@
+//
+// uplink.hxx - packet decoder for the remote link uplink
+//
+// Reads whatever the ground station has sent with large non-blocking
+// reads, frames it (START_OF_MSG0/1 protocol, see serial_framer.hxx)
+// and hands each checksum verified payload to the handler registered
+// for its packet id.  Payloads are passed as views into the receive
+// buffer (no copy), valid only for the duration of the handler call.
+// The work per call is bounded by the bytes received, noise on the
+// link just costs a memchr() over the junk.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_UPLINK_HXX
+#define _AURA_UPLINK_HXX
+
+#include <stdint.h>
+
+#include "util/serial_framer.hxx"
+
+
+// packet handler: payload excludes the framing
+typedef void (*uplink_handler)( const uint8_t *payload, int len, void *arg );
+
+
+class AuraUplink {
+
+public:
+
+    AuraUplink();
+    ~AuraUplink() {}
+
+    void open( int fd );
+    inline bool is_open() const { return fd >= 0; }
+
+    void set_handler( uint8_t packet_id, uplink_handler handler,
+		      void *arg );
+
+    // read and dispatch everything received so far.  Returns the
+    // number of packets handled.
+    int update();
+
+    // statistics
+    inline unsigned long get_packets() const { return framer.get_frames(); }
+    inline unsigned long get_unhandled() const { return unhandled; }
+    inline unsigned long get_cksum_errors() const {
+	return framer.get_cksum_errors();
+    }
+    inline unsigned long get_resyncs() const { return framer.get_resyncs(); }
+
+private:
+
+    struct handler_entry {
+	uplink_handler handler;
+	void *arg;
+    };
+
+    int fd;
+    SerialFramer framer;
+    handler_entry handlers[256];
+    unsigned long unhandled;
+
+    int dispatch();
+};
+
+
+#endif // _AURA_UPLINK_HXX
@@ -30,10 +30,15 @@
 using std::string;
 using std::ostringstream;
 
+#include "comms/events.hxx"
 #include "comms/logging.hxx"
+#include "init/globals.hxx"
+#include "util/timing.h"
 
 #include "ap.hxx"
 #include "dig_filter.hxx"
+#include "l1_circle.hxx"
+#include "l1_route.hxx"
 #include "pid.hxx"
 #include "pid_vel.hxx"
 #include "predictor.hxx"
@@ -41,6 +46,14 @@ using std::ostringstream;
 
 
 void AuraAutopilot::init() {
+    pyPropertyNode reconfig_node = pyGetNode( "/autopilot/reconfig", true );
+    reconfig_request = reconfig_node.getHandle<long>("request");
+    reconfig_latency_ms = reconfig_node.getHandle<double>("latency_ms");
+    reconfig_changed = reconfig_node.getHandle<long>("changed");
+    reconfig_rebuilt = reconfig_node.getHandle<long>("rebuilt");
+    reconfig_count = reconfig_node.getHandle<long>("count");
+    last_request = reconfig_request.get();
+
     if ( ! build() ) {
 	printf("Detected an internal inconsistency in the autopilot\n");
 	printf("configuration.  See earlier errors for details.\n" );
@@ -49,10 +62,93 @@ void AuraAutopilot::init() {
 }
 
 
+void AuraAutopilot::clear() {
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+	delete stages[i].component;
+    }
+    stages.clear();
+}
+
+
 void AuraAutopilot::reinit() {
-    components.clear();
+    clear();
     init();
-    build();
+}
+
+
+// true if /config/autopilot still describes the running stages: the
+// same component sections with the same modules and property
+// bindings (only gains and limits may differ.)
+bool AuraAutopilot::same_structure() {
+    pyPropertyNode config_props = pyGetNode( "/config/autopilot", true );
+    vector <string> children = config_props.getChildren();
+    unsigned int components = 0;
+    for ( unsigned int i = 0; i < children.size(); i++ ) {
+	if ( children[i].compare(0, 9, "component") == 0 ) {
+	    components++;
+	}
+    }
+
+    unsigned int built = 0;
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+	if ( stages[i].config_path == "" ) {
+	    continue;
+	}
+	built++;
+	pyPropertyNode node = pyGetNode( stages[i].config_path, false );
+	if ( node.isNull() || node.getString("module") != stages[i].module
+	     || stages[i].component->config_bindings() != stages[i].bindings )
+	{
+	    return false;
+	}
+    }
+
+    return built == components;
+}
+
+
+// Apply changes to /config/autopilot without a rebuild when possible.
+// If the structure is unchanged each stage just rereads its gains and
+// limits, so integrators, filter histories and predictor state carry
+// on and the aircraft doesn't see a transient.  Otherwise everything
+// is rebuilt (reinit().)  This runs on the control thread between
+// frames so a frame always sees either the old or the new gains.
+void AuraAutopilot::reconfigure() {
+    double start = get_Time();
+
+    bool rebuild = ! same_structure();
+    int changed = 0;
+    if ( rebuild ) {
+	reinit();
+    } else {
+	for ( unsigned int i = 0; i < stages.size(); i++ ) {
+	    changed += stages[i].component->reconfigure();
+	}
+    }
+
+    double latency_ms = (get_Time() - start) * 1000.0;
+    reconfig_latency_ms.set( latency_ms );
+    reconfig_changed.set( changed );
+    reconfig_rebuilt.set( rebuild );
+    reconfig_count.set( reconfig_count.get() + 1 );
+
+    char message[128];
+    if ( rebuild ) {
+	snprintf( message, sizeof(message),
+		  "autopilot rebuilt in %.3f ms", latency_ms );
+    } else {
+	snprintf( message, sizeof(message),
+		  "autopilot reconfigured, %d values changed in %.3f ms",
+		  changed, latency_ms );
+    }
+    events->log( "control", message );
+}
+
+
+// ask for a reconfigure() at the start of the next frame (may be
+// called from any thread holding the property lock)
+void AuraAutopilot::request_reconfigure() {
+    reconfig_request.set( reconfig_request.get() + 1 );
 }
 
 
@@ -62,18 +158,96 @@ void AuraAutopilot::bind() {
 void AuraAutopilot::unbind() {
 }
 
+void AuraAutopilot::add_stage( APComponent *c, const string &name,
+			       const string &config_path,
+			       const string &module )
+{
+    ap_stage stage;
+    stage.component = c;
+    stage.name = name;
+    stage.config_path = config_path;
+    stage.module = module;
+    stage.bindings = c->config_bindings();
+    stages.push_back( stage );
+}
+
+
+// Order the stages so each one runs after every stage that writes a
+// property it reads.  Stages with no dependency between them keep
+// their config order so the result is deterministic.  Stages caught
+// in a dependency cycle can't be ordered, they are run in config
+// order (with a warning.)
+void AuraAutopilot::sort_stages() {
+    unsigned int n = stages.size();
+
+    // after[i] = stages that read something stage i writes
+    vector< vector<unsigned int> > after( n );
+    vector<int> pending( n, 0 );
+    for ( unsigned int i = 0; i < n; i++ ) {
+	const vector<string> &writes = stages[i].component->get_writes();
+	for ( unsigned int j = 0; j < n; j++ ) {
+	    if ( i == j ) {
+		continue;
+	    }
+	    const vector<string> &reads = stages[j].component->get_reads();
+	    bool depends = false;
+	    for ( unsigned int k = 0; k < writes.size() && !depends; k++ ) {
+		for ( unsigned int m = 0; m < reads.size(); m++ ) {
+		    if ( writes[k] == reads[m] ) {
+			depends = true;
+			break;
+		    }
+		}
+	    }
+	    if ( depends ) {
+		after[i].push_back( j );
+		pending[j]++;
+	    }
+	}
+    }
+
+    stage_list sorted;
+    vector<bool> done( n, false );
+    while ( sorted.size() < n ) {
+	// first stage (in config order) with all its inputs ready
+	int next = -1;
+	for ( unsigned int i = 0; i < n; i++ ) {
+	    if ( !done[i] && pending[i] == 0 ) {
+		next = i;
+		break;
+	    }
+	}
+	if ( next < 0 ) {
+	    for ( unsigned int i = 0; i < n; i++ ) {
+		if ( !done[i] ) {
+		    next = i;
+		    break;
+		}
+	    }
+	    printf("WARNING: ap stage %s is part of a dependency cycle\n",
+		   stages[next].name.c_str());
+	}
+	done[next] = true;
+	sorted.push_back( stages[next] );
+	for ( unsigned int i = 0; i < after[next].size(); i++ ) {
+	    pending[ after[next][i] ]--;
+	}
+    }
+    stages = sorted;
+}
+
+
 bool AuraAutopilot::build() {
     pyPropertyNode config_props = pyGetNode( "/config/autopilot", true );
 
-    // FIXME: we have always depended on the order of children
-    // components here to ensure PID stages are run in the correct
-    // order, however that is a bad thing to assume ... especially now
-    // with pyprops!!!
+    // Stages are created in config order, then sorted by their
+    // property dependencies (see sort_stages()) so the order of the
+    // config children no longer matters.
+    string L1_path = "/config/autopilot/L1_controller";
     vector <string> children = config_props.getChildren();
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	pyPropertyNode component = config_props.getChild(children[i].c_str(),
 							 true);
-        printf("ap stage: %s\n", children[i].c_str());
 	string name = children[i];
 	size_t pos = name.find("[");
 	if ( pos != string::npos ) {
@@ -83,38 +257,50 @@ bool AuraAutopilot::build() {
 	    ostringstream config_path;
 	    config_path << "/config/autopilot/" << children[i];
 	    string module = component.getString("module");
+	    string label = children[i] + " (" + component.getString("name")
+		+ ")";
+	    string path = config_path.str();
+	    APComponent *c = NULL;
 	    if ( module == "pid_vel_component" ) {
-		APComponent *c
-		    = new AuraPIDVel( config_path.str() );
-		components.push_back( c );
+		c = new AuraPIDVel( path );
 	    } else if ( module == "pid_component" ) {
-		APComponent *c
-		    = new AuraPID( config_path.str() );
-		components.push_back( c );
+		c = new AuraPID( path );
 	    } else if ( module == "predict_simple" ) {
-		APComponent *c
-		    = new AuraPredictor( config_path.str() );
-		components.push_back( c );
+		c = new AuraPredictor( path );
 	    } else if ( module == "filter" ) {
-		APComponent *c
-		    = new AuraDigitalFilter( config_path.str() );
-		components.push_back( c );
+		c = new AuraDigitalFilter( path );
 	    } else if ( module == "summer" ) {
-		APComponent *c
-		    = new AuraSummer( config_path.str() );
-		components.push_back( c );
+		c = new AuraSummer( path );
+	    }
+	    if ( c != NULL ) {
+		add_stage( c, label, path, module );
 	    } else {
 		printf("Unknown AP module name: %s\n", module.c_str());
 		return false;
 	    }
 	} else if ( name == "L1_controller" ) {
-	    // information placeholder, we don't do anything here.
+	    L1_path = "/config/autopilot/" + children[i];
         } else {
 	    printf("Unknown top level section: %s\n", children[i].c_str() );
             return false;
         }
     }
 
+    // route following and circle hold (each only active in its
+    // /navigation/mode, defaults are filled in if the config has no
+    // L1_controller section.)  They set the targets the pid stages
+    // work from.
+    ap_stage l1_stages[] = {
+	{ new AuraL1Route( L1_path ), "L1 route" },
+	{ new AuraL1Circle( L1_path ), "L1 circle" }
+    };
+    stages.insert( stages.begin(), l1_stages, l1_stages + 2 );
+
+    sort_stages();
+    for ( unsigned int i = 0; i < stages.size(); i++ ) {
+	printf("ap stage %d: %s\n", i, stages[i].name.c_str());
+    }
+
     return true;
 }
 
@@ -133,8 +319,15 @@ inline void SG_NORMALIZE_RANGE( T &val, const T min, const T max ) {
  */
 
 void AuraAutopilot::update( double dt ) {
-    for ( unsigned int i = 0; i < components.size(); ++i ) {
-        components[i]->update( dt );
+    // pending reconfiguration, applied before any stage runs
+    long request = reconfig_request.get();
+    if ( request != last_request ) {
+	last_request = request;
+	reconfigure();
+    }
+
+    for ( unsigned int i = 0; i < stages.size(); ++i ) {
+        stages[i].component->update( dt );
     }
 }
 
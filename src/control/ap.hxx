@@ -30,7 +30,9 @@
 
 #include "python/pyprops.hxx"
 
+#include <string>
 #include <vector>
+using std::string;
 using std::vector;
 
 #include "component.hxx"
@@ -45,11 +47,13 @@ class AuraAutopilot {
 
 public:
 
-    AuraAutopilot() {}
+    AuraAutopilot(): last_request(0) {}
     ~AuraAutopilot() {}
 
     void init();
     void reinit();
+    void reconfigure();
+    void request_reconfigure();
     void bind();
     void unbind();
     void update( double dt );
@@ -58,12 +62,36 @@ public:
 
 protected:
 
-    typedef vector<APComponent *> comp_list;
+    // one step of the compiled autopilot
+    struct ap_stage {
+	APComponent *component;
+	string name;		// config section (for messages)
+	string config_path;	// empty for the built in stages
+	string module;
+	string bindings;	// component->config_bindings() when built
+    };
+    typedef vector<ap_stage> stage_list;
 
 private:
 
     bool serviceable;
-    comp_list components;
+    stage_list stages;		// in execution order
+
+    // /autopilot/reconfig: writing a new request value asks for a
+    // reconfigure() at the start of the next frame
+    PropertyHandle<long> reconfig_request;
+    PropertyHandle<double> reconfig_latency_ms;
+    PropertyHandle<long> reconfig_changed;
+    PropertyHandle<long> reconfig_rebuilt;
+    PropertyHandle<long> reconfig_count;
+    long last_request;
+
+    void add_stage( APComponent *c, const string &name,
+		    const string &config_path = "",
+		    const string &module = "" );
+    void sort_stages();
+    void clear();
+    bool same_structure();
 };
 
 
@@ -0,0 +1,146 @@
+// component.cxx - autopilot component base class
+//
+// Copyright (C) 2004-2017  Curtis L. Olson  - curtolson@flightgear.org
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+
+#include "python/pyprops.hxx"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "component.hxx"
+
+
+string APCanonicalPath( const string &prop ) {
+    string result;
+    size_t pos = 0;
+    while ( pos < prop.length() ) {
+	size_t next = prop.find( "[0]", pos );
+	if ( next == string::npos ) {
+	    result += prop.substr( pos );
+	    break;
+	}
+	result += prop.substr( pos, next - pos );
+	pos = next + 3;
+    }
+    return result;
+}
+
+
+void APCondition::bind( const string &prop, const string &value ) {
+    this->value = value;
+    checked = false;
+    source = PropertyHandle<string>();
+    size_t pos = prop.rfind("/");
+    if ( pos != string::npos ) {
+	string path = prop.substr(0, pos);
+	string attr = prop.substr(pos+1);
+	source = pyGetNode( path, true ).getHandle<string>( attr.c_str() );
+    }
+}
+
+
+void APComponent::bind_enable() {
+    pyPropertyNode node = component_node.getChild("enable", true);
+    string enable_prop = node.getString("prop");
+    enable.bind( enable_prop, node.getString("value") );
+    honor_passive = node.getBool("honor_passive");
+    if ( enable_prop != "" ) {
+	reads.push_back( APCanonicalPath(enable_prop) );
+    }
+}
+
+
+PropertyHandle<double> APComponent::bind_input( const string &prop ) {
+    size_t pos = prop.rfind("/");
+    if ( pos == string::npos ) {
+	return PropertyHandle<double>();
+    }
+    string path = prop.substr(0, pos);
+    string attr = prop.substr(pos+1);
+    reads.push_back( APCanonicalPath(prop) );
+    return pyGetNode( path, true ).getHandle<double>( attr.c_str() );
+}
+
+
+// a constant reference "value" takes precedence over a "prop"
+void APComponent::bind_reference() {
+    pyPropertyNode node = component_node.getChild("reference", true);
+    string ref_value = node.getString("value");
+    if ( ref_value != "" ) {
+	ref_const = atof( ref_value.c_str() );
+    } else {
+	ref_h = bind_input( node.getString("prop") );
+    }
+}
+
+
+void APComponent::bind_outputs() {
+    pyPropertyNode node = component_node.getChild( "output", true );
+    vector <string> children = node.getChildren();
+    for ( unsigned int i = 0; i < children.size(); ++i ) {
+	if ( children[i].substr(0,4) == "prop" ) {
+	    string output_prop = node.getString(children[i].c_str());
+	    size_t pos = output_prop.rfind("/");
+	    if ( pos != string::npos ) {
+		string path = output_prop.substr(0, pos);
+		string attr = output_prop.substr(pos+1);
+		pyPropertyNode onode = pyGetNode( path, true );
+		output_h.push_back( onode.getHandle<double>(attr.c_str()) );
+		writes.push_back( APCanonicalPath(output_prop) );
+	    } else {
+		printf("WARNING: requested bad output path: %s\n",
+		       output_prop.c_str());
+	    }
+	} else {
+	    printf("WARNING: unknown tag in output section: %s\n",
+		   children[i].c_str());
+	}
+    }
+}
+
+
+int APComponent::load_value( pyPropertyNode &node, const char *name,
+			     double *val )
+{
+    double new_val = node.getDouble(name);
+    if ( new_val != *val ) {
+	*val = new_val;
+	return 1;
+    }
+    return 0;
+}
+
+
+string APComponent::config_bindings() {
+    static const char *sections[] = { "enable", "input", "reference",
+				      "output" };
+    string result;
+    for ( unsigned int i = 0; i < sizeof(sections) / sizeof(char *); i++ ) {
+	if ( ! component_node.hasChild(sections[i]) ) {
+	    continue;
+	}
+	pyPropertyNode node = component_node.getChild(sections[i]);
+	vector <string> children = node.getChildren();
+	for ( unsigned int j = 0; j < children.size(); j++ ) {
+	    result += string(sections[i]) + "/" + children[j] + "="
+		+ node.getString(children[j].c_str()) + "\n";
+	}
+    }
+    return result;
+}
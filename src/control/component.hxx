@@ -34,6 +34,45 @@
 using std::vector;
 using std::string;
 
+/**
+ * An enable condition ("prop == value") compiled at init time.  The
+ * string compare is only redone when the source property has been
+ * written since the last test(), otherwise the cached result is
+ * returned.
+ */
+
+class APCondition {
+
+public:
+
+    APCondition(): last_serial(0), checked(false), state(false) {}
+
+    // a prop without a "/" (e.g. empty) never tests true
+    void bind( const string &prop, const string &value );
+
+    inline bool test() {
+	if ( source.isNull() ) {
+	    return false;
+	}
+	unsigned int serial = source.serial();
+	if ( !checked || serial != last_serial ) {
+	    state = (source.get() == value);
+	    last_serial = serial;
+	    checked = true;
+	}
+	return state;
+    }
+
+private:
+
+    PropertyHandle<string> source;
+    string value;
+    unsigned int last_serial;
+    bool checked;
+    bool state;
+};
+
+
 /**
  * Base class for other autopilot components
  */
@@ -44,41 +83,73 @@ protected:
 
     pyPropertyNode component_node;
     
-    pyPropertyNode enable_node;
-    string enable_attr;
-    string enable_value;
+    APCondition enable;
     bool honor_passive;
     bool enabled;
 
-    pyPropertyNode input_node;
-    string input_attr;
-    
-    pyPropertyNode ref_node;
-    string ref_attr;
-    string ref_value;
-  
-    string r_n_prop;
-    string r_n_value;
+    PropertyHandle<double> input_h;
 
-    vector <pyPropertyNode> output_node;
-    vector <string> output_attr;
+    PropertyHandle<double> ref_h;	// null for a constant reference
+    double ref_const;
+  
+    vector< PropertyHandle<double> > output_h;
 
     pyPropertyNode config_node;
 
+    // the properties this component reads and writes (canonical
+    // paths), used to order the stages
+    vector <string> reads;
+    vector <string> writes;
+
+    // bind the standard config sections of component_node
+    void bind_enable();
+    void bind_reference();
+    void bind_outputs();
+
+    // resolve an absolute property path to a slot and record it as
+    // an input of this component.  A bad path gives a null handle.
+    PropertyHandle<double> bind_input( const string &prop );
+
+    // reference (set point) value
+    inline double reference() const {
+	return ref_h.isNull() ? ref_const : ref_h.get();
+    }
+
+    // copy node/name into *val, returns 1 if the value changed
+    int load_value( pyPropertyNode &node, const char *name, double *val );
+
 public:
 
     APComponent() :
-      enable_value( "" ),
       honor_passive( false ),
-      enabled( false )
+      enabled( false ),
+      ref_const( 0.0 )
     { }
 
     virtual ~APComponent() {}
 
     virtual void update (double dt)=0;
+
+    // Hot reconfiguration (see AuraAutopilot::reconfigure().)  Reread
+    // the gains and limits from the config, keeping the controller
+    // state, and return the number of values that changed.  The
+    // values are copies so a config only half written by another
+    // thread is never seen mid-frame.
+    virtual int reconfigure() { return 0; }
+
+    // the enable, input, reference and output sections as one string
+    // (if these change the component must be rebuilt)
+    string config_bindings();
     
     inline string get_name() { return component_node.getString("name"); }
+
+    inline const vector<string> &get_reads() const { return reads; }
+    inline const vector<string> &get_writes() const { return writes; }
 };
 
 
+// "/a/b[0]/c" and "/a/b/c" are the same property
+string APCanonicalPath( const string &prop );
+
+
 #endif // _AURA_AP_COMPONENT_HXX
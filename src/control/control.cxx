@@ -30,19 +30,19 @@
 
 #include "comms/display.hxx"
 #include "comms/logging.hxx"
+#include "comms/packet_id.hxx"
 #include "comms/remote_link.hxx"
 #include "include/globaldefs.h"
 #include "init/globals.hxx"
-#include "python/pymodule.hxx"
 
 #include "include/util.h"
 #include "ap.hxx"
+#include "targets_mailbox.hxx"
 
 #include "control.hxx"
 
 
 // global variables
-static pyModuleBase navigation;
 static AuraAutopilot ap;
 
 
@@ -53,13 +53,16 @@ static pyPropertyNode targets_node;
 static pyPropertyNode pointing_node;
 static pyPropertyNode pointing_vec_node;
 static pyPropertyNode orient_node;
-static pyPropertyNode remote_link_node;
 static pyPropertyNode logging_node;
 static pyPropertyNode task_node;
 static pyPropertyNode home_node;
 static pyPropertyNode comms_node;
 
-static int remote_link_skip = 0;
+// pre-resolved handles for control_update()
+static PropertyHandle<bool> ap_master_switch;
+static PropertyHandle<string> ap_mode;
+static PropertyHandle<long> comms_wp_counter;
+
 static int logging_skip = 0;
 
 static void bind_properties() {
@@ -69,11 +72,14 @@ static void bind_properties() {
     pointing_node = pyGetNode( "/pointing", true );
     pointing_vec_node = pyGetNode( "/pointing/vector", true );
     orient_node = pyGetNode( "/orientation", true );
-    remote_link_node = pyGetNode( "/config/remote_link", true );
     logging_node = pyGetNode( "/config/logging", true );
     task_node = pyGetNode( "/task", true );
     home_node = pyGetNode( "/task/home", true );
     comms_node = pyGetNode( "/comms/remote_link", true);
+
+    ap_master_switch = ap_node.getHandle<bool>("master_switch");
+    ap_mode = ap_node.getHandle<string>("mode");
+    comms_wp_counter = comms_node.getHandle<long>("wp_counter");
 }
 
 
@@ -83,12 +89,8 @@ void control_init() {
 
     bind_properties();
 
-    remote_link_skip = remote_link_node.getDouble("autopilot_skip");
     logging_skip = logging_node.getDouble("autopilot_skip");
 
-    // initialize the navigation module
-    navigation.init("control.navigation");
-    
     // initialize and build the autopilot controller from the property
     // tree config (/config/autopilot)
     ap.init();
@@ -100,35 +102,39 @@ void control_init() {
 
 
 void control_reinit() {
-    // reread autopilot configuration from the property tree and reset
-    // all stages (i.e. real time gain tuning)
+    // reread autopilot configuration from the property tree (i.e. real
+    // time gain tuning.)  Applied by the control thread at the start of
+    // its next frame, see AuraAutopilot::reconfigure()
 
-    ap.reinit();
+    ap.request_reconfigure();
 }
 
 
 void control_update(double dt)
 {
-    static int remote_link_count = 0;
     static int logging_count = 0;
 
+    // latest complete set of mission targets
+    targets_mailbox_apply();
+
     // log auto/manual mode changes
     static bool last_ap_mode = false;
-    if ( ap_node.getBool("master_switch") != last_ap_mode ) {
+    bool master_switch = ap_master_switch.get();
+    if ( master_switch != last_ap_mode ) {
 	string ap_master_str;
-	if ( ap_node.getBool("master_switch") ) {
+	if ( master_switch ) {
 	    ap_master_str = "autopilot";
 	} else {
 	    ap_master_str = "manual flight";
 	}
 	string message = "master switch = " + ap_master_str;
 	events->log( "control", message.c_str() );
-	last_ap_mode = ap_node.getBool("master_switch");
+	last_ap_mode = master_switch;
     }
     
     static string last_fcs_mode = "";
-    string fcs_mode = ap_node.getString("mode");
-    if ( ap_node.getBool("master_switch") ) {
+    string fcs_mode = ap_mode.get();
+    if ( master_switch ) {
 	if ( last_fcs_mode != fcs_mode ) {
 	    string message = "mode change = " + fcs_mode;
 	    events->log( "control", message.c_str() );
@@ -213,10 +219,8 @@ void control_update(double dt)
 	last_fcs_mode = "";
     }
 
-    // navigation update
-    navigation.update(dt);
-        
-    // update the autopilot stages (even in manual flight mode.)  This
+    // update the autopilot stages, navigation (route following or
+    // circle hold) first (even in manual flight mode.)  This
     // keeps the differential metric up to date, tracks manual inputs,
     // and keeps more continuity in the flight when the mode is
     // switched to autopilot.
@@ -227,11 +231,16 @@ void control_update(double dt)
     // and circle hold point (all indicated on the ground station map.)
     // FIXME !!!
 
-    bool send_remote_link = false;
-    if ( remote_link_count < 0 ) {
-	send_remote_link = true;
-	remote_link_count = remote_link_skip;
+    // The remote link keeps only the newest ap packet, so it is
+    // refreshed every frame but the waypoint counter (see below) only
+    // moves on once the packet carrying the current waypoint has
+    // actually gone out.  That way the route trickles down in order.
+    static bool wp_waiting = false;
+    if ( wp_waiting && ! remote_link->is_pending( AP_STATUS_PACKET_V5, 0 ) ) {
+	comms_wp_counter.set( comms_wp_counter.get() + 1 );
+	wp_waiting = false;
     }
+    bool send_remote_link = true;
 	
     bool send_logging = false;
     if ( logging_count < 0 ) {
@@ -246,10 +255,12 @@ void control_update(double dt)
 	if ( send_remote_link ) {
 	    remote_link->send_message( buf, pkt_size );
 	    // do the counter dance with the packer (packer will reset
-	    // the count to zero at the appropriate time.)
-	    int counter = comms_node.getLong("wp_counter");
-	    counter++;
-	    comms_node.setLong("wp_counter", counter);
+	    // the count to zero at the appropriate time.)  Without a
+	    // link the packet counts as sent right away.
+	    wp_waiting = remote_link->is_pending( AP_STATUS_PACKET_V5, 0 );
+	    if ( ! wp_waiting ) {
+		comms_wp_counter.set( comms_wp_counter.get() + 1 );
+	    }
 	}
 
 	if ( send_logging ) {
@@ -257,7 +268,6 @@ void control_update(double dt)
 	}
     }
     
-    remote_link_count--;
     logging_count--;
 }
 
@@ -23,94 +23,78 @@
 #include "dig_filter.hxx"
 
 
-AuraDigitalFilter::AuraDigitalFilter( string config_path )
+AuraDigitalFilter::AuraDigitalFilter( string config_path ):
+    Tf( 0.0 ),
+    samples( 1 ),
+    rateOfChange( 0.0 ),
+    filterType( exponential ),
+    debug( false )
 {
-    size_t pos;
-    samples = 1;
-
     component_node = pyGetNode(config_path, true);
 
-    // enable
-    pyPropertyNode node = component_node.getChild("enable", true);
-    string enable_prop = node.getString("prop");
-    enable_value = node.getString("value");
-    honor_passive = node.getBool("honor_passive");
-    pos = enable_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = enable_prop.substr(0, pos);
-	enable_attr = enable_prop.substr(pos+1);
-	enable_node = pyGetNode( path, true );
-    }
+    bind_enable();
 
     // input
-    node = component_node.getChild("input", true);
-    string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	input_node = pyGetNode( path, true );
-    }
+    pyPropertyNode node = component_node.getChild("input", true);
+    input_h = bind_input( node.getString("prop") );
+
+    bind_outputs();
+
+    reconfigure();
+    output.init(2, 0.0);
+    input.init(samples + 1, 0.0);
+}
 
+int AuraDigitalFilter::reconfigure() {
+    int changed = 0;
     if ( component_node.hasChild("type") ) {
+	filterTypes new_type = filterType;
 	string cval = component_node.getString("type");
 	if ( cval == "exponential" ) {
-	    filterType = exponential;
+	    new_type = exponential;
 	} else if (cval == "double-exponential") {
-	    filterType = doubleExponential;
+	    new_type = doubleExponential;
 	} else if (cval == "moving-average") {
-	    filterType = movingAverage;
+	    new_type = movingAverage;
 	} else if (cval == "noise-spike") {
-	    filterType = noiseSpike;
+	    new_type = noiseSpike;
+	}
+	if ( new_type != filterType ) {
+	    filterType = new_type;
+	    changed++;
 	}
     }
     if ( component_node.hasChild("filter_time") ) {
-	Tf = component_node.getDouble("filter_time");
+	changed += load_value( component_node, "filter_time", &Tf );
     }
     if ( component_node.hasChild("samples") ) {
-	samples = component_node.getLong("samples");
-    }
-    if ( component_node.hasChild("max_rate_of_change") ) {
-	rateOfChange = component_node.getDouble("max_rate_of_change");
-    }
-
-    // output
-    node = component_node.getChild( "output", true );
-    vector <string> children = node.getChildren();
-    for ( unsigned int i = 0; i < children.size(); ++i ) {
-	if ( children[i].substr(0,4) == "prop" ) {
-	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
-	    } else {
-		printf("WARNING: requested bad output path: %s\n",
-		       output_prop.c_str());
+	long val = component_node.getLong("samples");
+	if ( val < 1 ) {
+	    printf("WARNING: filter samples must be >= 1 (%ld)\n", val);
+	    val = 1;
+	}
+	if ( (unsigned int)val != samples ) {
+	    samples = val;
+	    changed++;
+	    if ( input.capacity() > 0 ) {
+		// new window, fill it with the current output so the
+		// moving average carries on from where it is
+		input.init( samples + 1, output[0] );
 	    }
-	} else {
-	    printf("WARNING: unknown tag in output section: %s\n",
-		   children[i].c_str());
 	}
     }
-
-    output.resize(2, 0.0);
-    input.resize(samples + 1, 0.0);
+    if ( component_node.hasChild("max_rate_of_change") ) {
+	changed += load_value( component_node, "max_rate_of_change",
+			       &rateOfChange );
+    }
+    return changed;
 }
 
 void AuraDigitalFilter::update(double dt)
 {
-    if (!enable_node.isNull() && enable_node.getString(enable_attr.c_str()) == enable_value) {
-	enabled = true;
-    } else {
-	enabled = false;
-    }
+    enabled = enable.test();
 
-    input.push_front( input_node.getDouble(input_attr.c_str()) );
-    input.resize(samples + 1, 0.0);
+    input.push( input_h.get() );
 
     if ( enabled && dt > 0.0 ) {
         /*
@@ -123,32 +107,22 @@ void AuraDigitalFilter::update(double dt)
         if (filterType == exponential)
         {
             double alpha = 1 / ((Tf/dt) + 1);
-            output.push_front(alpha * input[0] + 
-                              (1 - alpha) * output[0]);
-	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-            output.resize(1);
+            output.push(alpha * input[0] + 
+                        (1 - alpha) * output[0]);
         } 
         else if (filterType == doubleExponential)
         {
             double alpha = 1 / ((Tf/dt) + 1);
-            output.push_front(alpha * alpha * input[0] + 
-                              2 * (1 - alpha) * output[0] -
-                              (1 - alpha) * (1 - alpha) * output[1]);
- 	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-            output.resize(2);
+            output.push(alpha * alpha * input[0] + 
+                        2 * (1 - alpha) * output[0] -
+                        (1 - alpha) * (1 - alpha) * output[1]);
         }
         else if (filterType == movingAverage)
         {
-            output.push_front(output[0] + 
-                              (input[0] - input.back()) / samples);
- 	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-            output.resize(1);
+            // running sum: add the newest sample, drop the one that
+            // just left the window
+            output.push(output[0] + 
+                        (input[0] - input.oldest()) / samples);
         }
         else if (filterType == noiseSpike)
         {
@@ -156,22 +130,21 @@ void AuraDigitalFilter::update(double dt)
 
             if ((output[0] - input[0]) > maxChange)
             {
-                output.push_front(output[0] - maxChange);
+                output.push(output[0] - maxChange);
             }
             else if ((output[0] - input[0]) < -maxChange)
             {
-                output.push_front(output[0] + maxChange);
+                output.push(output[0] + maxChange);
             }
             else if (fabs(input[0] - output[0]) <= maxChange)
             {
-                output.push_front(input[0]);
+                output.push(input[0]);
             }
-
- 	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output[0] );
-	    }
-	    output.resize(1);
         }
+
+	for ( unsigned int i = 0; i < output_h.size(); i++ ) {
+	    output_h[i].set( output[0] );
+	}
         if ( component_node.getBool("debug") ) {
             printf("input: %.3f\toutput: %.3f\n", input[0], output[0]);
         }
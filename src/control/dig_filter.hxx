@@ -18,10 +18,10 @@
 //
 
 #include <string>
-#include <deque>
 
 using std::string;
-using std::deque;
+
+#include "util/ring_buffer.hxx"
 
 #include "component.hxx"
 
@@ -36,6 +36,9 @@ using std::deque;
  *
  * All these filters are low-pass filters.
  *
+ * The input and output histories are fixed size ring buffers set up
+ * by the constructor, update() does not allocate.
+ *
  */
 
 class AuraDigitalFilter : public APComponent
@@ -44,8 +47,8 @@ private:
     double Tf;            // Filter time [s]
     unsigned int samples; // Number of input samples to average
     double rateOfChange;  // The maximum allowable rate of change [1/s]
-    deque <double> output;
-    deque <double> input;
+    RingBuffer<double> output;	// last 2 outputs
+    RingBuffer<double> input;	// last samples + 1 inputs
     enum filterTypes { exponential, doubleExponential, movingAverage, noiseSpike };
     filterTypes filterType;
 
@@ -56,4 +59,5 @@ public:
     ~AuraDigitalFilter() {}
 
     void update(double dt);
+    int reconfigure();
 };
@@ -0,0 +1,164 @@
+// filter_test.cxx - check that the filter components don't allocate
+// once they are set up
+//
+// Builds one AuraDigitalFilter of each type, an AuraPredictor, a
+// LowPassFilter and a LinearFitFilter, then runs them for a while
+// with operator new replaced by a counting version.  Any allocation
+// inside the update() calls is an error.  The moving average and
+// noise spike outputs are also checked against a direct computation.
+//
+// usage: filter_test
+//
+// This code is released into the public domain.
+
+#include "python/pyprops.hxx"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <new>
+#include <string>
+using std::string;
+
+#include "util/linearfit.hxx"
+#include "util/lowpass.hxx"
+
+#include "dig_filter.hxx"
+#include "predictor.hxx"
+
+
+static bool counting = false;
+static unsigned long allocations = 0;
+
+void *operator new( size_t size ) {
+    if ( counting ) {
+	allocations++;
+    }
+    void *p = malloc( size > 0 ? size : 1 );
+    if ( p == NULL ) {
+	throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[]( size_t size ) {
+    return operator new( size );
+}
+
+void operator delete( void *p ) noexcept {
+    free( p );
+}
+
+void operator delete[]( void *p ) noexcept {
+    free( p );
+}
+
+void operator delete( void *p, size_t size ) noexcept {
+    free( p );
+}
+
+void operator delete[]( void *p, size_t size ) noexcept {
+    free( p );
+}
+
+
+static const char *base = "/filter_test";
+static const int samples = 7;
+
+static string config_filter( const char *name, const char *type ) {
+    string path = string(base) + "/" + name;
+    pyPropertyNode node = pyGetNode( path, true );
+    node.setString( "type", type );
+    node.setDouble( "filter_time", 0.5 );
+    node.setLong( "samples", samples );
+    node.setDouble( "max_rate_of_change", 2.0 );
+    node.setDouble( "seconds", 1.0 );
+    node.setDouble( "filter_gain", 0.25 );
+    pyPropertyNode enable = node.getChild( "enable", true );
+    enable.setString( "prop", string(base) + "/enable" );
+    enable.setString( "value", "on" );
+    node.getChild( "input", true ).setString( "prop", string(base) + "/input" );
+    node.getChild( "output", true ).setString( "prop", string(base) + "/" + name + "_out" );
+    return path;
+}
+
+int main( int argc, char **argv ) {
+    pyPropsInit();
+
+    pyPropertyNode test_node = pyGetNode( base, true );
+    test_node.setString( "enable", "on" );
+    test_node.setDouble( "input", 0.0 );
+
+    AuraDigitalFilter exp_filt( config_filter("exp", "exponential") );
+    AuraDigitalFilter dexp_filt( config_filter("dexp", "double-exponential") );
+    AuraDigitalFilter avg_filt( config_filter("avg", "moving-average") );
+    AuraDigitalFilter spike_filt( config_filter("spike", "noise-spike") );
+    AuraPredictor predictor( config_filter("predict", "") );
+    LowPassFilter lowpass( 0.5 );
+    LinearFitFilter linearfit( 20.0 );
+
+    PropertyHandle<double> input_h = test_node.getHandle<double>( "input" );
+    PropertyHandle<double> avg_h = test_node.getHandle<double>( "avg_out" );
+    PropertyHandle<double> spike_h = test_node.getHandle<double>( "spike_out" );
+
+    const int steps = 20000;
+    const double dt = 0.01;
+    double history[samples];
+    for ( int i = 0; i < samples; i++ ) {
+	history[i] = 0.0;
+    }
+    double last_spike = 0.0;
+    int errors = 0;
+
+    counting = true;
+    for ( int i = 0; i < steps; i++ ) {
+	// a wobbly signal with the odd spike
+	double t = i * dt;
+	double x = sin( t ) + 0.1 * sin( 7.3 * t );
+	if ( i % 500 == 250 ) {
+	    x += 5.0;
+	}
+	input_h.set( x );
+
+	exp_filt.update( dt );
+	dexp_filt.update( dt );
+	avg_filt.update( dt );
+	spike_filt.update( dt );
+	predictor.update( dt );
+	lowpass.update( x, dt );
+	linearfit.update( t, x, dt );
+
+	// reference moving average and rate limit (kept outside the
+	// filters so they don't disturb the allocation count)
+	history[i % samples] = x;
+	if ( i >= samples ) {
+	    double sum = 0.0;
+	    for ( int j = 0; j < samples; j++ ) {
+		sum += history[j];
+	    }
+	    if ( fabs(avg_h.get() - sum / samples) > 1e-9 ) {
+		if ( errors++ < 10 ) {
+		    printf("moving average %d: %.12f expected %.12f\n",
+			   i, avg_h.get(), sum / samples);
+		}
+	    }
+	}
+	double spike = spike_h.get();
+	if ( fabs(spike - last_spike) > 2.0 * dt + 1e-12 ) {
+	    if ( errors++ < 10 ) {
+		printf("noise spike %d: changed by %.6f\n", i,
+		       spike - last_spike);
+	    }
+	}
+	last_spike = spike;
+    }
+    counting = false;
+
+    printf("%d steps, %lu allocations, %d errors\n", steps, allocations,
+	   errors);
+    if ( allocations > 0 || errors > 0 ) {
+	return 1;
+    }
+    return 0;
+}
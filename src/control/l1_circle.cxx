@@ -0,0 +1,182 @@
+//
+// l1_circle.cxx - L1 circle hold (/navigation/mode == "circle")
+//
+// This code is released into the public domain.
+//
+
+#include "python/pyprops.hxx"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "math/SGMath.hxx"
+#include "math/SGGeodesy.hxx"
+
+#include "l1_circle.hxx"
+
+
+static const double d2r = M_PI / 180.0;
+static const double r2d = 180.0 / M_PI;
+static const double gravity = 9.81;	// m/sec^2
+
+
+AuraL1Circle::AuraL1Circle( string config_path ):
+    valid( false ),
+    last_lon( 0.0 ),
+    last_lat( 0.0 ),
+    last_center_lon( 0.0 ),
+    last_center_lat( 0.0 ),
+    course_deg( 0.0 ),
+    dist_m( 0.0 )
+{
+    component_node = pyGetNode(config_path, true);
+
+    // sanity check, set some conservative values if none are
+    // provided in the autopilot config
+    if ( component_node.getDouble("bank_limit_deg") < 0.1 ) {
+	component_node.setDouble("bank_limit_deg", 25.0);
+    }
+    if ( component_node.getDouble("period") < 0.1 ) {
+	component_node.setDouble("period", 25.0);
+    }
+    bank_limit_h = component_node.getHandle<double>("bank_limit_deg");
+    period_h = component_node.getHandle<double>("period");
+
+    nav_mode_h = pyGetNode("/navigation", true).getHandle<string>("mode");
+
+    pyPropertyNode circle_node = pyGetNode("/task/circle", true);
+    direction_h = circle_node.getHandle<string>("direction");
+    center_lon_h = circle_node.getHandle<double>("longitude_deg");
+    center_lat_h = circle_node.getHandle<double>("latitude_deg");
+    radius_h = circle_node.getHandle<double>("radius_m");
+
+    pyPropertyNode route_node = pyGetNode("/task/route", true);
+    wp_dist_h = route_node.getHandle<double>("wp_dist_m");
+    wp_eta_h = route_node.getHandle<double>("wp_eta_sec");
+
+    pyPropertyNode pos_node = pyGetNode("/position", true);
+    lon_h = pos_node.getHandle<double>("longitude_deg");
+    lat_h = pos_node.getHandle<double>("latitude_deg");
+    gs_h = pyGetNode("/velocity", true).getHandle<double>("groundspeed_ms");
+    track_h = pyGetNode("/orientation", true).getHandle<double>("groundtrack_deg");
+
+    pyPropertyNode targets_node = pyGetNode("/autopilot/targets", true);
+    target_track_h = targets_node.getHandle<double>("groundtrack_deg");
+    course_error_h = targets_node.getHandle<double>("course_error_deg");
+    target_roll_h = targets_node.getHandle<double>("roll_deg");
+
+    // the targets this stage sets (for the stage ordering)
+    writes.push_back("/autopilot/targets/groundtrack_deg");
+    writes.push_back("/autopilot/targets/course_error_deg");
+    writes.push_back("/autopilot/targets/roll_deg");
+}
+
+
+void AuraL1Circle::update( double dt ) {
+    if ( nav_mode_h.get() != "circle" ) {
+	return;
+    }
+
+    double direction = 1.0;
+    if ( direction_h.get() == "right" ) {
+	direction = -1.0;
+    }
+
+    if ( !lon_h.isSet() || !lat_h.isSet() ) {
+	// no valid current position, bail out.
+	return;
+    }
+    double pos_lon = lon_h.get();
+    double pos_lat = lat_h.get();
+
+    if ( !center_lon_h.isSet() || !center_lat_h.isSet() ) {
+	// we have a valid position, but no valid circle center, use
+	// current position.  (sanity fallback)
+	center_lon_h.set( pos_lon );
+	center_lat_h.set( pos_lat );
+    }
+    double center_lon = center_lon_h.get();
+    double center_lat = center_lat_h.get();
+
+    // course and distance to center of target circle
+    if ( !valid || pos_lon != last_lon || pos_lat != last_lat
+	 || center_lon != last_center_lon || center_lat != last_center_lat )
+    {
+	double course2;
+	SGGeodesy::inverse( SGGeod::fromDeg(pos_lon, pos_lat),
+			    SGGeod::fromDeg(center_lon, center_lat),
+			    course_deg, course2, dist_m );
+	last_lon = pos_lon;
+	last_lat = pos_lat;
+	last_center_lon = center_lon;
+	last_center_lat = center_lat;
+	valid = true;
+    }
+
+    // ideal ground course to be on the circle perimeter if at ideal
+    // radius
+    double ideal_crs = course_deg + direction * 90.0;
+    if ( ideal_crs > 360.0 ) { ideal_crs -= 360.0; }
+    if ( ideal_crs < 0.0 ) { ideal_crs += 360.0; }
+
+    // (in)sanity check
+    double radius_m = 100.0;
+    if ( radius_h.isSet() ) {
+	radius_m = radius_h.get();
+	if ( radius_m < 50.0 ) { radius_m = 50.0; }
+    }
+
+    // target ground course based on our actual radius distance
+    double target_crs = ideal_crs;
+    if ( dist_m < radius_m ) {
+	// inside circle, adjust target heading to expand our circling
+	// radius
+	target_crs += direction * 90.0 * (1.0 - dist_m / radius_m);
+    } else if ( dist_m > radius_m ) {
+	// outside circle, adjust target heading to tighten our
+	// circling radius
+	double offset_dist = dist_m - radius_m;
+	if ( offset_dist > radius_m ) { offset_dist = radius_m; }
+	target_crs -= direction * 90.0 * offset_dist / radius_m;
+    }
+    if ( target_crs > 360.0 ) { target_crs -= 360.0; }
+    if ( target_crs < 0.0 ) { target_crs += 360.0; }
+    target_track_h.set( target_crs );
+
+    // L1 'mathematical' response to error
+    double L1_period = period_h.get();
+    double gs_mps = gs_h.get();
+    double omegaA = M_SQRT2 * M_PI / L1_period;
+    double VomegaA = gs_mps * omegaA;
+    double course_error = track_h.get() - target_crs;
+    if ( course_error < -180.0 ) { course_error += 360.0; }
+    if ( course_error > 180.0 ) { course_error -= 360.0; }
+    course_error_h.set( course_error );
+
+    // lateral acceleration needed to compensate for heading error
+    double accel = 2.0 * sin(course_error * d2r) * VomegaA;
+
+    // circling acceleration needed for our current distance from
+    // center
+    double turn_accel = 0.0;
+    if ( dist_m > 0.1 ) {
+	turn_accel = direction * gs_mps * gs_mps / dist_m;
+    }
+
+    double target_bank_deg = -atan( (accel + turn_accel) / gravity ) * r2d;
+    double bank_limit_deg = bank_limit_h.get();
+    if ( target_bank_deg < -bank_limit_deg ) {
+	target_bank_deg = -bank_limit_deg;
+    }
+    if ( target_bank_deg > bank_limit_deg ) {
+	target_bank_deg = bank_limit_deg;
+    }
+    target_roll_h.set( target_bank_deg );
+
+    wp_dist_h.set( dist_m );
+    if ( gs_mps > 0.1 ) {
+	wp_eta_h.set( dist_m / gs_mps );
+    } else {
+	wp_eta_h.set( 0.0 );
+    }
+}
@@ -0,0 +1,50 @@
+//
+// l1_circle.hxx - L1 circle hold (/navigation/mode == "circle")
+//
+// Orbit /task/circle (longitude_deg, latitude_deg, radius_m,
+// direction) using the L1 period and bank limit of the route
+// follower.  The course and distance to the center are only
+// recomputed when the aircraft or the center moved.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_L1_CIRCLE_HXX
+#define _AURA_L1_CIRCLE_HXX
+
+
+#include <string>
+using std::string;
+
+#include "component.hxx"
+
+
+class AuraL1Circle : public APComponent {
+
+private:
+
+    // course/distance to center cache
+    bool valid;
+    double last_lon, last_lat;
+    double last_center_lon, last_center_lat;
+    double course_deg;
+    double dist_m;
+
+    PropertyHandle<string> nav_mode_h;
+    PropertyHandle<string> direction_h;
+    PropertyHandle<double> center_lon_h, center_lat_h, radius_h;
+    PropertyHandle<double> wp_dist_h, wp_eta_h;
+    PropertyHandle<double> bank_limit_h, period_h;
+    PropertyHandle<double> lon_h, lat_h, gs_h, track_h;
+    PropertyHandle<double> target_track_h, course_error_h, target_roll_h;
+
+public:
+
+    AuraL1Circle( string config_path );
+    ~AuraL1Circle() {}
+
+    void update( double dt );
+};
+
+
+#endif // _AURA_L1_CIRCLE_HXX
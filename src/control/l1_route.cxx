@@ -0,0 +1,310 @@
+//
+// l1_route.cxx - L1 route following (/navigation/mode == "route")
+//
+// This code is released into the public domain.
+//
+
+#include "python/pyprops.hxx"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "math/SGMath.hxx"
+#include "math/SGGeodesy.hxx"
+
+#include "l1_route.hxx"
+
+
+static const double d2r = M_PI / 180.0;
+static const double r2d = 180.0 / M_PI;
+static const double gravity = 9.81;	// m/sec^2
+
+// distance to a waypoint that counts as reaching it
+static const double acquire_dist_m = 50.0;
+
+
+AuraL1Route::AuraL1Route( string config_path ):
+    serial( -1 ),
+    route_id( -1 ),
+    current_wp( 0 ),
+    acquired( false ),
+    last_lon( 0.0 ),
+    last_lat( 0.0 ),
+    last_wp( -1 ),
+    direct_course( 0.0 ),
+    direct_dist( 0.0 )
+{
+    component_node = pyGetNode(config_path, true);
+
+    // sanity check, set some conservative values if none are
+    // provided in the autopilot config
+    if ( component_node.getDouble("bank_limit_deg") < 0.1 ) {
+	component_node.setDouble("bank_limit_deg", 25.0);
+    }
+    if ( component_node.getDouble("period") < 0.1 ) {
+	component_node.setDouble("period", 25.0);
+    }
+    if ( component_node.getDouble("damping") < 0.1 ) {
+	component_node.setDouble("damping", 0.7);
+    }
+    bank_limit_h = component_node.getHandle<double>("bank_limit_deg");
+    period_h = component_node.getHandle<double>("period");
+    damping_h = component_node.getHandle<double>("damping");
+
+    nav_mode_h = pyGetNode("/navigation", true).getHandle<string>("mode");
+
+    pyPropertyNode route_node = pyGetNode("/task/route", true);
+    follow_mode_h = route_node.getHandle<string>("follow_mode");
+    start_mode_h = route_node.getHandle<string>("start_mode");
+    completion_mode_h = route_node.getHandle<string>("completion_mode");
+    xtrack_h = route_node.getHandle<double>("xtrack_dist_m");
+    projected_h = route_node.getHandle<double>("projected_dist_m");
+    dist_remaining_h = route_node.getHandle<double>("dist_remaining_m");
+    wp_dist_h = route_node.getHandle<double>("wp_dist_m");
+    wp_eta_h = route_node.getHandle<double>("wp_eta_sec");
+    route_size_h = route_node.getHandle<long>("route_size");
+    target_idx_h = route_node.getHandle<long>("target_waypoint_idx");
+    follow_serial_h = route_node.getHandle<long>("follow_serial");
+
+    active_node = pyGetNode("/task/route/active", true);
+    serial_h = active_node.getHandle<long>("serial");
+    route_id_h = active_node.getHandle<long>("route_id");
+
+    pyPropertyNode pos_node = pyGetNode("/position", true);
+    lon_h = pos_node.getHandle<double>("longitude_deg");
+    lat_h = pos_node.getHandle<double>("latitude_deg");
+    gs_h = pyGetNode("/velocity", true).getHandle<double>("groundspeed_ms");
+    track_h = pyGetNode("/orientation", true).getHandle<double>("groundtrack_deg");
+    gps_age_h = pyGetNode("/sensors/gps", true).getHandle<double>("data_age");
+
+    pyPropertyNode targets_node = pyGetNode("/autopilot/targets", true);
+    target_track_h = targets_node.getHandle<double>("groundtrack_deg");
+    course_error_h = targets_node.getHandle<double>("course_error_deg");
+    target_roll_h = targets_node.getHandle<double>("roll_deg");
+
+    // the targets this stage sets (for the stage ordering)
+    writes.push_back("/autopilot/targets/groundtrack_deg");
+    writes.push_back("/autopilot/targets/course_error_deg");
+    writes.push_back("/autopilot/targets/roll_deg");
+}
+
+
+// copy the published route and precompute the leg geometry.  A new
+// route_id means a new route (start over at the first waypoint),
+// otherwise the same route was just repositioned.
+void AuraL1Route::load_route() {
+    serial = serial_h.get();
+    long id = route_id_h.get();
+    if ( id != route_id ) {
+	route_id = id;
+	current_wp = 0;
+    }
+
+    int size = active_node.getLong("route_size");
+    route.resize( size );
+    for ( int i = 0; i < size; i++ ) {
+	pyPropertyNode wp_node = active_node.getChild("wpt", i, true);
+	route[i].lon_deg = wp_node.getDouble("longitude_deg");
+	route[i].lat_deg = wp_node.getDouble("latitude_deg");
+    }
+
+    // all the legs in one batch (the leg into wpt 0 starts from the
+    // last waypoint)
+    vector<double> lat1(size), lon1(size), lat2(size), lon2(size);
+    vector<double> course1(size), course2(size), dist(size);
+    for ( int i = 0; i < size; i++ ) {
+	const leg &prev = route[ i > 0 ? i - 1 : size - 1 ];
+	lat1[i] = prev.lat_deg;
+	lon1[i] = prev.lon_deg;
+	lat2[i] = route[i].lat_deg;
+	lon2[i] = route[i].lon_deg;
+    }
+    if ( size > 0 ) {
+	SGGeodesy::inverseBatch( size, &lat1[0], &lon1[0], &lat2[0], &lon2[0],
+				 &course1[0], &course2[0], &dist[0] );
+    }
+    for ( int i = 0; i < size; i++ ) {
+	route[i].course_deg = course1[i];
+	route[i].dist_m = (i < size - 1) ? dist[i + 1] : 0.0;
+    }
+    double sum = 0.0;
+    for ( int i = size - 1; i >= 0; i-- ) {
+	sum += route[i].dist_m;
+	route[i].remaining_m = sum;
+    }
+
+    if ( current_wp >= size ) {
+	current_wp = 0;
+    }
+    last_wp = -1;
+    follow_serial_h.set( serial );
+}
+
+
+void AuraL1Route::update_direct( double lon, double lat ) {
+    if ( current_wp == last_wp && lon == last_lon && lat == last_lat ) {
+	return;
+    }
+    const leg &wp = route[current_wp];
+    double course2;
+    SGGeodesy::inverse( SGGeod::fromDeg(lon, lat),
+			SGGeod::fromDeg(wp.lon_deg, wp.lat_deg),
+			direct_course, course2, direct_dist );
+    last_lon = lon;
+    last_lat = lat;
+    last_wp = current_wp;
+}
+
+
+void AuraL1Route::update( double dt ) {
+    if ( nav_mode_h.get() != "route" ) {
+	return;
+    }
+
+    if ( serial_h.get() != serial ) {
+	load_route();
+    }
+
+    int size = route.size();
+    route_size_h.set( size );
+
+    double wp_dist = 0.0;
+
+    // track current waypoint of route (only!) if we have recent gps
+    // data
+    if ( size > 0 && gps_age_h.get() < 10.0 ) {
+	// route start up logic: if start_mode == first_wpt then there
+	// is nothing to do, we simply continue to track wpt 0 if that
+	// is the current waypoint.  If start_mode == first_leg, then
+	// if we are tracking wpt 0, increment it so we track the 2nd
+	// waypoint along the first leg.  If only a 1 point route is
+	// given along with first_leg startup behavior, then don't do
+	// that again, force some sort of sane route parameters
+	// instead!
+	if ( current_wp == 0 && start_mode_h.get() == "first_leg" ) {
+	    if ( size > 1 ) {
+		current_wp++;
+	    } else {
+		start_mode_h.set( "first_wpt" );
+		follow_mode_h.set( "direct" );
+	    }
+	}
+
+	double L1_period = period_h.get();
+	double L1_damping = damping_h.get();
+	double gs_mps = gs_h.get();
+
+	update_direct( lon_h.get(), lat_h.get() );
+	wp_dist = direct_dist;
+
+	// difference between ideal (leg) course and direct course
+	double angle = route[current_wp].course_deg - direct_course;
+	if ( angle < -180.0 ) { angle += 360.0; }
+	else if ( angle > 180.0 ) { angle -= 360.0; }
+
+	// cross-track error
+	double xtrack_m = sin(angle * d2r) * direct_dist;
+	double dist_m = cos(angle * d2r) * direct_dist;
+	xtrack_h.set( xtrack_m );
+	projected_h.set( dist_m );
+
+	// default distance for waypoint acquisition = direct distance
+	// to the target waypoint.  Leg following replaces it with the
+	// distance remaining along the leg.
+	double nav_course = 0.0;
+	double nav_dist_m = direct_dist;
+
+	string follow_mode = follow_mode_h.get();
+	if ( follow_mode == "direct" ) {
+	    nav_course = direct_course;
+	} else if ( follow_mode == "leader" ) {
+	    double L1_dist = (1.0 / M_PI) * L1_damping * L1_period * gs_mps;
+	    double wangle = 0.0;
+	    if ( L1_dist < 0.01 ) {
+		// ground speed <= 0.0 (problem?!?)
+		nav_course = direct_course;
+	    } else if ( L1_dist <= fabs(xtrack_m) ) {
+		// beyond L1 distance, steer as directly toward leg as
+		// allowed
+		wangle = 0.0;
+	    } else {
+		// steer towards imaginary point projected onto the
+		// route leg L1_distance ahead of us
+		wangle = acos(fabs(xtrack_m) / L1_dist) * r2d;
+	    }
+	    if ( wangle < 30.0 ) {
+		wangle = 30.0;
+	    }
+	    if ( xtrack_m > 0.0 ) {
+		nav_course = direct_course + angle - 90.0 + wangle;
+	    } else {
+		nav_course = direct_course + angle + 90.0 - wangle;
+	    }
+	    if ( acquired ) {
+		nav_dist_m = dist_m;
+	    } else {
+		// direct to first waypoint until we've acquired this
+		// route
+		nav_course = direct_course;
+		nav_dist_m = direct_dist;
+	    }
+	}
+	// (the xtrack_direct_hdg and xtrack_leg_hdg modes are
+	// deprecated, see route_mgr.cxx in the historical archives)
+
+	if ( nav_course < 0.0 ) { nav_course += 360.0; }
+	if ( nav_course > 360.0 ) { nav_course -= 360.0; }
+	target_track_h.set( nav_course );
+
+	// target bank angle
+	double omegaA = M_SQRT2 * M_PI / L1_period;
+	double VomegaA = gs_mps * omegaA;
+	double course_error = track_h.get() - nav_course;
+	if ( course_error < -180.0 ) { course_error += 360.0; }
+	if ( course_error > 180.0 ) { course_error -= 360.0; }
+	course_error_h.set( course_error );
+
+	double accel = 2.0 * sin(course_error * d2r) * VomegaA;
+	double target_bank_deg = -atan( accel / gravity ) * r2d;
+	double bank_limit_deg = bank_limit_h.get();
+	if ( target_bank_deg < -bank_limit_deg ) {
+	    target_bank_deg = -bank_limit_deg;
+	}
+	if ( target_bank_deg > bank_limit_deg ) {
+	    target_bank_deg = bank_limit_deg;
+	}
+	target_roll_h.set( target_bank_deg );
+
+	// estimate distance remaining to completion of route
+	dist_remaining_h.set( nav_dist_m + route[current_wp].remaining_m );
+
+	// mark completion of leg and move to next leg
+	string completion_mode = completion_mode_h.get();
+	if ( nav_dist_m < acquire_dist_m ) {
+	    if ( completion_mode == "loop" ) {
+		acquired = true;
+		current_wp = (current_wp < size - 1) ? current_wp + 1 : 0;
+	    } else if ( completion_mode == "circle_last_wpt"
+			|| completion_mode == "extend_last_leg" ) {
+		// FIXME: circle_last_wpt should switch to circle mode
+		// around the last waypoint, for now both follow the
+		// last leg forever
+		acquired = true;
+		if ( current_wp < size - 1 ) {
+		    current_wp++;
+		}
+	    }
+	}
+
+	// publish current target waypoint
+	target_idx_h.set( current_wp );
+    }
+
+    wp_dist_h.set( wp_dist );
+    double gs_mps = gs_h.get();
+    if ( gs_mps > 0.1 ) {
+	wp_eta_h.set( wp_dist / gs_mps );
+    } else {
+	wp_eta_h.set( 0.0 );
+    }
+}
@@ -0,0 +1,78 @@
+//
+// l1_route.hxx - L1 route following (/navigation/mode == "route")
+//
+// The route itself is built on the python side (control/route.py:
+// route requests, relative waypoints, swapping) and published to
+// /task/route/active as wpt[i]/longitude_deg, wpt[i]/latitude_deg,
+// route_size and a serial number that is bumped last.  When the
+// serial changes the route is copied here and the leg courses,
+// lengths and the distance remaining after each waypoint are
+// computed once.  Per frame only the direct course/distance to the
+// target waypoint is recomputed, and only when the aircraft (or the
+// target waypoint) moved.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_L1_ROUTE_HXX
+#define _AURA_L1_ROUTE_HXX
+
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "component.hxx"
+
+
+class AuraL1Route : public APComponent {
+
+private:
+
+    struct leg {
+	double lon_deg;
+	double lat_deg;
+	double course_deg;	// course from the previous waypoint
+	double dist_m;		// length of the leg to the next waypoint
+	double remaining_m;	// sum of the legs from here to the end
+    };
+
+    vector<leg> route;
+    long serial;		// of the loaded route (-1 = none)
+    long route_id;		// of the loaded route (-1 = none)
+    int current_wp;
+    bool acquired;
+
+    // direct course/distance cache
+    double last_lon;
+    double last_lat;
+    int last_wp;
+    double direct_course;
+    double direct_dist;
+
+    pyPropertyNode active_node;
+
+    PropertyHandle<string> nav_mode_h;
+    PropertyHandle<long> serial_h, route_id_h;
+    PropertyHandle<string> follow_mode_h, start_mode_h, completion_mode_h;
+    PropertyHandle<double> xtrack_h, projected_h, dist_remaining_h;
+    PropertyHandle<double> wp_dist_h, wp_eta_h;
+    PropertyHandle<long> route_size_h, target_idx_h, follow_serial_h;
+    PropertyHandle<double> bank_limit_h, period_h, damping_h;
+    PropertyHandle<double> lon_h, lat_h, gs_h, track_h, gps_age_h;
+    PropertyHandle<double> target_track_h, course_error_h, target_roll_h;
+
+    void load_route();
+    void update_direct( double lon, double lat );
+
+public:
+
+    AuraL1Route( string config_path );
+    ~AuraL1Route() {}
+
+    void update( double dt );
+};
+
+
+#endif // _AURA_L1_ROUTE_HXX
@@ -1,18 +1,15 @@
 # high level navigation modes
+#
+# The route follower and circle hold run natively as part of the
+# autopilot (control/l1_route.cxx, control/l1_circle.cxx), this is
+# the request side: route requests and relative waypoint updates.
 
 from props import root, getNode
 
-import circle
 import route
 
-nav_node = getNode("/navigation", True)
-
 def init():
-    circle.init()
     route.init()
 
 def update(dt):
-    if nav_node.getString("mode") == 'circle':
-        circle.update(dt)
-    elif nav_node.getString("mode") == 'route':
-        route.update(dt)
+    route.update(dt)
@@ -32,104 +32,56 @@ AuraPID::AuraPID( string config_path ):
     clamp( false ),
     y_n( 0.0 ),
     y_n_1( 0.0 ),
-    r_n( 0.0 )
+    r_n( 0.0 ),
+    Kp( 0.0 ),
+    Ti( 0.0 ),
+    Td( 0.0 ),
+    u_trim( 0.0 ),
+    u_min( 0.0 ),
+    u_max( 0.0 )
 {
-    size_t pos;
-
     component_node = pyGetNode(config_path, true);
 
-    // enable
-    pyPropertyNode node = component_node.getChild("enable", true);
-    string enable_prop = node.getString("prop");
-    enable_value = node.getString("value");
-    honor_passive = node.getBool("honor_passive");
-    pos = enable_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = enable_prop.substr(0, pos);
-	enable_attr = enable_prop.substr(pos+1);
-	enable_node = pyGetNode( path, true );
-    }
-
-    // input
-    node = component_node.getChild("input", true);
-    string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	input_node = pyGetNode( path, true );
-    }
-
-    // reference
-    node = component_node.getChild("reference", true);
-    string ref_prop = node.getString("prop");
-    ref_value = node.getString("value");
-    pos = ref_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = ref_prop.substr(0, pos);
-	ref_attr = ref_prop.substr(pos+1);
-	// printf("path = %s attr = %s\n", path.c_str(), ref_attr.c_str());
-	ref_node = pyGetNode( path, true );
-    }
-
-    // output
-    node = component_node.getChild( "output", true );
-    vector <string> children = node.getChildren();
-    for ( unsigned int i = 0; i < children.size(); ++i ) {
-	if ( children[i].substr(0,4) == "prop" ) {
-	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
-	    } else {
-		printf("WARNING: requested bad output path: %s\n",
-		       output_prop.c_str());
-	    }
-	} else {
-	    printf("WARNING: unknown tag in output section: %s\n",
-		   children[i].c_str());
-	}
-    }
+    bind_enable();
+    pyPropertyNode node = component_node.getChild("input", true);
+    input_h = bind_input( node.getString("prop") );
+    bind_reference();
+    bind_outputs();
  
     // config
     config_node = component_node.getChild( "config", true );
+
+    reconfigure();
+
+    debug_h = component_node.getHandle<bool>("debug");
+}
+
+
+int AuraPID::reconfigure() {
+    int changed = 0;
+    changed += load_value( config_node, "Kp", &Kp );
+    changed += load_value( config_node, "Ti", &Ti );
+    changed += load_value( config_node, "Td", &Td );
+    changed += load_value( config_node, "u_trim", &u_trim );
+    changed += load_value( config_node, "u_min", &u_min );
+    changed += load_value( config_node, "u_max", &u_max );
+    return changed;
 }
 
 
 void AuraPID::update( double dt ) {
-    if (!enable_node.isNull() && enable_node.getString(enable_attr.c_str()) == enable_value) {
-	enabled = true;
-    } else {
-	enabled = false;
-    }
+    enabled = enable.test();
 
-    bool debug = component_node.getBool("debug");
+    bool debug = debug_h.get();
     if ( debug ) printf("Updating %s\n", get_name().c_str());
-    y_n = input_node.getDouble(input_attr.c_str());
-
-    double r_n = 0.0;
-    if ( ref_value != "" ) {
-	// printf("nonzero ref_value\n");
-	r_n = atof(ref_value.c_str());
-    } else {
-	r_n = ref_node.getDouble(ref_attr.c_str());
-    }
+    y_n = input_h.get();
+
+    double r_n = reference();
                       
     double error = r_n - y_n;
     if ( debug ) printf("input = %.3f reference = %.3f error = %.3f\n",
 			y_n, r_n, error);
 
-    double u_trim = config_node.getDouble("u_trim");
-    double u_min = config_node.getDouble("u_min");
-    double u_max = config_node.getDouble("u_max");
-
-    double Kp = config_node.getDouble("Kp");
-    double Ti = config_node.getDouble("Ti");
-    double Td = config_node.getDouble("Td");
     double Ki = 0.0;
     if ( Ti > 0.0001 ) {
 	Ki = Kp / Ti;
@@ -166,20 +118,16 @@ void AuraPID::update( double dt ) {
 
     if ( enabled ) {
 	// Copy the result to the output node(s)
-	for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-	    output_node[i].setDouble( output_attr[i].c_str(), output );
+	for ( unsigned int i = 0; i < output_h.size(); i++ ) {
+	    output_h[i].set( output );
 	}
-    } else {
+    } else if ( output_h.size() > 0 ) {
         // back compute an iterm that will produce zero initial
         // transient when activating this component
-        double u_n = output_node[0].getDouble(output_attr[0].c_str());
+        double u_n = output_h[0].get();
 	// and clip
-	double u_min = config_node.getDouble("u_min");
-	double u_max = config_node.getDouble("u_max");
  	if ( u_n < u_min ) { u_n = u_min; }
 	if ( u_n > u_max ) { u_n = u_max; }
         iterm = u_n - pterm;
     }
 }
-
-
@@ -42,12 +42,19 @@ private:
     double y_n_1;		// previous process value (input)
     double r_n;                 // reference (set point) value
 
+    // gains and limits (copied from the config by reconfigure())
+    double Kp, Ti, Td;
+    double u_trim, u_min, u_max;
+
+    PropertyHandle<bool> debug_h;
+
 public:
 
     AuraPID( string config_path );
     ~AuraPID() {}
 
     void update( double dt );
+    int reconfigure();
 };
 
 
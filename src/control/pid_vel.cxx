@@ -30,78 +30,33 @@ AuraPIDVel::AuraPIDVel( string config_path ):
     edf_n_2( 0.0 ),
     u_n_1( 0.0 ),
     desiredTs( 0.00001 ),
-    elapsedTime( 0.0 )
+    elapsedTime( 0.0 ),
+    beta( 0.0 ),
+    gamma( 0.0 ),
+    alpha( 0.0 ),
+    Kp( 0.0 ),
+    Ti( 0.0 ),
+    Td( 0.0 ),
+    u_min( 0.0 ),
+    u_max( 0.0 )
 {
-    size_t pos;
-
     component_node = pyGetNode(config_path, true);
-    
-    // enable
-    pyPropertyNode node = component_node.getChild("enable", true);
-    string enable_prop = node.getString("prop");
-    enable_value = node.getString("value");
-    honor_passive = node.getBool("honor_passive");
-    pos = enable_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = enable_prop.substr(0, pos);
-	enable_attr = enable_prop.substr(pos+1);
-	printf("path = %s attr = %s\n", path.c_str(), enable_attr.c_str());
-	enable_node = pyGetNode( path, true );
-    }
-
-    // input
-    node = component_node.getChild("input", true);
-    string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	printf("path = %s attr = %s\n", path.c_str(), input_attr.c_str());
-	input_node = pyGetNode( path, true );
-    }
 
-    // reference
-    node = component_node.getChild("reference", true);
-    string ref_prop = node.getString("prop");
-    ref_value = node.getString("value");
-    pos = ref_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = ref_prop.substr(0, pos);
-	ref_attr = ref_prop.substr(pos+1);
-	printf("path = %s attr = %s\n", path.c_str(), ref_attr.c_str());
-	ref_node = pyGetNode( path, true );
-    }
-
-    // output
-    node = component_node.getChild( "output", true );
-    vector <string> children = node.getChildren();
-    for ( unsigned int i = 0; i < children.size(); ++i ) {
-	if ( children[i].substr(0,4) == "prop" ) {
-	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		printf("path = %s attr = %s\n", path.c_str(), attr.c_str());
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
-	    } else {
-		printf("WARNING: requested bad output path: %s\n",
-		       output_prop.c_str());
-	    }
-	} else {
-	    printf("WARNING: unknown tag in output section: %s\n",
-		   children[i].c_str());
-	}
-    }
+    bind_enable();
+    pyPropertyNode node = component_node.getChild("input", true);
+    input_h = bind_input( node.getString("prop") );
+    bind_reference();
+    bind_outputs();
  
     // config
     config_node = component_node.getChild( "config", true );
-    if ( config_node.hasChild("Ts") ) {
-	desiredTs = config_node.getDouble("Ts");
-    }
-            
+    reconfigure();
+
+    debug_h = component_node.getHandle<bool>("debug");
+}
+
+
+int AuraPIDVel::reconfigure() {
     if ( !config_node.hasChild("beta") ) {
 	// create with default value
 	config_node.setDouble( "beta", 1.0 );
@@ -110,6 +65,20 @@ AuraPIDVel::AuraPIDVel( string config_path ):
 	// create with default value
 	config_node.setDouble( "alpha", 0.1 );
     }
+
+    int changed = 0;
+    if ( config_node.hasChild("Ts") ) {
+	changed += load_value( config_node, "Ts", &desiredTs );
+    }
+    changed += load_value( config_node, "beta", &beta );
+    changed += load_value( config_node, "gamma", &gamma );
+    changed += load_value( config_node, "alpha", &alpha );
+    changed += load_value( config_node, "Kp", &Kp );
+    changed += load_value( config_node, "Ti", &Ti );
+    changed += load_value( config_node, "Td", &Td );
+    changed += load_value( config_node, "u_min", &u_min );
+    changed += load_value( config_node, "u_max", &u_max );
+    return changed;
 }
 
 
@@ -182,31 +151,22 @@ void AuraPIDVel::update( double dt ) {
     Ts = elapsedTime;
     elapsedTime = 0.0;
 
-    if (!enable_node.isNull() && enable_node.getString(enable_attr.c_str()) == enable_value) {
-	enabled = true;
-    } else {
-	enabled = false;
-    }
+    enabled = enable.test();
 
-    bool debug = component_node.getBool("debug");
+    bool debug = debug_h.get();
 
     if ( Ts > 0.0) {
         if ( debug ) printf("Updating %s Ts = %.2f", get_name().c_str(), Ts );
 
         double y_n = 0.0;
-	y_n = input_node.getDouble(input_attr.c_str());
+	y_n = input_h.get();
 
-        double r_n = 0.0;
-	if ( ref_value != "" ) {
-	    r_n = atof(ref_value.c_str());
-	} else {
-            r_n = ref_node.getDouble(ref_attr.c_str());
-	}
+        double r_n = reference();
                       
         if ( debug ) printf("  input = %.3f ref = %.3f\n", y_n, r_n );
 
         // Calculates proportional error:
-        ep_n = config_node.getDouble("beta") * (r_n - y_n);
+        ep_n = beta * (r_n - y_n);
         if ( debug ) {
 	    printf( "  ep_n = %.3f", ep_n);
 	    printf( "  ep_n_1 = %.3f", ep_n_1);
@@ -217,13 +177,12 @@ void AuraPIDVel::update( double dt ) {
         if ( debug ) printf( " e_n = %.3f", e_n);
 
         // Calculates derivate error:
-        ed_n = config_node.getDouble("gamma") * r_n - y_n;
+        ed_n = gamma * r_n - y_n;
         if ( debug ) printf(" ed_n = %.3f", ed_n);
 
-	double Td = config_node.getDouble("Td");
         if ( Td > 0.0 ) {
             // Calculates filter time:
-            Tf = config_node.getDouble("alpha") * Td;
+            Tf = alpha * Td;
             if ( debug ) printf(" Tf = %.3f", Tf);
 
             // Filters the derivate error:
@@ -235,8 +194,6 @@ void AuraPIDVel::update( double dt ) {
         }
 
         // Calculates the incremental output:
-	double Ti = config_node.getDouble("Ti");
-	double Kp = config_node.getDouble("Kp");
         if ( Ti > 0.0 ) {
             delta_u_n = Kp * ( (ep_n - ep_n_1)
                                + ((Ts/Ti) * e_n)
@@ -252,8 +209,6 @@ void AuraPIDVel::update( double dt ) {
         }
 
         // Integrator anti-windup logic:
-	double u_min = config_node.getDouble("u_min");
-	double u_max = config_node.getDouble("u_max");
         if ( delta_u_n > (u_max - u_n_1) ) {
             delta_u_n = u_max - u_n_1;
             if ( debug ) printf(" max saturation\n");
@@ -275,18 +230,16 @@ void AuraPIDVel::update( double dt ) {
 
     if ( enabled ) {
 	// Copy the result to the output node(s)
-	for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-	    output_node[i].setDouble( output_attr[i].c_str(), u_n );
+	for ( unsigned int i = 0; i < output_h.size(); i++ ) {
+	    output_h[i].set( u_n );
 	}
-    } else if ( output_node.size() > 0 ) {
+    } else if ( output_h.size() > 0 ) {
 	// Mirror the output value while we are not enabled so there
 	// is less of a continuity break when this module is enabled
 
 	// pull output value from the corresponding property tree value
-	u_n = output_node[0].getDouble(output_attr[0].c_str());
+	u_n = output_h[0].get();
 	// and clip
-	double u_min = config_node.getDouble("u_min");
-	double u_max = config_node.getDouble("u_max");
  	if ( u_n < u_min ) { u_n = u_min; }
 	if ( u_n > u_max ) { u_n = u_max; }
 	u_n_1 = u_n;
@@ -36,6 +36,13 @@ private:
     double u_n_1;               // u[n-1]   (output)
     double desiredTs;            // desired sampling interval (sec)
     double elapsedTime;          // elapsed time (sec)
+
+    // gains and limits (copied from the config by reconfigure())
+    double beta, gamma, alpha;
+    double Kp, Ti, Td;
+    double u_min, u_max;
+
+    PropertyHandle<bool> debug_h;
     
 public:
 
@@ -45,6 +52,7 @@ public:
 
     void update_old( double dt );
     void update( double dt );
+    int reconfigure();
 };
 
 
@@ -30,61 +30,28 @@ AuraPredictor::AuraPredictor ( string config_path ):
     filter_gain( 0.0 ),
     ivalue( 0.0 )
 {
-    size_t pos;
-
     component_node = pyGetNode(config_path);
 
-    // enable
-    pyPropertyNode node = component_node.getChild("enable", true);
-    string enable_prop = node.getString("prop");
-    enable_value = node.getString("value");
-    honor_passive = node.getBool("honor_passive");
-    pos = enable_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = enable_prop.substr(0, pos);
-	enable_attr = enable_prop.substr(pos+1);
-	enable_node = pyGetNode( path, true );
-    }
+    bind_enable();
 
     // input
-    node = component_node.getChild("input", true);
-    string input_prop = node.getString("prop");
-    pos = input_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = input_prop.substr(0, pos);
-	input_attr = input_prop.substr(pos+1);
-	input_node = pyGetNode( path, true );
-    }
+    pyPropertyNode node = component_node.getChild("input", true);
+    input_h = bind_input( node.getString("prop") );
 
+    bind_outputs();
+
+    reconfigure();
+}
+
+int AuraPredictor::reconfigure() {
+    int changed = 0;
     if ( component_node.hasChild("seconds") ) {
-	seconds = component_node.getDouble("seconds");
+	changed += load_value( component_node, "seconds", &seconds );
     }
     if ( component_node.hasChild("filter_gain") ) {
-	filter_gain = component_node.getDouble("filter_gain");
-    }
-    
-    // output
-    node = component_node.getChild( "output", true );
-    vector <string> children = node.getChildren();
-    for ( unsigned int i = 0; i < children.size(); ++i ) {
-	if ( children[i].substr(0,4) == "prop" ) {
-	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
-	    } else {
-		printf("WARNING: requested bad output path: %s\n",
-		       output_prop.c_str());
-	    }
-	} else {
-	    printf("WARNING: unknown tag in output section: %s\n",
-		   children[i].c_str());
-	}
+	changed += load_value( component_node, "filter_gain", &filter_gain );
     }
+    return changed;
 }
 
 void AuraPredictor::update( double dt ) {
@@ -101,13 +68,9 @@ void AuraPredictor::update( double dt ) {
 
     */
 
-    if (!enable_node.isNull() && enable_node.getString(enable_attr.c_str()) == enable_value) {
-	enabled = true;
-    } else {
-	enabled = false;
-    }
+    enabled = enable.test();
 
-    ivalue = input_node.getDouble(input_attr.c_str());
+    ivalue = input_h.get();
 
     if ( enabled ) {
         // first time initialize average
@@ -127,8 +90,8 @@ void AuraPredictor::update( double dt ) {
             double output = ivalue + (1.0 - filter_gain) * (average * seconds) + filter_gain * (current * seconds);
 
 	    // Copy the result to the output node(s)
-	    for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-		output_node[i].setDouble( output_attr[i].c_str(), output );
+	    for ( unsigned int i = 0; i < output_h.size(); i++ ) {
+		output_h[i].set( output );
 	    }
         }
         last_value = ivalue;
@@ -45,4 +45,5 @@ public:
     ~AuraPredictor() {}
 
     void update( double dt );
+    int reconfigure();
 };
@@ -23,39 +23,24 @@
 #include "summer.hxx"
 
 
-AuraSummer::AuraSummer ( string config_path )
+AuraSummer::AuraSummer ( string config_path ):
+    u_min( 0.0 ),
+    u_max( 0.0 )
 {
-    size_t pos;
-
     component_node = pyGetNode(config_path);
 
-    // enable
-    pyPropertyNode node = component_node.getChild("enable", true);
-    string enable_prop = node.getString("prop");
-    enable_value = node.getString("value");
-    honor_passive = node.getBool("honor_passive");
-    pos = enable_prop.rfind("/");
-    if ( pos != string::npos ) {
-	string path = enable_prop.substr(0, pos);
-	enable_attr = enable_prop.substr(pos+1);
-	enable_node = pyGetNode( path, true );
-    }
+    bind_enable();
 
-    vector <string> children;
-    
     // input
-    node = component_node.getChild( "input", true );
-    children = node.getChildren();
+    pyPropertyNode node = component_node.getChild( "input", true );
+    vector <string> children = node.getChildren();
     for ( unsigned int i = 0; i < children.size(); ++i ) {
 	if ( children[i].substr(0,4) == "prop" ) {
 	    string input_prop = node.getString(children[i].c_str());
-	    pos = input_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = input_prop.substr(0, pos);
-		string attr = input_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		input_node.push_back( onode );
-		input_attr.push_back( attr );
+	    PropertyHandle<double> h = bind_input( input_prop );
+	    if ( !h.isNull() ) {
+		inputs_h.push_back( h );
+		input_attr.push_back( input_prop.substr(input_prop.rfind("/")+1) );
 	    } else {
 		printf("WARNING: requested bad input path: %s\n",
 		       input_prop.c_str());
@@ -66,56 +51,40 @@ AuraSummer::AuraSummer ( string config_path )
 	}
     }
 
-    // output
-    node = component_node.getChild( "output", true );
-    children = node.getChildren();
-    for ( unsigned int i = 0; i < children.size(); ++i ) {
-	if ( children[i].substr(0,4) == "prop" ) {
-	    string output_prop = node.getString(children[i].c_str());
-	    pos = output_prop.rfind("/");
-	    if ( pos != string::npos ) {
-		string path = output_prop.substr(0, pos);
-		string attr = output_prop.substr(pos+1);
-		pyPropertyNode onode = pyGetNode( path, true );
-		output_node.push_back( onode );
-		output_attr.push_back( attr );
-	    } else {
-		printf("WARNING: requested bad output path: %s\n",
-		       output_prop.c_str());
-	    }
-	} else {
-	    printf("WARNING: unknown tag in output section: %s\n",
-		   children[i].c_str());
-	}
-    }
+    bind_outputs();
     
     // config
     config_node = component_node.getChild( "config", true );
+
+    reconfigure();
+
+    debug_h = component_node.getHandle<bool>("debug");
+}
+
+int AuraSummer::reconfigure() {
+    int changed = 0;
+    changed += load_value( config_node, "u_min", &u_min );
+    changed += load_value( config_node, "u_max", &u_max );
+    return changed;
 }
 
 void AuraSummer::update( double dt ) {
-    if (!enable_node.isNull() && enable_node.getString(enable_attr.c_str()) == enable_value) {
-	enabled = true;
-    } else {
-	enabled = false;
-    }
+    enabled = enable.test();
 
     if ( enabled ) {
-	bool debug = component_node.getBool("debug");
+	bool debug = debug_h.get();
 	if ( debug ) printf("Updating %s\n", get_name().c_str());
 	double sum = 0.0;
-	for ( unsigned int i = 0; i < input_node.size(); i++ ) {
-	    double val = input_node[i].getDouble( input_attr[i].c_str() );
+	for ( unsigned int i = 0; i < inputs_h.size(); i++ ) {
+	    double val = inputs_h[i].get();
 	    sum += val;
 	    if (debug) printf("  %s = %.3f\n", input_attr[i].c_str(), val);
 	}
-	double u_min = config_node.getDouble("u_min");
-	double u_max = config_node.getDouble("u_max");
 	if ( sum < u_min ) { sum = u_min; }
 	if ( sum > u_max ) { sum = u_max; }
 	if (debug) printf("  sum = %.3f\n", sum);
-	for ( unsigned int i = 0; i < output_node.size(); i++ ) {
-	    output_node[i].setDouble( output_attr[i].c_str(), sum );
+	for ( unsigned int i = 0; i < output_h.size(); i++ ) {
+	    output_h[i].set( sum );
 	}
     }
 }
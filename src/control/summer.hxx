@@ -27,11 +27,13 @@ class AuraSummer : public APComponent {
 
 private:
     // support multiple input nodes
-    vector <pyPropertyNode> input_node;
-    vector <string> input_attr;
+    vector< PropertyHandle<double> > inputs_h;
+    vector <string> input_attr;	// for debug output
 
-    // debug flag
-    bool debug_node;
+    // limits (copied from the config by reconfigure())
+    double u_min, u_max;
+
+    PropertyHandle<bool> debug_h;
 
 public:
 
@@ -39,4 +41,5 @@ public:
     ~AuraSummer() {}
 
     void update( double dt );
+    int reconfigure();
 };
@@ -0,0 +1,126 @@
+//
+// targets_mailbox.cxx - autopilot targets from the mission thread
+//
+// This code is released into the public domain.
+//
+
+#include "python/pyprops.hxx"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+using std::string;
+
+#include "util/seqlock.hxx"
+
+#include "targets_mailbox.hxx"
+
+
+// the values the mission tasks set (live node, mission's copy)
+struct mailbox_value {
+    const char *live_path;
+    const char *task_path;
+    const char *name;
+};
+static const mailbox_value values[] = {
+    { "/autopilot/targets", "/task/targets", "groundtrack_deg" },
+    { "/autopilot/targets", "/task/targets", "roll_deg" },
+    { "/autopilot/targets", "/task/targets", "pitch_deg" },
+    { "/autopilot/targets", "/task/targets", "altitude_agl_ft" },
+    { "/autopilot/targets", "/task/targets", "airspeed_kt" },
+    { "/controls/engine", "/task/controls/engine", "throttle" },
+    { "/controls/flight", "/task/controls/flight", "flaps_setpoint" }
+};
+static const int NUM_VALUES = sizeof(values) / sizeof(mailbox_value);
+
+// plus /autopilot/mode, bit NUM_VALUES of changed
+static const int MODE_LEN = 32;
+
+struct targets_msg {
+    uint32_t changed;		// bit i set: value[i] is new
+    double value[NUM_VALUES];
+    char mode[MODE_LEN];
+};
+
+static AuraSeqlock<targets_msg> mailbox;
+
+static PropertyHandle<double> live_h[NUM_VALUES];
+static PropertyHandle<double> task_h[NUM_VALUES];
+static PropertyHandle<string> live_mode_h;	// /autopilot/mode
+static PropertyHandle<string> task_mode_h;	// /task/autopilot/mode
+
+// mission side: values copied in by the last refresh
+static double refreshed[NUM_VALUES];
+static string refreshed_mode;
+
+// control side: last message applied
+static uint32_t applied = 0;
+
+
+void targets_mailbox_init() {
+    for ( int i = 0; i < NUM_VALUES; i++ ) {
+	live_h[i] = pyGetNode( values[i].live_path, true )
+	    .getHandle<double>( values[i].name );
+	task_h[i] = pyGetNode( values[i].task_path, true )
+	    .getHandle<double>( values[i].name );
+    }
+    live_mode_h = pyGetNode( "/autopilot", true ).getHandle<string>( "mode" );
+    task_mode_h = pyGetNode( "/task/autopilot", true )
+	.getHandle<string>( "mode" );
+    targets_mailbox_refresh();
+}
+
+
+void targets_mailbox_refresh() {
+    for ( int i = 0; i < NUM_VALUES; i++ ) {
+	refreshed[i] = live_h[i].get();
+	task_h[i].set( refreshed[i] );
+    }
+    refreshed_mode = live_mode_h.get();
+    task_mode_h.set( refreshed_mode );
+}
+
+
+void targets_mailbox_publish() {
+    targets_msg msg;
+    msg.changed = 0;
+    for ( int i = 0; i < NUM_VALUES; i++ ) {
+	msg.value[i] = task_h[i].get();
+	if ( msg.value[i] != refreshed[i] ) {
+	    msg.changed |= (1 << i);
+	}
+    }
+    string mode = task_mode_h.get();
+    memset( msg.mode, 0, MODE_LEN );
+    if ( mode != refreshed_mode ) {
+	if ( mode.length() < MODE_LEN ) {
+	    strncpy( msg.mode, mode.c_str(), MODE_LEN - 1 );
+	    msg.changed |= (1 << NUM_VALUES);
+	} else {
+	    printf("targets mailbox: autopilot mode too long: %s\n",
+		   mode.c_str());
+	}
+    }
+    if ( msg.changed ) {
+	mailbox.store( msg );
+    }
+}
+
+
+void targets_mailbox_apply() {
+    if ( mailbox.count() == applied ) {
+	return;
+    }
+    targets_msg msg;
+    applied = mailbox.load( &msg );
+    for ( int i = 0; i < NUM_VALUES; i++ ) {
+	if ( msg.changed & (1 << i) ) {
+	    live_h[i].set( msg.value[i] );
+	}
+    }
+    if ( msg.changed & (1 << NUM_VALUES) ) {
+	live_mode_h.set( msg.mode );
+    }
+}
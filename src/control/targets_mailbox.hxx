@@ -0,0 +1,48 @@
+//
+// targets_mailbox.hxx - autopilot targets from the mission thread
+//
+// The mission tasks run at their own (lower) rate and may be
+// interrupted by several control frames in the middle of an update.
+// So they don't write the values the autopilot consumes directly,
+// they work on a copy under /task instead:
+//
+//   /autopilot/targets/{groundtrack_deg,roll_deg,pitch_deg,
+//     altitude_agl_ft,airspeed_kt}  ->  /task/targets/...
+//   /autopilot/mode                 ->  /task/autopilot/mode
+//   /controls/engine/throttle       ->  /task/controls/engine/throttle
+//   /controls/flight/flaps_setpoint ->  /task/controls/flight/...
+//
+//   mission thread: targets_mailbox_refresh() copies the live values
+//   into /task, the mission update runs, then
+//   targets_mailbox_publish() posts every value the mission changed
+//   to the mailbox in one piece.
+//
+//   control thread: targets_mailbox_apply() at the start of each
+//   control frame copies a newly posted set into the live tree.
+//
+// So a mode change and the targets or throttle set with it reach the
+// autopilot in the same frame.  Values the mission didn't touch (set
+// by the ground station, or by later autopilot stages) are left
+// alone.  Anything else a task writes (flaps_mgr's /controls/flight/
+// flaps ramp, launch's rudder, throttle_safety's actuator flag) is a
+// single value written live and can land between two control frames
+// of one mission update.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_TARGETS_MAILBOX_HXX
+#define _AURA_TARGETS_MAILBOX_HXX
+
+
+void targets_mailbox_init();
+
+// mission side
+void targets_mailbox_refresh();
+void targets_mailbox_publish();
+
+// control side
+void targets_mailbox_apply();
+
+
+#endif // _AURA_TARGETS_MAILBOX_HXX
@@ -63,6 +63,7 @@ int curt_adns_init( string output_path, pyPropertyNode *config ) {
     bind_properties( output_path );
 
     filter_node.setString( "navigation", "invalid" );
+    filter_node.setBool( "navigation_valid", false );
     init_pos = false;
 
     return 1;
@@ -471,6 +472,7 @@ int curt_adns_update( double imu_dt ) {
 	filter_node.setDouble( "ve_ms", vel_ned[1] );
 	filter_node.setDouble( "vd_ms", vel_ned[2] );
 	filter_node.setString( "navigation", "valid" );
+	filter_node.setBool( "navigation_valid", true );
 
 	filter_node.setDouble( "altitude_ft", pos_geod.getElevationFt() );
 	filter_node.setDouble( "groundtrack_deg",
@@ -12,6 +12,8 @@
 #include "python/pyprops.hxx"
 
 #include <stdio.h>
+
+#include <atomic>
 #include <string>
 #include <sstream>
 using std::string;
@@ -26,6 +28,7 @@ using std::ostringstream;
 #include "init/globals.hxx"
 #include "util/lowpass.hxx"
 #include "util/myprof.hxx"
+#include "util/worker_pool.hxx"
 
 #include "filter_mgr.hxx"
 
@@ -50,7 +53,81 @@ static pyPropertyNode task_node;
 static pyPropertyNode airdata_node;
 static pyPropertyNode wind_node;
 static pyPropertyNode status_node;
-static vector<pyPropertyNode> sections;
+
+// filter module entry points
+struct filter_module {
+    const char *name;
+    void (*init)( string output_path, pyPropertyNode *config );
+    void (*sample)();		// main thread: read the sensor inputs
+    bool (*compute)();		// any thread: run the filter step
+    void (*publish)();		// main thread: write the results
+    void (*close)();
+};
+
+static const filter_module modules[] = {
+    { "nav_eigen", nav_eigen_init, nav_eigen_sample, nav_eigen_compute,
+      nav_eigen_publish, nav_eigen_close },
+    { "nav_eigen_mag", nav_eigen_mag_init, nav_eigen_mag_sample,
+      nav_eigen_mag_compute, nav_eigen_mag_publish, nav_eigen_mag_close },
+    { "umn_quat", umngnss_quat_init, umngnss_quat_sample,
+      umngnss_quat_compute, umngnss_quat_publish, umngnss_quat_close }
+};
+static const int num_modules = sizeof(modules) / sizeof(modules[0]);
+
+// Secondary filters can run on the worker pool.  A job is handed a
+// sample of the sensors taken at the start of the frame and its
+// results are published (on the main thread, all at once) at the
+// start of the next frame, so they lag the primary filter by one
+// frame.  If a worker hasn't finished by then the frame is skipped for
+// that filter rather than making the main loop wait.
+enum job_state { JOB_IDLE, JOB_BUSY, JOB_DONE };
+
+struct filter_section {
+    int index;			// position in /config/filters
+    const filter_module *module;
+    bool threaded;
+    std::atomic<int> state;
+    bool result;		// written by the job before JOB_DONE
+    PropertyHandle<long> skipped;
+};
+static vector<filter_section *> sections;
+
+static AuraWorkerPool workers;
+
+// pre-resolved handles for the per-frame update (bound in Filter_init())
+static PropertyHandle<double> imu_timestamp;
+static PropertyHandle<double> imu_p, imu_q, imu_r;
+static PropertyHandle<double> filt_timestamp;
+static PropertyHandle<double> filt_roll_deg, filt_pitch_deg, filt_heading_deg;
+static PropertyHandle<double> filt_lat_deg, filt_lon_deg;
+static PropertyHandle<double> filt_alt_m, filt_alt_ft;
+static PropertyHandle<double> filt_vn_ms, filt_ve_ms, filt_vd_ms;
+static PropertyHandle<double> filt_groundtrack_deg, filt_groundspeed_ms;
+static PropertyHandle<double> filt_vertical_speed_fps;
+static PropertyHandle<string> filt_navigation;
+static PropertyHandle<double> orient_roll_deg, orient_pitch_deg;
+static PropertyHandle<double> orient_heading_deg;
+static PropertyHandle<double> orient_phi_dot, orient_the_dot, orient_psi_dot;
+static PropertyHandle<double> orient_groundtrack_deg;
+static PropertyHandle<double> orient_groundtrack_est_deg;
+static PropertyHandle<double> pos_lat_deg, pos_lon_deg;
+static PropertyHandle<double> pos_alt_m, pos_alt_ft;
+static PropertyHandle<double> pos_agl_m, pos_agl_ft, pos_ground_m;
+static PropertyHandle<double> pos_filt_alt_m, pos_filt_alt_ft;
+static PropertyHandle<double> pos_filt_agl_m, pos_filt_agl_ft;
+static PropertyHandle<double> pos_filt_ground_m;
+static PropertyHandle<double> vel_vn_ms, vel_ve_ms, vel_vd_ms;
+static PropertyHandle<double> vel_groundspeed_ms, vel_groundspeed_est_ms;
+static PropertyHandle<double> vel_vertical_speed_fps;
+static PropertyHandle<double> filter_group_timestamp;
+static PropertyHandle<string> status_navigation;
+static PropertyHandle<bool> task_is_airborne;
+static PropertyHandle<double> airdata_airspeed_kt;
+static PropertyHandle<double> wind_speed_kt, wind_dir_deg;
+static PropertyHandle<double> wind_east_mps, wind_north_mps;
+static PropertyHandle<double> wind_true_airspeed_kt, wind_true_heading_deg;
+static PropertyHandle<double> wind_true_east_mps, wind_true_north_mps;
+static PropertyHandle<double> wind_pitot_scale_factor;
 
 // initial values are the 'time factor'
 static LowPassFilter ground_alt_filt( 30.0 );
@@ -60,7 +137,6 @@ static LowPassFilter pitot_scale_filt( 30.0 );
 
 static bool ground_alt_calibrated = false;
 
-static int remote_link_skip = 0;
 static int logging_skip = 0;
 
 void Filter_init() {
@@ -81,10 +157,71 @@ void Filter_init() {
     status_node = pyGetNode("/status", true);
 
     wind_node.setDouble( "pitot_scale_factor", 1.0 );
+
+    imu_timestamp = imu_node.getHandle<double>("timestamp");
+    imu_p = imu_node.getHandle<double>("p_rad_sec");
+    imu_q = imu_node.getHandle<double>("q_rad_sec");
+    imu_r = imu_node.getHandle<double>("r_rad_sec");
+    filt_timestamp = filter_node.getHandle<double>("timestamp");
+    filt_roll_deg = filter_node.getHandle<double>("roll_deg");
+    filt_pitch_deg = filter_node.getHandle<double>("pitch_deg");
+    filt_heading_deg = filter_node.getHandle<double>("heading_deg");
+    filt_lat_deg = filter_node.getHandle<double>("latitude_deg");
+    filt_lon_deg = filter_node.getHandle<double>("longitude_deg");
+    filt_alt_m = filter_node.getHandle<double>("altitude_m");
+    filt_alt_ft = filter_node.getHandle<double>("altitude_ft");
+    filt_vn_ms = filter_node.getHandle<double>("vn_ms");
+    filt_ve_ms = filter_node.getHandle<double>("ve_ms");
+    filt_vd_ms = filter_node.getHandle<double>("vd_ms");
+    filt_groundtrack_deg = filter_node.getHandle<double>("groundtrack_deg");
+    filt_groundspeed_ms = filter_node.getHandle<double>("groundspeed_ms");
+    filt_vertical_speed_fps
+	= filter_node.getHandle<double>("vertical_speed_fps");
+    filt_navigation = filter_node.getHandle<string>("navigation");
+    orient_roll_deg = orient_node.getHandle<double>("roll_deg");
+    orient_pitch_deg = orient_node.getHandle<double>("pitch_deg");
+    orient_heading_deg = orient_node.getHandle<double>("heading_deg");
+    orient_phi_dot = orient_node.getHandle<double>("phi_dot_rad_sec");
+    orient_the_dot = orient_node.getHandle<double>("the_dot_rad_sec");
+    orient_psi_dot = orient_node.getHandle<double>("psi_dot_rad_sec");
+    orient_groundtrack_deg = orient_node.getHandle<double>("groundtrack_deg");
+    orient_groundtrack_est_deg
+	= orient_node.getHandle<double>("groundtrack_est_deg");
+    pos_lat_deg = pos_node.getHandle<double>("latitude_deg");
+    pos_lon_deg = pos_node.getHandle<double>("longitude_deg");
+    pos_alt_m = pos_node.getHandle<double>("altitude_m");
+    pos_alt_ft = pos_node.getHandle<double>("altitude_ft");
+    pos_agl_m = pos_node.getHandle<double>("altitude_agl_m");
+    pos_agl_ft = pos_node.getHandle<double>("altitude_agl_ft");
+    pos_ground_m = pos_node.getHandle<double>("altitude_ground_m");
+    pos_filt_alt_m = pos_filter_node.getHandle<double>("altitude_m");
+    pos_filt_alt_ft = pos_filter_node.getHandle<double>("altitude_ft");
+    pos_filt_agl_m = pos_filter_node.getHandle<double>("altitude_agl_m");
+    pos_filt_agl_ft = pos_filter_node.getHandle<double>("altitude_agl_ft");
+    pos_filt_ground_m = pos_filter_node.getHandle<double>("altitude_ground_m");
+    vel_vn_ms = vel_node.getHandle<double>("vn_ms");
+    vel_ve_ms = vel_node.getHandle<double>("ve_ms");
+    vel_vd_ms = vel_node.getHandle<double>("vd_ms");
+    vel_groundspeed_ms = vel_node.getHandle<double>("groundspeed_ms");
+    vel_groundspeed_est_ms = vel_node.getHandle<double>("groundspeed_est_ms");
+    vel_vertical_speed_fps = vel_node.getHandle<double>("vertical_speed_fps");
+    filter_group_timestamp = filter_group_node.getHandle<double>("timestamp");
+    status_navigation = status_node.getHandle<string>("navigation");
+    task_is_airborne = task_node.getHandle<bool>("is_airborne");
+    airdata_airspeed_kt = airdata_node.getHandle<double>("airspeed_kt");
+    wind_speed_kt = wind_node.getHandle<double>("wind_speed_kt");
+    wind_dir_deg = wind_node.getHandle<double>("wind_dir_deg");
+    wind_east_mps = wind_node.getHandle<double>("wind_east_mps");
+    wind_north_mps = wind_node.getHandle<double>("wind_north_mps");
+    wind_true_airspeed_kt = wind_node.getHandle<double>("true_airspeed_kt");
+    wind_true_heading_deg = wind_node.getHandle<double>("true_heading_deg");
+    wind_true_east_mps = wind_node.getHandle<double>("true_airspeed_east_mps");
+    wind_true_north_mps
+	= wind_node.getHandle<double>("true_airspeed_north_mps");
+    wind_pitot_scale_factor
+	= wind_node.getHandle<double>("pitot_scale_factor");
     
-    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
     pyPropertyNode logging_node = pyGetNode("/config/logging", true);
-    remote_link_skip = remote_link_node.getLong("filter_skip");
     logging_skip = logging_node.getLong("filter_skip");
 
     // traverse configured modules
@@ -93,7 +230,6 @@ void Filter_init() {
     printf("Found %d filter sections\n", (int)children.size());
     for ( unsigned int i = 0; i < children.size(); i++ ) {
 	pyPropertyNode section = group_node.getChild(children[i].c_str());
-	sections.push_back(section);
 	string module = section.getString("module");
 	bool enabled = section.getBool("enable");
 	if ( !enabled ) {
@@ -104,15 +240,70 @@ void Filter_init() {
 	printf("filter: %d = %s\n", i, module.c_str());
 	if ( module == "null" ) {
 	    // do nothing
-	} else if ( module == "nav_eigen" ) {
-	    nav_eigen_init( output_path.str(), &section );
-	} else if ( module == "nav_eigen_mag" ) {
-	    nav_eigen_mag_init( output_path.str(), &section );
-	} else if ( module == "umn_quat" ) {
-	    umngnss_quat_init( output_path.str(), &section );
-	} else {
+	    continue;
+	}
+	const filter_module *m = NULL;
+	for ( int j = 0; j < num_modules; j++ ) {
+	    if ( module == modules[j].name ) {
+		m = &modules[j];
+	    }
+	}
+	if ( m == NULL ) {
 	    printf("Unknown filter = '%s' in config file\n",
 		   module.c_str());
+	    continue;
+	}
+	m->init( output_path.str(), &section );
+
+	filter_section *s = new filter_section;
+	s->index = i;
+	s->module = m;
+	s->threaded = false;
+	s->state = JOB_IDLE;
+	s->result = false;
+	s->skipped = pyGetNode(output_path.str(), true)
+	    .getHandle<long>("worker_skipped");
+	if ( i > 0 ) {
+	    // the filter modules keep their state in file statics, so a
+	    // module can only be moved off the main thread if no other
+	    // section uses it
+	    s->threaded = true;
+	    if ( section.hasChild("threaded") ) {
+		s->threaded = section.getBool("threaded");
+	    }
+	    for ( unsigned int j = 0; j < sections.size(); j++ ) {
+		if ( sections[j]->module == m ) {
+		    s->threaded = false;
+		    sections[j]->threaded = false;
+		}
+	    }
+	}
+	sections.push_back(s);
+    }
+
+    // worker threads for the secondary filters (/config/filter_threads,
+    // defaults to one per threaded filter, 0 runs everything on the
+    // main thread)
+    int threaded = 0;
+    for ( unsigned int i = 0; i < sections.size(); i++ ) {
+	if ( sections[i]->threaded ) {
+	    threaded++;
+	}
+    }
+    int num_threads = threaded;
+    pyPropertyNode config_node = pyGetNode("/config", true);
+    if ( config_node.hasChild("filter_threads") ) {
+	num_threads = config_node.getLong("filter_threads");
+    }
+    if ( threaded > 0 && num_threads > 0 ) {
+	if ( workers.start( num_threads ) ) {
+	    printf("filter: %d secondary filter(s) on %d worker thread(s)\n",
+		   threaded, workers.size());
+	}
+    }
+    if ( workers.size() == 0 ) {
+	for ( unsigned int i = 0; i < sections.size(); i++ ) {
+	    sections[i]->threaded = false;
 	}
     }
 
@@ -121,25 +312,25 @@ void Filter_init() {
 
 
 static void update_euler_rates() {
-    double phi = orient_node.getDouble("roll_deg") * SGD_DEGREES_TO_RADIANS;
-    double the = orient_node.getDouble("pitch_deg") * SGD_DEGREES_TO_RADIANS;
+    double phi = orient_roll_deg.get() * SGD_DEGREES_TO_RADIANS;
+    double the = orient_pitch_deg.get() * SGD_DEGREES_TO_RADIANS;
 
     // direct computation of euler rates given body rates and estimated
     // attitude (based on googled references):
     // http://www.princeton.edu/~stengel/MAE331Lecture9.pdf
     // http://www.mathworks.com/help/aeroblks/customvariablemass6dofeulerangles.html
 
-    double p = imu_node.getDouble("p_rad_sec");
-    double q = imu_node.getDouble("q_rad_sec");
-    double r = imu_node.getDouble("r_rad_sec");
+    double p = imu_p.get();
+    double q = imu_q.get();
+    double r = imu_r.get();
 
     if ( SGD_PI_2 - fabs(the) > 0.00001 ) {
 	double phi_dot = p + q * sin(phi) * tan(the) + r * cos(phi) * tan(the);
 	double the_dot = q * cos(phi) - r * sin(phi);
 	double psi_dot = q * sin(phi) / cos(the) + r * cos(phi) / cos(the);
-	orient_node.setDouble("phi_dot_rad_sec", phi_dot);
-	orient_node.setDouble("the_dot_rad_sec", the_dot);
-	orient_node.setDouble("psi_dot_rad_sec", psi_dot);
+	orient_phi_dot.set(phi_dot);
+	orient_the_dot.set(the_dot);
+	orient_psi_dot.set(psi_dot);
 	/* printf("dt=%.3f q=%.3f q(ned)=%.3f phi(dot)=%.3f\n",
 	   dt,imu_node.getDouble("q_rad_sec"), dq/dt, phi_dot);  */
 	/* printf("%.3f %.3f %.3f %.3f\n",
@@ -153,21 +344,19 @@ static void update_ground(double dt) {
     // over the most recent 30 seconds that we are !is_airborne
     if ( !ground_alt_calibrated ) {
 	ground_alt_calibrated = true;
-	ground_alt_filt.init( filter_node.getDouble("altitude_m") );
+	ground_alt_filt.init( filt_alt_m.get() );
     }
 
-    if ( ! task_node.getBool("is_airborne") ) {
+    if ( ! task_is_airborne.get() ) {
 	// ground reference altitude averaged current altitude over
 	// first 30 seconds while on the ground
-	ground_alt_filt.update( filter_node.getDouble("altitude_m"), dt );
-	pos_filter_node.setDouble( "altitude_ground_m",
-				   ground_alt_filt.get_value() );
+	ground_alt_filt.update( filt_alt_m.get(), dt );
+	pos_filt_ground_m.set( ground_alt_filt.get_value() );
     }
 
-    float agl_m = filter_node.getDouble( "altitude_m" )
-	- ground_alt_filt.get_value();
-    pos_filter_node.setDouble( "altitude_agl_m", agl_m );
-    pos_filter_node.setDouble( "altitude_agl_ft", agl_m * SG_METER_TO_FEET );
+    float agl_m = filt_alt_m.get() - ground_alt_filt.get_value();
+    pos_filt_agl_m.set( agl_m );
+    pos_filt_agl_ft.set( agl_m * SG_METER_TO_FEET );
 }
 
 
@@ -177,20 +366,20 @@ static void update_wind(double dt) {
     // Estimate wind direction and speed based on ground track speed
     // versus aircraft heading and indicated airspeed.
 
-    double airspeed_kt = airdata_node.getDouble("airspeed_kt");
-    if ( ! task_node.getBool("is_airborne") ) {
+    double airspeed_kt = airdata_airspeed_kt.get();
+    if ( ! task_is_airborne.get() ) {
 	// System predicts we are not flying.  The wind estimation
 	// code only works in flight.
 	return;
     }
 
     double psi = SGD_PI_2
-	- orient_node.getDouble("heading_deg") * SG_DEGREES_TO_RADIANS;
+	- orient_heading_deg.get() * SG_DEGREES_TO_RADIANS;
     double pitot_scale = pitot_scale_filt.get_value();
     double ue = cos(psi) * (airspeed_kt * pitot_scale * SG_KT_TO_MPS);
     double un = sin(psi) * (airspeed_kt * pitot_scale * SG_KT_TO_MPS);
-    double we = ue - filter_node.getDouble("ve_ms");
-    double wn = un - filter_node.getDouble("vn_ms");
+    double we = ue - filt_ve_ms.get();
+    double wn = un - filt_vn_ms.get();
 
     //static double filt_we = 0.0, filt_wn = 0.0;
     //filt_we = 0.9998 * filt_we + 0.0002 * we;
@@ -204,26 +393,26 @@ static void update_wind(double dt) {
     double wind_deg = 90
 	- atan2( wn_filt_val, we_filt_val ) * SGD_RADIANS_TO_DEGREES;
     if ( wind_deg < 0 ) { wind_deg += 360.0; }
-    double wind_speed_kt = sqrt( we_filt_val*we_filt_val
-				 + wn_filt_val*wn_filt_val ) * SG_MPS_TO_KT;
+    double wind_speed = sqrt( we_filt_val*we_filt_val
+			      + wn_filt_val*wn_filt_val ) * SG_MPS_TO_KT;
 
-    wind_node.setDouble( "wind_speed_kt", wind_speed_kt );
-    wind_node.setDouble( "wind_dir_deg", wind_deg );
-    wind_node.setDouble( "wind_east_mps", we_filt_val );
-    wind_node.setDouble( "wind_north_mps", wn_filt_val );
+    wind_speed_kt.set( wind_speed );
+    wind_dir_deg.set( wind_deg );
+    wind_east_mps.set( we_filt_val );
+    wind_north_mps.set( wn_filt_val );
 
     // estimate pitot tube bias
-    double true_e = we_filt_val + filter_node.getDouble("ve_ms");
-    double true_n = wn_filt_val + filter_node.getDouble("vn_ms");
+    double true_e = we_filt_val + filt_ve_ms.get();
+    double true_n = wn_filt_val + filt_vn_ms.get();
 
     double true_deg = 90 - atan2( true_n, true_e ) * SGD_RADIANS_TO_DEGREES;
     if ( true_deg < 0 ) { true_deg += 360.0; }
     double true_speed_kt = sqrt( true_e*true_e + true_n*true_n ) * SG_MPS_TO_KT;
 
-    wind_node.setDouble( "true_airspeed_kt", true_speed_kt );
-    wind_node.setDouble( "true_heading_deg", true_deg );
-    wind_node.setDouble( "true_airspeed_east_mps", true_e );
-    wind_node.setDouble( "true_airspeed_north_mps", true_n );
+    wind_true_airspeed_kt.set( true_speed_kt );
+    wind_true_heading_deg.set( true_deg );
+    wind_true_east_mps.set( true_e );
+    wind_true_north_mps.set( true_n );
 
     double ps = 1.0;
     if ( airspeed_kt > 1.0 ) {
@@ -234,7 +423,7 @@ static void update_wind(double dt) {
     }
 
     pitot_scale_filt.update(ps, dt);
-    wind_node.setDouble( "pitot_scale_factor", pitot_scale_filt.get_value() );
+    wind_pitot_scale_factor.set( pitot_scale_filt.get_value() );
 
     // if ( display_on ) {
     //   printf("true: %.2f kt  %.1f deg (scale = %.4f)\n", true_speed_kt, true_deg, pitot_scale_filt);
@@ -247,33 +436,29 @@ static void update_wind(double dt) {
     if ( groundtrack_est_deg < 0 ) { groundtrack_est_deg += 360.0; }
     double groundspeed_est_ms = sqrt( ve_est*ve_est + vn_est*vn_est );
     double groundspeed_est_kt = groundspeed_est_ms * SG_MPS_TO_KT;
-    vel_node.setDouble( "groundspeed_est_ms", groundspeed_est_ms );
-    orient_node.setDouble( "groundtrack_est_deg", groundtrack_est_deg );
+    vel_groundspeed_est_ms.set( groundspeed_est_ms );
+    orient_groundtrack_est_deg.set( groundtrack_est_deg );
 }
 
 
 static void publish_values() {
-    orient_node.setDouble( "roll_deg", filter_node.getDouble("roll_deg") );
-    orient_node.setDouble( "pitch_deg", filter_node.getDouble("pitch_deg") );
-    orient_node.setDouble( "heading_deg", filter_node.getDouble("heading_deg") );
-    pos_node.setDouble( "latitude_deg", filter_node.getDouble("latitude_deg") );
-    pos_node.setDouble( "longitude_deg", filter_node.getDouble("longitude_deg") );
-    pos_filter_node.setDouble("altitude_m", filter_node.getDouble("altitude_m"));
-    pos_filter_node.setDouble("altitude_ft", filter_node.getDouble("altitude_ft"));
-    vel_node.setDouble( "vn_ms", filter_node.getDouble("vn_ms") );
-    vel_node.setDouble( "ve_ms", filter_node.getDouble("ve_ms") );
-    vel_node.setDouble( "vd_ms", filter_node.getDouble("vd_ms") );
-    filter_group_node.setDouble( "timestamp",
-				 filter_node.getDouble("timestamp") );
-    status_node.setString( "navigation",
-			   filter_node.getString("navigation") );
+    orient_roll_deg.set( filt_roll_deg.get() );
+    orient_pitch_deg.set( filt_pitch_deg.get() );
+    orient_heading_deg.set( filt_heading_deg.get() );
+    pos_lat_deg.set( filt_lat_deg.get() );
+    pos_lon_deg.set( filt_lon_deg.get() );
+    pos_filt_alt_m.set( filt_alt_m.get() );
+    pos_filt_alt_ft.set( filt_alt_ft.get() );
+    vel_vn_ms.set( filt_vn_ms.get() );
+    vel_ve_ms.set( filt_ve_ms.get() );
+    vel_vd_ms.set( filt_vd_ms.get() );
+    filter_group_timestamp.set( filt_timestamp.get() );
+    status_navigation.set( filt_navigation.get() );
     bool use_filter = true;
     bool use_gps = !use_filter;
     if ( use_filter ) {
-	orient_node.setDouble( "groundtrack_deg",
-			       filter_node.getDouble("groundtrack_deg") );
-	vel_node.setDouble( "groundspeed_ms",
-			    filter_node.getDouble("groundspeed_ms") );
+	orient_groundtrack_deg.set( filt_groundtrack_deg.get() );
+	vel_groundspeed_ms.set( filt_groundspeed_ms.get() );
     } else if ( use_gps ) {
 	const double R2D = 57.295779513082323;
 	double vn = gps_node.getDouble("vn_ms");
@@ -282,8 +467,7 @@ static void publish_values() {
 	filter_node.setDouble( "groundspeed_ms", sqrt(vn*vn + ve*ve) );
     }
    
-    vel_node.setDouble( "vertical_speed_fps",
-			filter_node.getDouble("vertical_speed_fps") );
+    vel_vertical_speed_fps.set( filt_vertical_speed_fps.get() );
     
     // select official source (currently AGL is pressure based,
     // absolute ground alt is based on average gps/filter value at
@@ -316,22 +500,25 @@ static void publish_values() {
 
     // the following block favor the filter based altitude which can
     // be adversely affected (significantly) by gps altitude errors.
-    pos_node.setDouble( "altitude_m",
-			pos_filter_node.getDouble("altitude_m") );
-    pos_node.setDouble( "altitude_ft",
-			pos_filter_node.getDouble("altitude_ft") );
-    pos_node.setDouble( "altitude_agl_m",
-			pos_filter_node.getDouble("altitude_agl_m") );
-    pos_node.setDouble( "altitude_agl_ft",
-			pos_filter_node.getDouble("altitude_agl_ft") );
-    pos_node.setDouble( "altitude_ground_m",
-			pos_filter_node.getDouble("altitude_ground_m") );
+    pos_alt_m.set( pos_filt_alt_m.get() );
+    pos_alt_ft.set( pos_filt_alt_ft.get() );
+    pos_agl_m.set( pos_filt_agl_m.get() );
+    pos_agl_ft.set( pos_filt_agl_ft.get() );
+    pos_ground_m.set( pos_filt_ground_m.get() );
+}
+
+// worker thread side of a secondary filter step (touches nothing but
+// the module's own state)
+static void run_filter_job( void *arg ) {
+    filter_section *s = (filter_section *)arg;
+    s->result = s->module->compute();
+    s->state.store( JOB_DONE, std::memory_order_release );
 }
 
 bool Filter_update() {
     filter_prof.start();
 
-    double imu_time = imu_node.getDouble("timestamp");
+    double imu_time = imu_timestamp.get();
     double imu_dt = imu_time - last_imu_time;
     bool fresh_filter_data = false;
 
@@ -339,26 +526,37 @@ bool Filter_update() {
     if ( imu_dt > 1.0 ) { imu_dt = 0.01; }
     if ( imu_dt < 0.0 ) { imu_dt = 0.01; }
 
-    static int remote_link_count = 0;
     static int logging_count = 0;
 
     // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string module = sections[i].getString("module");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
+    for ( unsigned int k = 0; k < sections.size(); k++ ) {
+	filter_section *s = sections[k];
+	int i = s->index;
+	bool fresh = false;
+	if ( s->threaded ) {
+	    if ( s->state.load(std::memory_order_acquire) == JOB_BUSY ) {
+		// still working on the last frame
+		s->skipped.set( s->skipped.get() + 1 );
+		continue;
+	    }
+	    if ( s->state.load(std::memory_order_relaxed) == JOB_DONE ) {
+		s->module->publish();
+		fresh = s->result;
+	    }
+	    s->module->sample();
+	    s->state.store( JOB_BUSY, std::memory_order_relaxed );
+	    if ( ! workers.submit( run_filter_job, s ) ) {
+		run_filter_job( s );
+	    }
+	} else {
+	    s->module->sample();
+	    fresh = s->module->compute();
+	    s->module->publish();
 	}
-	if ( module == "null" ) {
-	    // do nothing
-	} else if ( module == "nav_eigen" ) {
-	    fresh_filter_data = nav_eigen_update();
-	} else if ( module == "nav_eigen_mag" ) {
-	    fresh_filter_data = nav_eigen_mag_update();
-	} else if ( module == "umn_quat" ) {
-	    fresh_filter_data = umngnss_quat_update();
+	if ( i == 0 ) {
+	    fresh_filter_data = fresh;
 	}
-	if ( fresh_filter_data ) {
+	if ( fresh ) {
 	    if ( i == 0 ) {
 		// only for primary filter
 		update_euler_rates();
@@ -368,11 +566,9 @@ bool Filter_update() {
 	    }
 	}
 
-	bool send_remote_link = false;
-	if ( remote_link_count < 0 ) {
-	    send_remote_link = true;
-	    remote_link_count = remote_link_skip;
-	}
+	// the primary section goes out from the frame snapshot
+	// (see comms/remote_link.hxx)
+	bool send_remote_link = i > 0 && remote_link->is_open();
 	
 	bool send_logging = false;
 	if ( logging_count < 0 ) {
@@ -395,7 +591,6 @@ bool Filter_update() {
     filter_prof.stop();
 
     if ( fresh_filter_data ) {
-        remote_link_count--;
         logging_count--;
     }
 	     
@@ -412,21 +607,13 @@ bool Filter_update() {
 
 
 void Filter_close() {
+    // let any filter steps in flight finish
+    workers.stop();
+
     // traverse configured modules
     for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string module = sections[i].getString("module");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( module == "null" ) {
-	    // do nothing
-	} else if ( module == "nav_eigen" ) {
-	    nav_eigen_close();
-	} else if ( module == "nav_eigen_mag" ) {
-	    nav_eigen_mag_close();
-	} else if ( module == "umn_quat" ) {
-	    umngnss_quat_close();
-	}
+	sections[i]->module->close();
+	delete sections[i];
     }
+    sections.clear();
 }
@@ -18,7 +18,7 @@
 #include <math.h>
 #include <eigen3/Eigen/Core>
 #include <eigen3/Eigen/Geometry>
-#include <eigen3/Eigen/LU>
+#include <eigen3/Eigen/Cholesky>
 using namespace Eigen;
 
 #include <iostream>
@@ -28,6 +28,7 @@ using std::endl;
 
 #include "nav_functions.hxx"
 #include "nav_interface.hxx"
+#include "EKF_15state_quat.hxx"
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //error characteristics of navigation parameters
@@ -57,25 +58,13 @@ const double P_GB_INIT = 0.01745;  // 5 deg/s
 const double Rew = 6.359058719353925e+006; // earth radius
 const double Rns = 6.386034030458164e+006; // earth radius
 
-// define some types for notational convenience and consistency
-typedef Matrix<double,6,6> Matrix6d;
-typedef Matrix<double,12,12> Matrix12d;
-typedef Matrix<double,15,15> Matrix15d;
-typedef Matrix<double,6,15> Matrix6x15d;
-typedef Matrix<double,15,6> Matrix15x6d;
-typedef Matrix<double,15,12> Matrix15x12d;
-typedef Matrix<double,6,1> Vector6f;
-typedef Matrix<double,15,1> Vector15f;
-
-static Matrix15d F, PHI, P, Qw, Q, ImKH, KRKt, I15 /* identity */;
-static Matrix15x12d G;
+static Matrix15d P;
 static Matrix15x6d K;
-static Vector15f x;
-static Matrix12d Rw;
-static Matrix6x15d H;
-static Matrix6d R;
-static Vector6f y;
-static Matrix3d C_N2B, C_B2N, I3 /* identity */, temp33;
+static Vector15d x;
+static Vector12d Rw;	// diagonal of Rw
+static Vector6d R;	// diagonal of R
+static Vector6d y;
+static Matrix3d C_N2B, C_B2N, I3 /* identity */;
 static Vector3d grav, f_b, om_ib, nr, pos_ins_ecef, pos_ins_ned, pos_gps, pos_gps_ecef, pos_gps_ned, dx;
 
 static Quaterniond quat; // fixme, make state persist here, not in nav
@@ -84,34 +73,128 @@ static double tprev;
 
 static NAVdata nav;
 
-////////// BRT I think there are some several identity and sparse matrices, so probably some optimization still left there
 ////////// BRT Seems like a lot of the transforms could be more efficiently done with just a matrix or vector multiply
-////////// BRT Probably could do a lot of block operations with F, i.e. F.block(j,k) = C_B2N, etc
 ////////// BRT A lot of these multi line equations with temp matrices can be compressed
 	
+// The jacobian F (and so PHI = I + F*dt) only has a handful of non
+// zero 3x3 blocks (C = C_B2N, ta = dt/TAU_A, tg = dt/TAU_G):
+//
+//          pos    vel    att              abias     gbias
+//   pos  [ I      I*dt   0                0         0          ]
+//   vel  [ vp     I      -2*C*sk(f_b)*dt  -C*dt     0          ]
+//   att  [ 0      0      I - sk(om)*dt    0         -0.5*I*dt  ]
+//   abias[ 0      0      0                (1-ta)*I  0          ]
+//   gbias[ 0      0      0                0         (1-tg)*I   ]
+//
+// where vp is the single gs2pos term PHI(5,2).  G*Rw*G' is block
+// diagonal as well, so both products are done a block row at a time
+// instead of as dense 15x15 products.
+struct PhiBlocks {
+    double dt;
+    double vp;			// PHI(5,2)
+    Matrix3d va;		// vel <- att
+    Matrix3d vab;		// vel <- accel bias
+    Matrix3d aa;		// att <- att
+    double agb;			// att <- gyro bias (diagonal)
+    double abab;		// accel bias (diagonal)
+    double gbgb;		// gyro bias (diagonal)
+};
+
+// out = PHI * X
+template <typename Derived>
+static inline void phi_mult( const PhiBlocks &phi,
+			     const MatrixBase<Derived> &X, Matrix15d &out )
+{
+    out.middleRows<3>(0) = X.template middleRows<3>(0)
+	+ phi.dt * X.template middleRows<3>(3);
+    out.middleRows<3>(3) = X.template middleRows<3>(3)
+	+ phi.va * X.template middleRows<3>(6)
+	+ phi.vab * X.template middleRows<3>(9);
+    out.row(5) += phi.vp * X.row(2);
+    out.middleRows<3>(6) = phi.aa * X.template middleRows<3>(6)
+	+ phi.agb * X.template middleRows<3>(12);
+    out.middleRows<3>(9) = phi.abab * X.template middleRows<3>(9);
+    out.middleRows<3>(12) = phi.gbgb * X.template middleRows<3>(12);
+}
+
+void ekf15_time_update( Matrix15d &P, const Matrix3d &C_B2N,
+			const Vector3d &f_b, const Vector3d &om_ib,
+			const Vector12d &rw, double dt )
+{
+    PhiBlocks phi;
+    phi.dt = dt;
+    phi.vp = -2 * g / EARTH_RADIUS * dt;
+    phi.va = -2.0 * dt * (C_B2N * sk(f_b));
+    phi.vab = -dt * C_B2N;
+    phi.aa = Matrix3d::Identity() - dt * sk(om_ib);
+    phi.agb = -0.5 * dt;
+    phi.abab = 1.0 - dt / TAU_A;
+    phi.gbgb = 1.0 - dt / TAU_G;
+
+    // M = PHI*P*PHI' = PHI*(PHI*P)' since P is symmetric
+    Matrix15d A, M;
+    phi_mult( phi, P, A );
+    phi_mult( phi, A.transpose(), M );
+
+    // Discrete process noise Qw = dt*G*Rw*G' has four diagonal
+    // blocks, add in PHI*Qw one block column at a time
+    Matrix3d Qv = C_B2N * (dt * rw.segment<3>(0)).asDiagonal()
+	* C_B2N.transpose();
+    Vector3d qa = 0.25 * dt * rw.segment<3>(3);
+    Vector3d qab = dt * rw.segment<3>(6);
+    Vector3d qgb = dt * rw.segment<3>(9);
+
+    M.block<3,3>(0,3) += dt * Qv;
+    M.block<3,3>(3,3) += Qv;
+    M.block<3,3>(3,6) += phi.va * qa.asDiagonal();
+    M.block<3,3>(6,6) += phi.aa * qa.asDiagonal();
+    M.block<3,3>(3,9) += phi.vab * qab.asDiagonal();
+    M.block<3,3>(9,9).diagonal() += phi.abab * qab;
+    M.block<3,3>(6,12).diagonal() += phi.agb * qgb;
+    M.block<3,3>(12,12).diagonal() += phi.gbgb * qgb;
+
+    // P = 0.5*(M+M') (this also makes Q = 0.5*(PHI*Qw + (PHI*Qw)'))
+    P = (M + M.transpose()) * 0.5;
+}
+
+void ekf15_measurement_update( Matrix15d &P, Matrix15x6d &K,
+			       const Vector6d &r )
+{
+    // H = [ I6 0 ] so H*P is the top 6 rows of P and H*P*H' is the
+    // top left corner.
+    Matrix6d S = P.topLeftCorner<6,6>();
+    S.diagonal() += r;
+
+    // K = P*H'*inv(S), S is symmetric positive definite so solve
+    // S*K' = H*P with a cholesky factorization instead of inverting
+    K = S.ldlt().solve( P.topRows<6>() ).transpose();
+
+    // Joseph form: P = (I-K*H)*P*(I-K*H)' + K*R*K'
+    Matrix15d A = P - K * P.topRows<6>();
+    Matrix15d M = A - A.leftCols<6>() * K.transpose();
+    M += K * r.asDiagonal() * K.transpose();
+    P = (M + M.transpose()) * 0.5;
+}
+
 NAVdata init_nav(IMUdata imu, GPSdata gps) {
     // configuration choices
     bool internal_gyro_cal = false;
 
-    I15.setIdentity();
     I3.setIdentity();
 
     // Assemble the matrices
     // .... gravity, g
     grav(2) = g;
 	
-    // ... H
-    H.topLeftCorner(6,6).setIdentity();
-
     // first order correlation + white noise, tau = time constant for correlation
     // gain on white noise plus gain on correlation
     // Rw small - trust time update, Rw more - lean on measurement update
     // split between accels and gyros and / or noise and correlation
     // ... Rw
-    Rw(0,0) = SIG_W_AX*SIG_W_AX;	Rw(1,1) = SIG_W_AY*SIG_W_AY;	      Rw(2,2) = SIG_W_AZ*SIG_W_AZ; //1 sigma on noise
-    Rw(3,3) = SIG_W_GX*SIG_W_GX;	Rw(4,4) = SIG_W_GY*SIG_W_GY;	      Rw(5,5) = SIG_W_GZ*SIG_W_GZ;
-    Rw(6,6) = 2*SIG_A_D*SIG_A_D/TAU_A;	Rw(7,7) = 2*SIG_A_D*SIG_A_D/TAU_A;    Rw(8,8) = 2*SIG_A_D*SIG_A_D/TAU_A;
-    Rw(9,9) = 2*SIG_G_D*SIG_G_D/TAU_G;	Rw(10,10) = 2*SIG_G_D*SIG_G_D/TAU_G;  Rw(11,11) = 2*SIG_G_D*SIG_G_D/TAU_G;
+    Rw(0) = SIG_W_AX*SIG_W_AX;	Rw(1) = SIG_W_AY*SIG_W_AY;	      Rw(2) = SIG_W_AZ*SIG_W_AZ; //1 sigma on noise
+    Rw(3) = SIG_W_GX*SIG_W_GX;	Rw(4) = SIG_W_GY*SIG_W_GY;	      Rw(5) = SIG_W_GZ*SIG_W_GZ;
+    Rw(6) = 2*SIG_A_D*SIG_A_D/TAU_A;	Rw(7) = 2*SIG_A_D*SIG_A_D/TAU_A;    Rw(8) = 2*SIG_A_D*SIG_A_D/TAU_A;
+    Rw(9) = 2*SIG_G_D*SIG_G_D/TAU_G;	Rw(10) = 2*SIG_G_D*SIG_G_D/TAU_G;  Rw(11) = 2*SIG_G_D*SIG_G_D/TAU_G;
 	
     // ... P (initial)
     P(0,0) = P_P_INIT*P_P_INIT; 	P(1,1) = P_P_INIT*P_P_INIT; 	      P(2,2) = P_P_INIT*P_P_INIT;
@@ -129,8 +212,8 @@ NAVdata init_nav(IMUdata imu, GPSdata gps) {
     nav.Pgb[0] = P(12,12);	        nav.Pgb[1] = P(13,13);	              nav.Pgb[2] = P(14,14);
 	
     // ... R
-    R(0,0) = SIG_GPS_P_NE*SIG_GPS_P_NE;	R(1,1) = SIG_GPS_P_NE*SIG_GPS_P_NE;   R(2,2) = SIG_GPS_P_D*SIG_GPS_P_D;
-    R(3,3) = SIG_GPS_V*SIG_GPS_V;	R(4,4) = SIG_GPS_V*SIG_GPS_V;	      R(5,5) = SIG_GPS_V*SIG_GPS_V;
+    R(0) = SIG_GPS_P_NE*SIG_GPS_P_NE;	R(1) = SIG_GPS_P_NE*SIG_GPS_P_NE;   R(2) = SIG_GPS_P_D*SIG_GPS_P_D;
+    R(3) = SIG_GPS_V*SIG_GPS_V;	R(4) = SIG_GPS_V*SIG_GPS_V;	      R(5) = SIG_GPS_V*SIG_GPS_V;
 	
     // .. then initialize states with GPS Data
     nav.lat = gps.lat*D2R;
@@ -231,64 +314,8 @@ NAVdata get_nav(IMUdata imu, GPSdata gps) {
     nav.lon += imu_dt*dx(1);
     nav.alt += imu_dt*dx(2);
 	
-    // JACOBIAN
-    F.setZero();
-    // ... pos2gs
-    F(0,3) = 1.0; 	F(1,4) = 1.0; 	F(2,5) = 1.0;
-    // ... gs2pos
-    F(5,2) = -2 * g / EARTH_RADIUS;
-	
-    // ... gs2att
-    temp33 = C_B2N * sk(f_b);
-	
-    F(3,6) = -2.0*temp33(0,0);  F(3,7) = -2.0*temp33(0,1);  F(3,8) = -2.0*temp33(0,2);
-    F(4,6) = -2.0*temp33(1,0);  F(4,7) = -2.0*temp33(1,1);  F(4,8) = -2.0*temp33(1,2);
-    F(5,6) = -2.0*temp33(2,0);  F(5,7) = -2.0*temp33(2,1);  F(5,8) = -2.0*temp33(2,2);
-	
-    // ... gs2acc
-    F(3,9) = -C_B2N(0,0);  F(3,10) = -C_B2N(0,1);  F(3,11) = -C_B2N(0,2);
-    F(4,9) = -C_B2N(1,0);  F(4,10) = -C_B2N(1,1);  F(4,11) = -C_B2N(1,2);
-    F(5,9) = -C_B2N(2,0);  F(5,10) = -C_B2N(2,1);  F(5,11) = -C_B2N(2,2);
-	
-    // ... att2att
-    temp33 = sk(om_ib);
-    F(6,6) = -temp33(0,0);  F(6,7) = -temp33(0,1);  F(6,8) = -temp33(0,2);
-    F(7,6) = -temp33(1,0);  F(7,7) = -temp33(1,1);  F(7,8) = -temp33(1,2);
-    F(8,6) = -temp33(2,0);  F(8,7) = -temp33(2,1);  F(8,8) = -temp33(2,2);
-	
-    // ... att2gyr
-    F(6,12) = -0.5;
-    F(7,13) = -0.5;
-    F(8,14) = -0.5;
-	
-    // ... Accel Markov Bias
-    F(9,9) = -1.0/TAU_A;    F(10,10) = -1.0/TAU_A;  F(11,11) = -1.0/TAU_A;
-    F(12,12) = -1.0/TAU_G;  F(13,13) = -1.0/TAU_G;  F(14,14) = -1.0/TAU_G;
-	
-    // State Transition Matrix: PHI = I15 + F*dt;
-    PHI = I15 + F * imu_dt;
-	
-    // Process Noise
-    G.setZero();
-    G(3,0) = -C_B2N(0,0);   G(3,1) = -C_B2N(0,1);   G(3,2) = -C_B2N(0,2);
-    G(4,0) = -C_B2N(1,0);   G(4,1) = -C_B2N(1,1);   G(4,2) = -C_B2N(1,2);
-    G(5,0) = -C_B2N(2,0);   G(5,1) = -C_B2N(2,1);   G(5,2) = -C_B2N(2,2);
-	
-    G(6,3) = -0.5;
-    G(7,4) = -0.5;
-    G(8,5) = -0.5;
-	
-    G(9,6) = 1.0; 	    G(10,7) = 1.0; 	    G(11,8) = 1.0;
-    G(12,9) = 1.0; 	    G(13,10) = 1.0; 	    G(14,11) = 1.0;
-
-    // Discrete Process Noise
-    Qw = G * Rw * G.transpose() * imu_dt;		// Qw = dt*G*Rw*G'
-    Q = PHI * Qw;					// Q = (I+F*dt)*Qw
-    Q = (Q + Q.transpose()) * 0.5;			// Q = 0.5*(Q+Q')
-	
-    // Covariance Time Update
-    P = PHI * P * PHI.transpose() + Q;			// P = PHI*P*PHI' + Q
-    P = (P + P.transpose()) * 0.5;			// P = 0.5*(P+P')
+    // Covariance Time Update (P = PHI*P*PHI' + Q)
+    ekf15_time_update( P, C_B2N, f_b, om_ib, Rw, imu_dt );
 	
     nav.Pp[0] = P(0,0);     nav.Pp[1] = P(1,1);     nav.Pp[2] = P(2,2);
     nav.Pv[0] = P(3,3);     nav.Pv[1] = P(4,4);     nav.Pv[2] = P(5,5);
@@ -327,16 +354,8 @@ NAVdata get_nav(IMUdata imu, GPSdata gps) {
 	y(4) = gps.ve - nav.ve;
 	y(5) = gps.vd - nav.vd;
 		
-	// Kalman Gain
-	// K = P*H'*inv(H*P*H'+R)
-	K = P * H.transpose() * (H * P * H.transpose() + R).inverse();
-		
-	// Covariance Update
-	ImKH = I15 - K * H;	                // ImKH = I - K*H
-		
-	KRKt = K * R * K.transpose();		// KRKt = K*R*K'
-		
-	P = ImKH * P * ImKH.transpose() + KRKt;	// P = ImKH*P*ImKH' + KRKt
+	// Kalman Gain and Covariance Update
+	ekf15_measurement_update( P, K, R );
 		
 	nav.Pp[0] = P(0,0); 	nav.Pp[1] = P(1,1); 	nav.Pp[2] = P(2,2);
 	nav.Pv[0] = P(3,3); 	nav.Pv[1] = P(4,4); 	nav.Pv[2] = P(5,5);
@@ -0,0 +1,37 @@
+/*! \file EKF_15state_quat.hxx
+ *	\brief 15 state EKF covariance kernels
+ *
+ *	\details The covariance time and measurement updates of the 15
+ *	state EKF, exposed so they can be exercised on their own (see
+ *	ekf_bench.cxx.)  State order is position (NED), velocity (NED),
+ *	attitude error, accel bias, gyro bias.
+ *	\ingroup nav_fcns
+ */
+
+#ifndef EKF_15STATE_QUAT_HXX_
+#define EKF_15STATE_QUAT_HXX_
+
+#include <eigen3/Eigen/Core>
+using namespace Eigen;
+
+// define some types for notational convenience and consistency
+typedef Matrix<double,6,6> Matrix6d;
+typedef Matrix<double,15,15> Matrix15d;
+typedef Matrix<double,15,6> Matrix15x6d;
+typedef Matrix<double,6,1> Vector6d;
+typedef Matrix<double,12,1> Vector12d;
+typedef Matrix<double,15,1> Vector15d;
+
+/// Covariance time update P = PHI*P*PHI' + Q with PHI = I + F*dt.
+/// rw is the diagonal of the (continuous) process noise Rw.
+void ekf15_time_update( Matrix15d &P, const Matrix3d &C_B2N,
+			const Vector3d &f_b, const Vector3d &om_ib,
+			const Vector12d &rw, double dt );
+
+/// GPS position/velocity measurement update of P (Joseph form.)
+/// r is the diagonal of the measurement noise R, the kalman gain
+/// is returned in K.
+void ekf15_measurement_update( Matrix15d &P, Matrix15x6d &K,
+			       const Vector6d &r );
+
+#endif // EKF_15STATE_QUAT_HXX_
@@ -22,6 +22,9 @@ static IMUdata imu_data;
 static GPSdata gps_data;
 static NAVdata nav_data;
 
+static bool nav_inited = false;
+static bool init_ready = false;
+
 // property nodes
 static pyPropertyNode imu_node;
 static pyPropertyNode gps_node;
@@ -81,8 +84,10 @@ static void umn2props(void) {
 	 nav_data.err_type == gps_aided )
     {
 	filter_node.setString( "navigation", "valid" );
+	filter_node.setBool( "navigation_valid", true );
     } else {
 	filter_node.setString( "navigation", "invalid" );
+	filter_node.setBool( "navigation_valid", false );
     }
 
     filter_node.setDouble( "p_bias", nav_data.gb[0] );
@@ -110,6 +115,7 @@ void nav_eigen_init( string output_path, pyPropertyNode *config ) {
     gps_node = pyGetNode("/sensors/gps", true);
     filter_node = pyGetNode(output_path, true);
     filter_node.setString( "navigation", "invalid" );
+    filter_node.setBool( "navigation_valid", false );
 
 #if 0
     // set tuning value for specific gps and imu noise characteristics
@@ -127,25 +133,38 @@ void nav_eigen_init( string output_path, pyPropertyNode *config ) {
 }
 
 
-bool nav_eigen_update() {
-    static bool nav_inited = false;
-
+// the update is split in three steps so the filter manager can run
+// the (pure computation) middle step on a worker thread.  Only
+// sample() and publish() touch the property tree.
+void nav_eigen_sample() {
     // fill in the UMN structures
     props2umn();
+    init_ready = GPS_age() < 1.0 && gps_node.getBool("settle");
+}
 
+
+bool nav_eigen_compute() {
     if ( nav_inited ) {
 	nav_data = get_nav( imu_data, gps_data );
-    } else {
-	if ( GPS_age() < 1.0 && gps_node.getBool("settle") ) {
-	    nav_data = init_nav( imu_data, gps_data );
-	    nav_inited = true;
-	}
+    } else if ( init_ready ) {
+	nav_data = init_nav( imu_data, gps_data );
+	nav_inited = true;
     }
+    return nav_inited;
+}
+
 
+void nav_eigen_publish() {
     // copy the nav_data results back to the property tree
     umn2props();
+}
 
-    return nav_inited;
+
+bool nav_eigen_update() {
+    nav_eigen_sample();
+    bool fresh = nav_eigen_compute();
+    nav_eigen_publish();
+    return fresh;
 }
 
 
@@ -15,6 +15,9 @@ using std::string;
 
 void nav_eigen_init( string output_path, pyPropertyNode *config );
 bool nav_eigen_update();
+void nav_eigen_sample();
+bool nav_eigen_compute();
+void nav_eigen_publish();
 void nav_eigen_close();
 
 
@@ -0,0 +1,193 @@
+//
+// ekf_bench.cxx - time the 15 state EKF covariance updates against the
+//                 original dense formulation and check they agree
+//
+// usage: ekf_bench [iterations]
+//
+// This code is released into the public domain.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <eigen3/Eigen/Core>
+#include <eigen3/Eigen/LU>
+using namespace Eigen;
+
+#include "nav_functions.hxx"
+#include "nav_interface.hxx"
+#include "EKF_15state_quat.hxx"
+
+typedef Matrix<double,12,12> Matrix12d;
+typedef Matrix<double,6,15> Matrix6x15d;
+typedef Matrix<double,15,12> Matrix15x12d;
+
+static const double TAU_A = 100.0;
+static const double TAU_G = 50.0;
+
+
+static double now() {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+
+// the dense time update as originally written in EKF_15state_quat.cxx
+static void dense_time_update( Matrix15d &P, const Matrix3d &C_B2N,
+			       const Vector3d &f_b, const Vector3d &om_ib,
+			       const Matrix12d &Rw, double dt )
+{
+    Matrix15d F, PHI, Qw, Q;
+    Matrix15x12d G;
+    Matrix3d temp33;
+
+    F.setZero();
+    F(0,3) = 1.0; 	F(1,4) = 1.0; 	F(2,5) = 1.0;
+    F(5,2) = -2 * g / EARTH_RADIUS;
+    temp33 = C_B2N * sk(f_b);
+    F.block<3,3>(3,6) = -2.0 * temp33;
+    F.block<3,3>(3,9) = -C_B2N;
+    F.block<3,3>(6,6) = -sk(om_ib);
+    F(6,12) = -0.5;	F(7,13) = -0.5;	F(8,14) = -0.5;
+    F(9,9) = -1.0/TAU_A;    F(10,10) = -1.0/TAU_A;  F(11,11) = -1.0/TAU_A;
+    F(12,12) = -1.0/TAU_G;  F(13,13) = -1.0/TAU_G;  F(14,14) = -1.0/TAU_G;
+    PHI = Matrix15d::Identity() + F * dt;
+
+    G.setZero();
+    G.block<3,3>(3,0) = -C_B2N;
+    G(6,3) = -0.5;	G(7,4) = -0.5;	G(8,5) = -0.5;
+    G(9,6) = 1.0; 	G(10,7) = 1.0; 	G(11,8) = 1.0;
+    G(12,9) = 1.0; 	G(13,10) = 1.0; G(14,11) = 1.0;
+
+    Qw = G * Rw * G.transpose() * dt;
+    Q = PHI * Qw;
+    Q = (Q + Q.transpose().eval()) * 0.5;
+    P = PHI * P * PHI.transpose() + Q;
+    P = (P + P.transpose().eval()) * 0.5;
+}
+
+// the dense measurement update as originally written
+static void dense_measurement_update( Matrix15d &P, Matrix15x6d &K,
+				      const Matrix6d &R )
+{
+    Matrix6x15d H;
+    H.setZero();
+    H.topLeftCorner(6,6).setIdentity();
+    K = P * H.transpose() * (H * P * H.transpose() + R).inverse();
+    Matrix15d ImKH = Matrix15d::Identity() - K * H;
+    Matrix15d KRKt = K * R * K.transpose();
+    P = ImKH * P * ImKH.transpose() + KRKt;
+}
+
+
+static double rel_err( const Matrix15d &a, const Matrix15d &b ) {
+    return (a - b).cwiseAbs().maxCoeff() / b.cwiseAbs().maxCoeff();
+}
+
+
+int main( int argc, char **argv ) {
+    int n = 200000;
+    if ( argc > 1 ) {
+	n = atoi( argv[1] );
+    }
+
+    // noise and initial covariance as set up by init_nav()
+    Vector12d rw;
+    rw << 0.05*0.05, 0.05*0.05, 0.05*0.05,
+	0.00175*0.00175, 0.00175*0.00175, 0.00175*0.00175,
+	2*0.01*0.01/TAU_A, 2*0.01*0.01/TAU_A, 2*0.01*0.01/TAU_A,
+	2*0.00025*0.00025/TAU_G, 2*0.00025*0.00025/TAU_G,
+	2*0.00025*0.00025/TAU_G;
+    Vector6d r;
+    r << 3.0*3.0, 3.0*3.0, 5.0*5.0, 1.0, 1.0, 1.0;
+    Matrix12d Rw = rw.asDiagonal();
+    Matrix6d R = r.asDiagonal();
+
+    Vector15d p0;
+    p0 << 100.0, 100.0, 100.0, 1.0, 1.0, 1.0,
+	0.34906*0.34906, 0.34906*0.34906, 3.14159*3.14159,
+	0.981*0.981, 0.981*0.981, 0.981*0.981,
+	0.01745*0.01745, 0.01745*0.01745, 0.01745*0.01745;
+    Matrix15d P_init = p0.asDiagonal();
+
+    const double dt = 0.01;
+    Vector3d f_b( 0.3, -0.2, -9.7 );
+    Vector3d om_ib( 0.02, -0.01, 0.05 );
+    Matrix3d C_B2N = quat2dcm( eul2quat(0.1, 0.05, 1.2) ).transpose();
+
+    // equivalence: fly both versions for a while (gps at 10hz) with a
+    // slowly turning attitude and compare
+    Matrix15d Pd = P_init, Ps = P_init;
+    Matrix15x6d Kd, Ks;
+    double max_p_err = 0.0;
+    double max_k_err = 0.0;
+    for ( int i = 0; i < 10000; i++ ) {
+	Matrix3d C = quat2dcm( eul2quat(0.1, 0.05, 1.2 + i * 0.001) )
+	    .transpose();
+	dense_time_update( Pd, C, f_b, om_ib, Rw, dt );
+	ekf15_time_update( Ps, C, f_b, om_ib, rw, dt );
+	double e = rel_err( Ps, Pd );
+	if ( e > max_p_err ) { max_p_err = e; }
+	if ( i % 10 == 0 ) {
+	    dense_measurement_update( Pd, Kd, R );
+	    ekf15_measurement_update( Ps, Ks, r );
+	    e = (Ks - Kd).cwiseAbs().maxCoeff() / Kd.cwiseAbs().maxCoeff();
+	    if ( e > max_k_err ) { max_k_err = e; }
+	    e = rel_err( Ps, Pd );
+	    if ( e > max_p_err ) { max_p_err = e; }
+	}
+    }
+    printf("max relative difference: P %.3g  K %.3g\n", max_p_err, max_k_err);
+
+    // timing.  Each measurement update starts from the same (converged)
+    // covariance so both versions do identical work.
+    Matrix15d P_conv = Ps;
+    double t0, td, ts;
+    double sink = 0.0;
+
+    Pd = P_init;
+    t0 = now();
+    for ( int i = 0; i < n; i++ ) {
+	dense_time_update( Pd, C_B2N, f_b, om_ib, Rw, dt );
+    }
+    td = now() - t0;
+    Ps = P_init;
+    t0 = now();
+    for ( int i = 0; i < n; i++ ) {
+	ekf15_time_update( Ps, C_B2N, f_b, om_ib, rw, dt );
+    }
+    ts = now() - t0;
+    sink += Pd(0,0) + Ps(0,0);
+    printf("time_update:        dense %7.3f usec  structured %7.3f usec  (%.1fx)\n",
+	   td * 1.0e6 / n, ts * 1.0e6 / n, td / ts);
+
+    t0 = now();
+    for ( int i = 0; i < n; i++ ) {
+	Pd = P_conv;
+	dense_measurement_update( Pd, Kd, R );
+    }
+    td = now() - t0;
+    t0 = now();
+    for ( int i = 0; i < n; i++ ) {
+	Ps = P_conv;
+	ekf15_measurement_update( Ps, Ks, r );
+    }
+    ts = now() - t0;
+    sink += Pd(0,0) + Ps(0,0);
+    printf("measurement_update: dense %7.3f usec  structured %7.3f usec  (%.1fx)\n",
+	   td * 1.0e6 / n, ts * 1.0e6 / n, td / ts);
+
+    if ( sink != sink ) {
+	printf("nan!\n");
+    }
+
+    const double tol = 1.0e-9;
+    if ( max_p_err > tol || max_k_err > tol ) {
+	printf("FAILED: results differ by more than %g\n", tol);
+	return 1;
+    }
+    return 0;
+}
@@ -15,6 +15,9 @@ using std::string;
 
 void nav_eigen_mag_init( string output_path, pyPropertyNode *config );
 bool nav_eigen_mag_update();
+void nav_eigen_mag_sample();
+bool nav_eigen_mag_compute();
+void nav_eigen_mag_publish();
 void nav_eigen_mag_close();
 
 
@@ -22,6 +22,9 @@ static struct imu imu_data;
 static struct gps gps_data;
 static struct nav nav_data;
 
+static bool umn_inited = false;
+static bool init_ready = false;
+
 // property nodes
 static pyPropertyNode imu_node;
 static pyPropertyNode gps_node;
@@ -76,8 +79,10 @@ static void umn2props(void) {
 	 nav_data.err_type == gps_aided )
     {
 	filter_node.setString( "navigation", "valid" );
+	filter_node.setBool( "navigation_valid", true );
     } else {
 	filter_node.setString( "navigation", "invalid" );
+	filter_node.setBool( "navigation_valid", false );
     }
 
     filter_node.setDouble( "p_bias", nav_data.gb[0] );
@@ -106,6 +111,7 @@ void umngnss_quat_init( string output_path, pyPropertyNode *config ) {
     gps_node = pyGetNode("/sensors/gps", true);
     filter_node = pyGetNode(output_path, true);
     filter_node.setString( "navigation", "invalid" );
+    filter_node.setBool( "navigation_valid", false );
 
 #if 0
     // set tuning value for specific gps and imu noise characteristics
@@ -123,25 +129,38 @@ void umngnss_quat_init( string output_path, pyPropertyNode *config ) {
 }
 
 
-bool umngnss_quat_update() {
-    static bool umn_inited = false;
-
+// the update is split in three steps so the filter manager can run
+// the (pure computation) middle step on a worker thread.  Only
+// sample() and publish() touch the property tree.
+void umngnss_quat_sample() {
     // fill in the UMN structures
     props2umn();
+    init_ready = GPS_age() < 1.0 && gps_node.getBool("settle");
+}
 
+
+bool umngnss_quat_compute() {
     if ( umn_inited ) {
 	get_nav( &imu_data, &gps_data, &nav_data );
-    } else {
-	if ( GPS_age() < 1.0 && gps_node.getBool("settle") ) {
-	    init_nav( &imu_data, &gps_data, &nav_data );
-	    umn_inited = true;
-	}
+    } else if ( init_ready ) {
+	init_nav( &imu_data, &gps_data, &nav_data );
+	umn_inited = true;
     }
+    return umn_inited;
+}
+
 
+void umngnss_quat_publish() {
     // copy the nav_data results back to the property tree
     umn2props();
+}
 
-    return umn_inited;
+
+bool umngnss_quat_update() {
+    umngnss_quat_sample();
+    bool fresh = umngnss_quat_compute();
+    umngnss_quat_publish();
+    return fresh;
 }
 
 
@@ -15,6 +15,9 @@ using std::string;
 
 void umngnss_quat_init( string output_path, pyPropertyNode *config );
 bool umngnss_quat_update();
+void umngnss_quat_sample();
+bool umngnss_quat_compute();
+void umngnss_quat_publish();
 void umngnss_quat_close();
 
 
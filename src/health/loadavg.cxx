@@ -18,7 +18,8 @@ bool loadavg_init() {
 }
 
 
-bool loadavg_update() {
+// read /proc/loadavg (no property or python access)
+static bool read_loadavg( float *load ) {
     char buf[5];
     int result = 0;
 
@@ -26,8 +27,7 @@ bool loadavg_update() {
         result = fread( buf, 4, 1, fload );
         buf[4] = 0;
         if ( result == 1 ) {
-            float load = atof(buf);
-            system_node.setDouble( "system_load_avg", load );
+            *load = atof(buf);
         } else {
 	    printf("fread() failed\n");
             fclose( fload );
@@ -43,3 +43,18 @@ bool loadavg_update() {
 
     return true;
 }
+
+bool loadavg_update() {
+    // file io, let the control thread have the interpreter lock
+    // meanwhile
+    float load = 0.0;
+    bool result;
+    Py_BEGIN_ALLOW_THREADS
+    result = read_loadavg( &load );
+    Py_END_ALLOW_THREADS
+
+    if ( result ) {
+	system_node.setDouble( "system_load_avg", load );
+    }
+    return result;
+}
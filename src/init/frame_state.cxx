@@ -0,0 +1,330 @@
+//
+// frame_state.cxx - consistent per frame snapshot of the vehicle state
+//
+// This code is released into the public domain.
+//
+
+#include "python/pyprops.hxx"
+
+#include "frame_state.hxx"
+
+
+AuraSeqlock<AuraFrameState> frame_state;
+
+// handles into the primary sensor/filter nodes
+static struct {
+    PropertyHandle<double> imu_timestamp;
+    PropertyHandle<double> imu_p, imu_q, imu_r;
+    PropertyHandle<double> imu_ax, imu_ay, imu_az;
+    PropertyHandle<double> imu_hx, imu_hy, imu_hz;
+    PropertyHandle<double> imu_temp_C;
+
+    PropertyHandle<double> gps_timestamp;
+    PropertyHandle<double> gps_lat_deg, gps_lon_deg, gps_alt_m;
+    PropertyHandle<double> gps_vn_ms, gps_ve_ms, gps_vd_ms;
+    PropertyHandle<double> gps_unix_time_sec, gps_data_age;
+    PropertyHandle<double> gps_horiz_accuracy_m, gps_vert_accuracy_m, gps_pdop;
+    PropertyHandle<long> gps_satellites, gps_fix_type, gps_status;
+
+    PropertyHandle<double> air_timestamp;
+    PropertyHandle<double> air_pressure_mbar, air_temp_degC, air_airspeed_kt;
+    PropertyHandle<double> vel_airspeed_smoothed_kt;
+    PropertyHandle<double> vel_pressure_vertical_speed_fps;
+    PropertyHandle<double> pos_pressure_altitude_smoothed_m;
+    PropertyHandle<double> pos_combined_altitude_true_m;
+    PropertyHandle<double> wind_dir_deg, wind_speed_kt, pitot_scale_factor;
+    PropertyHandle<long> air_status;
+
+    PropertyHandle<double> filt_timestamp;
+    PropertyHandle<double> filt_lat_deg, filt_lon_deg, filt_alt_m;
+    PropertyHandle<double> filt_vn_ms, filt_ve_ms, filt_vd_ms;
+    PropertyHandle<double> filt_roll_deg, filt_pitch_deg, filt_heading_deg;
+    PropertyHandle<double> filt_p_bias, filt_q_bias, filt_r_bias;
+    PropertyHandle<double> filt_ax_bias, filt_ay_bias, filt_az_bias;
+    PropertyHandle<bool> filt_navigation_valid;
+
+    PropertyHandle<bool> ap_master_switch, ap_pilot_pass_through;
+    PropertyHandle<double> tgt_groundtrack_deg, tgt_roll_deg, tgt_pitch_deg;
+    PropertyHandle<double> tgt_altitude_agl_ft, tgt_airspeed_kt;
+
+    PropertyHandle<double> act_timestamp;
+    PropertyHandle<double> act_aileron, act_elevator, act_throttle;
+    PropertyHandle<double> act_rudder, act_channel5, act_flaps;
+    PropertyHandle<double> act_channel7, act_channel8;
+} h;
+
+static uint32_t frame_count = 0;
+
+
+static void bind_properties() {
+    pyPropertyNode imu_node = pyGetNode("/sensors/imu[0]", true);
+    h.imu_timestamp = imu_node.getHandle<double>("timestamp");
+    h.imu_p = imu_node.getHandle<double>("p_rad_sec");
+    h.imu_q = imu_node.getHandle<double>("q_rad_sec");
+    h.imu_r = imu_node.getHandle<double>("r_rad_sec");
+    h.imu_ax = imu_node.getHandle<double>("ax_mps_sec");
+    h.imu_ay = imu_node.getHandle<double>("ay_mps_sec");
+    h.imu_az = imu_node.getHandle<double>("az_mps_sec");
+    h.imu_hx = imu_node.getHandle<double>("hx");
+    h.imu_hy = imu_node.getHandle<double>("hy");
+    h.imu_hz = imu_node.getHandle<double>("hz");
+    h.imu_temp_C = imu_node.getHandle<double>("temp_C");
+
+    pyPropertyNode gps_node = pyGetNode("/sensors/gps[0]", true);
+    h.gps_timestamp = gps_node.getHandle<double>("timestamp");
+    h.gps_lat_deg = gps_node.getHandle<double>("latitude_deg");
+    h.gps_lon_deg = gps_node.getHandle<double>("longitude_deg");
+    h.gps_alt_m = gps_node.getHandle<double>("altitude_m");
+    h.gps_vn_ms = gps_node.getHandle<double>("vn_ms");
+    h.gps_ve_ms = gps_node.getHandle<double>("ve_ms");
+    h.gps_vd_ms = gps_node.getHandle<double>("vd_ms");
+    h.gps_unix_time_sec = gps_node.getHandle<double>("unix_time_sec");
+    h.gps_data_age = gps_node.getHandle<double>("data_age");
+    h.gps_horiz_accuracy_m = gps_node.getHandle<double>("horiz_accuracy_m");
+    h.gps_vert_accuracy_m = gps_node.getHandle<double>("vert_accuracy_m");
+    h.gps_pdop = gps_node.getHandle<double>("pdop");
+    h.gps_satellites = gps_node.getHandle<long>("satellites");
+    h.gps_fix_type = gps_node.getHandle<long>("fixType");
+    h.gps_status = gps_node.getHandle<long>("status");
+
+    pyPropertyNode air_node = pyGetNode("/sensors/airdata[0]", true);
+    pyPropertyNode vel_node = pyGetNode("/velocity", true);
+    pyPropertyNode pressure_node = pyGetNode("/position/pressure", true);
+    pyPropertyNode combined_node = pyGetNode("/position/combined", true);
+    h.air_timestamp = air_node.getHandle<double>("timestamp");
+    h.air_pressure_mbar = air_node.getHandle<double>("pressure_mbar");
+    h.air_temp_degC = air_node.getHandle<double>("temp_degC");
+    h.air_airspeed_kt = air_node.getHandle<double>("airspeed_kt");
+    h.air_status = air_node.getHandle<long>("status");
+    h.vel_airspeed_smoothed_kt
+	= vel_node.getHandle<double>("airspeed_smoothed_kt");
+    h.vel_pressure_vertical_speed_fps
+	= vel_node.getHandle<double>("pressure_vertical_speed_fps");
+    h.pos_pressure_altitude_smoothed_m
+	= pressure_node.getHandle<double>("altitude_smoothed_m");
+    h.pos_combined_altitude_true_m
+	= combined_node.getHandle<double>("altitude_true_m");
+    pyPropertyNode wind_node = pyGetNode("/filters/wind", true);
+    h.wind_dir_deg = wind_node.getHandle<double>("wind_dir_deg");
+    h.wind_speed_kt = wind_node.getHandle<double>("wind_speed_kt");
+    h.pitot_scale_factor = wind_node.getHandle<double>("pitot_scale_factor");
+
+    pyPropertyNode filt_node = pyGetNode("/filters/filter[0]", true);
+    h.filt_timestamp = filt_node.getHandle<double>("timestamp");
+    h.filt_lat_deg = filt_node.getHandle<double>("latitude_deg");
+    h.filt_lon_deg = filt_node.getHandle<double>("longitude_deg");
+    h.filt_alt_m = filt_node.getHandle<double>("altitude_m");
+    h.filt_vn_ms = filt_node.getHandle<double>("vn_ms");
+    h.filt_ve_ms = filt_node.getHandle<double>("ve_ms");
+    h.filt_vd_ms = filt_node.getHandle<double>("vd_ms");
+    h.filt_roll_deg = filt_node.getHandle<double>("roll_deg");
+    h.filt_pitch_deg = filt_node.getHandle<double>("pitch_deg");
+    h.filt_heading_deg = filt_node.getHandle<double>("heading_deg");
+    h.filt_p_bias = filt_node.getHandle<double>("p_bias");
+    h.filt_q_bias = filt_node.getHandle<double>("q_bias");
+    h.filt_r_bias = filt_node.getHandle<double>("r_bias");
+    h.filt_ax_bias = filt_node.getHandle<double>("ax_bias");
+    h.filt_ay_bias = filt_node.getHandle<double>("ay_bias");
+    h.filt_az_bias = filt_node.getHandle<double>("az_bias");
+    h.filt_navigation_valid = filt_node.getHandle<bool>("navigation_valid");
+
+    pyPropertyNode ap_node = pyGetNode("/autopilot", true);
+    pyPropertyNode targets_node = pyGetNode("/autopilot/targets", true);
+    h.ap_master_switch = ap_node.getHandle<bool>("master_switch");
+    h.ap_pilot_pass_through = ap_node.getHandle<bool>("pilot_pass_through");
+    h.tgt_groundtrack_deg = targets_node.getHandle<double>("groundtrack_deg");
+    h.tgt_roll_deg = targets_node.getHandle<double>("roll_deg");
+    h.tgt_pitch_deg = targets_node.getHandle<double>("pitch_deg");
+    h.tgt_altitude_agl_ft = targets_node.getHandle<double>("altitude_agl_ft");
+    h.tgt_airspeed_kt = targets_node.getHandle<double>("airspeed_kt");
+
+    pyPropertyNode act_node = pyGetNode("/actuators", true);
+    h.act_timestamp = act_node.getHandle<double>("timestamp");
+    h.act_aileron = act_node.getHandle<double>("aileron");
+    h.act_elevator = act_node.getHandle<double>("elevator");
+    h.act_throttle = act_node.getHandle<double>("throttle");
+    h.act_rudder = act_node.getHandle<double>("rudder");
+    h.act_channel5 = act_node.getHandle<double>("channel5");
+    h.act_flaps = act_node.getHandle<double>("flaps");
+    h.act_channel7 = act_node.getHandle<double>("channel7");
+    h.act_channel8 = act_node.getHandle<double>("channel8");
+}
+
+
+void frame_state_update( double dt ) {
+    AuraFrameState s;
+
+    s.frame = ++frame_count;
+    s.frame_time = h.imu_timestamp.get();
+    s.dt = dt;
+
+    s.imu.timestamp = h.imu_timestamp.get();
+    s.imu.p = h.imu_p.get();
+    s.imu.q = h.imu_q.get();
+    s.imu.r = h.imu_r.get();
+    s.imu.ax = h.imu_ax.get();
+    s.imu.ay = h.imu_ay.get();
+    s.imu.az = h.imu_az.get();
+    s.imu.hx = h.imu_hx.get();
+    s.imu.hy = h.imu_hy.get();
+    s.imu.hz = h.imu_hz.get();
+    s.imu.temp_C = h.imu_temp_C.get();
+
+    s.gps.timestamp = h.gps_timestamp.get();
+    s.gps.lat_deg = h.gps_lat_deg.get();
+    s.gps.lon_deg = h.gps_lon_deg.get();
+    s.gps.alt_m = h.gps_alt_m.get();
+    s.gps.vn_ms = h.gps_vn_ms.get();
+    s.gps.ve_ms = h.gps_ve_ms.get();
+    s.gps.vd_ms = h.gps_vd_ms.get();
+    s.gps.unix_time_sec = h.gps_unix_time_sec.get();
+    s.gps.data_age = h.gps_data_age.get();
+    s.gps.horiz_accuracy_m = h.gps_horiz_accuracy_m.get();
+    s.gps.vert_accuracy_m = h.gps_vert_accuracy_m.get();
+    s.gps.pdop = h.gps_pdop.get();
+    s.gps.satellites = h.gps_satellites.get();
+    s.gps.fix_type = h.gps_fix_type.get();
+    s.gps.status = h.gps_status.get();
+
+    s.airdata.timestamp = h.air_timestamp.get();
+    s.airdata.pressure_mbar = h.air_pressure_mbar.get();
+    s.airdata.temp_degC = h.air_temp_degC.get();
+    s.airdata.airspeed_kt = h.air_airspeed_kt.get();
+    s.airdata.airspeed_smoothed_kt = h.vel_airspeed_smoothed_kt.get();
+    s.airdata.altitude_smoothed_m = h.pos_pressure_altitude_smoothed_m.get();
+    s.airdata.altitude_true_m = h.pos_combined_altitude_true_m.get();
+    s.airdata.vertical_speed_fps = h.vel_pressure_vertical_speed_fps.get();
+    s.airdata.wind_dir_deg = h.wind_dir_deg.get();
+    s.airdata.wind_speed_kt = h.wind_speed_kt.get();
+    s.airdata.pitot_scale_factor = h.pitot_scale_factor.get();
+    s.airdata.status = h.air_status.get();
+
+    s.filter.timestamp = h.filt_timestamp.get();
+    s.filter.lat_deg = h.filt_lat_deg.get();
+    s.filter.lon_deg = h.filt_lon_deg.get();
+    s.filter.alt_m = h.filt_alt_m.get();
+    s.filter.vn_ms = h.filt_vn_ms.get();
+    s.filter.ve_ms = h.filt_ve_ms.get();
+    s.filter.vd_ms = h.filt_vd_ms.get();
+    s.filter.roll_deg = h.filt_roll_deg.get();
+    s.filter.pitch_deg = h.filt_pitch_deg.get();
+    s.filter.heading_deg = h.filt_heading_deg.get();
+    s.filter.p_bias = h.filt_p_bias.get();
+    s.filter.q_bias = h.filt_q_bias.get();
+    s.filter.r_bias = h.filt_r_bias.get();
+    s.filter.ax_bias = h.filt_ax_bias.get();
+    s.filter.ay_bias = h.filt_ay_bias.get();
+    s.filter.az_bias = h.filt_az_bias.get();
+    s.filter.valid = h.filt_navigation_valid.get();
+
+    s.ap.master_switch = h.ap_master_switch.get();
+    s.ap.pilot_pass_through = h.ap_pilot_pass_through.get();
+    s.ap.groundtrack_deg = h.tgt_groundtrack_deg.get();
+    s.ap.roll_deg = h.tgt_roll_deg.get();
+    s.ap.pitch_deg = h.tgt_pitch_deg.get();
+    s.ap.altitude_agl_ft = h.tgt_altitude_agl_ft.get();
+    s.ap.airspeed_kt = h.tgt_airspeed_kt.get();
+
+    s.act.timestamp = h.act_timestamp.get();
+    s.act.aileron = h.act_aileron.get();
+    s.act.elevator = h.act_elevator.get();
+    s.act.throttle = h.act_throttle.get();
+    s.act.rudder = h.act_rudder.get();
+    s.act.channel5 = h.act_channel5.get();
+    s.act.flaps = h.act_flaps.get();
+    s.act.channel7 = h.act_channel7.get();
+    s.act.channel8 = h.act_channel8.get();
+
+    frame_state.store( s );
+}
+
+
+// python frame_state module
+
+static PyObject *frame_state_read( PyObject *self, PyObject *args ) {
+    AuraFrameState s;
+    frame_state.load( &s );
+
+    PyObject *imu = Py_BuildValue(
+	"{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d}",
+	"timestamp", s.imu.timestamp,
+	"p_rad_sec", s.imu.p, "q_rad_sec", s.imu.q, "r_rad_sec", s.imu.r,
+	"ax_mps_sec", s.imu.ax, "ay_mps_sec", s.imu.ay,
+	"az_mps_sec", s.imu.az,
+	"hx", s.imu.hx, "hy", s.imu.hy, "hz", s.imu.hz,
+	"temp_C", s.imu.temp_C );
+    PyObject *gps = Py_BuildValue(
+	"{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:i,s:i,s:i}",
+	"timestamp", s.gps.timestamp,
+	"latitude_deg", s.gps.lat_deg, "longitude_deg", s.gps.lon_deg,
+	"altitude_m", s.gps.alt_m,
+	"vn_ms", s.gps.vn_ms, "ve_ms", s.gps.ve_ms, "vd_ms", s.gps.vd_ms,
+	"unix_time_sec", s.gps.unix_time_sec, "data_age", s.gps.data_age,
+	"horiz_accuracy_m", s.gps.horiz_accuracy_m,
+	"vert_accuracy_m", s.gps.vert_accuracy_m, "pdop", s.gps.pdop,
+	"satellites", (int)s.gps.satellites, "fixType", (int)s.gps.fix_type,
+	"status", (int)s.gps.status );
+    PyObject *airdata = Py_BuildValue(
+	"{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:i}",
+	"timestamp", s.airdata.timestamp,
+	"pressure_mbar", s.airdata.pressure_mbar,
+	"temp_degC", s.airdata.temp_degC,
+	"airspeed_kt", s.airdata.airspeed_kt,
+	"airspeed_smoothed_kt", s.airdata.airspeed_smoothed_kt,
+	"altitude_smoothed_m", s.airdata.altitude_smoothed_m,
+	"altitude_true_m", s.airdata.altitude_true_m,
+	"vertical_speed_fps", s.airdata.vertical_speed_fps,
+	"wind_dir_deg", s.airdata.wind_dir_deg,
+	"wind_speed_kt", s.airdata.wind_speed_kt,
+	"pitot_scale_factor", s.airdata.pitot_scale_factor,
+	"status", (int)s.airdata.status );
+    PyObject *filter = Py_BuildValue(
+	"{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:N}",
+	"timestamp", s.filter.timestamp,
+	"latitude_deg", s.filter.lat_deg, "longitude_deg", s.filter.lon_deg,
+	"altitude_m", s.filter.alt_m,
+	"vn_ms", s.filter.vn_ms, "ve_ms", s.filter.ve_ms,
+	"vd_ms", s.filter.vd_ms,
+	"roll_deg", s.filter.roll_deg, "pitch_deg", s.filter.pitch_deg,
+	"heading_deg", s.filter.heading_deg,
+	"p_bias", s.filter.p_bias, "q_bias", s.filter.q_bias,
+	"r_bias", s.filter.r_bias,
+	"ax_bias", s.filter.ax_bias, "ay_bias", s.filter.ay_bias,
+	"az_bias", s.filter.az_bias,
+	"valid", PyBool_FromLong(s.filter.valid) );
+    PyObject *ap = Py_BuildValue(
+	"{s:N,s:N,s:d,s:d,s:d,s:d,s:d}",
+	"master_switch", PyBool_FromLong(s.ap.master_switch),
+	"pilot_pass_through", PyBool_FromLong(s.ap.pilot_pass_through),
+	"groundtrack_deg", s.ap.groundtrack_deg,
+	"roll_deg", s.ap.roll_deg, "pitch_deg", s.ap.pitch_deg,
+	"altitude_agl_ft", s.ap.altitude_agl_ft,
+	"airspeed_kt", s.ap.airspeed_kt );
+    PyObject *act = Py_BuildValue(
+	"{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d}",
+	"timestamp", s.act.timestamp,
+	"aileron", s.act.aileron, "elevator", s.act.elevator,
+	"throttle", s.act.throttle, "rudder", s.act.rudder,
+	"channel5", s.act.channel5, "flaps", s.act.flaps,
+	"channel7", s.act.channel7, "channel8", s.act.channel8 );
+
+    return Py_BuildValue( "{s:I,s:d,s:d,s:N,s:N,s:N,s:N,s:N,s:N}",
+			  "frame", s.frame,
+			  "frame_time", s.frame_time,
+			  "dt", s.dt,
+			  "imu", imu, "gps", gps, "airdata", airdata,
+			  "filter", filter, "ap", ap, "act", act );
+}
+
+static PyMethodDef frame_state_methods[] = {
+    { "read", frame_state_read, METH_NOARGS,
+      "read(): consistent snapshot of the most recent frame (dict)" },
+    { NULL, NULL, 0, NULL }
+};
+
+
+void frame_state_init() {
+    bind_properties();
+    Py_InitModule3( "frame_state", frame_state_methods,
+		    "per frame vehicle state snapshot" );
+}
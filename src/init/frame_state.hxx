@@ -0,0 +1,108 @@
+//
+// frame_state.hxx - consistent per frame snapshot of the vehicle state
+//
+// The control loop copies the primary imu, gps, airdata, filter,
+// autopilot target and actuator values out of the property tree once
+// per frame (after the actuator output) and publishes them through a
+// seqlock.  Any thread can then read a complete snapshot of one frame
+// without taking the interpreter lock, and never sees values from two
+// different estimator updates mixed together.
+//
+// The main thread packs the remote link's primary imu, gps, airdata,
+// filter and actuator telemetry from it (pyModuleRemoteLink::update())
+// and the main and mission loops take their frame time from it.  The
+// flight log is still written by the control thread, it needs every
+// frame and not just the newest one.  Python code reads the same
+// snapshot through the frame_state module (frame_state.read() returns
+// a dictionary.)
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_FRAME_STATE_HXX
+#define _AURA_FRAME_STATE_HXX
+
+#include <stdint.h>
+
+#include "util/seqlock.hxx"
+
+
+struct AuraFrameState {
+    uint32_t frame;		// frame counter
+    double frame_time;		// imu timestamp of the frame
+    double dt;
+
+    struct imu_state {
+	double timestamp;
+	double p, q, r;		// rad/sec
+	double ax, ay, az;	// mps/sec
+	double hx, hy, hz;
+	double temp_C;
+    } imu;
+
+    struct gps_state {
+	double timestamp;
+	double lat_deg, lon_deg, alt_m;
+	double vn_ms, ve_ms, vd_ms;
+	double unix_time_sec;
+	double data_age;
+	double horiz_accuracy_m, vert_accuracy_m, pdop;
+	int32_t satellites;
+	int32_t fix_type;
+	int32_t status;
+    } gps;
+
+    struct airdata_state {
+	double timestamp;
+	double pressure_mbar;
+	double temp_degC;
+	double airspeed_kt;
+	double airspeed_smoothed_kt;
+	double altitude_smoothed_m;	// pressure
+	double altitude_true_m;		// combined
+	double vertical_speed_fps;
+	double wind_dir_deg, wind_speed_kt, pitot_scale_factor;
+	int32_t status;
+    } airdata;
+
+    struct filter_state {
+	double timestamp;
+	double lat_deg, lon_deg, alt_m;
+	double vn_ms, ve_ms, vd_ms;
+	double roll_deg, pitch_deg, heading_deg;
+	double p_bias, q_bias, r_bias;
+	double ax_bias, ay_bias, az_bias;
+	bool valid;			// navigation_valid
+    } filter;
+
+    struct {
+	bool master_switch;
+	bool pilot_pass_through;
+	double groundtrack_deg;
+	double roll_deg;
+	double pitch_deg;
+	double altitude_agl_ft;
+	double airspeed_kt;
+    } ap;
+
+    struct act_state {
+	double timestamp;
+	double aileron, elevator, throttle, rudder;
+	double channel5, flaps, channel7, channel8;
+    } act;
+};
+
+
+// bind the property handles and register the python module (call
+// once at startup, holding the interpreter lock)
+void frame_state_init();
+
+// copy the current frame out of the property tree and publish it
+// (control loop only)
+void frame_state_update( double dt );
+
+// the published snapshots
+extern AuraSeqlock<AuraFrameState> frame_state;
+
+
+#endif // _AURA_FRAME_STATE_HXX
@@ -6,6 +6,9 @@
 // This code is released into the public domain.
 // 
 
+#include "control/targets_mailbox.hxx"
+
+#include "frame_state.hxx"
 #include "globals.hxx"
 
 
@@ -16,6 +19,7 @@ pyModulePacker *packer = NULL;
 pyModuleRemoteLink *remote_link = NULL;
 pyModuleBase *mission_mgr = NULL;
 pyModuleBase *telnet = NULL;
+pyModuleTick *tick = NULL;
 
 
 bool AuraCoreInit() {
@@ -27,15 +31,22 @@ bool AuraCoreInit() {
     remote_link = new pyModuleRemoteLink;
     mission_mgr = new pyModuleBase;
     telnet = new pyModuleBase;
+    tick = new pyModuleTick;
     
+    // native modules the python code may import
+    frame_state_init();
+
     // import and init the python modules
     display->init("comms.display");
     packer->init("comms.packer");
     logging->init("comms.logging");
     remote_link->init("comms.remote_link");
     events->init("comms.events");
+    targets_mailbox_init();
     mission_mgr->init("mission.mission_mgr");
+    targets_mailbox_publish();	// targets set by the task activate()'s
     telnet->init("comms.telnet");
+    tick->init("comms.tick");
     
     return true;
 }
@@ -15,6 +15,7 @@
 #include "comms/logging.hxx"
 #include "comms/packer.hxx"
 #include "comms/remote_link.hxx"
+#include "comms/tick.hxx"
 #include "python/pymodule.hxx"
 
 
@@ -25,6 +26,7 @@ extern pyModulePacker *packer;
 extern pyModuleRemoteLink *remote_link;
 extern pyModuleBase *mission_mgr;
 extern pyModuleBase *telnet;
+extern pyModuleTick *tick;
 
 
 bool AuraCoreInit();
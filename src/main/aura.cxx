@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <sys/types.h>
+#include <time.h>
 
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -31,9 +32,11 @@ using std::string;
 #include "comms/remote_link.hxx"
 #include "control/cas.hxx"
 #include "control/control.hxx"
+#include "control/targets_mailbox.hxx"
 #include "filters/filter_mgr.hxx"
 #include "health/health.hxx"
 #include "include/globaldefs.h"
+#include "init/frame_state.hxx"
 #include "init/globals.hxx"
 #include "payload/payload_mgr.hxx"
 #include "sensors/airdata_mgr.hxx"
@@ -43,40 +46,43 @@ using std::string;
 #include "util/exception.hxx"
 #include "util/myprof.hxx"
 #include "util/netSocket.h"	// netInit()
+#include "util/reactor.hxx"
+#include "util/rt_thread.hxx"
 #include "util/sg_path.hxx"
 #include "util/timing.h"
 
-// we include the sensors here that support syncing from their main
-// update() routine
-#include "sensors/APM2.hxx"
-#include "sensors/Aura3.hxx"
-#include "sensors/FGFS.hxx"
-#include "sensors/Goldy2.hxx"
-#include "sensors/pika.hxx"
-
-// sync modes
-enum SyncMode {
-    SYNC_NONE,
-    SYNC_APM2,
-    SYNC_AURA3,
-    SYNC_FGFS,
-    SYNC_GOLDY2,
-    SYNC_PIKA
-};
-
 //
 // Configuration settings
 //
 
 static const int HEARTBEAT_HZ = 100;  // master clock rate
 
-static SyncMode sync_source = SYNC_NONE;   // main loop sync source
-    
 static bool enable_mission = true;    // mission mgr module enabled/disabled
 static bool enable_cas     = false;   // cas module enabled/disabled
 static bool enable_pointing = false;  // pan/tilt pointing module
 static double gps_timeout_sec = 9.0;  // nav algorithm gps timeout
 
+// Threads (/config/threads).  The control thread owns sync, sensor
+// input, the filters, the autopilot and the actuator output.  The
+// mission thread runs the mission manager at its own (lower) rate.
+// The main thread runs everything else (commands, telnet, health,
+// logging) at its own rate.  All of them share the property tree
+// under the python interpreter lock, the control thread gets the
+// lock handed over first (see python/python_sys.hxx.)
+static bool enable_threads = true;
+static bool enable_mission_thread = true;
+static bool lock_memory = true;
+static AuraThreadConfig control_config;
+static AuraThreadConfig mission_config;
+static AuraThreadConfig main_config;
+static AuraThreadStats control_stats;
+static AuraThreadStats mission_stats;
+static AuraThreadStats main_stats;
+
+// python tick slot of the mission manager when it runs on the main
+// thread (for mission_prof)
+static int mission_slot = -1;
+
 // property nodes
 static pyPropertyNode imu_node;
 static pyPropertyNode status_node;
@@ -91,7 +97,6 @@ myprofile debug2c;
 myprofile debug2d;
 myprofile debug3;
 myprofile debug4;
-myprofile debug5;
 myprofile debug7;
 
 //
@@ -109,51 +114,21 @@ void usage(char *progname)
 }	
 
 
-void main_work_loop()
-{
-    debug1.start();
-
-    // update display_on variable
-    display_on = comms_node.getBool("display_on");
-    
-    // printf("apm loop:\n");
-    // read the sensors until we receive an IMU packet
-    sync_prof.start();
-    double dt = 0.0;
-    if ( sync_source == SYNC_NONE ) {
-	if ( display_on ) {
-	    printf("No main loop sync source discovered.\n");
-	}
-    } else if ( sync_source == SYNC_APM2 ) {
-	dt = APM2_update();
-    } else if ( sync_source == SYNC_AURA3 ) {
-	dt = Aura3_update();
-    } else if ( sync_source == SYNC_FGFS ) {
-	dt = FGFS_update();
-    } else if ( sync_source == SYNC_GOLDY2 ) {
-	dt = goldy2_update();
-    } else if ( sync_source == SYNC_PIKA ) {
-	dt = pika_update();
-    }
-    status_node.setDouble("frame_time", imu_node.getDouble( "timestamp" ));
+// record the frame time of the new imu frame, returns dt
+static double update_frame_time() {
+    static double last_time = 0.0;
+    double cur_time = imu_node.getDouble( "timestamp" );
+    double dt = cur_time - last_time;
+    last_time = cur_time;
+    status_node.setDouble("frame_time", cur_time);
     status_node.setDouble("dt", dt);
-    sync_prof.stop();
-    
-    main_prof.start();
-    
-    
-    static double display_timer = get_Time();
-    static int health_counter = 0;
-
-    static int count = 0;
-
-    count++;
-    // printf ("timer expired %d times\n", count);
-
-    health_counter++;
+    return dt;
+}
 
-    debug1.stop();
 
+// sensor input, state estimation, flight control and actuator output
+// for one imu frame
+static void control_frame( double dt ) {
     debug2.start();
 
     //
@@ -213,47 +188,49 @@ void main_work_loop()
 
     Actuator_update();
 
-    debug3.stop();
+    // publish the completed frame for readers on other threads
+    frame_state_update( dt );
 
-    debug4.start();
+    debug3.stop();
+}
 
-    //
-    // External Command section
-    //
 
-    // check for incoming command data
-    remote_link->command();
+// commands, telnet, mission, health, telemetry and logging.  'rate'
+// is how often this is called (hz)
+static void main_frame( double dt, int rate ) {
+    static double display_timer = get_Time();
+    static double profile_timer = get_Time();
+    static int health_counter = 0;
 
-    // dribble a bit more out of the serial port if there is
-    // something pending
-    remote_link->flush_serial();
+    health_counter++;
 
-    debug4.stop();
+    debug4.start();
 
-    debug5.start();
+    // incoming commands from the remote link (decoded and executed
+    // natively, see comms/uplink.hxx)
+    remote_link->command();
 
     //
-    // Read commands from telnet interface
+    // Python section: telnet and the mission manager run inside one
+    // call into the interpreter (see comms/tick.hxx)
     //
-    telnet->update(0);
 
-    debug5.stop();
+    if ( mission_slot >= 0 ) {
+	targets_mailbox_refresh();
+    }
+    tick->update(dt);
+    if ( mission_slot >= 0 ) {
+	targets_mailbox_publish();
+	mission_prof.record( tick->get_elapsed(mission_slot) );
+    }
+
+    debug4.stop();
 
     // if ( enable_pointing ) {
     // 	// Update pointing module
     // 	ati_pointing_update( dt );
     // }
 
-    //
-    // Mission and Task section
-    //
-
-    mission_prof.start();
-    if ( enable_mission ) {
-	mission_mgr->update(dt);
-    }
-    mission_prof.stop();
-
     debug7.start();
 
     //
@@ -261,7 +238,7 @@ void main_work_loop()
     //
 
     // health status (update at 10hz)
-    if ( health_counter >= (HEARTBEAT_HZ / 10) ) {
+    if ( health_counter >= (rate / 10) ) {
 	health_prof.start();
 	health_counter = 0;
 	health_update();
@@ -270,6 +247,43 @@ void main_work_loop()
 
     payload_mgr.update();
 
+    // telemetry out to the remote link (scheduled to fit the link
+    // budget, see comms/link_scheduler.hxx).  The encoding and the
+    // write to the link run without the interpreter lock so the
+    // control thread never waits on them.
+    remote_link->update();
+    Py_BEGIN_ALLOW_THREADS
+    remote_link->flush();
+    Py_END_ALLOW_THREADS
+
+    // latency histograms to the property tree and the flight log @ 1hz
+    if ( get_Time() >= profile_timer + 1.0 ) {
+	profile_timer += 1.0;
+	imu_prof.publish();
+	gps_prof.publish();
+	air_prof.publish();
+	pilot_prof.publish();
+	filter_prof.publish();
+	mission_prof.publish();
+	control_prof.publish();
+	health_prof.publish();
+	datalog_prof.publish();
+	sync_prof.publish();
+	main_prof.publish();
+	if ( enable_threads ) {
+	    control_stats.publish( "control" );
+	    if ( enable_mission_thread ) {
+		mission_stats.publish( "mission" );
+	    }
+	}
+	main_stats.publish( "main" );
+	uint8_t buf[256];
+	int size;
+	for ( int i = 0; (size = packer->pack_profile( i, buf )) > 0; i++ ) {
+	    logging->log_message( buf, size );
+	}
+    }
+
     // sensor summary display @ 2 second interval
     if ( display_on && get_Time() >= display_timer + 2.0 ) {
 	display_timer += 2.0;
@@ -284,11 +298,19 @@ void main_work_loop()
 	datalog_prof.stats();
 	sync_prof.stats();
 	main_prof.stats();
+	if ( enable_threads ) {
+	    printf("threads: control frames: %lu misses: %lu  main frames: %lu misses: %lu\n",
+		   control_stats.get_frames(), control_stats.get_misses(),
+		   main_stats.get_frames(), main_stats.get_misses());
+	    if ( enable_mission_thread ) {
+		printf("threads: mission frames: %lu misses: %lu\n",
+		       mission_stats.get_frames(), mission_stats.get_misses());
+	    }
+	}
         // debug1.stats();
         // debug2.stats();
         // debug3.stats();
         // debug4.stats();
-        // debug5.stats();
         // debug7.stats();
     }
 
@@ -299,19 +321,204 @@ void main_work_loop()
 	datalog_prof.stop();
     }
 
-    //
-    // Remote telemetry section
-    //
+    debug7.stop();
+}
 
-    // dribble pending bytes down the serial port
-    remote_link->flush_serial();
 
-    debug7.stop();
+// single threaded main loop (/config/threads/enable = false)
+void main_work_loop()
+{
+    debug1.start();
+
+    // update display_on variable
+    display_on = comms_node.getBool("display_on");
+    
+    // sleep until the main imu delivers a fresh packet.  Every other
+    // registered sensor source is parsed as its bytes arrive.
+    sync_prof.start();
+    if ( reactor.has_sync() ) {
+	while ( ! reactor.poll( 100 ) ) {
+	    // keep waiting
+	}
+    } else {
+	if ( display_on ) {
+	    printf("No main loop sync source discovered.\n");
+	}
+	reactor.poll( 0 );
+    }
+    double dt = update_frame_time();
+    sync_prof.stop();
+    
+    main_prof.start();
+    main_stats.begin();
+
+    debug1.stop();
 
+    control_frame( dt );
+    main_frame( dt, HEARTBEAT_HZ );
+
+    main_stats.end();
     main_prof.stop();
 }
 
 
+// control thread: sleeps (without the interpreter lock) until the
+// main imu delivers a fresh packet, then takes the lock ahead of the
+// main thread and runs the frame
+static void *control_thread_main( void *arg ) {
+    aura_thread_setup( control_config );
+    AuraPythonAttach();
+
+    struct timespec next;
+    clock_gettime( CLOCK_MONOTONIC, &next );
+    long period_ns = 1000000000L / HEARTBEAT_HZ;
+    bool waiting = false;
+
+    while ( true ) {
+	if ( ! waiting ) {
+	    sync_prof.start();
+	    waiting = true;
+	}
+	if ( reactor.has_sync() ) {
+	    if ( reactor.wait( 100 ) <= 0 ) {
+		continue;
+	    }
+	    AuraPythonAcquire( true );
+	    if ( ! reactor.dispatch() ) {
+		AuraPythonRelease();
+		continue;
+	    }
+	} else {
+	    // no sync source, pace the loop ourselves
+	    next.tv_nsec += period_ns;
+	    if ( next.tv_nsec >= 1000000000L ) {
+		next.tv_nsec -= 1000000000L;
+		next.tv_sec++;
+	    }
+	    clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL );
+	    AuraPythonAcquire( true );
+	    reactor.poll( 0 );
+	}
+	waiting = false;
+	double dt = update_frame_time();
+	sync_prof.stop();
+
+	main_prof.start();
+	control_stats.begin();
+	control_frame( dt );
+	control_stats.end();
+	main_prof.stop();
+
+	AuraPythonRelease();
+    }
+
+    return NULL;
+}
+
+
+// time of the newest published control frame (for the loops on the
+// other threads)
+static double snapshot_frame_time() {
+    AuraFrameState s;
+    frame_state.load( &s );
+    return s.frame_time;
+}
+
+
+// sleep until the next period of a fixed rate loop
+static void sleep_next_period( struct timespec *next, long period_ns ) {
+    next->tv_nsec += period_ns;
+    if ( next->tv_nsec >= 1000000000L ) {
+	next->tv_nsec -= 1000000000L;
+	next->tv_sec++;
+    }
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    if ( now.tv_sec > next->tv_sec + 1 ) {
+	// far behind (stopped in a debugger?), don't try to catch up
+	*next = now;
+    }
+    clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, next, NULL );
+}
+
+
+// mission thread: the mission manager at mission_config.rate_hz.  The
+// tasks see the targets as of the start of the update and their
+// changes reach the control thread in one piece when it is done (see
+// control/targets_mailbox.hxx)
+static void *mission_thread_main( void *arg ) {
+    aura_thread_setup( mission_config );
+    AuraPythonAttach();
+    AuraPythonAcquire();
+    AuraPythonYieldHook();
+    double last_time = snapshot_frame_time();
+    AuraPythonRelease();
+
+    long period_ns = (long)(1.0e9 / mission_config.rate_hz);
+    struct timespec next;
+    clock_gettime( CLOCK_MONOTONIC, &next );
+
+    while ( true ) {
+	sleep_next_period( &next, period_ns );
+	AuraPythonAcquire();
+
+	mission_stats.begin();
+	double cur_time = snapshot_frame_time();
+	double dt = cur_time - last_time;
+	last_time = cur_time;
+	targets_mailbox_refresh();
+	mission_prof.start();
+	mission_mgr->update( dt );
+	mission_prof.stop();
+	targets_mailbox_publish();
+	mission_stats.end();
+
+	AuraPythonRelease();
+    }
+
+    return NULL;
+}
+
+
+// main thread loop when threaded: everything but the control frame at
+// main_config.rate_hz
+static void main_thread_loop() {
+    aura_thread_setup( main_config );
+
+    int rate = (int)(main_config.rate_hz + 0.5);
+    if ( rate < 1 ) {
+	rate = 1;
+    }
+    long period_ns = 1000000000L / rate;
+    struct timespec next;
+    clock_gettime( CLOCK_MONOTONIC, &next );
+    double last_time = snapshot_frame_time();
+
+    while ( true ) {
+	AuraPythonRelease();
+	sleep_next_period( &next, period_ns );
+	AuraPythonAcquire();
+
+	main_stats.begin();
+	display_on = comms_node.getBool("display_on");
+	double cur_time = snapshot_frame_time();
+	double dt = cur_time - last_time;
+	last_time = cur_time;
+	main_frame( dt, rate );
+	main_stats.end();
+    }
+}
+
+
+// per frame python work, called in this order from main_frame()
+static void setup_python_tick() {
+    tick->add( telnet, "update", false );
+    if ( enable_mission && ! enable_mission_thread ) {
+	mission_slot = tick->add( mission_mgr, "update", true );
+    }
+}
+
+
 //
 // main ...
 //
@@ -361,6 +568,7 @@ int main( int argc, char **argv )
     datalog_prof.set_name("logger");
     sync_prof.set_name("sync");
     main_prof.set_name("main");
+    myprofile::frame_budget = 1.0 / HEARTBEAT_HZ;
 
     // only enable sync and main by default
     sync_prof.enable();
@@ -380,8 +588,7 @@ int main( int argc, char **argv )
     debug2c.set_name("debug2c (GPS)");
     debug2d.set_name("debug2d (Pilot)");
     debug3.set_name("debug3 (filter+nav)");
-    debug4.set_name("debug4 (console)");
-    debug5.set_name("debug5 (telnet)");
+    debug4.set_name("debug4 (python)");
     debug7.set_name("debug7 (logging)");
 
     if ( display_on ) {
@@ -434,23 +641,36 @@ int main( int argc, char **argv )
 	enable_mission = p.getBool("enable");
     }
 
-    // auto-detect IMU main loop sync source
-    p = pyGetNode("/config/sensors/imu_group/imu", true);
-    if ( p.hasChild("source") ) {
-	string source = p.getString("source");
-	if ( source == "APM2" ) {
-	    sync_source = SYNC_APM2;
-        } else if ( source == "Aura3" ) {
-	    sync_source = SYNC_AURA3;
-	} else if ( source == "fgfs" ) {
-	    sync_source = SYNC_FGFS;
-	} else if ( source == "Goldy2" ) {
-	    sync_source = SYNC_GOLDY2;
-	} else if ( source == "pika" ) {
-	    sync_source = SYNC_PIKA;
-	}
+    p = pyGetNode("/config/threads", true);
+    if ( p.hasChild("enable") ) {
+	enable_threads = p.getBool("enable");
     }
-    
+    if ( p.hasChild("lock_memory") ) {
+	lock_memory = p.getBool("lock_memory");
+    }
+    control_config.name = "control";
+    control_config.priority = 50;
+    control_config.rate_hz = HEARTBEAT_HZ;
+    pyPropertyNode thread_node = p.getChild("control", true);
+    control_config.load( &thread_node );
+    main_config.name = "main";
+    main_config.rate_hz = HEARTBEAT_HZ;
+    thread_node = p.getChild("main", true);
+    main_config.load( &thread_node );
+    mission_config.name = "mission";
+    mission_config.rate_hz = 25;
+    thread_node = p.getChild("mission", true);
+    mission_config.load( &thread_node );
+    if ( thread_node.hasChild("enable") ) {
+	enable_mission_thread = thread_node.getBool("enable");
+    }
+    if ( mission_config.rate_hz < 1.0 ) {
+	mission_config.rate_hz = 1.0;
+    }
+    control_stats.set_deadline( 1.0 / control_config.rate_hz );
+    mission_stats.set_deadline( 1.0 / mission_config.rate_hz );
+    main_stats.set_deadline( 1.0 / main_config.rate_hz );
+
     // Parse the command line: pass #2 allows command line options to
     // override config file options
     for ( iarg = 1; iarg < argc; iarg++ ) {
@@ -480,7 +700,9 @@ int main( int argc, char **argv )
     // initialize required aura-core structures
     AuraCoreInit();
 
-    // Initialize communication with the selected IMU
+
+    // Initialize communication with the selected IMU (the imu driver
+    // registers itself with the reactor as the main loop sync source)
     IMU_init();
 
     // Initialize communication with the selected air data sensor
@@ -525,6 +747,46 @@ int main( int argc, char **argv )
     
     printf("Everything inited ... ready to run\n");
 
+    if ( lock_memory ) {
+	aura_lock_memory();
+    }
+
+    if ( ! enable_threads || ! enable_mission ) {
+	enable_mission_thread = false;
+    }
+    if ( enable_mission_thread ) {
+	mission_prof.set_budget( 1.0 / mission_config.rate_hz );
+    }
+    mission_prof.enable();
+
+    if ( enable_threads ) {
+	// the main thread keeps the interpreter lock until it first
+	// sleeps in main_thread_loop()
+	AuraPythonThreadsInit();
+	pthread_t control_thread;
+	if ( aura_thread_start( &control_thread, control_config,
+				control_thread_main, NULL ) )
+	{
+	    pthread_t mission_thread;
+	    if ( enable_mission_thread
+		 && ! aura_thread_start( &mission_thread, mission_config,
+					 mission_thread_main, NULL ) )
+	    {
+		printf("Running the mission manager on the main thread\n");
+		enable_mission_thread = false;
+		mission_prof.set_budget( 0.0 );
+	    }
+	    setup_python_tick();
+	    main_thread_loop();
+	}
+	printf("Falling back to the single threaded main loop\n");
+	enable_threads = false;
+	enable_mission_thread = false;
+    }
+
+    setup_python_tick();
+
+    main_stats.set_deadline( 1.0 / HEARTBEAT_HZ );
     while ( true ) {
 	main_work_loop();
     }
@@ -0,0 +1,374 @@
+//
+// replay.cxx - run the flight code against a recorded flight log
+//
+// The sensor packets of a flight.dat.gz are fed back through the
+// sensor managers and the real imu -> filter -> control -> actuator
+// chain runs once per logged imu frame, as fast as the cpu allows.
+// get_Time() follows the logged imu timestamps (virtual clock) and
+// nothing is read from the hardware, network or wall clock, so two
+// runs of the same log and config produce identical outputs.
+//
+// The filter, actuator and ap status packets of each frame are
+// written to an optional output log (same format as flight.dat.gz)
+// and folded into a digest that is printed at the end so regression
+// runs can be compared at a glance.
+//
+// This code is released into the public domain.
+//
+
+#include "python/python_sys.hxx"
+#include "python/pyprops.hxx"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <zlib.h>
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "actuators/act_mgr.hxx"
+#include "comms/display.hxx"
+#include "comms/logging.hxx"
+#include "control/control.hxx"
+#include "control/targets_mailbox.hxx"
+#include "filters/filter_mgr.hxx"
+#include "init/frame_state.hxx"
+#include "init/globals.hxx"
+#include "sensors/airdata_mgr.hxx"
+#include "sensors/gps_mgr.hxx"
+#include "sensors/imu_mgr.hxx"
+#include "sensors/pilot_mgr.hxx"
+#include "sensors/replay.hxx"
+#include "util/exception.hxx"
+#include "util/myprof.hxx"
+#include "util/netSocket.h"	// netInit()
+#include "util/sg_path.hxx"
+#include "util/timing.h"
+
+
+static const int HEARTBEAT_HZ = 100;  // master clock rate (of the log)
+
+static bool enable_mission = true;    // mission mgr module enabled/disabled
+static double gps_timeout_sec = 9.0;  // nav algorithm gps timeout
+
+// output log and digest (64 bit FNV-1a of every output byte)
+static gzFile fout = NULL;
+static uint64_t digest = 0xcbf29ce484222325ULL;
+
+
+static void usage( char *progname ) {
+    printf("\n%s [options] <flight.dat.gz or flight dir>\n", progname);
+    printf("--config path        : path to location of configuration file tree\n");
+    printf("--python_path path   : python module path\n");
+    printf("--output file        : write the filter/actuator/ap packets here\n");
+    printf("--display on/off     : dump periodic data to display\n");
+    printf("--help               : display this help messages\n\n");
+    exit(0);
+}
+
+
+// elapsed cpu side time (get_Time() is the virtual clock here)
+static double wall_clock() {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+
+static void write_output( uint8_t *buf, int size ) {
+    for ( int i = 0; i < size; i++ ) {
+	digest ^= buf[i];
+	digest *= 0x100000001b3ULL;
+    }
+    if ( fout != NULL ) {
+	gzwrite( fout, buf, size );
+    }
+}
+
+
+// point every sensor section at the log and switch off everything
+// that would touch hardware, the network or the flight log directory
+static void replay_config() {
+    const char *groups[] = {
+	"/config/sensors/imu_group",
+	"/config/sensors/gps_group",
+	"/config/sensors/airdata_group",
+	"/config/sensors/pilot_inputs"
+    };
+    for ( unsigned int i = 0; i < sizeof(groups) / sizeof(groups[0]); i++ ) {
+	pyPropertyNode group_node = pyGetNode(groups[i], true);
+	vector<string> children = group_node.getChildren();
+	for ( unsigned int j = 0; j < children.size(); j++ ) {
+	    pyPropertyNode section = group_node.getChild(children[j].c_str());
+	    section.setString("source", "replay");
+	}
+    }
+
+    pyPropertyNode act_group = pyGetNode("/config/actuators", true);
+    vector<string> children = act_group.getChildren();
+    for ( unsigned int j = 0; j < children.size(); j++ ) {
+	pyPropertyNode section = act_group.getChild(children[j].c_str());
+	section.setString("module", "null");
+    }
+
+    // secondary filters on worker threads may skip frames depending on
+    // timing, keep everything on this thread
+    pyPropertyNode config_node = pyGetNode("/config", true);
+    config_node.setLong("filter_threads", 0);
+
+    pyPropertyNode logging_node = pyGetNode("/config/logging", true);
+    logging_node.setString("path", "");
+    logging_node.setString("hostname", "");
+    logging_node.setLong("port", 0);
+    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
+    remote_link_node.setString("device", "");
+    pyPropertyNode telnet_node = pyGetNode("/config/telnet", true);
+    telnet_node.setLong("port", 0);
+}
+
+
+int main( int argc, char **argv )
+{
+    int iarg;
+
+    // Parse command line: Pass #1 to scan for a custom config root
+    // and python module path on command line
+    string root = "./config";
+    string python_path = "";
+    for ( iarg = 1; iarg < argc; iarg++ ) {
+	if ( !strcmp(argv[iarg], "--config" ) && iarg + 1 < argc ) {
+	    ++iarg;
+	    root = argv[iarg];
+	} else if ( !strcmp(argv[iarg], "--python_path" ) && iarg + 1 < argc ) {
+	    ++iarg;
+	    python_path = argv[iarg];
+	}
+    }
+
+    // start the virtual clock before anything samples it
+    set_Virtual_Time( 0.0 );
+
+    // destroy things in the correct order
+    atexit(AuraPythonCleanup);
+
+    // initialize network library
+    netInit( NULL, NULL );
+
+    // initialize python
+    AuraPythonInit(argc, argv, python_path.c_str());
+
+    // initialize properties
+    pyPropsInit();
+    pyPropertyNode comms_node = pyGetNode("/comms", true);
+    pyPropertyNode status_node = pyGetNode("/status", true);
+
+    imu_prof.set_name("imu");
+    gps_prof.set_name("gps");
+    air_prof.set_name("airdata");
+    pilot_prof.set_name("pilot");
+    filter_prof.set_name("filter");
+    mission_prof.set_name("mission");
+    control_prof.set_name("control");
+    main_prof.set_name("main");
+    myprofile::frame_budget = 1.0 / HEARTBEAT_HZ;
+    imu_prof.enable();
+    gps_prof.enable();
+    air_prof.enable();
+    pilot_prof.enable();
+    filter_prof.enable();
+    mission_prof.enable();
+    control_prof.enable();
+    main_prof.enable();
+
+    // load master config file
+    SGPath master( root );
+    master.append( "main.json" );
+    try {
+	pyPropertyNode props = pyGetNode("/", true);
+        readJSON( master.c_str(), &props);
+        printf("Loaded configuration from %s\n", master.c_str());
+	pyPropertyNode config_node = pyGetNode("/config");
+	config_node.setString("root-path", root.c_str());
+    } catch (const sg_exception &exc) {
+        printf("\n");
+        printf("*** Cannot load master config file: %s\n", master.c_str());
+	printf("*** \n%s\n***\n", exc.getFormattedMessage().c_str());
+        printf("\n");
+        printf("Cannot continue without a valid configuration, sorry.\n");
+        exit(1);
+    }
+
+    pyPropertyNode p = pyGetNode("/config", true);
+    if ( p.hasChild("gps_timeout_sec") ) {
+	gps_timeout_sec = p.getDouble("gps_timeout_sec");
+    }
+    p = pyGetNode("/config/mission", true);
+    if ( p.hasChild("enable") ) {
+	enable_mission = p.getBool("enable");
+    }
+
+    // Parse the command line: pass #2
+    string log_file = "";
+    string output_file = "";
+    for ( iarg = 1; iarg < argc; iarg++ ) {
+        if ( !strcmp(argv[iarg], "--display") && iarg + 1 < argc ) {
+            ++iarg;
+	    display_on = !strcmp(argv[iarg], "on");
+            comms_node.setBool("display_on", display_on);
+        } else if ( !strcmp(argv[iarg], "--output") && iarg + 1 < argc ) {
+            ++iarg;
+	    output_file = argv[iarg];
+        } else if ( !strcmp(argv[iarg], "--config" )
+		    || !strcmp(argv[iarg], "--python_path" ) ) {
+   	    // considered earlier in first pass
+            ++iarg;
+        } else if ( !strcmp(argv[iarg], "--help") ) {
+            usage(argv[0]);
+        } else if ( argv[iarg][0] != '-' && log_file == "" ) {
+	    log_file = argv[iarg];
+        } else {
+            printf("Unknown option \"%s\"\n", argv[iarg]);
+            usage(argv[0]);
+        }
+    }
+    if ( log_file == "" ) {
+	usage(argv[0]);
+    }
+    SGPath log_path( log_file );
+    struct stat st;
+    if ( stat( log_path.c_str(), &st ) == 0 && S_ISDIR(st.st_mode) ) {
+	log_path.append( "flight.dat.gz" );
+    }
+
+    replay_config();
+
+    // initialize required aura-core structures
+    AuraCoreInit();
+
+    if ( ! replay_open( log_path.c_str() ) ) {
+	exit(1);
+    }
+    if ( output_file != "" ) {
+	fout = gzopen( output_file.c_str(), "wb" );
+	if ( fout == NULL ) {
+	    printf("Cannot create output file: %s\n", output_file.c_str());
+	    exit(1);
+	}
+    }
+
+    IMU_init();
+    AirData_init();
+    GPS_init();
+    PilotInput_init();
+    Filter_init();
+    control_init();
+    Actuator_init();
+
+    // repeatable random numbers
+    srandom( 0 );
+
+    printf("Replaying %s\n", log_path.c_str());
+
+    double wall_start = wall_clock();
+    double first_time = -1.0;
+    double last_time = 0.0;
+    unsigned long frames = 0;
+
+    while ( replay_read_frame() ) {
+	double frame_time = replay_frame_time();
+	if ( first_time < 0.0 ) {
+	    first_time = frame_time;
+	    last_time = frame_time - 1.0 / HEARTBEAT_HZ;
+	}
+	double dt = frame_time - last_time;
+	last_time = frame_time;
+	set_Virtual_Time( frame_time );
+	status_node.setDouble("frame_time", frame_time);
+	status_node.setDouble("dt", dt);
+
+	main_prof.start();
+
+	// same order as the main loop in aura.cxx
+	bool fresh_imu_data = IMU_update();
+	AirData_update();
+	GPS_update();
+	PilotInput_update();
+
+	if ( fresh_imu_data ) {
+	    Filter_update();
+	}
+	if ( GPS_age() > gps_timeout_sec ) {
+	    status_node.setString("navigation", "invalid");
+	}
+
+	control_prof.start();
+	control_update(dt);
+	control_prof.stop();
+
+	Actuator_update();
+	frame_state_update( dt );
+
+	mission_prof.start();
+	if ( enable_mission ) {
+	    targets_mailbox_refresh();
+	    mission_mgr->update(dt);
+	    targets_mailbox_publish();
+	}
+	mission_prof.stop();
+
+	// python messages (events) have nowhere to go, but don't let
+	// them pile up
+	logging->update();
+
+	main_prof.stop();
+
+	uint8_t buf[256];
+	write_output( buf, packer->pack_filter( 0, buf ) );
+	write_output( buf, packer->pack_actuator( 0, buf ) );
+	write_output( buf, packer->pack_ap( 0, buf ) );
+
+	frames++;
+    }
+
+    double wall_time = wall_clock() - wall_start;
+    double log_time = last_time - first_time;
+
+    Filter_close();
+    IMU_close();
+    GPS_close();
+    AirData_close();
+    PilotInput_close();
+    control_close();
+    replay_close();
+    if ( fout != NULL ) {
+	gzclose( fout );
+    }
+
+    printf("\n");
+    printf("frames: %lu  packets: %lu  skipped: %lu  errors: %lu\n",
+	   frames, replay_get_packets(), replay_get_skipped(),
+	   replay_get_errors());
+    printf("log time: %.1f sec  run time: %.2f sec  speedup: %.0fx\n",
+	   log_time, wall_time, wall_time > 0.0 ? log_time / wall_time : 0.0);
+    if ( frames > 0 ) {
+	printf("frame cost: %.1f usec\n", wall_time * 1000000.0 / frames);
+    }
+    printf("output digest: %016llx\n", (unsigned long long)digest);
+    printf("\n");
+    imu_prof.stats();
+    gps_prof.stats();
+    air_prof.stats();
+    pilot_prof.stats();
+    filter_prof.stats();
+    mission_prof.stats();
+    control_prof.stats();
+    main_prof.stats();
+
+    return 0;
+}
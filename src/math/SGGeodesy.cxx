@@ -23,6 +23,7 @@
 
 #include "util/exception.hxx"
 #include "SGMath.hxx"
+#include "SGSimd.hxx"
 
 // These are hard numbers from the WGS84 standard.  DON'T MODIFY
 // unless you want to change the datum.
@@ -552,3 +553,383 @@ SGGeodesy::distanceM(const SGGeoc& from, const SGGeoc& to)
   double s = SGMiscd::min(sqrt(SGMiscd::max(square, 0)), 1);
   return 2 * asin(s) * SG_RAD_TO_NM * SG_NM_TO_METER;
 }
+
+////////////////////////////////////////////////////////////////////////
+//
+// Batch versions over structure of arrays.  SG_SIMD_LANES points go
+// through the same algorithms as above in lock step (see
+// SGSimd.hxx), the iterations run until every lane converged.  Lanes
+// that hit one of the special cases (coincident, polar or antipodal
+// points, non convergence, near the geocenter) are redone with the
+// scalar routine.  Without vector support these are plain loops over
+// the scalar routines.
+//
+////////////////////////////////////////////////////////////////////////
+
+#if SG_SIMD_LANES > 1
+
+static const int batch_max_iter = 100;
+
+// one block of the inverse problem, fallback marks the lanes that
+// need the scalar routine
+static void _geo_inverse_lanes( sgvd lat1, sgvd lon1, sgvd lat2, sgvd lon2,
+                                sgvd *az1, sgvd *az2, sgvd *s,
+                                sgvm *fallback )
+{
+    const double a = SGGeodesy::EQURAD, rf = SGGeodesy::iFLATTENING;
+    const double testv = 1.0E-10;
+    const double f = ( rf > 0.0 ? 1.0/rf : 0.0 );
+    const double b = a*(1.0-f);
+    const double pi = SGMiscd::pi();
+    sgvd phi1 = lat1*pi/180, lam1 = lon1*pi/180;
+    sgvd phi2 = lat2*pi/180, lam2 = lon2*pi/180;
+    sgvd sinphi1, cosphi1, sinphi2, cosphi2;
+    sg_sincos( phi1, &sinphi1, &cosphi1 );
+    sg_sincos( phi2, &sinphi2, &cosphi2 );
+
+    sgvd v_testv = sg_set( testv );
+    sgvm special =
+        ( sg_lt(sg_abs(lat1-lat2), v_testv) & sg_lt(sg_abs(lon1-lon2), v_testv) )
+        | sg_lt( sg_abs(lat1-90.0), v_testv )
+        | sg_lt( sg_abs(cosphi1), v_testv )
+        | sg_lt( sg_abs(cosphi2), v_testv )
+        | ( sg_lt(sg_abs(sg_abs(lon1-lon2) - 180.0), v_testv)
+            & sg_lt(sg_abs(lat1+lat2), v_testv) );
+
+    // Reduced latitudes
+    sgvd temp = (1.0-f)*sinphi1/cosphi1;
+    sgvd cosu1 = 1.0/sg_sqrt(1.0+temp*temp);
+    sgvd sinu1 = temp*cosu1;
+    temp = (1.0-f)*sinphi2/cosphi2;
+    sgvd cosu2 = 1.0/sg_sqrt(1.0+temp*temp);
+    sgvd sinu2 = temp*cosu2;
+    sgvm sinu_zero = ~( sg_lt(sg_set(0.0), sg_abs(sinu1))
+                        & sg_lt(sg_set(0.0), sg_abs(sinu2)) );
+
+    sgvd dlam = lam2 - lam1, dlams = dlam;
+    sgvd sdlams = sg_set(0.0), cdlams = sg_set(0.0), sig = sg_set(0.0);
+    sgvd sinsig = sg_set(0.0), cossig = sg_set(0.0), sinaz = sg_set(0.0);
+    sgvd cos2saz = sg_set(0.0), c2sigm = sg_set(0.0);
+
+    sgvm active = ~special;
+    int iter = 0;
+    while ( sg_any(active) && iter++ < batch_max_iter ) {
+        sgvd n_sdlams, n_cdlams;
+        sg_sincos( dlams, &n_sdlams, &n_cdlams );
+        sgvd t1 = cosu1*sinu2-sinu1*cosu2*n_cdlams;
+        sgvd n_sinsig = sg_sqrt(cosu2*cosu2*n_sdlams*n_sdlams + t1*t1);
+        sgvd n_cossig = sinu1*sinu2+cosu1*cosu2*n_cdlams;
+        sgvd n_sig = sg_atan2(n_sinsig, n_cossig);
+        sgvd n_sinaz = cosu1*cosu2*n_sdlams/n_sinsig;
+        sgvd n_cos2saz = 1.0-n_sinaz*n_sinaz;
+        sgvd n_c2sigm = sg_select( sinu_zero, n_cossig,
+                                   n_cossig-2.0*sinu1*sinu2/n_cos2saz );
+        sgvd tc = f*n_cos2saz*(4.0+f*(4.0-3.0*n_cos2saz))/16.0;
+        sgvd n_dlams = dlam+(1.0-tc)*f*n_sinaz*
+            (n_sig+tc*n_sinsig*
+             (n_c2sigm+tc*n_cossig*(-1.0+2.0*n_c2sigm*n_c2sigm)));
+
+        sdlams = sg_select( active, n_sdlams, sdlams );
+        cdlams = sg_select( active, n_cdlams, cdlams );
+        sinsig = sg_select( active, n_sinsig, sinsig );
+        cossig = sg_select( active, n_cossig, cossig );
+        sig = sg_select( active, n_sig, sig );
+        sinaz = sg_select( active, n_sinaz, sinaz );
+        cos2saz = sg_select( active, n_cos2saz, cos2saz );
+        c2sigm = sg_select( active, n_c2sigm, c2sigm );
+        sgvd prev = dlams;
+        dlams = sg_select( active, n_dlams, dlams );
+        // (a NaN difference doesn't compare greater, that lane stops
+        // and goes to the scalar routine below)
+        active = active & sg_lt( v_testv, sg_abs(prev-dlams) );
+        special = special | ( ~sg_le(sg_abs(prev-dlams), v_testv) & ~active );
+    }
+    *fallback = special | active;
+
+    sgvd us = cos2saz*(a*a-b*b)/(b*b);
+    // BACK AZIMUTH FROM NORTH
+    sgvd r2 = sg_atan2( -(cosu1*sdlams), sinu1*cosu2-cosu1*sinu2*cdlams )
+        * 180 / pi;
+    r2 = sg_select( sg_lt(sg_abs(r2), v_testv), sg_set(0.0), r2 );
+    *az2 = sg_select( sg_lt(r2, sg_set(0.0)), r2 + 360.0, r2 );
+
+    // FORWARD AZIMUTH FROM NORTH
+    sgvd r1 = sg_atan2( cosu2*sdlams, cosu1*sinu2-sinu1*cosu2*cdlams )
+        * 180 / pi;
+    r1 = sg_select( sg_lt(sg_abs(r1), v_testv), sg_set(0.0), r1 );
+    *az1 = sg_select( sg_lt(r1, sg_set(0.0)), r1 + 360.0, r1 );
+
+    // Terms a & b
+    sgvd ta = 1.0+us*(4096.0+us*(-768.0+us*(320.0-175.0*us)))/16384.0;
+    sgvd tb = us*(256.0+us*(-128.0+us*(74.0-47.0*us)))/1024.0;
+
+    // GEODETIC DISTANCE
+    *s = b*ta*(sig-tb*sinsig*
+               (c2sigm+tb*(cossig*(-1.0+2.0*c2sigm*c2sigm)-tb*
+                           c2sigm*(-3.0+4.0*sinsig*sinsig)*
+                           (-3.0+4.0*c2sigm*c2sigm)/6.0)/
+                4.0));
+}
+
+void
+SGGeodesy::inverseBatch(unsigned n, const double *lat1, const double *lon1,
+                        const double *lat2, const double *lon2,
+                        double *course1, double *course2, double *distance)
+{
+  for (unsigned i = 0; i < n; i += SG_SIMD_LANES) {
+    int count = (n - i < SG_SIMD_LANES) ? n - i : SG_SIMD_LANES;
+    sgvd az1, az2, s;
+    sgvm fallback;
+    _geo_inverse_lanes(sg_load(lat1 + i, count), sg_load(lon1 + i, count),
+                       sg_load(lat2 + i, count), sg_load(lon2 + i, count),
+                       &az1, &az2, &s, &fallback);
+    if (sg_any(fallback)) {
+      for (int j = 0; j < count; j++) {
+        if (sg_lane(fallback, j)) {
+          double c1 = 0.0, c2 = 0.0, d = 0.0;
+          _geo_inverse_wgs_84(lat1[i+j], lon1[i+j], lat2[i+j], lon2[i+j],
+                              &c1, &c2, &d);
+          sg_set_lane(az1, j, c1);
+          sg_set_lane(az2, j, c2);
+          sg_set_lane(s, j, d);
+        }
+      }
+    }
+    sg_store(course1 + i, az1, count);
+    sg_store(course2 + i, az2, count);
+    sg_store(distance + i, s, count);
+  }
+}
+
+// one block of the direct problem
+static void _geo_direct_lanes( sgvd lat1, sgvd lon1, sgvd az1, sgvd s,
+                               sgvd *lat2, sgvd *lon2, sgvd *az2,
+                               sgvm *fallback )
+{
+    const double a = SGGeodesy::EQURAD, rf = SGGeodesy::iFLATTENING;
+    const double testv = 1.0E-10;
+    const double f = ( rf > 0.0 ? 1.0/rf : 0.0 );
+    const double b = a*(1.0-f);
+    const double e2 = f*(2.0-f);
+    const double pi = SGMiscd::pi();
+    sgvd phi1 = lat1*pi/180, lam1 = lon1*pi/180;
+    sgvd sinphi1, cosphi1;
+    sg_sincos( phi1, &sinphi1, &cosphi1 );
+    sgvd azm1 = az1*pi/180;
+    sgvd sinaz1, cosaz1;
+    sg_sincos( azm1, &sinaz1, &cosaz1 );
+
+    sgvd v_testv = sg_set( testv );
+    // congruency and polar origin
+    sgvm special = sg_lt( sg_abs(s), sg_set(0.01) )
+        | sg_le( sg_abs(cosphi1), sg_set(SGLimitsd::min()) );
+
+    // u1 is reduced latitude
+    sgvd tanu1 = sqrt(1.0-e2)*sinphi1/cosphi1;
+    sgvd sig1 = sg_atan2(tanu1,cosaz1);
+    sgvd cosu1 = 1.0/sg_sqrt( 1.0 + tanu1*tanu1 ), sinu1 = tanu1*cosu1;
+    sgvd sinaz =  cosu1*sinaz1, cos2saz = 1.0-sinaz*sinaz;
+    sgvd us = cos2saz*e2/(1.0-e2);
+
+    // Terms
+    sgvd ta = 1.0+us*(4096.0+us*(-768.0+us*(320.0-175.0*us)))/16384.0;
+    sgvd tb = us*(256.0+us*(-128.0+us*(74.0-47.0*us)))/1024.0;
+
+    // FIRST ESTIMATE OF SIGMA (SIG)
+    sgvd first = s/(b*ta);
+    sgvd sig = first;
+    sgvd c2sigm = sg_set(0.0), sinsig = sg_set(0.0), cossig = sg_set(0.0);
+
+    sgvm active = ~special;
+    int iter = 0;
+    while ( sg_any(active) && iter++ < batch_max_iter ) {
+        sgvd n_c2sigm, n_sinsig, n_cossig, unused;
+        sg_sincos( 2.0*sig1+sig, &unused, &n_c2sigm );
+        sg_sincos( sig, &n_sinsig, &n_cossig );
+        sgvd n_sig = first +
+            tb*n_sinsig*(n_c2sigm+tb*(n_cossig*(-1.0+2.0*n_c2sigm*n_c2sigm) -
+                                      tb*n_c2sigm*(-3.0+4.0*n_sinsig*n_sinsig)
+                                      *(-3.0+4.0*n_c2sigm*n_c2sigm)/6.0)
+                         /4.0);
+
+        c2sigm = sg_select( active, n_c2sigm, c2sigm );
+        sinsig = sg_select( active, n_sinsig, sinsig );
+        cossig = sg_select( active, n_cossig, cossig );
+        sgvd prev = sig;
+        sig = sg_select( active, n_sig, sig );
+        active = active & sg_lt( v_testv, sg_abs(sig-prev) );
+        special = special | ( ~sg_le(sg_abs(sig-prev), v_testv) & ~active );
+    }
+    *fallback = special | active;
+
+    // LATITUDE OF POINT 2
+    // DENOMINATOR IN 2 PARTS (TEMP ALSO USED LATER)
+    sgvd temp = sinu1*sinsig-cosu1*cossig*cosaz1;
+    sgvd denom = (1.0-f)*sg_sqrt(sinaz*sinaz+temp*temp);
+
+    // NUMERATOR
+    sgvd rnumer = sinu1*cossig+cosu1*sinsig*cosaz1;
+    *lat2 = sg_atan2(rnumer,denom)*180/pi;
+
+    // DIFFERENCE IN LONGITUDE ON AUXILARY SPHERE (DLAMS )
+    rnumer = sinsig*sinaz1;
+    denom = cosu1*cossig-sinu1*sinsig*cosaz1;
+    sgvd dlams = sg_atan2(rnumer,denom);
+
+    // TERM C
+    sgvd tc = f*cos2saz*(4.0+f*(4.0-3.0*cos2saz))/16.0;
+
+    // DIFFERENCE IN LONGITUDE
+    sgvd dlam = dlams-(1.0-tc)*f*sinaz*(sig+tc*sinsig*
+                                        (c2sigm+
+                                         tc*cossig*(-1.0+2.0*
+                                                    c2sigm*c2sigm)));
+    sgvd lon = (lam1+dlam)*180/pi;
+    lon = sg_select( sg_lt(sg_set(180.0), lon), lon - 360.0, lon );
+    *lon2 = sg_select( sg_lt(lon, sg_set(-180.0)), lon + 360.0, lon );
+
+    // AZIMUTH - FROM NORTH
+    sgvd r2 = sg_atan2(-sinaz,temp)*180/pi;
+    r2 = sg_select( sg_lt(sg_abs(r2), v_testv), sg_set(0.0), r2 );
+    *az2 = sg_select( sg_lt(r2, sg_set(0.0)), r2 + 360.0, r2 );
+}
+
+void
+SGGeodesy::directBatch(unsigned n, const double *lat1, const double *lon1,
+                       const double *course1, const double *distance,
+                       double *lat2, double *lon2, double *course2)
+{
+  for (unsigned i = 0; i < n; i += SG_SIMD_LANES) {
+    int count = (n - i < SG_SIMD_LANES) ? n - i : SG_SIMD_LANES;
+    sgvd la2, lo2, az2;
+    sgvm fallback;
+    _geo_direct_lanes(sg_load(lat1 + i, count), sg_load(lon1 + i, count),
+                      sg_load(course1 + i, count),
+                      sg_load(distance + i, count),
+                      &la2, &lo2, &az2, &fallback);
+    if (sg_any(fallback)) {
+      for (int j = 0; j < count; j++) {
+        if (sg_lane(fallback, j)) {
+          double lat = 0.0, lon = 0.0, az = 0.0;
+          _geo_direct_wgs_84(lat1[i+j], lon1[i+j], course1[i+j],
+                             distance[i+j], &lat, &lon, &az);
+          sg_set_lane(la2, j, lat);
+          sg_set_lane(lo2, j, lon);
+          sg_set_lane(az2, j, az);
+        }
+      }
+    }
+    sg_store(lat2 + i, la2, count);
+    sg_store(lon2 + i, lo2, count);
+    sg_store(course2 + i, az2, count);
+  }
+}
+
+// one block of SGCartToGeod() (same Vermeille algorithm)
+static void _cart_to_geod_lanes( sgvd X, sgvd Y, sgvd Z,
+                                 sgvd *lon, sgvd *lat, sgvd *elev,
+                                 sgvm *fallback )
+{
+    const double pi = SGMiscd::pi();
+    sgvd XXpYY = X*X+Y*Y;
+    // near the geocenter
+    sgvm special = sg_lt( XXpYY + Z*Z, sg_set(25.0) );
+
+    sgvd sqrtXXpYY = sg_sqrt(XXpYY);
+    sgvd p = XXpYY*ra2;
+    sgvd q = Z*Z*(1-e2)*ra2;
+    sgvd r = 1/6.0*(p+q-e4);
+    sgvd s = e4*p*q/(4*r*r*r);
+    s = sg_select( sg_le(sg_set(-2.0), s) & sg_le(s, sg_set(0.0)),
+                   sg_set(0.0), s );
+    sgvd t3 = 1+s+sg_sqrt(s*(2+s));
+    // the cube root kernel covers [1, 2] (anything near the earth's
+    // surface), the scalar pow() does the rest
+    special = special | ~( sg_le(sg_set(1.0), t3) & sg_le(t3, sg_set(2.0)) );
+    *fallback = special;
+
+    sgvd t = sg_cbrt12( sg_select(special, sg_set(1.0), t3) );
+    sgvd u = r*(1+t+1/t);
+    sgvd v = sg_sqrt(u*u+e4*q);
+    sgvd w = e2*(u+v-q)/(2*v);
+    sgvd k = sg_sqrt(u+v+w*w)-w;
+    sgvd D = k*sqrtXXpYY/(k+e2);
+    *lon = 2*sg_atan2(Y, X+sqrtXXpYY) * 180 / pi;
+    sgvd sqrtDDpZZ = sg_sqrt(D*D+Z*Z);
+    *lat = 2*sg_atan2(Z, D+sqrtDDpZZ) * 180 / pi;
+    *elev = (k+e2-1)*sqrtDDpZZ/k;
+}
+
+void
+SGGeodesy::SGCartToGeodBatch(unsigned n, const double *x, const double *y,
+                             const double *z, double *lon_deg,
+                             double *lat_deg, double *elev_m)
+{
+  for (unsigned i = 0; i < n; i += SG_SIMD_LANES) {
+    int count = (n - i < SG_SIMD_LANES) ? n - i : SG_SIMD_LANES;
+    sgvd lon, lat, elev;
+    sgvm fallback;
+    _cart_to_geod_lanes(sg_load(x + i, count), sg_load(y + i, count),
+                        sg_load(z + i, count), &lon, &lat, &elev, &fallback);
+    if (sg_any(fallback)) {
+      for (int j = 0; j < count; j++) {
+        if (sg_lane(fallback, j)) {
+          SGGeod geod;
+          SGCartToGeod(SGVec3<double>(x[i+j], y[i+j], z[i+j]), geod);
+          sg_set_lane(lon, j, geod.getLongitudeDeg());
+          sg_set_lane(lat, j, geod.getLatitudeDeg());
+          sg_set_lane(elev, j, geod.getElevationM());
+        }
+      }
+    }
+    sg_store(lon_deg + i, lon, count);
+    sg_store(lat_deg + i, lat, count);
+    sg_store(elev_m + i, elev, count);
+  }
+}
+
+#else
+
+void
+SGGeodesy::inverseBatch(unsigned n, const double *lat1, const double *lon1,
+                        const double *lat2, const double *lon2,
+                        double *course1, double *course2, double *distance)
+{
+  for (unsigned i = 0; i < n; i++) {
+    _geo_inverse_wgs_84(lat1[i], lon1[i], lat2[i], lon2[i],
+                        &course1[i], &course2[i], &distance[i]);
+  }
+}
+
+void
+SGGeodesy::directBatch(unsigned n, const double *lat1, const double *lon1,
+                       const double *course1, const double *distance,
+                       double *lat2, double *lon2, double *course2)
+{
+  for (unsigned i = 0; i < n; i++) {
+    _geo_direct_wgs_84(lat1[i], lon1[i], course1[i], distance[i],
+                       &lat2[i], &lon2[i], &course2[i]);
+  }
+}
+
+void
+SGGeodesy::SGCartToGeodBatch(unsigned n, const double *x, const double *y,
+                             const double *z, double *lon_deg,
+                             double *lat_deg, double *elev_m)
+{
+  for (unsigned i = 0; i < n; i++) {
+    SGGeod geod;
+    SGCartToGeod(SGVec3<double>(x[i], y[i], z[i]), geod);
+    lon_deg[i] = geod.getLongitudeDeg();
+    lat_deg[i] = geod.getLatitudeDeg();
+    elev_m[i] = geod.getElevationM();
+  }
+}
+
+#endif // SG_SIMD_LANES > 1
+
+const char *
+SGGeodesy::batchSimdName()
+{
+  return SG_SIMD_NAME;
+}
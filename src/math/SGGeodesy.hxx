@@ -57,6 +57,26 @@ public:
   static double distanceM(const SGGeod& from, const SGGeod& to);
   static double distanceNm(const SGGeod& from, const SGGeod& to);
     
+  // Batch versions of inverse(), direct() and SGCartToGeod() over
+  // structure of arrays (n points, angles in degrees, distances in
+  // meters.)  Vectorized when built for SSE2/AVX or aarch64 NEON (see
+  // SGSimd.hxx), results agree with the scalar functions to well
+  // under a micrometer.
+  static void inverseBatch(unsigned n, const double *lat1,
+                           const double *lon1, const double *lat2,
+                           const double *lon2, double *course1,
+                           double *course2, double *distance);
+  static void directBatch(unsigned n, const double *lat1,
+                          const double *lon1, const double *course1,
+                          const double *distance, double *lat2,
+                          double *lon2, double *course2);
+  static void SGCartToGeodBatch(unsigned n, const double *x,
+                                const double *y, const double *z,
+                                double *lon_deg, double *lat_deg,
+                                double *elev_m);
+  // instruction set the batch functions were built for
+  static const char *batchSimdName();
+
   // Geocentric course/distance computation
   static void advanceRadM(const SGGeoc& geoc, double course, double distance,
                           SGGeoc& result);
@@ -0,0 +1,224 @@
+// SGSimd.hxx - a few packed double operations for the batch geodesy
+// routines (SGGeodesy::*Batch)
+//
+// sgvd holds SG_SIMD_LANES doubles: 4 with AVX, 2 with SSE2 or
+// aarch64 NEON.  Otherwise (or with SG_NO_SIMD defined)
+// SG_SIMD_LANES is 1 and nothing else is defined, the batch functions
+// just loop over the scalar ones.  32 bit ARM NEON has no double
+// precision lanes so it gets the loops too.  The gcc/clang
+// vector extensions let the same source compile to each instruction
+// set; only sqrt needs an intrinsic.
+//
+// Masks (sgvm) are 0 or -1 per lane, like the vector compares.  The
+// sin/cos and atan2 kernels are the fdlibm polynomials without the
+// large argument reduction, fine for the angles the geodesy code
+// works with (|x| < 1e5 rad.)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+
+#ifndef SGSimd_H
+#define SGSimd_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(SG_NO_SIMD)
+# define SG_SIMD_LANES 1
+# define SG_SIMD_NAME "scalar"
+#elif defined(__AVX__)
+# include <immintrin.h>
+# define SG_SIMD_LANES 4
+# define SG_SIMD_NAME "avx"
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+# define SG_SIMD_LANES 2
+# define SG_SIMD_NAME "sse2"
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define SG_SIMD_LANES 2
+# define SG_SIMD_NAME "neon"
+#else
+# define SG_SIMD_LANES 1
+# define SG_SIMD_NAME "scalar"
+#endif
+
+#if SG_SIMD_LANES > 1
+
+typedef double sgvd __attribute__((vector_size(SG_SIMD_LANES * 8)));
+typedef int64_t sgvm __attribute__((vector_size(SG_SIMD_LANES * 8)));
+
+static inline sgvm sg_bits( sgvd x ) { return (sgvm)x; }
+static inline sgvd sg_double( sgvm m ) { return (sgvd)m; }
+
+static inline sgvd sg_set( double x ) {
+    sgvd r = {};
+    return r + x;
+}
+
+static inline sgvm sg_lt( sgvd a, sgvd b ) { return (sgvm)(a < b); }
+static inline sgvm sg_le( sgvd a, sgvd b ) { return (sgvm)(a <= b); }
+
+static inline bool sg_any( sgvm m ) {
+    for ( int i = 0; i < SG_SIMD_LANES; i++ ) {
+	if ( m[i] ) return true;
+    }
+    return false;
+}
+
+static inline double sg_lane( sgvd v, int i ) { return v[i]; }
+static inline void sg_set_lane( sgvd &v, int i, double x ) { v[i] = x; }
+static inline bool sg_lane( sgvm m, int i ) { return m[i] != 0; }
+
+static inline sgvd sg_sqrt( sgvd x ) {
+#if defined(__AVX__)
+    return (sgvd)_mm256_sqrt_pd( (__m256d)x );
+#elif defined(__SSE2__)
+    return (sgvd)_mm_sqrt_pd( (__m128d)x );
+#else
+    return (sgvd)vsqrtq_f64( (float64x2_t)x );
+#endif
+}
+
+
+// count lanes from p, the rest are copies of p[0] (so they stay
+// well behaved)
+static inline sgvd sg_load( const double *p, int count ) {
+    sgvd v = sg_set( p[0] );
+    for ( int i = 1; i < count; i++ ) {
+	sg_set_lane( v, i, p[i] );
+    }
+    return v;
+}
+
+static inline void sg_store( double *p, sgvd v, int count ) {
+    for ( int i = 0; i < count; i++ ) {
+	p[i] = sg_lane( v, i );
+    }
+}
+
+// m ? a : b per lane
+static inline sgvd sg_select( sgvm m, sgvd a, sgvd b ) {
+    return sg_double( (sg_bits(a) & m) | (sg_bits(b) & ~m) );
+}
+
+static inline sgvd sg_abs( sgvd x ) {
+    return sg_double( sg_bits(x) & 0x7fffffffffffffffLL );
+}
+
+// -1 where the sign bit is set
+static inline sgvm sg_signbit( sgvd x ) {
+    return sg_bits(x) >> 63;
+}
+
+// flip the sign where m is set
+static inline sgvd sg_negate( sgvd x, sgvm m ) {
+    return sg_double( sg_bits(x) ^ (m & (-0x7fffffffffffffffLL - 1)) );
+}
+
+
+// sin and cos (fdlibm kernels after a Cody-Waite reduction by pi/2)
+static inline void sg_sincos( sgvd x, sgvd *s, sgvd *c ) {
+    const double magic = 6755399441055744.0;	// 1.5 * 2^52
+    const double pio2_1 = 1.57079632673412561417e+00;
+    const double pio2_2 = 6.07710050630396597660e-11;
+    const double pio2_2t = 2.02226624879595063154e-21;
+
+    // n = nearest integer to x * 2/pi (the low bits of t hold it)
+    sgvd t = x * 6.36619772367581382433e-01 + magic;
+    sgvd n = t - magic;
+    sgvm q = sg_bits(t);
+    sgvd r = ((x - n * pio2_1) - n * pio2_2) - n * pio2_2t;
+
+    sgvd z = r * r;
+    sgvd ps = r + r * z * (-1.66666666666666324348e-01 + z *
+			   (8.33333333332248946124e-03 + z *
+			    (-1.98412698298579493134e-04 + z *
+			     (2.75573137070700676789e-06 + z *
+			      (-2.50507602534068634195e-08 + z *
+			       1.58969099521155010221e-10)))));
+    sgvd pc = 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02 + z *
+				       (-1.38888888888741095749e-03 + z *
+					(2.48015872894767294178e-05 + z *
+					 (-2.75573143513906633035e-07 + z *
+					  (2.08757232129817482790e-09 + z *
+					   -1.13596475577881948265e-11)))));
+
+    // quadrant: sin = s, c, -s, -c  cos = c, -s, -c, s
+    sgvm odd = -(q & 1);
+    *s = sg_negate( sg_select(odd, pc, ps), -((q >> 1) & 1) );
+    *c = sg_negate( sg_select(odd, ps, pc), -(((q + 1) >> 1) & 1) );
+}
+
+// atan for 0 <= x <= 1 (fdlibm)
+static inline sgvd sg_atan01( sgvd x ) {
+    // x < 7/16: atan(x) directly
+    // x < 11/16: atan(1/2) + atan((2x-1)/(2+x))
+    // otherwise: atan(1) + atan((x-1)/(x+1))
+    sgvm small = sg_lt( x, sg_set(0.4375) );
+    sgvm mid = sg_lt( x, sg_set(0.6875) );
+    sgvd xr = sg_select( mid, (2.0 * x - 1.0) / (2.0 + x),
+			 (x - 1.0) / (x + 1.0) );
+    xr = sg_select( small, x, xr );
+    sgvd hi = sg_select( mid, sg_set(4.63647609000806093515e-01),
+			 sg_set(7.85398163397448278999e-01) );
+    sgvd lo = sg_select( mid, sg_set(2.26987774529616870924e-17),
+			 sg_set(3.06161699786838301793e-17) );
+
+    sgvd z = xr * xr;
+    sgvd w = z * z;
+    sgvd s1 = z * (3.33333333333329318027e-01 + w *
+		   (1.42857142725034663711e-01 + w *
+		    (9.09088713343650656196e-02 + w *
+		     (6.66107313738753120669e-02 + w *
+		      (4.97687799461593236017e-02 + w *
+		       1.62858201153657823623e-02)))));
+    sgvd s2 = w * (-1.99999999998764832476e-01 + w *
+		   (-1.11111104054623557880e-01 + w *
+		    (-7.69187620504482999495e-02 + w *
+		     (-5.83357013379057348645e-02 + w *
+		      -3.65315727442169155270e-02))));
+    sgvd p = xr * (s1 + s2);
+    return sg_select( small, xr - p, hi - ((p - lo) - xr) );
+}
+
+// atan2 with the libm quadrant and signed zero conventions
+static inline sgvd sg_atan2( sgvd y, sgvd x ) {
+    const double pio2_hi = 1.57079632679489655800e+00;
+    const double pio2_lo = 6.12323399573676603587e-17;
+    const double pi_hi = 3.1415926535897931160e+00;
+    const double pi_lo = 1.2246467991473531772e-16;
+
+    sgvd ay = sg_abs(y);
+    sgvd ax = sg_abs(x);
+    sgvm swap = sg_lt( ax, ay );
+    sgvd num = sg_select( swap, ax, ay );
+    sgvd den = sg_select( swap, ay, ax );
+    sgvd t = sg_select( sg_lt(sg_set(0.0), den), num / den, sg_set(0.0) );
+    sgvd a = sg_atan01( t );
+    a = sg_select( swap, pio2_hi - (a - pio2_lo), a );
+    a = sg_select( sg_signbit(x), pi_hi - (a - pi_lo), a );
+    return sg_negate( a, sg_signbit(y) );
+}
+
+// cube root for 1 <= x <= 2 (Halley iterations from a quadratic
+// guess)
+static inline sgvd sg_cbrt12( sgvd x ) {
+    sgvd e = x - 1.0;
+    sgvd y = 1.0 + e * (1.0 / 3.0 - e * (1.0 / 9.0));
+    for ( int i = 0; i < 3; i++ ) {
+	sgvd y3 = y * y * y;
+	y = y * (y3 + 2.0 * x) / (2.0 * y3 + x);
+    }
+    // final newton step to clean up the rounding
+    return y - (y * y * y - x) / (3.0 * y * y);
+}
+
+
+#endif // SG_SIMD_LANES > 1
+
+#endif // SGSimd_H
@@ -1,6 +1,7 @@
 from props import root, getNode
 
 import comms.events
+import control.navigation
 
 import task.is_airborne
 import task.camera
@@ -23,7 +24,11 @@ import mission.greatcircle
 
 class MissionMgr:
     def __init__(self):
-        self.targets_node = getNode("/autopilot/targets", True)
+        # the tasks set /task/targets (and the mode, throttle and
+        # flaps setpoint under /task), the native side posts the
+        # changes to the control thread after each update (see
+        # control/targets_mailbox.hxx)
+        self.targets_node = getNode("/task/targets", True)
         self.missions_node = getNode("/config/mission", True)
         self.pos_node = getNode("/position", True)
         self.task_node = getNode("/task", True)
@@ -75,6 +80,8 @@ class MissionMgr:
         return result
     
     def init(self):
+        control.navigation.init()
+
         print "global_tasks:"
         global_node = self.missions_node.getChild("global_tasks", True)
         if global_node:
@@ -140,6 +147,9 @@ class MissionMgr:
         if not len(self.seq_tasks):
 	    # sequential queue is empty so request the idle task
 	    self.request_task_idle()
+
+        # route requests from the ground station or the tasks above
+        control.navigation.update(dt)
         return True
 
     def find_global_task(self, name):
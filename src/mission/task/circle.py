@@ -15,9 +15,9 @@ class Circle(Task):
         self.pos_node = getNode("/position", True)
         self.orient_node = getNode("/orientation", True)
         self.circle_node = getNode("/task/circle", True)
-        self.ap_node = getNode("/autopilot", True)
+        self.ap_node = getNode("/task/autopilot", True)
         self.nav_node = getNode("/navigation", True)
-        self.targets_node = getNode("/autopilot/targets", True)
+        self.targets_node = getNode("/task/targets", True)
 
         self.coord_path = ""
         self.direction = "left"
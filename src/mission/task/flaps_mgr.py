@@ -7,6 +7,7 @@ class FlapsMgr(Task):
     def __init__(self, config_node):
         Task.__init__(self)
         self.flight_node = getNode("/controls/flight", True)
+        self.task_flight_node = getNode("/task/controls/flight", True)
         self.imu_node = getNode("/sensors/imu", True)
         
         self.name = config_node.getString("name")
@@ -26,7 +27,7 @@ class FlapsMgr(Task):
         if not self.active:
             return False
 
-        target_value = self.flight_node.getFloat("flaps_setpoint")
+        target_value = self.task_flight_node.getFloat("flaps_setpoint")
         current_value = self.flight_node.getFloat("flaps")
         df = target_value - current_value
         max = dt / self.speed_secs
@@ -13,8 +13,8 @@ class Idle(Task):
     def __init__(self, config_node):
         Task.__init__(self)
         self.task_node = getNode("/task", True)
-        self.ap_node = getNode("/autopilot", True)
-        self.engine_node = getNode("/controls/engine", True)
+        self.ap_node = getNode("/task/autopilot", True)
+        self.engine_node = getNode("/task/controls/engine", True)
         self.saved_fcs_mode = ""
         self.name = config_node.getString("name")
         self.nickname = config_node.getString("nickname")
@@ -17,16 +17,16 @@ class Land(Task):
         self.task_node = getNode("/task", True)
         self.land_node = getNode("/task/land", True)
         self.route_node = getNode("/task/route", True)
-        self.ap_node = getNode("/autopilot", True)
+        self.ap_node = getNode("/task/autopilot", True)
         self.nav_node = getNode("/navigation", True)
         self.pos_node = getNode("/position", True)
         self.vel_node = getNode("/velocity", True)
         self.orient_node = getNode("/orientation", True)
-	self.flight_node = getNode("/controls/flight", True)
-        self.engine_node = getNode("/controls/engine", True)
+	self.flight_node = getNode("/task/controls/flight", True)
+        self.engine_node = getNode("/task/controls/engine", True)
         self.imu_node = getNode("/sensors/imu", True)
         self.home_node = getNode("/task/home", True)
-        self.targets_node = getNode("/autopilot/targets", True)
+        self.targets_node = getNode("/task/targets", True)
 
         # get task configuration parameters
         self.name = config_node.getString("name")
@@ -24,15 +24,15 @@ class Land(Task):
         self.land_node = getNode("/task/land", True)
         self.circle_node = getNode("/task/circle", True)
         self.route_node = getNode("/task/route", True)
-        self.ap_node = getNode("/autopilot", True)
+        self.ap_node = getNode("/task/autopilot", True)
         self.nav_node = getNode("/navigation", True)
         self.pos_node = getNode("/position", True)
         self.vel_node = getNode("/velocity", True)
         self.orient_node = getNode("/orientation", True)
-	self.flight_node = getNode("/controls/flight", True)
-        self.engine_node = getNode("/controls/engine", True)
+	self.flight_node = getNode("/task/controls/flight", True)
+        self.engine_node = getNode("/task/controls/engine", True)
         self.imu_node = getNode("/sensors/imu", True)
-        self.targets_node = getNode("/autopilot/targets", True)
+        self.targets_node = getNode("/task/targets", True)
 
         # get task configuration parameters
         self.name = config_node.getString("name")
@@ -186,7 +186,7 @@ class Land(Task):
                     self.nav_node.setString("mode", "route")
         else:
             # on final approach
-            if control.route.dist_valid:
+            if control.route.dist_valid():
                 self.dist_rem_m = self.route_node.getFloat("dist_remaining_m")
 
         # compute glideslope/target elevation
@@ -12,14 +12,16 @@ class Launch(Task):
         Task.__init__(self)
 
 	self.ap_node = getNode("/autopilot", True)
+	self.task_ap_node = getNode("/task/autopilot", True)
 	self.task_node = getNode("/task", True)
 	self.pos_node = getNode("/position", True)
 	self.vel_node = getNode("/velocity", True)
 	self.orient_node = getNode("/orientation", True)
-	self.targets_node = getNode("/autopilot/targets", True)
+	self.targets_node = getNode("/task/targets", True)
 	self.imu_node = getNode("/sensors/imu", True)
 	self.flight_node = getNode("/controls/flight", True)
-	self.engine_node = getNode("/controls/engine", True)
+	self.task_flight_node = getNode("/task/controls/flight", True)
+	self.engine_node = getNode("/task/controls/engine", True)
 
         self.complete_agl_ft = 150.0
         self.mission_agl_ft = 300.0
@@ -51,7 +53,7 @@ class Launch(Task):
         self.active = True
         # start with roll control only, we fix elevator to neutral until
         # flight speeds come up and steer the rudder directly
-        self.ap_node.setString("mode", "roll");
+        self.task_ap_node.setString("mode", "roll");
         self.targets_node.setFloat("roll_deg", 0.0)
         self.targets_node.setFloat("altitude_agl_ft", self.mission_agl_ft)
         self.targets_node.setFloat("airspeed_kt", self.target_speed_kt)
@@ -69,7 +71,7 @@ class Launch(Task):
                 # reset on entering AP mode
                 self.relhdg = 0.0
                 self.control_limit = 1.0
-                self.flight_node.setFloat("flaps_setpoint", self.flaps)
+                self.task_flight_node.setFloat("flaps_setpoint", self.flaps)
 
             throttle_time_sec = 2.0 # hard code for now (fixme: move to config)
             if dt > 0.0:
@@ -130,7 +132,7 @@ class Launch(Task):
                     # we've reached our flying/climbout airspeed,
                     # switch to pitch/elevator speed hold mode
                     self.targets_node.setFloat("pitch_deg", self.orient_node.getFloat("pitch_deg"))
-                    self.ap_node.setString("mode", "basic+alt+speed")
+                    self.task_ap_node.setString("mode", "basic+alt+speed")
 
         self.last_ap_master = self.ap_node.getBool("master_switch")
 
@@ -141,7 +143,7 @@ class Launch(Task):
                 # before we've feathered out the rudder input, let's
                 # leave the rudder centered.
                 self.flight_node.setFloat("rudder", 0.0)
-                self.flight_node.setFloat("flaps_setpoint", 0.0)
+                self.task_flight_node.setFloat("flaps_setpoint", 0.0)
             return True
         return False
     
@@ -7,10 +7,10 @@ class Preflight(Task):
     def __init__(self, config_node):
         Task.__init__(self)
         self.task_node = getNode("/task", True)
-        self.ap_node = getNode("/autopilot", True)
-        self.targets_node = getNode("/autopilot/targets", True)
+        self.ap_node = getNode("/task/autopilot", True)
+        self.targets_node = getNode("/task/targets", True)
         self.imu_node = getNode("/sensors/imu", True)
-        self.flight_node = getNode("/controls/flight", True)
+        self.flight_node = getNode("/task/controls/flight", True)
         self.saved_fcs_mode = ""
         self.timer = 0.0
         self.duration_sec = 60.0
@@ -11,9 +11,9 @@ class Route(Task):
     def __init__(self, config_node):
         Task.__init__(self)
         self.route_node = getNode('/task/route', True)
-        self.ap_node = getNode('/autopilot', True)
+        self.ap_node = getNode('/task/autopilot', True)
         self.nav_node = getNode("/navigation", True)
-        self.targets_node = getNode('/autopilot/targets', True)
+        self.targets_node = getNode('/task/targets', True)
 
         self.alt_agl_ft = 0.0
         self.speed_kt = 30.0
@@ -21,9 +21,7 @@
 
 
 UGPayloadMgr::UGPayloadMgr():
-    remote_link_skip(0),
     logging_skip(0),
-    remote_link_count(0),
     logging_count(0)
 {
 }
@@ -41,24 +39,17 @@ void UGPayloadMgr::bind() {
 void UGPayloadMgr::init() {
     bind();
     
-    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
     pyPropertyNode logging_node = pyGetNode("/config/logging", true);
-    remote_link_skip = remote_link_node.getDouble("payload_skip");
     logging_skip = logging_node.getDouble("payload_skip");
 }
 
 
 bool UGPayloadMgr::update() {
-    remote_link_count = 0;
     logging_count = 0;
 
     bool fresh_data = true;
     if ( fresh_data ) {
-	bool send_remote_link = false;
-	if ( remote_link_count < 0 ) {
-	    send_remote_link = true;
-	    remote_link_count = remote_link_skip;
-	}
+	bool send_remote_link = remote_link->is_open();
 	
 	bool send_logging = false;
 	if ( logging_count < 0 ) {
@@ -77,7 +68,6 @@ bool UGPayloadMgr::update() {
 	    }
 	}
 	
-        remote_link_count--;
         logging_count--;
     }
 
@@ -28,9 +28,7 @@ public:
 
 private:
     
-    int remote_link_skip;
     int logging_skip;
-    int remote_link_count;
     int logging_count;
 };
 
@@ -0,0 +1,493 @@
+//
+// props.cxx - native property tree
+//
+// This code is released into the public domain.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <set>
+using std::set;
+
+#include "props.hxx"
+
+
+// interned name storage.  std::set nodes never move so the c_str()
+// pointers we hand out stay valid for the life of the program.
+static set<string> *intern_table = NULL;
+
+const char *PropertyIntern( const char *name, int len ) {
+    if ( intern_table == NULL ) {
+	intern_table = new set<string>;
+    }
+    if ( len < 0 ) {
+	len = strlen(name);
+    }
+    string key(name, len);
+    set<string>::iterator it = intern_table->find(key);
+    if ( it == intern_table->end() ) {
+	it = intern_table->insert(key).first;
+    }
+    return it->c_str();
+}
+
+void PropertyParseIndex( const char *name, int len,
+			 int *name_len, int *index )
+{
+    *name_len = len;
+    *index = -1;
+    const char *pos = (const char *)memchr(name, '[', len);
+    if ( pos != NULL ) {
+	*name_len = pos - name;
+	*index = atoi(pos + 1);
+    }
+}
+
+string PropertyFormatDouble( double val ) {
+    // match python's str(float) so values read back through either
+    // interface look the same
+    char buf[64];
+    snprintf(buf, 64, "%.12g", val);
+    if ( strpbrk(buf, ".eninf") == NULL ) {
+	strcat(buf, ".0");
+    }
+    return buf;
+}
+
+
+// PropertyValue conversions
+
+double PropertyValue::getDouble() const {
+    switch ( type ) {
+    case PROP_BOOL: return b ? 1.0 : 0.0;
+    case PROP_INT: return (double)l;
+    case PROP_DOUBLE: return d;
+    case PROP_STRING: {
+	char *end = NULL;
+	double result = strtod(s.c_str(), &end);
+	if ( end == s.c_str() && s.length() ) {
+	    printf("WARNING: conversion from string to float failed: '%s'\n",
+		   s.c_str());
+	}
+	return result;
+    }
+    default: return 0.0;
+    }
+}
+
+long PropertyValue::getLong() const {
+    switch ( type ) {
+    case PROP_BOOL: return b ? 1 : 0;
+    case PROP_INT: return l;
+    case PROP_DOUBLE: return (long)d;
+    case PROP_STRING: return (long)getDouble();
+    default: return 0;
+    }
+}
+
+bool PropertyValue::getBool() const {
+    switch ( type ) {
+    case PROP_BOOL: return b;
+    case PROP_INT: return l != 0;
+    case PROP_DOUBLE: return d != 0.0;
+    case PROP_STRING:
+	return s.length() && s != "false" && s != "False" && s != "0";
+    default: return false;
+    }
+}
+
+string PropertyValue::getString() const {
+    char buf[64];
+    switch ( type ) {
+    case PROP_BOOL: return b ? "True" : "False";
+    case PROP_INT:
+	snprintf(buf, 64, "%ld", l);
+	return buf;
+    case PROP_DOUBLE: return PropertyFormatDouble(d);
+    case PROP_STRING: return s;
+    default: return "";
+    }
+}
+
+
+// PropertyNode
+
+PropertyNode::PropertyNode()
+{
+}
+
+PropertyNode::~PropertyNode() {
+    for ( unsigned int i = 0; i < entries.size(); i++ ) {
+	for ( unsigned int j = 0; j < entries[i].nodes.size(); j++ ) {
+	    delete entries[i].nodes[j];
+	}
+    }
+}
+
+PropertyEntry *PropertyNode::findEntry( const char *name ) {
+    for ( unsigned int i = 0; i < entries.size(); i++ ) {
+	const char *n = entries[i].name;
+	if ( n == name || (n[0] == name[0] && strcmp(n, name) == 0) ) {
+	    return &entries[i];
+	}
+    }
+    return NULL;
+}
+
+const PropertyEntry *PropertyNode::findEntry( const char *name ) const {
+    return const_cast<PropertyNode *>(this)->findEntry(name);
+}
+
+PropertyEntry *PropertyNode::makeEntry( const char *name, bool is_leaf ) {
+    PropertyEntry entry;
+    entry.name = PropertyIntern(name);
+    entry.is_leaf = is_leaf;
+    entry.is_enum = false;
+    entries.push_back(entry);
+    return &entries.back();
+}
+
+// look up (or create) a single path element 'name' (not null
+// terminated, 'len' chars long)
+PropertyNode *PropertyNode::getChildElement( const char *name, int len,
+					     int index, bool create )
+{
+    PropertyEntry *entry = NULL;
+    for ( unsigned int i = 0; i < entries.size(); i++ ) {
+	const char *n = entries[i].name;
+	if ( strncmp(n, name, len) == 0 && n[len] == 0 ) {
+	    entry = &entries[i];
+	    break;
+	}
+    }
+    if ( entry == NULL ) {
+	if ( !create ) {
+	    return NULL;
+	}
+	string tmp(name, len);
+	entry = makeEntry(tmp.c_str(), false);
+    } else if ( entry->is_leaf ) {
+	return NULL;
+    }
+    if ( index < 0 ) {
+	index = 0;
+    } else if ( create ) {
+	entry->is_enum = true;
+    }
+    if ( index >= (int)entry->nodes.size() ) {
+	if ( !create ) {
+	    return NULL;
+	}
+	while ( (int)entry->nodes.size() <= index ) {
+	    entry->nodes.push_back(new PropertyNode);
+	}
+    }
+    return entry->nodes[index];
+}
+
+PropertyNode *PropertyNode::getChild( const char *name, bool create ) {
+    PropertyNode *node = this;
+    const char *start = name;
+    while ( node != NULL && *start ) {
+	const char *end = strchr(start, '/');
+	int len = (end == NULL) ? strlen(start) : end - start;
+	if ( len > 0 ) {
+	    int name_len, index;
+	    PropertyParseIndex(start, len, &name_len, &index);
+	    node = node->getChildElement(start, name_len, index, create);
+	}
+	if ( end == NULL ) {
+	    break;
+	}
+	start = end + 1;
+    }
+    return node;
+}
+
+PropertyNode *PropertyNode::getChild( const char *name, int index,
+				      bool create )
+{
+    return getChildElement(name, strlen(name), index, create);
+}
+
+bool PropertyNode::hasChild( const char *name ) const {
+    const PropertyEntry *e = findEntry(name);
+    return e != NULL && !e->is_unset();
+}
+
+vector<string> PropertyNode::getChildren( bool expand ) const {
+    vector<string> result;
+    for ( unsigned int i = 0; i < entries.size(); i++ ) {
+	const PropertyEntry &e = entries[i];
+	if ( e.is_unset() ) {
+	    continue;
+	}
+	if ( e.is_enum && expand ) {
+	    int len = e.len();
+	    for ( int j = 0; j < len; j++ ) {
+		char buf[16];
+		snprintf(buf, 16, "[%d]", j);
+		result.push_back( string(e.name) + buf );
+	    }
+	} else {
+	    result.push_back( e.name );
+	}
+    }
+    return result;
+}
+
+bool PropertyNode::isLeaf( const char *name ) const {
+    const PropertyEntry *e = findEntry(name);
+    return e != NULL && e->is_leaf;
+}
+
+bool PropertyNode::isEnum( const char *name ) const {
+    const PropertyEntry *e = findEntry(name);
+    return e != NULL && e->is_enum;
+}
+
+int PropertyNode::getLen( const char *name ) const {
+    const PropertyEntry *e = findEntry(name);
+    if ( e == NULL ) {
+	return 0;
+    }
+    return e->len();
+}
+
+void PropertyNode::setLen( const char *name, int size ) {
+    PropertyEntry *e = findEntry(name);
+    if ( e == NULL ) {
+	e = makeEntry(name, false);
+    } else if ( e->is_leaf ) {
+	printf("WARNING: setLen(%s) on a leaf value\n", name);
+	return;
+    }
+    e->is_enum = true;
+    while ( (int)e->nodes.size() < size ) {
+	e->nodes.push_back(new PropertyNode);
+    }
+}
+
+void PropertyNode::setLen( const char *name, int size, double init_val ) {
+    PropertyEntry *e = findEntry(name);
+    if ( e == NULL ) {
+	e = makeEntry(name, true);
+    } else if ( !e->is_leaf ) {
+	printf("WARNING: setLen(%s) on a branch node\n", name);
+	return;
+    }
+    e->is_enum = true;
+    while ( (int)e->values.size() < size ) {
+	PropertyValue val;
+	val.setDouble(init_val);
+	e->values.push_back(val);
+    }
+}
+
+PropertyValue *PropertyNode::getValue( const char *name, int index,
+				       bool create )
+{
+    PropertyEntry *e = findEntry(name);
+    if ( e == NULL ) {
+	if ( !create ) {
+	    return NULL;
+	}
+	e = makeEntry(name, true);
+    } else if ( !e->is_leaf ) {
+	return NULL;
+    }
+    if ( index >= (int)e->values.size() ) {
+	if ( !create ) {
+	    return NULL;
+	}
+	e->values.resize(index + 1);
+    }
+    if ( create && index > 0 ) {
+	e->is_enum = true;
+    }
+    return &e->values[index];
+}
+
+const PropertyValue *PropertyNode::getValue( const char *name,
+					     int index ) const
+{
+    const PropertyEntry *e = findEntry(name);
+    if ( e == NULL || !e->is_leaf || index >= (int)e->values.size() ) {
+	return NULL;
+    }
+    return &e->values[index];
+}
+
+int PropertyNode::resolve( const char *name, int index ) {
+    if ( getValue(name, index, true) == NULL ) {
+	return -1;
+    }
+    return findEntry(name) - &entries[0];
+}
+
+// value getters
+double PropertyNode::getDouble( const char *name ) const {
+    const PropertyValue *v = getValue(name, 0);
+    return v ? v->getDouble() : 0.0;
+}
+
+long PropertyNode::getLong( const char *name ) const {
+    const PropertyValue *v = getValue(name, 0);
+    return v ? v->getLong() : 0;
+}
+
+bool PropertyNode::getBool( const char *name ) const {
+    const PropertyValue *v = getValue(name, 0);
+    return v ? v->getBool() : false;
+}
+
+string PropertyNode::getString( const char *name ) const {
+    const PropertyValue *v = getValue(name, 0);
+    return v ? v->getString() : "";
+}
+
+PropType PropertyNode::getType( const char *name ) const {
+    const PropertyValue *v = getValue(name, 0);
+    return v ? v->type : PROP_NONE;
+}
+
+// indexed value getters
+double PropertyNode::getDouble( const char *name, int index ) const {
+    const PropertyValue *v = getValue(name, index);
+    return v ? v->getDouble() : 0.0;
+}
+
+long PropertyNode::getLong( const char *name, int index ) const {
+    const PropertyValue *v = getValue(name, index);
+    return v ? v->getLong() : 0;
+}
+
+bool PropertyNode::getBool( const char *name, int index ) const {
+    const PropertyValue *v = getValue(name, index);
+    return v ? v->getBool() : false;
+}
+
+string PropertyNode::getString( const char *name, int index ) const {
+    const PropertyValue *v = getValue(name, index);
+    return v ? v->getString() : "";
+}
+
+// value setters
+bool PropertyNode::setDouble( const char *name, double val ) {
+    PropertyValue *v = getValue(name, 0, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setDouble(val);
+    return true;
+}
+
+bool PropertyNode::setLong( const char *name, long val ) {
+    PropertyValue *v = getValue(name, 0, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setLong(val);
+    return true;
+}
+
+bool PropertyNode::setBool( const char *name, bool val ) {
+    PropertyValue *v = getValue(name, 0, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setBool(val);
+    return true;
+}
+
+bool PropertyNode::setString( const char *name, const string &val ) {
+    PropertyValue *v = getValue(name, 0, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setString(val);
+    return true;
+}
+
+// indexed value setters
+bool PropertyNode::setDouble( const char *name, int index, double val ) {
+    PropertyValue *v = getValue(name, index, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setDouble(val);
+    return true;
+}
+
+bool PropertyNode::setLong( const char *name, int index, long val ) {
+    PropertyValue *v = getValue(name, index, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setLong(val);
+    return true;
+}
+
+bool PropertyNode::setBool( const char *name, int index, bool val ) {
+    PropertyValue *v = getValue(name, index, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setBool(val);
+    return true;
+}
+
+bool PropertyNode::setString( const char *name, int index,
+			      const string &val )
+{
+    PropertyValue *v = getValue(name, index, true);
+    if ( v == NULL ) {
+	return false;
+    }
+    v->setString(val);
+    return true;
+}
+
+void PropertyNode::pretty_print( const string &indent ) const {
+    for ( unsigned int i = 0; i < entries.size(); i++ ) {
+	const PropertyEntry &e = entries[i];
+	if ( e.is_unset() ) {
+	    continue;
+	}
+	int len = e.len();
+	for ( int j = 0; j < len; j++ ) {
+	    string name = e.name;
+	    if ( e.is_enum ) {
+		char buf[16];
+		snprintf(buf, 16, "[%d]", j);
+		name += buf;
+	    }
+	    if ( e.is_leaf ) {
+		printf("%s%s: %s\n", indent.c_str(), name.c_str(),
+		       e.values[j].getString().c_str());
+	    } else {
+		printf("%s%s:\n", indent.c_str(), name.c_str());
+		e.nodes[j]->pretty_print(indent + "    ");
+	    }
+	}
+    }
+}
+
+
+static PropertyNode *root_node = NULL;
+
+PropertyNode *PropertyRoot() {
+    if ( root_node == NULL ) {
+	root_node = new PropertyNode;
+    }
+    return root_node;
+}
+
+PropertyNode *PropertyGetNode( const char *abs_path, bool create ) {
+    while ( *abs_path == '/' ) {
+	abs_path++;
+    }
+    return PropertyRoot()->getChild(abs_path, create);
+}
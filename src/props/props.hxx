@@ -0,0 +1,314 @@
+//
+// props.hxx - native property tree
+//
+// The property tree is owned and stored entirely on the C++ side.
+// Each node keeps its leaf values in a contiguous array of typed
+// slots and its child nodes in a parallel list.  Names are interned
+// once so lookups are pointer/strcmp comparisons and never allocate.
+// The python 'props' module is a thin view over this tree (see
+// python/pyprops_module.cxx) so C++ update routines never need to
+// enter the python interpreter to read or write a value.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_PROPS_HXX
+#define _AURA_PROPS_HXX
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+
+// supported leaf value types
+enum PropType {
+    PROP_NONE,
+    PROP_BOOL,
+    PROP_INT,
+    PROP_DOUBLE,
+    PROP_STRING
+};
+
+
+// a single typed value slot
+class PropertyValue {
+
+public:
+
+    PropType type;
+    unsigned int serial;	// bumped by every set (change detection)
+    union {
+	bool b;
+	long l;
+	double d;
+    };
+    string s;			// only valid when type == PROP_STRING
+
+    PropertyValue(): type(PROP_NONE), serial(0), d(0.0) {}
+
+    double getDouble() const;
+    long getLong() const;
+    bool getBool() const;
+    string getString() const;
+
+    inline void setDouble( double val ) {
+	type = PROP_DOUBLE; d = val; serial++;
+    }
+    inline void setLong( long val ) {
+	type = PROP_INT; l = val; serial++;
+    }
+    inline void setBool( bool val ) {
+	type = PROP_BOOL; b = val; serial++;
+    }
+    inline void setString( const string &val ) {
+	type = PROP_STRING; s = val; serial++;
+    }
+
+    // back to no value (the slot itself stays, handles may point at it)
+    inline void clear() {
+	type = PROP_NONE; s.clear(); serial++;
+    }
+};
+
+
+class PropertyNode;
+
+// A named member of a node.  A member is either a leaf (one or more
+// values) or a branch (one or more child nodes).  A member with more
+// than one element (or created with an explicit [index]) is
+// 'enumerated', and un-indexed access refers to element zero.
+struct PropertyEntry {
+    const char *name;		// interned
+    bool is_leaf;
+    bool is_enum;
+    vector<PropertyValue> values;
+    vector<PropertyNode *> nodes;
+
+    // number of elements.  Trailing leaf slots without a value (only
+    // created by binding a handle, or cleared when a shorter list was
+    // assigned) don't count: slots are never removed since handles
+    // refer to them by index.
+    inline int len() const {
+	if ( !is_leaf ) {
+	    return nodes.size();
+	}
+	int n = values.size();
+	while ( n > 0 && values[n - 1].type == PROP_NONE ) {
+	    n--;
+	}
+	return n;
+    }
+
+    // a leaf that exists only because a handle was bound to it and
+    // that nothing has written yet.  Listings, hasChild(), python
+    // attribute access and the writers treat it as missing.
+    inline bool is_unset() const {
+	return is_leaf && len() == 0;
+    }
+};
+
+
+class PropertyNode {
+
+public:
+
+    PropertyNode();
+    ~PropertyNode();
+
+    // child/branch access.  'name' may be a relative path
+    // ("a/b[2]/c") and each path element may carry an [index].
+    PropertyNode *getChild( const char *name, bool create=false );
+    PropertyNode *getChild( const char *name, int index, bool create=false );
+    bool hasChild( const char *name ) const;
+
+    // list of member names in insertion order.  With expand=true
+    // enumerated members are listed as name[0], name[1], ...
+    vector<string> getChildren( bool expand=true ) const;
+
+    bool isLeaf( const char *name ) const;
+    bool isEnum( const char *name ) const;
+    int getLen( const char *name ) const;
+    void setLen( const char *name, int size ); // branch
+    void setLen( const char *name, int size, double init_val ); // leaf
+
+    // value getters (missing values return 0/false/"")
+    double getDouble( const char *name ) const;
+    long getLong( const char *name ) const;
+    bool getBool( const char *name ) const;
+    string getString( const char *name ) const;
+    PropType getType( const char *name ) const;
+
+    // indexed value getters
+    double getDouble( const char *name, int index ) const;
+    long getLong( const char *name, int index ) const;
+    bool getBool( const char *name, int index ) const;
+    string getString( const char *name, int index ) const;
+
+    // value setters (create the leaf if needed, return false if
+    // 'name' already refers to a branch)
+    bool setDouble( const char *name, double val );
+    bool setLong( const char *name, long val );
+    bool setBool( const char *name, bool val );
+    bool setString( const char *name, const string &val );
+
+    // indexed value setters (grow the leaf as needed)
+    bool setDouble( const char *name, int index, double val );
+    bool setLong( const char *name, int index, long val );
+    bool setBool( const char *name, int index, bool val );
+    bool setString( const char *name, int index, const string &val );
+
+    // return the value slot for name[index], optionally creating it.
+    // Returns NULL if name is a branch (or missing and !create.)  A
+    // slot nothing has written yet has type PROP_NONE.
+    PropertyValue *getValue( const char *name, int index=0,
+			     bool create=false );
+    const PropertyValue *getValue( const char *name, int index=0 ) const;
+
+    // direct member access (used by the python bindings and the
+    // json/xml readers/writers)
+    inline const vector<PropertyEntry> &getEntries() const {
+	return entries;
+    }
+    PropertyEntry *findEntry( const char *name );
+    const PropertyEntry *findEntry( const char *name ) const;
+
+    void pretty_print( const string &indent="" ) const;
+
+    // resolve (creating if needed) the slot for name[index] and
+    // return its member position for a PropertyHandle, or -1 if
+    // name is a branch.
+    int resolve( const char *name, int index );
+
+private:
+
+    template <class T> friend class PropertyHandle;
+
+    vector<PropertyEntry> entries;
+
+    PropertyEntry *makeEntry( const char *name, bool is_leaf );
+    PropertyNode *getChildElement( const char *name, int len, int index,
+				   bool create );
+};
+
+
+// A pre-resolved reference to a single value slot (node + member +
+// index).  Bind once at init time, then get()/set() are a couple of
+// pointer dereferences with no name lookup or string compare.  Slots
+// are never removed from the tree so a handle stays valid for the
+// life of the program.
+template <class T>
+class PropertyHandle {
+
+public:
+
+    PropertyHandle(): node(NULL), entry(-1), index(0) {}
+    PropertyHandle( PropertyNode *n, const char *name, int i=0 ):
+	node(n), entry(-1), index(i)
+    {
+	if ( node != NULL ) {
+	    entry = node->resolve(name, index);
+	    if ( entry < 0 ) {
+		node = NULL;
+	    }
+	}
+    }
+
+    inline bool isNull() const { return node == NULL; }
+
+    // true once the slot has been given a value (binding a handle
+    // creates the slot, so hasChild() can't tell)
+    inline bool isSet() const {
+	return node != NULL && slot().type != PROP_NONE;
+    }
+
+    // changes whenever the slot is written (not necessarily to a
+    // different value), compare against a saved copy to skip work
+    // that only depends on this value
+    inline unsigned int serial() const {
+	return (node != NULL) ? slot().serial : 0;
+    }
+
+    inline T get() const;
+    inline void set( const T &val );
+
+private:
+
+    PropertyNode *node;
+    int entry;
+    int index;
+
+    inline PropertyValue &slot() const {
+	return node->entries[entry].values[index];
+    }
+};
+
+template <>
+inline double PropertyHandle<double>::get() const {
+    if ( node == NULL ) return 0.0;
+    const PropertyValue &v = slot();
+    return (v.type == PROP_DOUBLE) ? v.d : v.getDouble();
+}
+
+template <>
+inline long PropertyHandle<long>::get() const {
+    if ( node == NULL ) return 0;
+    const PropertyValue &v = slot();
+    return (v.type == PROP_INT) ? v.l : v.getLong();
+}
+
+template <>
+inline bool PropertyHandle<bool>::get() const {
+    if ( node == NULL ) return false;
+    const PropertyValue &v = slot();
+    return (v.type == PROP_BOOL) ? v.b : v.getBool();
+}
+
+template <>
+inline string PropertyHandle<string>::get() const {
+    if ( node == NULL ) return "";
+    return slot().getString();
+}
+
+template <>
+inline void PropertyHandle<double>::set( const double &val ) {
+    if ( node != NULL ) slot().setDouble(val);
+}
+
+template <>
+inline void PropertyHandle<long>::set( const long &val ) {
+    if ( node != NULL ) slot().setLong(val);
+}
+
+template <>
+inline void PropertyHandle<bool>::set( const bool &val ) {
+    if ( node != NULL ) slot().setBool(val);
+}
+
+template <>
+inline void PropertyHandle<string>::set( const string &val ) {
+    if ( node != NULL ) slot().setString(val);
+}
+
+
+// Return a pointer to the unique (interned) copy of 'name'.  The
+// returned pointer is valid for the life of the program.
+extern const char *PropertyIntern( const char *name, int len=-1 );
+
+// The root of the property tree
+extern PropertyNode *PropertyRoot();
+
+// Return the node at the specified absolute path (or NULL)
+extern PropertyNode *PropertyGetNode( const char *abs_path,
+				      bool create=false );
+
+// split "name[index]" into name length and index (index = -1 if
+// not present)
+extern void PropertyParseIndex( const char *name, int len,
+				int *name_len, int *index );
+
+// format a double the same way python str() would
+extern string PropertyFormatDouble( double val );
+
+
+#endif // _AURA_PROPS_HXX
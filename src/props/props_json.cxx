@@ -0,0 +1,418 @@
+//
+// props_json.cxx - load/save a property (sub)tree as json
+//
+// This code is released into the public domain.
+//
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+using std::string;
+
+#include "props_json.hxx"
+
+
+// minimal recursive descent json parser that writes directly into
+// the property tree
+
+class JSONReader {
+
+public:
+
+    JSONReader( const string &_filename, const string &_text ):
+	filename(_filename), text(_text), pos(0), line(1), ok(true) {}
+
+    bool parse( PropertyNode *node );
+
+private:
+
+    string filename;
+    string dir;
+    const string &text;
+    size_t pos;
+    int line;
+    bool ok;
+
+    void error( const char *msg );
+    void skip_ws();
+    bool expect( char c );
+    bool parse_string( string *result );
+    bool parse_object( PropertyNode *node );
+    bool parse_array( PropertyNode *node, const string &name );
+    bool parse_scalar( PropertyNode *node, const string &name, int index );
+    bool skip_value();
+};
+
+void JSONReader::error( const char *msg ) {
+    if ( ok ) {
+	printf("json: %s:%d: %s\n", filename.c_str(), line, msg);
+    }
+    ok = false;
+}
+
+void JSONReader::skip_ws() {
+    while ( pos < text.length() && isspace(text[pos]) ) {
+	if ( text[pos] == '\n' ) {
+	    line++;
+	}
+	pos++;
+    }
+}
+
+bool JSONReader::expect( char c ) {
+    skip_ws();
+    if ( pos < text.length() && text[pos] == c ) {
+	pos++;
+	return true;
+    }
+    char msg[64];
+    snprintf(msg, 64, "expected '%c'", c);
+    error(msg);
+    return false;
+}
+
+bool JSONReader::parse_string( string *result ) {
+    if ( !expect('"') ) {
+	return false;
+    }
+    result->clear();
+    while ( pos < text.length() && text[pos] != '"' ) {
+	char c = text[pos++];
+	if ( c == '\\' && pos < text.length() ) {
+	    c = text[pos++];
+	    switch ( c ) {
+	    case 'n': c = '\n'; break;
+	    case 't': c = '\t'; break;
+	    case 'r': c = '\r'; break;
+	    case 'b': c = '\b'; break;
+	    case 'f': c = '\f'; break;
+	    case 'u': {
+		// only the ascii range is meaningful in our config files
+		long code = strtol(text.substr(pos, 4).c_str(), NULL, 16);
+		pos += 4;
+		c = (code < 128) ? (char)code : '?';
+		break;
+	    }
+	    default: break;	// \" \\ \/
+	    }
+	} else if ( c == '\n' ) {
+	    line++;
+	}
+	*result += c;
+    }
+    return expect('"');
+}
+
+bool JSONReader::parse_scalar( PropertyNode *node, const string &name,
+			       int index )
+{
+    skip_ws();
+    if ( pos >= text.length() ) {
+	error("unexpected end of file");
+	return false;
+    }
+    const char *name_str = name.c_str();
+    if ( index < 0 ) {
+	index = 0;
+    }
+    char c = text[pos];
+    if ( c == '"' ) {
+	string val;
+	if ( !parse_string(&val) ) {
+	    return false;
+	}
+	node->setString(name_str, index, val);
+    } else if ( text.compare(pos, 4, "true") == 0 ) {
+	pos += 4;
+	node->setBool(name_str, index, true);
+    } else if ( text.compare(pos, 5, "false") == 0 ) {
+	pos += 5;
+	node->setBool(name_str, index, false);
+    } else if ( text.compare(pos, 4, "null") == 0 ) {
+	pos += 4;
+    } else if ( text.compare(pos, 3, "NaN") == 0 ) {
+	pos += 3;
+	node->setDouble(name_str, index, NAN);
+    } else if ( text.compare(pos, 8, "Infinity") == 0 ) {
+	pos += 8;
+	node->setDouble(name_str, index, INFINITY);
+    } else if ( text.compare(pos, 9, "-Infinity") == 0 ) {
+	pos += 9;
+	node->setDouble(name_str, index, -INFINITY);
+    } else if ( c == '-' || isdigit(c) ) {
+	const char *start = text.c_str() + pos;
+	char *end = NULL;
+	double d = strtod(start, &end);
+	if ( end == start ) {
+	    error("bad number");
+	    return false;
+	}
+	if ( strcspn(start, ".eE") < (size_t)(end - start) ) {
+	    node->setDouble(name_str, index, d);
+	} else {
+	    node->setLong(name_str, index, strtol(start, NULL, 10));
+	}
+	pos += end - start;
+    } else {
+	error("unexpected character");
+	return false;
+    }
+    return true;
+}
+
+// skip over (and discard) a value we have no place for
+bool JSONReader::skip_value() {
+    PropertyNode tmp;
+    skip_ws();
+    if ( pos < text.length() && text[pos] == '{' ) {
+	return parse_object(&tmp);
+    } else if ( pos < text.length() && text[pos] == '[' ) {
+	return parse_array(&tmp, "tmp");
+    }
+    return parse_scalar(&tmp, "tmp", 0);
+}
+
+bool JSONReader::parse_array( PropertyNode *node, const string &name ) {
+    if ( !expect('[') ) {
+	return false;
+    }
+    const char *name_str = name.c_str();
+    int index = 0;
+    skip_ws();
+    if ( pos < text.length() && text[pos] == ']' ) {
+	pos++;
+	return true;
+    }
+    while ( ok ) {
+	skip_ws();
+	if ( pos >= text.length() ) {
+	    error("unexpected end of file");
+	    return false;
+	}
+	if ( text[pos] == '{' ) {
+	    PropertyNode *child = node->getChild(name_str, index, true);
+	    if ( child == NULL ) {
+		printf("json: %s: '%s' is already a leaf value\n",
+		       filename.c_str(), name_str);
+		if ( !skip_value() ) {
+		    return false;
+		}
+	    } else if ( !parse_object(child) ) {
+		return false;
+	    }
+	} else if ( text[pos] == '[' ) {
+	    // nested arrays have no property tree equivalent
+	    if ( !skip_value() ) {
+		return false;
+	    }
+	} else {
+	    if ( !parse_scalar(node, name, index) ) {
+		return false;
+	    }
+	}
+	index++;
+	skip_ws();
+	if ( pos < text.length() && text[pos] == ',' ) {
+	    pos++;
+	} else {
+	    break;
+	}
+    }
+    // mark as enumerated even if the array held a single element
+    if ( node->isLeaf(name_str) ) {
+	node->setLen(name_str, index, 0.0);
+    } else {
+	node->setLen(name_str, index);
+    }
+    return expect(']');
+}
+
+bool JSONReader::parse_object( PropertyNode *node ) {
+    if ( !expect('{') ) {
+	return false;
+    }
+    skip_ws();
+    if ( pos < text.length() && text[pos] == '}' ) {
+	pos++;
+	return true;
+    }
+    while ( ok ) {
+	string name;
+	if ( !parse_string(&name) || !expect(':') ) {
+	    return false;
+	}
+	skip_ws();
+	if ( pos >= text.length() ) {
+	    error("unexpected end of file");
+	    return false;
+	}
+	if ( name == "include" && text[pos] == '"' ) {
+	    string file;
+	    if ( !parse_string(&file) ) {
+		return false;
+	    }
+	    if ( file[0] != '/' ) {
+		file = dir + file;
+	    }
+	    PropertyReadJSON(file, node);
+	} else if ( text[pos] == '{' ) {
+	    PropertyNode *child = node->getChild(name.c_str(), -1, true);
+	    if ( child == NULL ) {
+		printf("json: %s: '%s' is already a leaf value\n",
+		       filename.c_str(), name.c_str());
+		if ( !skip_value() ) {
+		    return false;
+		}
+	    } else if ( !parse_object(child) ) {
+		return false;
+	    }
+	} else if ( text[pos] == '[' ) {
+	    if ( !parse_array(node, name) ) {
+		return false;
+	    }
+	} else if ( !parse_scalar(node, name, -1) ) {
+	    return false;
+	}
+	skip_ws();
+	if ( pos < text.length() && text[pos] == ',' ) {
+	    pos++;
+	} else {
+	    break;
+	}
+    }
+    return expect('}');
+}
+
+bool JSONReader::parse( PropertyNode *node ) {
+    size_t slash = filename.rfind('/');
+    if ( slash != string::npos ) {
+	dir = filename.substr(0, slash + 1);
+    }
+    parse_object(node);
+    return ok;
+}
+
+bool PropertyReadJSON( const string &filename, PropertyNode *node ) {
+    if ( node == NULL ) {
+	return false;
+    }
+    FILE *fp = fopen(filename.c_str(), "r");
+    if ( fp == NULL ) {
+	printf("json: cannot open: %s\n", filename.c_str());
+	return false;
+    }
+    string text;
+    char buf[4096];
+    size_t len;
+    while ( (len = fread(buf, 1, sizeof(buf), fp)) > 0 ) {
+	text.append(buf, len);
+    }
+    fclose(fp);
+
+    JSONReader reader(filename, text);
+    return reader.parse(node);
+}
+
+
+// json writer
+
+static void write_string( FILE *fp, const string &s ) {
+    fputc('"', fp);
+    for ( unsigned int i = 0; i < s.length(); i++ ) {
+	unsigned char c = s[i];
+	if ( c == '"' || c == '\\' ) {
+	    fprintf(fp, "\\%c", c);
+	} else if ( c == '\n' ) {
+	    fputs("\\n", fp);
+	} else if ( c == '\t' ) {
+	    fputs("\\t", fp);
+	} else if ( c < 0x20 ) {
+	    fprintf(fp, "\\u%04x", c);
+	} else {
+	    fputc(c, fp);
+	}
+    }
+    fputc('"', fp);
+}
+
+static void write_value( FILE *fp, const PropertyValue &val ) {
+    switch ( val.type ) {
+    case PROP_BOOL:
+	fputs(val.b ? "true" : "false", fp);
+	break;
+    case PROP_INT:
+	fprintf(fp, "%ld", val.l);
+	break;
+    case PROP_DOUBLE:
+	if ( isnan(val.d) ) {
+	    fputs("NaN", fp);
+	} else if ( isinf(val.d) ) {
+	    fputs(val.d > 0 ? "Infinity" : "-Infinity", fp);
+	} else {
+	    fputs(PropertyFormatDouble(val.d).c_str(), fp);
+	}
+	break;
+    case PROP_STRING:
+	write_string(fp, val.s);
+	break;
+    default:
+	fputs("null", fp);
+	break;
+    }
+}
+
+static void write_node( FILE *fp, const PropertyNode *node,
+			const string &indent )
+{
+    const vector<PropertyEntry> &entries = node->getEntries();
+    string child_indent = indent + "    ";
+    fputs("{", fp);
+    bool first = true;
+    for ( unsigned int i = 0; i < entries.size(); i++ ) {
+	const PropertyEntry &e = entries[i];
+	if ( e.is_unset() ) {
+	    continue;
+	}
+	fprintf(fp, "%s\n%s", first ? "" : ",", child_indent.c_str());
+	first = false;
+	write_string(fp, e.name);
+	fputs(": ", fp);
+	int len = e.len();
+	if ( e.is_enum ) {
+	    fputs("[", fp);
+	}
+	for ( int j = 0; j < len; j++ ) {
+	    if ( j ) {
+		fputs(", ", fp);
+	    }
+	    if ( e.is_leaf ) {
+		write_value(fp, e.values[j]);
+	    } else {
+		write_node(fp, e.nodes[j], child_indent);
+	    }
+	}
+	if ( e.is_enum ) {
+	    fputs("]", fp);
+	}
+    }
+    fprintf(fp, "\n%s}", indent.c_str());
+}
+
+bool PropertyWriteJSON( const string &filename, PropertyNode *node ) {
+    if ( node == NULL ) {
+	return false;
+    }
+    FILE *fp = fopen(filename.c_str(), "w");
+    if ( fp == NULL ) {
+	printf("json: cannot create: %s\n", filename.c_str());
+	return false;
+    }
+    write_node(fp, node, "");
+    fputs("\n", fp);
+    fclose(fp);
+    return true;
+}
@@ -0,0 +1,26 @@
+//
+// props_json.hxx - load/save a property (sub)tree as json
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_PROPS_JSON_HXX
+#define _AURA_PROPS_JSON_HXX
+
+#include <string>
+using std::string;
+
+#include "props.hxx"
+
+
+// Read a json file and merge the results into 'node'.  An "include"
+// member names another json file (relative to this one) that is
+// loaded into the same node at that point; members that follow it
+// override the included values.
+extern bool PropertyReadJSON( const string &filename, PropertyNode *node );
+
+// Write the subtree beginning with 'node' to a json file
+extern bool PropertyWriteJSON( const string &filename, PropertyNode *node );
+
+
+#endif // _AURA_PROPS_JSON_HXX
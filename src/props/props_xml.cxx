@@ -0,0 +1,386 @@
+//
+// props_xml.cxx - load/save a property (sub)tree as PropertyList xml
+//
+// This code is released into the public domain.
+//
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+using std::map;
+using std::string;
+
+#include "props_xml.hxx"
+
+
+// minimal PropertyList xml parser (elements, attributes, text,
+// comments and the five predefined entities -- which is all our
+// config files use.)
+
+class XMLReader {
+
+public:
+
+    XMLReader( const string &_filename, const string &_text ):
+	filename(_filename), text(_text), pos(0), line(1), ok(true) {}
+
+    bool parse( PropertyNode *node );
+
+private:
+
+    string filename;
+    string dir;
+    const string &text;
+    size_t pos;
+    int line;
+    bool ok;
+
+    void error( const char *msg );
+    void advance( size_t count );
+    void skip_ws();
+    bool skip_markup();
+    string parse_name();
+    string decode( const string &s );
+    bool parse_content( PropertyNode *node, const string &end_tag );
+};
+
+void XMLReader::error( const char *msg ) {
+    if ( ok ) {
+	printf("xml: %s:%d: %s\n", filename.c_str(), line, msg);
+    }
+    ok = false;
+}
+
+void XMLReader::advance( size_t count ) {
+    for ( size_t i = 0; i < count && pos < text.length(); i++ ) {
+	if ( text[pos] == '\n' ) {
+	    line++;
+	}
+	pos++;
+    }
+}
+
+void XMLReader::skip_ws() {
+    while ( pos < text.length() && isspace(text[pos]) ) {
+	advance(1);
+    }
+}
+
+// skip comments, processing instructions and doctype declarations.
+// Returns true if anything was skipped.
+bool XMLReader::skip_markup() {
+    const char *end = NULL;
+    if ( text.compare(pos, 4, "<!--") == 0 ) {
+	end = "-->";
+    } else if ( text.compare(pos, 2, "<?") == 0 ) {
+	end = "?>";
+    } else if ( text.compare(pos, 2, "<!") == 0 ) {
+	end = ">";
+    } else {
+	return false;
+    }
+    size_t stop = text.find(end, pos);
+    if ( stop == string::npos ) {
+	error("unterminated markup");
+	pos = text.length();
+	return false;
+    }
+    advance(stop + strlen(end) - pos);
+    return true;
+}
+
+string XMLReader::parse_name() {
+    size_t start = pos;
+    while ( pos < text.length()
+	    && (isalnum(text[pos]) || strchr("_-.:", text[pos])) )
+    {
+	pos++;
+    }
+    return text.substr(start, pos - start);
+}
+
+string XMLReader::decode( const string &s ) {
+    static const char *entities[][2] = {
+	{ "&lt;", "<" }, { "&gt;", ">" }, { "&amp;", "&" },
+	{ "&quot;", "\"" }, { "&apos;", "'" }
+    };
+    string result;
+    for ( size_t i = 0; i < s.length(); i++ ) {
+	bool found = false;
+	if ( s[i] == '&' ) {
+	    for ( int j = 0; j < 5; j++ ) {
+		int len = strlen(entities[j][0]);
+		if ( s.compare(i, len, entities[j][0]) == 0 ) {
+		    result += entities[j][1];
+		    i += len - 1;
+		    found = true;
+		    break;
+		}
+	    }
+	}
+	if ( !found ) {
+	    result += s[i];
+	}
+    }
+    // trim surrounding white space
+    size_t first = result.find_first_not_of(" \t\r\n");
+    if ( first == string::npos ) {
+	return "";
+    }
+    size_t last = result.find_last_not_of(" \t\r\n");
+    return result.substr(first, last - first + 1);
+}
+
+// parse child elements of 'node' up to the closing </end_tag>
+bool XMLReader::parse_content( PropertyNode *node, const string &end_tag ) {
+    map<string, int> counts;
+    while ( ok ) {
+	// skip character data between elements
+	while ( pos < text.length() && text[pos] != '<' ) {
+	    advance(1);
+	}
+	if ( pos >= text.length() ) {
+	    if ( end_tag.length() ) {
+		error("unexpected end of file");
+	    }
+	    return ok;
+	}
+	if ( skip_markup() ) {
+	    continue;
+	}
+	if ( text.compare(pos, 2, "</") == 0 ) {
+	    advance(2);
+	    string name = parse_name();
+	    if ( name != end_tag ) {
+		error("mismatched closing tag");
+		return false;
+	    }
+	    skip_ws();
+	    advance(1);		// '>'
+	    return true;
+	}
+
+	// opening tag and attributes
+	advance(1);
+	string name = parse_name();
+	map<string, string> attrs;
+	bool empty = false;
+	while ( ok ) {
+	    skip_ws();
+	    if ( pos >= text.length() ) {
+		error("unexpected end of file");
+		return false;
+	    }
+	    if ( text[pos] == '>' ) {
+		advance(1);
+		break;
+	    } else if ( text.compare(pos, 2, "/>") == 0 ) {
+		advance(2);
+		empty = true;
+		break;
+	    }
+	    string attr = parse_name();
+	    skip_ws();
+	    if ( attr.empty() || text[pos] != '=' ) {
+		error("bad attribute");
+		return false;
+	    }
+	    advance(1);
+	    skip_ws();
+	    char quote = text[pos];
+	    size_t stop = text.find(quote, pos + 1);
+	    if ( stop == string::npos ) {
+		error("unterminated attribute");
+		return false;
+	    }
+	    attrs[attr] = decode(text.substr(pos + 1, stop - pos - 1));
+	    advance(stop + 1 - pos);
+	}
+
+	int index = counts[name]++;
+	if ( attrs.count("n") ) {
+	    index = atoi(attrs["n"].c_str());
+	}
+
+	// decide leaf vs. branch by looking for a child element.  An
+	// element with only white space spanning several lines is an
+	// empty branch (that is how the writer below saves one.)
+	size_t save_pos = pos;
+	int save_line = line;
+	bool branch = false;
+	if ( !empty ) {
+	    bool blank = true;
+	    while ( pos < text.length() ) {
+		while ( pos < text.length() && text[pos] != '<' ) {
+		    if ( !isspace(text[pos]) ) {
+			blank = false;
+		    }
+		    advance(1);
+		}
+		if ( skip_markup() ) {
+		    continue;
+		}
+		branch = text.compare(pos, 2, "</") != 0
+		    || (blank && line > save_line);
+		break;
+	    }
+	}
+	pos = save_pos;
+	line = save_line;
+
+	if ( branch || attrs.count("include") ) {
+	    PropertyNode *child = node->getChild(name.c_str(),
+						 index ? index : -1, true);
+	    if ( child == NULL ) {
+		error("element is already a leaf value");
+		return false;
+	    }
+	    if ( attrs.count("include") ) {
+		string file = attrs["include"];
+		if ( file[0] != '/' ) {
+		    file = dir + file;
+		}
+		PropertyReadXML(file, child);
+	    }
+	    if ( !empty && !parse_content(child, name) ) {
+		return false;
+	    }
+	} else {
+	    string value;
+	    if ( !empty ) {
+		size_t stop = text.find("</", pos);
+		if ( stop == string::npos ) {
+		    error("unexpected end of file");
+		    return false;
+		}
+		value = decode(text.substr(pos, stop - pos));
+		advance(stop - pos);
+		PropertyNode tmp;
+		if ( !parse_content(&tmp, name) ) {
+		    return false;
+		}
+	    }
+	    string type = attrs["type"];
+	    const char *name_str = name.c_str();
+	    if ( type == "double" || type == "float" ) {
+		node->setDouble(name_str, index, atof(value.c_str()));
+	    } else if ( type == "int" || type == "long" ) {
+		node->setLong(name_str, index, atol(value.c_str()));
+	    } else if ( type == "bool" ) {
+		PropertyValue tmp;
+		tmp.setString(value);
+		node->setBool(name_str, index, tmp.getBool());
+	    } else {
+		node->setString(name_str, index, value);
+	    }
+	}
+    }
+    return ok;
+}
+
+bool XMLReader::parse( PropertyNode *node ) {
+    size_t slash = filename.rfind('/');
+    if ( slash != string::npos ) {
+	dir = filename.substr(0, slash + 1);
+    }
+    // find the top level <PropertyList> element
+    while ( pos < text.length() ) {
+	while ( pos < text.length() && text[pos] != '<' ) {
+	    advance(1);
+	}
+	if ( skip_markup() ) {
+	    continue;
+	}
+	break;
+    }
+    if ( text.compare(pos, 13, "<PropertyList") != 0 ) {
+	error("missing <PropertyList>");
+	return false;
+    }
+    size_t stop = text.find('>', pos);
+    if ( stop == string::npos ) {
+	error("unexpected end of file");
+	return false;
+    }
+    advance(stop + 1 - pos);
+    return parse_content(node, "PropertyList");
+}
+
+bool PropertyReadXML( const string &filename, PropertyNode *node ) {
+    if ( node == NULL ) {
+	return false;
+    }
+    FILE *fp = fopen(filename.c_str(), "r");
+    if ( fp == NULL ) {
+	printf("xml: cannot open: %s\n", filename.c_str());
+	return false;
+    }
+    string text;
+    char buf[4096];
+    size_t len;
+    while ( (len = fread(buf, 1, sizeof(buf), fp)) > 0 ) {
+	text.append(buf, len);
+    }
+    fclose(fp);
+
+    XMLReader reader(filename, text);
+    return reader.parse(node);
+}
+
+
+// xml writer
+
+static void write_text( FILE *fp, const string &s ) {
+    for ( unsigned int i = 0; i < s.length(); i++ ) {
+	switch ( s[i] ) {
+	case '<': fputs("&lt;", fp); break;
+	case '>': fputs("&gt;", fp); break;
+	case '&': fputs("&amp;", fp); break;
+	default: fputc(s[i], fp); break;
+	}
+    }
+}
+
+static void write_node( FILE *fp, const PropertyNode *node,
+			const string &indent )
+{
+    const vector<PropertyEntry> &entries = node->getEntries();
+    for ( unsigned int i = 0; i < entries.size(); i++ ) {
+	const PropertyEntry &e = entries[i];
+	if ( e.is_unset() ) {
+	    continue;
+	}
+	int len = e.len();
+	for ( int j = 0; j < len; j++ ) {
+	    if ( e.is_leaf ) {
+		fprintf(fp, "%s<%s>", indent.c_str(), e.name);
+		write_text(fp, e.values[j].getString());
+		fprintf(fp, "</%s>\n", e.name);
+	    } else {
+		fprintf(fp, "%s<%s>\n", indent.c_str(), e.name);
+		write_node(fp, e.nodes[j], indent + "  ");
+		fprintf(fp, "%s</%s>\n", indent.c_str(), e.name);
+	    }
+	}
+    }
+}
+
+bool PropertyWriteXML( const string &filename, PropertyNode *node ) {
+    if ( node == NULL ) {
+	return false;
+    }
+    FILE *fp = fopen(filename.c_str(), "w");
+    if ( fp == NULL ) {
+	printf("xml: cannot create: %s\n", filename.c_str());
+	return false;
+    }
+    fprintf(fp, "<?xml version=\"1.0\"?>\n\n<PropertyList>\n");
+    write_node(fp, node, "  ");
+    fprintf(fp, "</PropertyList>\n");
+    fclose(fp);
+    return true;
+}
@@ -0,0 +1,25 @@
+//
+// props_xml.hxx - load/save a property (sub)tree as PropertyList xml
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_PROPS_XML_HXX
+#define _AURA_PROPS_XML_HXX
+
+#include <string>
+using std::string;
+
+#include "props.hxx"
+
+
+// Read a PropertyList xml file and merge the results into 'node'.
+// Repeated sibling elements become enumerated children and an
+// include="file" attribute loads another file into that element.
+extern bool PropertyReadXML( const string &filename, PropertyNode *node );
+
+// Write the subtree beginning with 'node' as a PropertyList xml file
+extern bool PropertyWriteXML( const string &filename, PropertyNode *node );
+
+
+#endif // _AURA_PROPS_XML_HXX
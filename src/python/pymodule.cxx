@@ -2,17 +2,59 @@
 
 pyModuleBase::pyModuleBase():
     pModuleObj(NULL),
+    pFuncUpdate(NULL),
     module_name("")
 {
 }
 
 pyModuleBase::~pyModuleBase()
 {
+    for ( unsigned int i = 0; i < methods.size(); i++ ) {
+	Py_XDECREF(methods[i].func);
+    }
     if ( pModuleObj != NULL ) {
 	Py_XDECREF(pModuleObj);
     }
 }
 
+PyObject *pyModuleBase::get_method(const char *name)
+{
+    for ( unsigned int i = 0; i < methods.size(); i++ ) {
+	if ( methods[i].name == name ) {
+	    return methods[i].func;
+	}
+    }
+
+    method_entry entry;
+    entry.name = name;
+    entry.func = NULL;
+    if ( pModuleObj != NULL ) {
+	entry.func = PyObject_GetAttrString(pModuleObj, name);
+	if ( entry.func == NULL || ! PyCallable_Check(entry.func) ) {
+	    PyErr_Clear();
+	    Py_XDECREF(entry.func);
+	    entry.func = NULL;
+	    printf("Cannot find function '%s.%s()'\n",
+		   module_name.c_str(), name);
+	}
+    }
+    methods.push_back(entry);
+    return entry.func;
+}
+
+bool pyModuleBase::check_result(PyObject *pValue)
+{
+    if (pValue != NULL) {
+	bool result = PyObject_IsTrue(pValue);
+	Py_DECREF(pValue);
+	return result;
+    } else {
+	PyErr_Print();
+	printf("ERROR: call failed (%s)\n", module_name.c_str());
+	return false;
+    }
+}
+
 bool pyModuleBase::init(const char *import_name)
 {
     printf("pyModule importing: %s\n", import_name);
@@ -24,17 +66,18 @@ bool pyModuleBase::init(const char *import_name)
 	return false;
     }
 
-    PyObject *pFuncInit = PyObject_GetAttrString(pModuleObj, "init");
-    if ( pFuncInit == NULL || ! PyCallable_Check(pFuncInit) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
-	printf("Cannot find function '%s.init()'\n", import_name);
+    PyObject *pFuncInit = get_method("init");
+    if ( pFuncInit == NULL ) {
 	Py_DECREF(pModuleObj);
 	pModuleObj = NULL;
 	return false;
     }
 
-    // FIXME decref pFuncInit
-    
+    // optional, not every module has a per frame update()
+    if ( PyObject_HasAttrString(pModuleObj, "update") ) {
+	pFuncUpdate = get_method("update");
+    }
+
     PyObject *pValue = PyObject_CallFunction(pFuncInit, NULL);
     if (pValue != NULL) {
 	bool result = PyObject_IsTrue(pValue);
@@ -54,24 +97,9 @@ bool pyModuleBase::update( double dt ) {
 	printf("ERROR: module.init() failed (%s)\n", module_name.c_str());
 	return false;
     }
-    PyObject *pFuncUpdate = PyObject_GetAttrString(pModuleObj, "update");
-    if ( pFuncUpdate == NULL || ! PyCallable_Check(pFuncUpdate) ) {
-	if ( PyErr_Occurred() ) PyErr_Print();
+    if ( pFuncUpdate == NULL ) {
 	printf("ERROR: cannot find function 'update()'\n");
 	return false;
     }
-
-    // FIXME decref pFuncUpdate
-    
-    PyObject *pValue = PyObject_CallFunction(pFuncUpdate, (char *)"d", dt);
-    if (pValue != NULL) {
-	bool result = PyObject_IsTrue(pValue);
-	Py_DECREF(pValue);
-	return result;
-    } else {
-	PyErr_Print();
-	printf("ERROR: call failed\n");
-	return false;
-    }
-    return false;
+    return check_result( PyObject_CallFunction(pFuncUpdate, (char *)"d", dt) );
 }
@@ -4,10 +4,16 @@
 // import a python module and call it's init() and update() routines
 // requires imported python modules to follow some basic rules to play
 // nice.  (see examples in the code for now.)
+//
+// Module functions are looked up once (get_method()) and the function
+// objects are kept for the life of the module, so a call from the
+// main loop is a plain PyObject_Call*() with no attribute lookup.
 
 #include <Python.h>
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 
 class pyModuleBase {
 
@@ -19,12 +25,31 @@ public:
 
     bool init(const char *import_name);
     bool update( double dt );
-    
+
+    // the named module function (borrowed reference, owned by this
+    // object) or NULL if the module doesn't have it.  The first call
+    // for a name does the lookup, later calls just return the cached
+    // handle (misses are cached too.)
+    PyObject *get_method(const char *name);
+
 protected:
 
     PyObject *pModuleObj;
+    PyObject *pFuncUpdate;
     string module_name;
-    
+
+    // common handling of the result of a call through a method
+    // handle: returns the truth value of the result and prints the
+    // python error if the call failed.
+    bool check_result(PyObject *pValue);
+
+private:
+
+    struct method_entry {
+	string name;
+	PyObject *func;
+    };
+    vector<method_entry> methods;
 };
 
 #endif // _AURA_PYMODULE_HXX
@@ -8,9 +8,13 @@
 using std::string;
 using std::vector;
 
+#include "props/props.hxx"
+
 
 //
-// C++ interface to a python PropertyNode()
+// C++ handle to a property tree node.  The tree itself is native
+// (see props/props.hxx) and is shared with python through the builtin
+// 'props' module, so none of these calls enter the interpreter.
 //
 class pyPropertyNode
 {
@@ -18,7 +22,7 @@ public:
     // Constructor.
     pyPropertyNode();
     pyPropertyNode(const pyPropertyNode &node); // copy constructor
-    pyPropertyNode(PyObject *p);
+    pyPropertyNode(PropertyNode *p);
 
     // Destructor.
     ~pyPropertyNode();
@@ -61,20 +65,27 @@ public:
     // indexed value setters
     bool setDouble( const char *name, int index, double val  ); // returns true if successful
     
+    // return a pre-resolved handle to name[index] (the value slot is
+    // created if needed).  Use these in update routines instead of
+    // the get/set by name calls.
+    template <class T>
+    PropertyHandle<T> getHandle( const char *name, int index=0 ) {
+	return PropertyHandle<T>(pObj, name, index);
+    }
+
     void pretty_print();
 
     // semi-private (pretend you can't touch this!) : :-)
-    PyObject *pObj;
-
-private:
-    // really private
-    double PyObject2Double(const char *name, PyObject *pAttr);
-    long PyObject2Long(const char *name, PyObject *pAttr);
+    PropertyNode *pObj;
 };
 
 
+// This function must be called before Py_Initialize().  It registers
+// the native 'props', 'props_json' and 'props_xml' python modules.
+extern void pyPropsRegisterModules();
+
 // This function must be called before any pyPropertyNode usage. It
-// imports the python props and props_xml modules.
+// creates the root of the property tree.
 extern void pyPropsInit();
 
 // This function can be called at exit to properly free resources
@@ -0,0 +1,487 @@
+/**
+ * Python 'props', 'props_json' and 'props_xml' modules implemented as
+ * a thin view over the native C++ property tree (props/props.hxx).
+ *
+ * These are registered as builtin modules before the interpreter
+ * starts so they take precedence over any pure python versions
+ * installed on the system.  Python code keeps the same interface
+ * (getNode(), root, node.getFloat(), node.setInt(), ...) but every
+ * value lives in the C++ tree.
+ */
+
+#include <Python.h>
+
+#include <string>
+using std::string;
+
+#include "props/props.hxx"
+#include "props/props_json.hxx"
+#include "props/props_xml.hxx"
+
+#include "pyprops.hxx"
+
+
+typedef struct {
+    PyObject_HEAD
+    PropertyNode *node;
+} PyPropsNode;
+
+static PyTypeObject PyPropsNodeType = {
+    PyObject_HEAD_INIT(NULL)
+};
+
+static PyObject *wrap_node( PropertyNode *node ) {
+    if ( node == NULL ) {
+	Py_RETURN_NONE;
+    }
+    PyPropsNode *self = PyObject_New(PyPropsNode, &PyPropsNodeType);
+    if ( self != NULL ) {
+	self->node = node;
+    }
+    return (PyObject *)self;
+}
+
+static PyObject *wrap_value( const PropertyValue &val ) {
+    switch ( val.type ) {
+    case PROP_BOOL: return PyBool_FromLong(val.b);
+    case PROP_INT: return PyInt_FromLong(val.l);
+    case PROP_DOUBLE: return PyFloat_FromDouble(val.d);
+    case PROP_STRING: return PyString_FromString(val.s.c_str());
+    default: Py_RETURN_NONE;
+    }
+}
+
+// store a python value into a slot, keeping the python type
+static bool store_value( PropertyValue *val, PyObject *obj ) {
+    if ( PyBool_Check(obj) ) {
+	val->setBool(obj == Py_True);
+    } else if ( PyInt_Check(obj) ) {
+	val->setLong(PyInt_AsLong(obj));
+    } else if ( PyLong_Check(obj) ) {
+	val->setLong(PyLong_AsLong(obj));
+    } else if ( PyFloat_Check(obj) ) {
+	val->setDouble(PyFloat_AsDouble(obj));
+    } else {
+	PyObject *pStr = PyObject_Str(obj);
+	if ( pStr == NULL ) {
+	    return false;
+	}
+	val->setString(PyString_AsString(pStr));
+	Py_DECREF(pStr);
+    }
+    return true;
+}
+
+
+// PropertyNode methods
+
+static PyObject *node_getFloat( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    return PyFloat_FromDouble(self->node->getDouble(name));
+}
+
+static PyObject *node_getInt( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    return PyInt_FromLong(self->node->getLong(name));
+}
+
+static PyObject *node_getBool( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    return PyBool_FromLong(self->node->getBool(name));
+}
+
+static PyObject *node_getString( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    int name_len, index;
+    PropertyParseIndex(name, strlen(name), &name_len, &index);
+    if ( index >= 0 ) {
+	string base(name, name_len);
+	return PyString_FromString(self->node->getString(base.c_str(), index).c_str());
+    }
+    return PyString_FromString(self->node->getString(name).c_str());
+}
+
+static PyObject *node_getFloatEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    if ( !PyArg_ParseTuple(args, "si", &name, &index) ) return NULL;
+    return PyFloat_FromDouble(self->node->getDouble(name, index));
+}
+
+static PyObject *node_getIntEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    if ( !PyArg_ParseTuple(args, "si", &name, &index) ) return NULL;
+    return PyInt_FromLong(self->node->getLong(name, index));
+}
+
+static PyObject *node_getBoolEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    if ( !PyArg_ParseTuple(args, "si", &name, &index) ) return NULL;
+    return PyBool_FromLong(self->node->getBool(name, index));
+}
+
+static PyObject *node_getStringEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    if ( !PyArg_ParseTuple(args, "si", &name, &index) ) return NULL;
+    return PyString_FromString(self->node->getString(name, index).c_str());
+}
+
+static PyObject *node_setFloat( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    double val;
+    if ( !PyArg_ParseTuple(args, "sd", &name, &val) ) return NULL;
+    return PyBool_FromLong(self->node->setDouble(name, val));
+}
+
+static PyObject *node_setInt( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    long val;
+    if ( !PyArg_ParseTuple(args, "sl", &name, &val) ) return NULL;
+    return PyBool_FromLong(self->node->setLong(name, val));
+}
+
+static PyObject *node_setBool( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    PyObject *val;
+    if ( !PyArg_ParseTuple(args, "sO", &name, &val) ) return NULL;
+    return PyBool_FromLong(self->node->setBool(name, PyObject_IsTrue(val)));
+}
+
+static PyObject *node_setString( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    PyObject *val;
+    if ( !PyArg_ParseTuple(args, "sO", &name, &val) ) return NULL;
+    PyObject *pStr = PyObject_Str(val);
+    if ( pStr == NULL ) return NULL;
+    bool result = self->node->setString(name, PyString_AsString(pStr));
+    Py_DECREF(pStr);
+    return PyBool_FromLong(result);
+}
+
+static PyObject *node_setFloatEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    double val;
+    if ( !PyArg_ParseTuple(args, "sid", &name, &index, &val) ) return NULL;
+    return PyBool_FromLong(self->node->setDouble(name, index, val));
+}
+
+static PyObject *node_setIntEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    long val;
+    if ( !PyArg_ParseTuple(args, "sil", &name, &index, &val) ) return NULL;
+    return PyBool_FromLong(self->node->setLong(name, index, val));
+}
+
+static PyObject *node_setBoolEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    PyObject *val;
+    if ( !PyArg_ParseTuple(args, "siO", &name, &index, &val) ) return NULL;
+    return PyBool_FromLong(self->node->setBool(name, index,
+					       PyObject_IsTrue(val)));
+}
+
+static PyObject *node_setStringEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int index;
+    PyObject *val;
+    if ( !PyArg_ParseTuple(args, "siO", &name, &index, &val) ) return NULL;
+    PyObject *pStr = PyObject_Str(val);
+    if ( pStr == NULL ) return NULL;
+    bool result = self->node->setString(name, index, PyString_AsString(pStr));
+    Py_DECREF(pStr);
+    return PyBool_FromLong(result);
+}
+
+static PyObject *node_hasChild( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    return PyBool_FromLong(self->node->hasChild(name));
+}
+
+static PyObject *node_getChild( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    PyObject *create = Py_False;
+    if ( !PyArg_ParseTuple(args, "s|O", &name, &create) ) return NULL;
+    return wrap_node(self->node->getChild(name,
+					  (bool)PyObject_IsTrue(create)));
+}
+
+static PyObject *node_getChildren( PyPropsNode *self, PyObject *args,
+				   PyObject *kwds )
+{
+    static char *kwlist[] = { (char *)"expand", NULL };
+    PyObject *expand = Py_True;
+    if ( !PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &expand) ) {
+	return NULL;
+    }
+    vector<string> children
+	= self->node->getChildren(PyObject_IsTrue(expand));
+    PyObject *pList = PyList_New(children.size());
+    for ( unsigned int i = 0; i < children.size(); i++ ) {
+	// note: SetItem steals the reference
+	PyList_SetItem(pList, i, PyString_FromString(children[i].c_str()));
+    }
+    return pList;
+}
+
+static PyObject *node_getLen( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    return PyInt_FromLong(self->node->getLen(name));
+}
+
+static PyObject *node_setLen( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    int size;
+    PyObject *init_val = Py_None;
+    if ( !PyArg_ParseTuple(args, "si|O", &name, &size, &init_val) ) {
+	return NULL;
+    }
+    if ( init_val == Py_None ) {
+	self->node->setLen(name, size);
+    } else {
+	int len = self->node->getLen(name);
+	self->node->setLen(name, size, 0.0);
+	// honor the type of the init value for the new elements
+	for ( int i = len; i < size; i++ ) {
+	    PropertyValue *val = self->node->getValue(name, i);
+	    if ( val != NULL && !store_value(val, init_val) ) {
+		return NULL;
+	    }
+	}
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *node_isLeaf( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    return PyBool_FromLong(self->node->isLeaf(name));
+}
+
+static PyObject *node_isEnum( PyPropsNode *self, PyObject *args ) {
+    const char *name;
+    if ( !PyArg_ParseTuple(args, "s", &name) ) return NULL;
+    return PyBool_FromLong(self->node->isEnum(name));
+}
+
+static PyObject *node_pretty_print( PyPropsNode *self, PyObject *args ) {
+    const char *indent = "";
+    if ( !PyArg_ParseTuple(args, "|s", &indent) ) return NULL;
+    self->node->pretty_print(indent);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef node_methods[] = {
+    { "getFloat", (PyCFunction)node_getFloat, METH_VARARGS, NULL },
+    { "getInt", (PyCFunction)node_getInt, METH_VARARGS, NULL },
+    { "getBool", (PyCFunction)node_getBool, METH_VARARGS, NULL },
+    { "getString", (PyCFunction)node_getString, METH_VARARGS, NULL },
+    { "getFloatEnum", (PyCFunction)node_getFloatEnum, METH_VARARGS, NULL },
+    { "getIntEnum", (PyCFunction)node_getIntEnum, METH_VARARGS, NULL },
+    { "getBoolEnum", (PyCFunction)node_getBoolEnum, METH_VARARGS, NULL },
+    { "getStringEnum", (PyCFunction)node_getStringEnum, METH_VARARGS, NULL },
+    { "setFloat", (PyCFunction)node_setFloat, METH_VARARGS, NULL },
+    { "setInt", (PyCFunction)node_setInt, METH_VARARGS, NULL },
+    { "setBool", (PyCFunction)node_setBool, METH_VARARGS, NULL },
+    { "setString", (PyCFunction)node_setString, METH_VARARGS, NULL },
+    { "setFloatEnum", (PyCFunction)node_setFloatEnum, METH_VARARGS, NULL },
+    { "setIntEnum", (PyCFunction)node_setIntEnum, METH_VARARGS, NULL },
+    { "setBoolEnum", (PyCFunction)node_setBoolEnum, METH_VARARGS, NULL },
+    { "setStringEnum", (PyCFunction)node_setStringEnum, METH_VARARGS, NULL },
+    { "hasChild", (PyCFunction)node_hasChild, METH_VARARGS, NULL },
+    { "getChild", (PyCFunction)node_getChild, METH_VARARGS, NULL },
+    { "getChildren", (PyCFunction)node_getChildren,
+      METH_VARARGS | METH_KEYWORDS, NULL },
+    { "getLen", (PyCFunction)node_getLen, METH_VARARGS, NULL },
+    { "setLen", (PyCFunction)node_setLen, METH_VARARGS, NULL },
+    { "isLeaf", (PyCFunction)node_isLeaf, METH_VARARGS, NULL },
+    { "isEnum", (PyCFunction)node_isEnum, METH_VARARGS, NULL },
+    { "pretty_print", (PyCFunction)node_pretty_print, METH_VARARGS, NULL },
+    { NULL, NULL, 0, NULL }
+};
+
+// plain attribute access (node.name) for code that doesn't use the
+// accessor functions.  Enumerated members come back as lists.
+static PyObject *node_getattro( PyPropsNode *self, PyObject *name ) {
+    PyObject *result = PyObject_GenericGetAttr((PyObject *)self, name);
+    if ( result != NULL || !PyErr_ExceptionMatches(PyExc_AttributeError) ) {
+	return result;
+    }
+    const PropertyEntry *e
+	= self->node->findEntry(PyString_AsString(name));
+    if ( e == NULL || e->is_unset() ) {
+	return NULL;		// leave the AttributeError set
+    }
+    PyErr_Clear();
+    if ( !e->is_enum ) {
+	return e->is_leaf ? wrap_value(e->values[0]) : wrap_node(e->nodes[0]);
+    }
+    int len = e->len();
+    PyObject *pList = PyList_New(len);
+    for ( int i = 0; i < len; i++ ) {
+	PyList_SetItem(pList, i, e->is_leaf ? wrap_value(e->values[i])
+		                            : wrap_node(e->nodes[i]));
+    }
+    return pList;
+}
+
+static int node_setattro( PyPropsNode *self, PyObject *name,
+			  PyObject *value )
+{
+    const char *attr = PyString_AsString(name);
+    if ( attr == NULL ) {
+	return -1;
+    }
+    if ( value == NULL ) {
+	PyErr_SetString(PyExc_TypeError, "cannot delete property values");
+	return -1;
+    }
+    PropertyEntry *e = self->node->findEntry(attr);
+    if ( e != NULL && !e->is_leaf ) {
+	PyErr_Format(PyExc_AttributeError,
+		     "'%s' is a branch node, not a value", attr);
+	return -1;
+    }
+    if ( PyList_Check(value) ) {
+	// replaces the whole list: a shorter one clears the slots past
+	// its end
+	int len = PyList_Size(value);
+	self->node->setLen(attr, len, 0.0);
+	e = self->node->findEntry(attr);
+	for ( int i = 0; i < len; i++ ) {
+	    if ( !store_value(&e->values[i], PyList_GetItem(value, i)) ) {
+		return -1;
+	    }
+	}
+	for ( unsigned int i = len; i < e->values.size(); i++ ) {
+	    e->values[i].clear();
+	}
+	return 0;
+    }
+    PropertyValue *val = self->node->getValue(attr, 0, true);
+    return store_value(val, value) ? 0 : -1;
+}
+
+static PyObject *node_richcompare( PyObject *a, PyObject *b, int op ) {
+    if ( !PyObject_TypeCheck(b, &PyPropsNodeType)
+	 || (op != Py_EQ && op != Py_NE) )
+    {
+	Py_INCREF(Py_NotImplemented);
+	return Py_NotImplemented;
+    }
+    bool same = ((PyPropsNode *)a)->node == ((PyPropsNode *)b)->node;
+    return PyBool_FromLong(op == Py_EQ ? same : !same);
+}
+
+static long node_hash( PyPropsNode *self ) {
+    return _Py_HashPointer(self->node);
+}
+
+
+// props module functions
+
+static PyObject *props_getNode( PyObject *self, PyObject *args ) {
+    const char *path;
+    PyObject *create = Py_False;
+    if ( !PyArg_ParseTuple(args, "s|O", &path, &create) ) return NULL;
+    return wrap_node(PropertyGetNode(path, PyObject_IsTrue(create)));
+}
+
+static PyMethodDef props_methods[] = {
+    { "getNode", props_getNode, METH_VARARGS,
+      "getNode(path, create=False): return the node at path (or None)" },
+    { NULL, NULL, 0, NULL }
+};
+
+PyMODINIT_FUNC initprops( void ) {
+    PyPropsNodeType.tp_name = "props.PropertyNode";
+    PyPropsNodeType.tp_basicsize = sizeof(PyPropsNode);
+    PyPropsNodeType.tp_flags = Py_TPFLAGS_DEFAULT;
+    PyPropsNodeType.tp_doc = "view of a native property tree node";
+    PyPropsNodeType.tp_methods = node_methods;
+    PyPropsNodeType.tp_getattro = (getattrofunc)node_getattro;
+    PyPropsNodeType.tp_setattro = (setattrofunc)node_setattro;
+    PyPropsNodeType.tp_richcompare = node_richcompare;
+    PyPropsNodeType.tp_hash = (hashfunc)node_hash;
+    if ( PyType_Ready(&PyPropsNodeType) < 0 ) {
+	return;
+    }
+
+    PyObject *m = Py_InitModule3("props", props_methods,
+				 "native property tree");
+    if ( m == NULL ) {
+	return;
+    }
+    Py_INCREF(&PyPropsNodeType);
+    PyModule_AddObject(m, "PropertyNode", (PyObject *)&PyPropsNodeType);
+    PyModule_AddObject(m, "root", wrap_node(PropertyRoot()));
+}
+
+
+// props_json / props_xml modules
+
+typedef bool (*PropertyIOFunc)( const string &filename, PropertyNode *node );
+
+static PyObject *props_io( PyObject *args, PropertyIOFunc func ) {
+    const char *filename;
+    PyObject *node;
+    if ( !PyArg_ParseTuple(args, "sO!", &filename, &PyPropsNodeType, &node) ) {
+	return NULL;
+    }
+    return PyBool_FromLong(func(filename, ((PyPropsNode *)node)->node));
+}
+
+static PyObject *json_load( PyObject *self, PyObject *args ) {
+    return props_io(args, PropertyReadJSON);
+}
+
+static PyObject *json_save( PyObject *self, PyObject *args ) {
+    return props_io(args, PropertyWriteJSON);
+}
+
+static PyObject *xml_load( PyObject *self, PyObject *args ) {
+    return props_io(args, PropertyReadXML);
+}
+
+static PyObject *xml_save( PyObject *self, PyObject *args ) {
+    return props_io(args, PropertyWriteXML);
+}
+
+static PyMethodDef json_methods[] = {
+    { "load", json_load, METH_VARARGS, "load(filename, node)" },
+    { "save", json_save, METH_VARARGS, "save(filename, node)" },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyMethodDef xml_methods[] = {
+    { "load", xml_load, METH_VARARGS, "load(filename, node)" },
+    { "save", xml_save, METH_VARARGS, "save(filename, node)" },
+    { NULL, NULL, 0, NULL }
+};
+
+PyMODINIT_FUNC initprops_json( void ) {
+    Py_InitModule3("props_json", json_methods, "property tree json i/o");
+}
+
+PyMODINIT_FUNC initprops_xml( void ) {
+    Py_InitModule3("props_xml", xml_methods, "property tree xml i/o");
+}
+
+
+// This function must be called before Py_Initialize()
+void pyPropsRegisterModules() {
+    PyImport_AppendInittab((char *)"props", initprops);
+    PyImport_AppendInittab((char *)"props_json", initprops_json);
+    PyImport_AppendInittab((char *)"props_xml", initprops_xml);
+}
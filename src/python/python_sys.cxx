@@ -1,5 +1,9 @@
 #include "python_sys.hxx"
+#include "pyprops.hxx"
 
+#include <pthread.h>
+
+#include <atomic>
 #include <sstream>
 #include <string>
 using std::ostringstream;
@@ -8,6 +12,7 @@ using std::string;
 // This function must be called first (before any other python usage.)
 // It sets up the python intepreter.
 void AuraPythonInit(int argc, char **argv, string extra_module_path) {
+    pyPropsRegisterModules();   // native props modules (builtin)
     Py_SetProgramName(argv[0]); // optional but recommended
     Py_Initialize();
     PySys_SetArgv(argc, argv);  // for relative imports to work
@@ -27,3 +32,84 @@ void AuraPythonInit(int argc, char **argv, string extra_module_path) {
 void AuraPythonCleanup(void) {
     Py_Finalize();
 }
+
+
+// thread state of the calling thread while it doesn't hold the lock
+static __thread PyThreadState *saved_state = NULL;
+static __thread bool is_priority = false;
+
+// set while the priority (control) thread wants or holds the lock
+static std::atomic<bool> priority_waiting(false);
+static std::atomic<bool> yield_queued(false);
+static pthread_mutex_t yield_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t yield_cond = PTHREAD_COND_INITIALIZER;
+
+// give up the lock until the priority thread is done with it
+static void wait_for_priority() {
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock( &yield_lock );
+    while ( priority_waiting ) {
+	pthread_cond_wait( &yield_cond, &yield_lock );
+    }
+    pthread_mutex_unlock( &yield_lock );
+    Py_END_ALLOW_THREADS
+}
+
+// pending call, run by the main thread from inside the interpreter
+// loop: step aside until the priority thread is done
+static int yield_to_priority( void *arg ) {
+    yield_queued = false;
+    if ( priority_waiting ) {
+	wait_for_priority();
+    }
+    return 0;
+}
+
+// profile hook for the other threads (the interpreter only runs
+// pending calls in the main thread.)  Called on every python and
+// builtin function call/return, so keep it to a single load.
+static int yield_profile( PyObject *obj, struct _frame *frame, int what,
+			  PyObject *arg )
+{
+    if ( priority_waiting.load( std::memory_order_relaxed ) ) {
+	wait_for_priority();
+    }
+    return 0;
+}
+
+void AuraPythonThreadsInit() {
+    PyEval_InitThreads();
+}
+
+void AuraPythonAttach() {
+    PyGILState_Ensure();
+    saved_state = PyEval_SaveThread();
+}
+
+void AuraPythonAcquire( bool priority ) {
+    if ( priority ) {
+	priority_waiting = true;
+	if ( ! yield_queued.exchange(true) ) {
+	    if ( Py_AddPendingCall( yield_to_priority, NULL ) != 0 ) {
+		yield_queued = false;
+	    }
+	}
+    }
+    PyEval_RestoreThread( saved_state );
+    saved_state = NULL;
+    is_priority = priority;
+}
+
+void AuraPythonYieldHook() {
+    PyEval_SetProfile( yield_profile, NULL );
+}
+
+void AuraPythonRelease() {
+    saved_state = PyEval_SaveThread();
+    if ( is_priority ) {
+	pthread_mutex_lock( &yield_lock );
+	priority_waiting = false;
+	pthread_cond_broadcast( &yield_cond );
+	pthread_mutex_unlock( &yield_lock );
+    }
+}
@@ -1,5 +1,5 @@
 #ifndef _AURA_PYTHON_SYS_HXX
-#define _AURA_PYTHOS_SYS_HXX
+#define _AURA_PYTHON_SYS_HXX
 
 #include <Python.h>
 
@@ -17,4 +17,44 @@ extern void AuraPythonInit(int argc, char **argv, string extra_module_path);
 extern void AuraPythonCleanup(void);
 
 
+// Threads.  The interpreter lock also guards the property tree and
+// the other structures shared by the control thread and the main
+// thread, so any thread touching them must hold it.  Native work that
+// needs neither (file and link io) drops it with
+// Py_BEGIN_ALLOW_THREADS, the priority hand over below can only
+// interrupt python code.
+//
+// AuraPythonThreadsInit() is called once by the main thread (after
+// AuraPythonInit(), which leaves the main thread holding the lock.)
+// A new thread calls AuraPythonAttach() once, which returns without
+// the lock.  After that each thread brackets its work with
+// AuraPythonAcquire() / AuraPythonRelease().  With priority=true
+// (the control thread) the main thread is asked to hand the lock
+// over at its next python instruction instead of whenever the
+// interpreter gets around to switching threads.
+extern void AuraPythonThreadsInit();
+extern void AuraPythonAttach();
+extern void AuraPythonAcquire( bool priority=false );
+extern void AuraPythonRelease();
+
+// The hand over above relies on a pending call, which the interpreter
+// only runs in the main thread.  Any other thread that runs python
+// code at normal priority (the mission thread) calls this once while
+// holding the lock so it steps aside for the priority thread as well.
+//
+// This installs a profile function (PyEval_SetProfile()) for the
+// calling thread, which has two costs:
+//  - it runs on every python and builtin function call and return of
+//    that thread, not only when the priority thread is waiting.  The
+//    hook itself is one relaxed load, but every call also goes
+//    through the interpreter's tracing path: around 5-10% more time
+//    for call heavy code like the mission tasks (a loop of small
+//    get/set style method calls measured with and without the hook.)
+//  - it is the thread's only profile slot: sys.setprofile() or
+//    cProfile in that thread replace it, and the thread stops
+//    stepping aside until the hook is installed again.  Other threads
+//    are not affected.
+extern void AuraPythonYieldHook();
+
+
 #endif // _AURA_PYTHON_SYS_HXX
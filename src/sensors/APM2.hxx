@@ -14,7 +14,6 @@
 
 // function prototypes
 
-double APM2_update();
 void APM2_close();
 bool APM2_request_baud( uint32_t baud );
 
@@ -29,6 +29,8 @@ using namespace Eigen;
 #include "util/linearfit.hxx"
 #include "util/lowpass.hxx"
 //#include "util/poly1d.hxx"
+#include "util/reactor.hxx"
+#include "util/serial_framer.hxx"
 #include "util/timing.h"
 
 #include "Aura3.hxx"
@@ -91,6 +93,11 @@ static pyPropertyNode airdata_node;
 static pyPropertyNode analog_node;
 static pyPropertyNode config_power_node;
 
+// uart framing statistics
+static PropertyHandle<double> bytes_per_read_h;
+static PropertyHandle<long> resyncs_h;
+static PropertyHandle<long> cksum_errors_h;
+
 static bool master_opened = false;
 static bool imu_inited = false;
 static bool gps_inited = false;
@@ -100,6 +107,7 @@ static bool actuator_inited = false;
 bool Aura3_actuator_configured = false; // externally visible
 
 static int fd = -1;
+static SerialFramer framer;
 static string device_name = "/dev/ttyS0";
 static int baud = 500000;
 static float volt_div_ratio = 100; // a nonsense value
@@ -378,6 +386,9 @@ static void bind_pilot_controls( string output_path ) {
 }
 
 
+static bool Aura3_read_available( void *arg );
+
+
 // send our configured init strings to configure gpsd the way we prefer
 static bool Aura3_open_device( int baud_bits ) {
     if ( display_on ) {
@@ -385,8 +396,7 @@ static bool Aura3_open_device( int baud_bits ) {
 	       baud_bits);
     }
 
-    // fd = open( device_name.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK );
-    fd = open( device_name.c_str(), O_RDWR | O_NOCTTY );
+    fd = open( device_name.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK );
     if ( fd < 0 ) {
         fprintf( stderr, "open serial: unable to open %s - %s\n",
                  device_name.c_str(), strerror(errno) );
@@ -409,8 +419,8 @@ static bool Aura3_open_device( int baud_bits ) {
     config.c_oflag     = 0;
     config.c_lflag     = 0;
     config.c_cc[VTIME] = 0;
-    config.c_cc[VMIN]  = 1;	   // block 'read' from returning until at
-                                   // least 1 character is received
+    config.c_cc[VMIN]  = 0;	   // non-blocking, the reactor tells us
+                                   // when input is available
 
     // Flush Serial Port I/O buffer
     tcflush(fd, TCIOFLUSH);
@@ -424,10 +434,18 @@ static bool Aura3_open_device( int baud_bits ) {
     }
 
     // Enable non-blocking IO (one more time for good measure)
-    // fcntl(fd, F_SETFL, O_NONBLOCK);
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    framer.init( fd, START_OF_MSG0, START_OF_MSG1 );
+
+    // parse input as it arrives
+    reactor.add( fd, Aura3_read_available, NULL );
 
     // bind main apm2 property nodes here for lack of a better place..
     aura3_node = pyGetNode("/sensors/Aura3", true);
+    bytes_per_read_h = aura3_node.getHandle<double>("serial_bytes_per_read");
+    resyncs_h = aura3_node.getHandle<long>("serial_resyncs");
+    cksum_errors_h = aura3_node.getHandle<long>("serial_cksum_errors");
     analog_node = pyGetNode("/sensors/Aura3/raw_analog", true);
     analog_node.setLen("channel", NUM_ANALOG_INPUTS, 0.0);
     
@@ -513,6 +531,9 @@ bool Aura3_imu_init( string output_path, pyPropertyNode *config ) {
 	return false;
     }
 
+    // imu packets drive the main loop
+    reactor.add( fd, Aura3_read_available, NULL, true );
+
     bind_imu_output( output_path );
 
     if ( config->hasChild("reverse_imu_mount") ) {
@@ -946,125 +967,32 @@ static void Aura3_read_tmp() {
 #endif
 
 
+// Pull in everything waiting on the uart and parse each complete
+// packet.  Returns the id of the last packet parsed (an IMU packet
+// takes precedence since it drives the main loop) or 0 if nothing
+// new arrived.
 static int Aura3_read() {
-    static int state = 0;
-    static int pkt_id = 0;
-    static int pkt_len = 0;
-    static int counter = 0;
-    static uint8_t cksum_A = 0, cksum_B = 0, cksum_lo = 0, cksum_hi = 0;
-    int len;
-    uint8_t input[500];
-    static uint8_t payload[500];
-    int giveup_counter = 0;
-
-    // if ( display_on ) {
-    //    printf("read Aura3, entry state = %d\n", state);
-    // }
-
-    bool new_data = false;
-
-    if ( state == 0 ) {
-	counter = 0;
-	cksum_A = cksum_B = 0;
-	len = read( fd, input, 1 );
-	giveup_counter = 0;
-	while ( len > 0 && input[0] != START_OF_MSG0 && giveup_counter < 100 ) {
-	    // printf("state0: len = %d val = %2X (%c)\n", len, input[0] , input[0]);
-	    len = read( fd, input, 1 );
-	    giveup_counter++;
-	    // fprintf( stderr, "giveup_counter = %d\n", giveup_counter);
-	}
-	if ( len > 0 && input[0] == START_OF_MSG0 ) {
-	    // fprintf( stderr, "read START_OF_MSG0\n");
-	    state++;
-	}
-    }
-    if ( state == 1 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    if ( input[0] == START_OF_MSG1 ) {
-		//fprintf( stderr, "read START_OF_MSG1\n");
-		state++;
-	    } else if ( input[0] == START_OF_MSG0 ) {
-		//fprintf( stderr, "read START_OF_MSG0\n");
-	    } else {
-		state = 0;
-	    }
-	}
-    }
-    if ( state == 2 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    pkt_id = input[0];
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    //fprintf( stderr, "pkt_id = %d\n", pkt_id );
-	    state++;
-	}
-    }
-    if ( state == 3 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    pkt_len = input[0];
-	    if ( pkt_len < 256 ) {
-		//fprintf( stderr, "pkt_len = %d\n", pkt_len );
-		cksum_A += input[0];
-		cksum_B += cksum_A;
-		state++;
-	    } else {
-		state = 0;
-	    }
-	}
-    }
-    if ( state == 4 ) {
-	len = read( fd, input, 1 );
-	while ( len > 0 ) {
-	    payload[counter++] = input[0];
-	    // fprintf( stderr, "%02X ", input[0] );
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    if ( counter >= pkt_len ) {
-		break;
-	    }
-	    len = read( fd, input, 1 );
-	}
-
-	if ( counter >= pkt_len ) {
-	    state++;
-	    // fprintf( stderr, "\n" );
-	}
-    }
-    if ( state == 5 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    cksum_lo = input[0];
-	    state++;
-	}
-    }
-    if ( state == 6 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    cksum_hi = input[0];
-	    if ( cksum_A == cksum_lo && cksum_B == cksum_hi ) {
-		// printf( "checksum passes (%d)\n", pkt_id );
-		new_data = Aura3_parse( pkt_id, pkt_len, payload );
-	    } else {
-		if ( display_on ) {
-		    // printf("checksum failed %d %d (computed) != %d %d (message)\n",
-		    //        cksum_A, cksum_B, cksum_lo, cksum_hi );
+    int result = 0;
+    uint8_t pkt_id;
+    int pkt_len;
+    uint8_t *payload;
+
+    do {
+	framer.fill();
+	while ( framer.next( &pkt_id, &pkt_len, &payload ) ) {
+	    if ( Aura3_parse( pkt_id, pkt_len, payload ) ) {
+		if ( result != IMU_PACKET_ID ) {
+		    result = pkt_id;
 		}
 	    }
-	    // this is the end of a record, reset state to 0 to start
-	    // looking for next record
-	    state = 0;
 	}
-    }
+    } while ( framer.more() );
 
-    if ( new_data ) {
-	return pkt_id;
-    } else {
-	return 0;
-    }
+    bytes_per_read_h.set( framer.get_bytes_per_read() );
+    resyncs_h.set( framer.get_resyncs() );
+    cksum_errors_h.set( framer.get_cksum_errors() );
+
+    return result;
 }
 
 
@@ -1354,29 +1282,11 @@ static bool Aura3_act_write() {
 }
 
 
-// Read Aura3 packets using IMU packet as the main timing reference.
-// Returns the dt from the IMU perspective, not the localhost
-// perspective.  This should generally be far more accurate and
-// consistent.
-double Aura3_update() {
-    // read packets until we receive an IMU packet and the uart buffer
-    // is mostly empty.  The IMU packet (combined with being caught up
-    // reading the uart buffer is our signal to run an interation of
-    // the main loop.
-    double last_time = imu_node.getDouble( "timestamp" );
-    int bytes_available = 0;
-    while ( true ) {
-        int pkt_id = Aura3_read();
-        if ( pkt_id == IMU_PACKET_ID ) {
-            ioctl(fd, FIONREAD, &bytes_available);
-	    if ( bytes_available < 64 ) {
-		break;
-            }
-        }
-    }
-    double cur_time = imu_node.getDouble( "timestamp" );
-
-    return cur_time - last_time;
+// Reactor handler: parse everything currently buffered on the uart.
+// Returns true if a fresh IMU packet arrived (the main timing
+// reference.)
+static bool Aura3_read_available( void *arg ) {
+    return Aura3_read() == IMU_PACKET_ID;
 }
 
 
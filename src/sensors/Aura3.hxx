@@ -14,7 +14,6 @@
 
 // function prototypes
 
-double Aura3_update();
 void Aura3_close();
 bool Aura3_request_baud( uint32_t baud );
 
@@ -9,6 +9,7 @@
 #include <sys/ioctl.h>
 
 #include "util/netSocket.h"
+#include "util/reactor.hxx"
 #include "util/timing.h"
 
 #include "FGFS.hxx"
@@ -29,6 +30,10 @@ static pyPropertyNode apm2_node;
 static pyPropertyNode config_power_node;
 
 static bool airdata_inited = false;
+static bool gps_fresh = false;
+
+static bool fgfs_imu_read_available( void *arg );
+static bool fgfs_gps_read_available( void *arg );
 
 
 // initialize fgfs_imu input property nodes
@@ -92,10 +97,8 @@ bool fgfs_imu_init( string output_path, pyPropertyNode *config ) {
 	return false;
     }
 
-#if 0 // we are using blocking for main loop sync now
-    // don't block waiting for input
-    sock_imu.setBlocking( false );
-#endif
+    // imu packets drive the main loop
+    reactor.add( sock_imu.getHandle(), fgfs_imu_read_available, NULL, true );
     
     return true;
 }
@@ -127,6 +130,7 @@ bool fgfs_gps_init( string output_path, pyPropertyNode *config ) {
 
     // don't block waiting for input
     sock_gps.setBlocking( false );
+    reactor.add( sock_gps.getHandle(), fgfs_gps_read_available, NULL );
 
     return true;
 }
@@ -231,29 +235,20 @@ static bool fgfs_imu_sync_update() {
     return fresh_data;
 }
 
-// Read fgfs packets using IMU packet as the main timing reference.
-// Returns the dt from the IMU perspective, not the localhost
-// perspective.  This should generally be far more accurate and
-// consistent.
-double FGFS_update() {
-    // read packets until we receive an IMU packet and the socket
-    // buffer is empty.  The IMU packet (combined with being caught up
-    // reading the buffer is our signal to run an interation of the
-    // main loop.
-    double last_time = imu_node.getDouble( "timestamp" );
+// Reactor handler: read all the pending imu packets (the last one
+// wins.)  Returns true if a fresh IMU packet arrived, which is the
+// signal to run an iteration of the main loop.
+static bool fgfs_imu_read_available( void *arg ) {
+    bool fresh_data = false;
     int bytes_available = 0;
-    while ( true ) {
-        fgfs_imu_sync_update();
+    do {
+        if ( fgfs_imu_sync_update() ) {
+	    fresh_data = true;
+	}
 	ioctl(sock_imu.getHandle(), FIONREAD, &bytes_available);
-	if ( !bytes_available ) {
-	    break;
-        }
-	// printf("looping: %d bytes available in imu sock buffer\n", bytes_available);
-    }
-
-    double cur_time = imu_node.getDouble( "timestamp" );
+    } while ( bytes_available > 0 );
 
-    return cur_time - last_time;
+    return fresh_data;
 }
 
 
@@ -280,7 +275,9 @@ bool fgfs_airdata_update() {
 }
 
 
-bool fgfs_gps_update() {
+// Reactor handler: parse gps packets as they arrive, fgfs_gps_update()
+// reports them to the gps manager.
+static bool fgfs_gps_read_available( void *arg ) {
     const int fgfs_gps_size = 40;
     uint8_t packet_buf[fgfs_gps_size];
 
@@ -330,6 +327,17 @@ bool fgfs_gps_update() {
 	gps_node.setLong( "status", 2 ); // valid fix
     }
 
+    if ( fresh_data ) {
+	gps_fresh = true;
+    }
+
+    return fresh_data;
+}
+
+
+bool fgfs_gps_update() {
+    bool fresh_data = gps_fresh;
+    gps_fresh = false;
     return fresh_data;
 }
 
@@ -8,8 +8,6 @@
 
 
 // function prototypes
-double FGFS_update();
-
 bool fgfs_imu_init( string output_path, pyPropertyNode *config );
 bool fgfs_imu_update();
 void fgfs_imu_close();
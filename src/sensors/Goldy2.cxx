@@ -24,6 +24,7 @@ using namespace Eigen;
 #include "util/linearfit.hxx"
 #include "util/netSocket.h"
 //#include "util/poly1d.hxx"
+#include "util/reactor.hxx"
 #include "util/timing.h"
 
 #include "util_goldy2.hxx"
@@ -146,6 +147,8 @@ static void bind_pilot_controls( string output_path ) {
 }
 
 
+static bool goldy2_read_available( void *arg );
+
 bool goldy2_init() {
     if ( master_init ) {
         return true;
@@ -165,10 +168,8 @@ bool goldy2_init() {
 	return false;
     }
 
-#if 0 // we are using blocking for main loop sync now
-    // don't block waiting for input
-    sock.setBlocking( false );
-#endif
+    // parse input as it arrives
+    reactor.add( sock.getHandle(), goldy2_read_available, NULL );
 
     master_init = true;
 
@@ -182,6 +183,9 @@ bool goldy2_imu_init( string output_path, pyPropertyNode *config ) {
         return false;
     }
 
+    // imu packets drive the main loop
+    reactor.add( sock.getHandle(), goldy2_read_available, NULL, true );
+
     bind_imu_output( output_path );
     
     if ( config->hasChild("imu_orientation") ) {
@@ -974,27 +978,19 @@ static int goldy2_read() {
     return 0;
 }
 
-// Read goldy2 packets using IMU packet as the main timing reference.
-// Returns the dt from the IMU perspective, not the localhost
-// perspective.  This should generally be far more accurate and
-// consistent.
-double goldy2_update() {
-    // printf("checking for packet ...\n");
-    double last_time = imu_node.getDouble( "timestamp" );
-    while ( true ) {
-	int pkt_id = goldy2_read();
-	if ( pkt_id == 0x81 /* IMU */ ) {
-	    int bytes_available = 0;
-            ioctl(sock.getHandle(), FIONREAD, &bytes_available);
-	    if ( bytes_available < 76 /* IMU packet len */ ) {
-		break;
-            }
-	    // printf("looping: %d bytes available in imu sock buffer\n", bytes_available);
+// Reactor handler: read all the pending packets.  Returns true if a
+// fresh IMU packet arrived (the main timing reference.)
+static bool goldy2_read_available( void *arg ) {
+    bool fresh_imu = false;
+    int bytes_available = 0;
+    do {
+	if ( goldy2_read() == 0x81 /* IMU */ ) {
+	    fresh_imu = true;
 	}
-    }
-    double cur_time = imu_node.getDouble( "timestamp" );
+	ioctl(sock.getHandle(), FIONREAD, &bytes_available);
+    } while ( bytes_available > 0 );
 
-    return cur_time - last_time;
+    return fresh_imu;
 }
 
 
@@ -14,10 +14,8 @@
 #include <stdio.h>
 #include <string.h>
 
-#include <sstream>
 #include <string>
 #include <vector>
-using std::ostringstream;
 using std::string;
 using std::vector;
 
@@ -36,6 +34,8 @@ using std::vector;
 #include "pika.hxx"
 #include "raven1.hxx"
 #include "raven2.hxx"
+#include "replay.hxx"
+#include "sensor_driver.hxx"
 
 #include "airdata_mgr.hxx"
 
@@ -61,9 +61,8 @@ static pyPropertyNode pos_pressure_node;
 static pyPropertyNode pos_combined_node;
 static pyPropertyNode vel_node;
 static pyPropertyNode task_node;
-static vector<pyPropertyNode> sections;
+static vector<sensor_section> sections;
 
-static int remote_link_skip = 0;
 static int logging_skip = 0;
 
 static myprofile debug2b1;
@@ -72,7 +71,94 @@ static myprofile debug2b2;
 // 1. ground altitude, 2. error between pressure altitude and gps altitude
 static bool airdata_calibrated = false;
 static bool alt_error_calibrated = false;
-    
+
+
+//
+// Driver table
+//
+
+static void airdata_replay_init( int i, string path, pyPropertyNode *config ) {
+    replay_airdata_init( i, config );
+}
+static bool airdata_replay_update( int i ) {
+    return replay_airdata_update( i );
+}
+
+static void bolder_airdata_init( int i, string path, pyPropertyNode *config ) {
+    airdata_bolder_init( path, config );
+}
+static bool bolder_airdata_update( int i ) { return airdata_bolder_update(); }
+static void bolder_airdata_close( int i ) { airdata_bolder_close(); }
+static void bolder_airdata_zero( int i ) { airdata_bolder_zero_airspeed(); }
+
+static void airdata_APM2_init( int i, string path, pyPropertyNode *config ) {
+    APM2_airdata_init( path );
+}
+static bool airdata_APM2_update( int i ) { return APM2_airdata_update(); }
+static void airdata_APM2_close( int i ) { APM2_airdata_close(); }
+static void airdata_APM2_zero( int i ) { APM2_airdata_zero_airspeed(); }
+
+static void airdata_Aura3_init( int i, string path, pyPropertyNode *config ) {
+    Aura3_airdata_init( path );
+}
+static bool airdata_Aura3_update( int i ) { return Aura3_airdata_update(); }
+static void airdata_Aura3_close( int i ) { Aura3_airdata_close(); }
+static void airdata_Aura3_zero( int i ) { Aura3_airdata_zero_airspeed(); }
+
+static void airdata_fgfs_init( int i, string path, pyPropertyNode *config ) {
+    fgfs_airdata_init( path );
+}
+static bool airdata_fgfs_update( int i ) { return fgfs_airdata_update(); }
+
+static void airdata_goldy2_init( int i, string path, pyPropertyNode *config ) {
+    goldy2_airdata_init( path );
+}
+static bool airdata_goldy2_update( int i ) { return goldy2_airdata_update(); }
+static void airdata_goldy2_close( int i ) { goldy2_airdata_close(); }
+
+static void airdata_pika_init( int i, string path, pyPropertyNode *config ) {
+    pika_airdata_init( path, config );
+}
+static bool airdata_pika_update( int i ) { return pika_airdata_update(); }
+static void airdata_pika_close( int i ) { pika_airdata_close(); }
+
+static void airdata_raven1_init( int i, string path, pyPropertyNode *config ) {
+    raven1_airdata_init( path, config );
+}
+static bool airdata_raven1_update( int i ) { return raven1_airdata_update(); }
+static void airdata_raven1_close( int i ) { raven1_airdata_close(); }
+
+static void airdata_raven2_init( int i, string path, pyPropertyNode *config ) {
+    raven2_airdata_init( path, config );
+}
+static bool airdata_raven2_update( int i ) { return raven2_airdata_update(); }
+static void airdata_raven2_close( int i ) { raven2_airdata_close(); }
+
+static const sensor_driver drivers[] = {
+    { "replay", 0,
+      airdata_replay_init, airdata_replay_update, NULL, NULL },
+    { "airdata_bolder", 0,
+      bolder_airdata_init, bolder_airdata_update, bolder_airdata_close,
+      bolder_airdata_zero },
+    { "APM2", 0,
+      airdata_APM2_init, airdata_APM2_update, airdata_APM2_close,
+      airdata_APM2_zero },
+    { "Aura3", 0,
+      airdata_Aura3_init, airdata_Aura3_update, airdata_Aura3_close,
+      airdata_Aura3_zero },
+    { "fgfs", 0,
+      airdata_fgfs_init, airdata_fgfs_update, NULL, NULL },
+    { "Goldy2", 0,
+      airdata_goldy2_init, airdata_goldy2_update, airdata_goldy2_close, NULL },
+    { "pika", 0,
+      airdata_pika_init, airdata_pika_update, airdata_pika_close, NULL },
+    { "raven1", SENSOR_RAVEN_PACKET,
+      airdata_raven1_init, airdata_raven1_update, airdata_raven1_close, NULL },
+    { "raven2", SENSOR_RAVEN_PACKET,
+      airdata_raven2_init, airdata_raven2_update, airdata_raven2_close, NULL }
+};
+
+
 void AirData_init() {
     debug2b1.set_name("debug2b1 airdata update");
     debug2b2.set_name("debug2b2 airdata console link");
@@ -86,49 +172,14 @@ void AirData_init() {
     vel_node = pyGetNode("/velocity", true);
     task_node = pyGetNode("/task", true);
 
-    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
     pyPropertyNode logging_node = pyGetNode("/config/logging", true);
-    remote_link_skip = remote_link_node.getDouble("airdata_skip");
     logging_skip = logging_node.getDouble("airdata_skip");
 
     // traverse configured modules
-    pyPropertyNode group_node = pyGetNode("/config/sensors/airdata_group", true);
-    vector<string> children = group_node.getChildren();
-    printf("Found %d airdata sections\n", (int)children.size());
-    for ( unsigned int i = 0; i < children.size(); i++ ) {
-	pyPropertyNode section = group_node.getChild(children[i].c_str());
-	sections.push_back(section);
-	string source = section.getString("source");
-	bool enabled = section.getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	ostringstream output_path;
-	output_path << "/sensors/airdata" << '[' << i << ']';
-	printf("airdata: %d = %s (%s)\n", i, source.c_str(), output_path.str().c_str());
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "airdata_bolder" ) {
-	    airdata_bolder_init( output_path.str(), &section);
-	} else if ( source == "APM2" ) {
-	    APM2_airdata_init( output_path.str() );
-	} else if ( source == "Aura3" ) {
-	    Aura3_airdata_init( output_path.str() );
-	} else if ( source == "fgfs" ) {
-	    fgfs_airdata_init( output_path.str() );
-	} else if ( source == "Goldy2" ) {
-	    goldy2_airdata_init( output_path.str() );
-	} else if ( source == "pika" ) {
-	    pika_airdata_init( output_path.str(), &section );
-	} else if ( source == "raven1" ) {
-	    raven1_airdata_init( output_path.str(), &section );
-	} else if ( source == "raven2" ) {
-	    raven2_airdata_init( output_path.str(), &section );
-	} else {
-	    printf("Unknown air data source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    sections = sensor_drivers_init( "/config/sensors/airdata_group", "airdata",
+				    drivers,
+				    sizeof(drivers) / sizeof(drivers[0]),
+				    false );
 }
 
 
@@ -214,7 +265,7 @@ static void update_pressure_helpers() {
     //
 
     if ( !alt_error_calibrated ) {
-	if ( filter_node.getString("navigation") == "valid" ) {
+	if ( filter_node.getBool("navigation_valid") ) {
 	    alt_error_calibrated = true;
 	    Ps_filt_err.init( filter_alt_m - Ps );
 	}
@@ -301,49 +352,21 @@ bool AirData_update() {
 
     bool fresh_data = false;
 
-    static int remote_link_count = 0;
     static int logging_count = 0;
 
     // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "airdata_bolder" ) {
-	    fresh_data = airdata_bolder_update();
-	} else if ( source == "APM2" ) {
-	    fresh_data = APM2_airdata_update();
-	} else if ( source == "Aura3" ) {
-	    fresh_data = Aura3_airdata_update();
-	} else if ( source == "fgfs" ) {
-	    fresh_data = fgfs_airdata_update();
-	} else if ( source == "Goldy2" ) {
-	    fresh_data = goldy2_airdata_update();
-	} else if ( source == "pika" ) {
-	    fresh_data = pika_airdata_update();
-	} else if ( source == "raven1" ) {
-	    fresh_data = raven1_airdata_update();
-	} else if ( source == "raven2" ) {
-	    fresh_data = raven2_airdata_update();
-	} else {
-	    printf("Unknown air data source = '%s' in config file\n",
-		   source.c_str());
-	}
+    for ( unsigned int k = 0; k < sections.size(); k++ ) {
+	int i = sections[k].index;
+	fresh_data = sections[k].driver->update( i );
 	if ( fresh_data ) {
 	    if (i == 0) {
 		// these are computed from the primary airdata sensor
 		update_pressure_helpers();
 	    }
 
-	    bool send_remote_link = false;
-	    if ( remote_link_count < 0 ) {
-		send_remote_link = true;
-		remote_link_count = remote_link_skip;
-	    }
+	    // the primary section goes out from the frame snapshot
+	    // (see comms/remote_link.hxx)
+	    bool send_remote_link = i > 0 && remote_link->is_open();
 	
 	    bool send_logging = false;
 	    if ( logging_count < 0 ) {
@@ -352,7 +375,7 @@ bool AirData_update() {
 	
 	    if ( send_remote_link || send_logging ) {
 		uint8_t buf[256];
-		if ( source != "raven1" and source != "raven2" ) {
+		if ( !(sections[k].driver->flags & SENSOR_RAVEN_PACKET) ) {
 		    int size = packer->pack_airdata( i, buf );
 		    if ( send_remote_link ) {
 			remote_link->send_message( buf, size );
@@ -382,7 +405,6 @@ bool AirData_update() {
     debug2b2.start();
 
     if ( fresh_data ) {
-        remote_link_count--;
         logging_count--;
     }
 
@@ -402,29 +424,9 @@ bool AirData_update() {
 
 void AirData_calibrate() {
     // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "airdata_bolder" ) {
-	    airdata_bolder_zero_airspeed();
-	} else if ( source == "APM2" ) {
-	    APM2_airdata_zero_airspeed();
-	} else if ( source == "Aura3" ) {
-	    Aura3_airdata_zero_airspeed();
-	} else if ( source == "fgfs" ) {
-	    // do nothing
-	} else if ( source == "Goldy2" ) {
-	    // do nothing
-	} else if ( source == "raven1" || source == "raven2" ) {
-	    // do nothing
-	} else {
-	    printf("Unknown air data source = '%s' in config file\n",
-		   source.c_str());
+    for ( unsigned int k = 0; k < sections.size(); k++ ) {
+	if ( sections[k].driver->calibrate != NULL ) {
+	    sections[k].driver->calibrate( sections[k].index );
 	}
     }
     // mark these as requiring calibrate so they will be reinited
@@ -435,32 +437,5 @@ void AirData_calibrate() {
 
 
 void AirData_close() {
-    // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    APM2_airdata_close();
-	} else if ( source == "Aura3" ) {
-	    Aura3_airdata_close();
-	} else if ( source == "fgfs" ) {
-	    // nop
-	} else if ( source == "Goldy2" ) {
-	    goldy2_airdata_close();
-	} else if ( source == "pika" ) {
-	    pika_airdata_close();
-	} else if ( source == "raven1" ) {
-	    raven1_airdata_close();
-	} else if ( source == "raven2" ) {
-	    raven2_airdata_close();
-	} else {
-	    printf("Unknown air data source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    sensor_drivers_close( sections );
 }
@@ -15,10 +15,8 @@
 #include <string.h>
 #include <sys/time.h>
 
-#include <sstream>
 #include <string>
 #include <vector>
-using std::ostringstream;
 using std::string;
 using std::vector;
 
@@ -39,6 +37,8 @@ using std::vector;
 #include "gps_gpsd.hxx"
 #include "gps_ublox6.hxx"
 #include "gps_ublox8.hxx"
+#include "replay.hxx"
+#include "sensor_driver.hxx"
 #include "ugfile.hxx"
 
 #include "gps_mgr.hxx"
@@ -50,59 +50,108 @@ using std::vector;
 static double gps_last_time = -31557600.0; // default to t minus one year old
 
 static pyPropertyNode gps_node;
-static vector<pyPropertyNode> sections;
+static vector<sensor_section> sections;
 
-static int remote_link_skip = 0;
 static int logging_skip = 0;
 
+
+//
+// Driver table
+//
+
+static void gps_replay_init( int i, string path, pyPropertyNode *config ) {
+    replay_gps_init( i, config );
+}
+static bool gps_replay_update( int i ) { return replay_gps_update( i ); }
+
+static void gps_APM2_init( int i, string path, pyPropertyNode *config ) {
+    APM2_gps_init( path, config );
+}
+static bool gps_APM2_update( int i ) { return APM2_gps_update(); }
+static void gps_APM2_close( int i ) { APM2_gps_close(); }
+
+static void gps_Aura3_init( int i, string path, pyPropertyNode *config ) {
+    Aura3_gps_init( path, config );
+}
+static bool gps_Aura3_update( int i ) { return Aura3_gps_update(); }
+static void gps_Aura3_close( int i ) { Aura3_gps_close(); }
+
+static void gps_fgfs_init( int i, string path, pyPropertyNode *config ) {
+    fgfs_gps_init( path, config );
+}
+static bool gps_fgfs_update( int i ) { return fgfs_gps_update(); }
+static void gps_fgfs_close( int i ) { fgfs_gps_close(); }
+
+static void gps_file_init( int i, string path, pyPropertyNode *config ) {
+    ugfile_gps_init( path, config );
+}
+static bool gps_file_update( int i ) { return ugfile_get_gps(); }
+static void gps_file_close( int i ) { ugfile_close(); }
+
+static void gps_goldy2_init( int i, string path, pyPropertyNode *config ) {
+    goldy2_gps_init( path );
+}
+static bool gps_goldy2_update( int i ) { return goldy2_gps_update(); }
+static void gps_goldy2_close( int i ) { goldy2_gps_close(); }
+
+static void gps_pika_init( int i, string path, pyPropertyNode *config ) {
+    pika_gps_init( path, config );
+}
+static bool gps_pika_update( int i ) { return pika_gps_update(); }
+static void gps_pika_close( int i ) { pika_gps_close(); }
+
+static void gps_gpsd_init( int i, string path, pyPropertyNode *config ) {
+    gpsd_init( path, config );
+}
+static bool gps_gpsd_update( int i ) { return gpsd_get_gps(); }
+
+static void ublox6_gps_init( int i, string path, pyPropertyNode *config ) {
+    gps_ublox6_init( path, config );
+}
+static bool ublox6_gps_update( int i ) { return gps_ublox6_update(); }
+static void ublox6_gps_close( int i ) { gps_ublox6_close(); }
+
+static void ublox8_gps_init( int i, string path, pyPropertyNode *config ) {
+    gps_ublox8_init( path, config );
+}
+static bool ublox8_gps_update( int i ) { return gps_ublox8_update(); }
+static void ublox8_gps_close( int i ) { gps_ublox8_close(); }
+
+static const sensor_driver drivers[] = {
+    { "replay", 0,
+      gps_replay_init, gps_replay_update, NULL, NULL },
+    { "APM2", 0,
+      gps_APM2_init, gps_APM2_update, gps_APM2_close, NULL },
+    { "Aura3", 0,
+      gps_Aura3_init, gps_Aura3_update, gps_Aura3_close, NULL },
+    { "fgfs", 0,
+      gps_fgfs_init, gps_fgfs_update, gps_fgfs_close, NULL },
+    { "file", 0,
+      gps_file_init, gps_file_update, gps_file_close, NULL },
+    { "Goldy2", 0,
+      gps_goldy2_init, gps_goldy2_update, gps_goldy2_close, NULL },
+    { "pika", 0,
+      gps_pika_init, gps_pika_update, gps_pika_close, NULL },
+    { "gpsd", 0,		// fixme: no close
+      gps_gpsd_init, gps_gpsd_update, NULL, NULL },
+    { "ublox6", 0,
+      ublox6_gps_init, ublox6_gps_update, ublox6_gps_close, NULL },
+    { "ublox8", 0,
+      ublox8_gps_init, ublox8_gps_update, ublox8_gps_close, NULL }
+};
+
+
 void GPS_init() {
     gps_node = pyGetNode("/sensors/gps", true);
     
-    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
     pyPropertyNode logging_node = pyGetNode("/config/logging", true);
-    remote_link_skip = remote_link_node.getDouble("gps_skip");
     logging_skip = logging_node.getDouble("gps_skip");
 
     // traverse configured modules
-    pyPropertyNode group_node = pyGetNode("/config/sensors/gps_group", true);
-    vector<string> children = group_node.getChildren();
-    printf("Found %d gps sections\n", (int)children.size());
-    for ( unsigned int i = 0; i < children.size(); i++ ) {
-	pyPropertyNode section_node = group_node.getChild(children[i].c_str());
-	sections.push_back(section_node);
-	string source = section_node.getString("source");
-	bool enabled = section_node.getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	ostringstream output_path;
-	output_path << "/sensors/gps" << '[' << i << ']';
-	printf("gps: %d = %s\n", i, source.c_str());
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    APM2_gps_init( output_path.str(), &section_node );
-	} else if ( source == "Aura3" ) {
-	    Aura3_gps_init( output_path.str(), &section_node );
-	} else if ( source == "fgfs" ) {
-	    fgfs_gps_init( output_path.str(), &section_node );
-	} else if ( source == "file" ) {
-	    ugfile_gps_init( output_path.str(), &section_node );
-	} else if ( source == "Goldy2" ) {
-	    goldy2_gps_init( output_path.str() );
-	} else if ( source == "pika" ) {
-	    pika_gps_init( output_path.str(), &section_node );
-	} else if ( source == "gpsd" ) {
-	    gpsd_init( output_path.str(), &section_node );
-	} else if ( source == "ublox6" ) {
-	    gps_ublox6_init( output_path.str(), &section_node );
-	} else if ( source == "ublox8" ) {
-	    gps_ublox8_init( output_path.str(), &section_node );
-	} else {
-	    printf("Unknown gps source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    sections = sensor_drivers_init( "/config/sensors/gps_group", "gps",
+				    drivers,
+				    sizeof(drivers) / sizeof(drivers[0]),
+				    false );
 }
 
 
@@ -137,50 +186,17 @@ bool GPS_update() {
     bool fresh_data = false;
     static int gps_state = 0;
 
-    static int remote_link_count = 0;
     static int logging_count = 0;
 
     // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
+    for ( unsigned int k = 0; k < sections.size(); k++ ) {
+	int i = sections[k].index;
+	fresh_data = sections[k].driver->update( i );
 
-	// printf("i = %d  name = %s source = %s\n",
-	//	   i, name.c_str(), source.c_str());
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    fresh_data = APM2_gps_update();
-	} else if ( source == "Aura3" ) {
-	    fresh_data = Aura3_gps_update();
-	} else if ( source == "fgfs" ) {
-	    fresh_data = fgfs_gps_update();
-	} else if ( source == "file" ) {
-	    fresh_data = ugfile_get_gps();
-	} else if ( source == "Goldy2" ) {
-	    fresh_data = goldy2_gps_update();
-	} else if ( source == "pika" ) {
-	    fresh_data = pika_gps_update();
-	} else if ( source == "gpsd" ) {
-	    fresh_data = gpsd_get_gps();
-	} else if ( source == "ublox6" ) {
-	    fresh_data = gps_ublox6_update();
-	} else if ( source == "ublox8" ) {
-	    fresh_data = gps_ublox8_update();
-	} else {
-	    printf("Unknown gps source = '%s' in config file\n",
-		   source.c_str());
-	}
-	
 	if ( fresh_data ) {
-	    bool send_remote_link = false;
-	    if ( remote_link_count < 0 ) {
-		send_remote_link = true;
-		remote_link_count = remote_link_skip;
-	    }
+	    // the primary section goes out from the frame snapshot
+	    // (see comms/remote_link.hxx)
+	    bool send_remote_link = i > 0 && remote_link->is_open();
 	
 	    bool send_logging = false;
 	    if ( logging_count < 0 ) {
@@ -207,7 +223,6 @@ bool GPS_update() {
 	// for computing gps data age
 	gps_last_time = gps_node.getDouble("timestamp");
 
-        remote_link_count--;
         logging_count--;
     }
     
@@ -278,41 +293,7 @@ bool GPS_update() {
 
 
 void GPS_close() {
-
-    // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	//printf("i = %d  name = %s source = %s\n",
-	//       i, name.c_str(), source.c_str());
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    APM2_gps_close();
-	} else if ( source == "Aura3" ) {
-	    Aura3_gps_close();
-	} else if ( source == "fgfs" ) {
-	    fgfs_gps_close();
-	} else if ( source == "file" ) {
-	    ugfile_close();
-	} else if ( source == "Goldy2" ) {
-	    goldy2_gps_close();
-	} else if ( source == "pika" ) {
-	    pika_gps_close();
-	} else if ( source == "gpsd" ) {
-	    // fixme
-	} else if ( source == "ublox6" ) {
-	    gps_ublox6_close();
-	} else if ( source == "ublox8" ) {
-	    gps_ublox8_close();
-	} else {
-	    printf("Unknown gps source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    sensor_drivers_close( sections );
 }
 
 
@@ -11,6 +11,7 @@
 
 #include <errno.h>		// errno
 #include <math.h>		// sin() cos()
+#include <sys/ioctl.h>		// ioctl()
 #include <sys/types.h>		// open()
 #include <sys/stat.h>		// open()
 #include <fcntl.h>		// open()
@@ -31,6 +32,7 @@ using std::string;
 #include "init/globals.hxx"
 #include "math/SGMath.hxx"
 #include "math/SGGeodesy.hxx"
+#include "util/reactor.hxx"
 #include "util/strutils.hxx"
 #include "util/timing.h"
 #include "gps_mgr.hxx"
@@ -45,6 +47,9 @@ static int fd = -1;
 static string device_name = "/dev/ttyS0";
 static int baud = 57600;
 static int gps_fix_value = 0;
+static bool gps_fresh = false;
+
+static bool gps_ublox6_read_available( void *arg );
 
 // initialize gpsd input property nodes
 static void bind_input( pyPropertyNode *config ) {
@@ -126,7 +131,9 @@ static bool gps_ublox6_open() {
 void gps_ublox6_init( string output_node, pyPropertyNode *config ) {
     bind_input( config );
     bind_output( output_node );
-    gps_ublox6_open();
+    if ( gps_ublox6_open() ) {
+	reactor.add( fd, gps_ublox6_read_available, NULL );
+    }
 }
 
 
@@ -519,12 +526,28 @@ static bool read_ublox6() {
 }
 
 
+// Reactor handler: run the scanner/parser over everything currently
+// buffered on the uart.
+static bool gps_ublox6_read_available( void *arg ) {
+    int bytes_available = 0;
+    do {
+	if ( read_ublox6() ) {
+	    gps_fresh = true;
+	}
+	ioctl(fd, FIONREAD, &bytes_available);
+    } while ( bytes_available > 0 );
+
+    return false;		// never a main loop sync source
+}
+
+
 bool gps_ublox6_update() {
-    // run an iteration of the ublox scanner/parser
-    bool gps_data_valid = read_ublox6();
+    // report any new position parsed since the last call
+    bool gps_data_valid = gps_fresh;
+    gps_fresh = false;
 
     return gps_data_valid;
- }
+}
 
 
 void gps_ublox6_close() {
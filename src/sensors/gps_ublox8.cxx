@@ -11,6 +11,7 @@
 
 #include <errno.h>		// errno
 #include <math.h>		// sin() cos()
+#include <sys/ioctl.h>		// ioctl()
 #include <sys/types.h>		// open()
 #include <sys/stat.h>		// open()
 #include <fcntl.h>		// open()
@@ -29,6 +30,7 @@ using std::string;
 #include "comms/display.hxx"
 #include "comms/logging.hxx"
 #include "init/globals.hxx"
+#include "util/reactor.hxx"
 #include "util/strutils.hxx"
 #include "util/timing.h"
 #include "gps_mgr.hxx"
@@ -43,6 +45,9 @@ static int fd = -1;
 static string device_name = "/dev/ttyS0";
 static int baud = 115200;
 static int gps_fix_value = 0;
+static bool gps_fresh = false;
+
+static bool gps_ublox8_read_available( void *arg );
 
 // initialize gpsd input property nodes
 static void bind_input( pyPropertyNode *config ) {
@@ -124,7 +129,9 @@ static bool gps_ublox8_open() {
 void gps_ublox8_init( string output_node, pyPropertyNode *config ) {
     bind_input( config );
     bind_output( output_node );
-    gps_ublox8_open();
+    if ( gps_ublox8_open() ) {
+	reactor.add( fd, gps_ublox8_read_available, NULL );
+    }
 }
 
 
@@ -427,9 +434,25 @@ static bool read_ublox8() {
 }
 
 
+// Reactor handler: run the scanner/parser over everything currently
+// buffered on the uart.
+static bool gps_ublox8_read_available( void *arg ) {
+    int bytes_available = 0;
+    do {
+	if ( read_ublox8() ) {
+	    gps_fresh = true;
+	}
+	ioctl(fd, FIONREAD, &bytes_available);
+    } while ( bytes_available > 0 );
+
+    return false;		// never a main loop sync source
+}
+
+
 bool gps_ublox8_update() {
-    // run an iteration of the ublox scanner/parser
-    bool gps_data_valid = read_ublox8();
+    // report any new position parsed since the last call
+    bool gps_data_valid = gps_fresh;
+    gps_fresh = false;
 
     return gps_data_valid;
 }
@@ -11,10 +11,8 @@
 #include <stdio.h>
 #include <string.h>
 
-#include <sstream>
 #include <string>
 #include <vector>
-using std::ostringstream;
 using std::string;
 using std::vector;
 
@@ -32,6 +30,8 @@ using std::vector;
 #include "sensors/imu_vn100_spi.hxx"
 #include "sensors/imu_vn100_uart.hxx"
 #include "sensors/pika.hxx"
+#include "sensors/replay.hxx"
+#include "sensors/sensor_driver.hxx"
 #include "sensors/ugfile.hxx"
 
 #include "imu_mgr.hxx"
@@ -44,64 +44,113 @@ using std::vector;
 static double imu_last_time = -31557600.0; // default to t minus one year old
 
 static pyPropertyNode imu_node;
-static vector<pyPropertyNode> sections;
+static PropertyHandle<double> imu_timestamp;
+static vector<sensor_section> sections;
 
-static int remote_link_skip = 0;
 static int logging_skip = 0;
 
 static myprofile debug2a1;
 static myprofile debug2a2;
 	
 
+//
+// Driver table
+//
+
+static void imu_replay_init( int i, string path, pyPropertyNode *config ) {
+    replay_imu_init( i, config );
+}
+static bool imu_replay_update( int i ) { return replay_imu_update( i ); }
+
+static void imu_APM2_init( int i, string path, pyPropertyNode *config ) {
+    APM2_imu_init( path, config );
+}
+static bool imu_APM2_update( int i ) { return APM2_imu_update(); }
+static void imu_APM2_close( int i ) { APM2_imu_close(); }
+
+static void imu_Aura3_init( int i, string path, pyPropertyNode *config ) {
+    Aura3_imu_init( path, config );
+}
+static bool imu_Aura3_update( int i ) { return Aura3_imu_update(); }
+static void imu_Aura3_close( int i ) { Aura3_imu_close(); }
+
+static void imu_fgfs_init( int i, string path, pyPropertyNode *config ) {
+    fgfs_imu_init( path, config );
+}
+static bool imu_fgfs_update( int i ) { return fgfs_imu_update(); }
+static void imu_fgfs_close( int i ) { fgfs_imu_close(); }
+
+static void imu_file_init( int i, string path, pyPropertyNode *config ) {
+    ugfile_imu_init( path, config );
+}
+static bool imu_file_update( int i ) {
+    ugfile_read();
+    return ugfile_get_imu();
+}
+static void imu_file_close( int i ) { ugfile_close(); }
+
+static void imu_goldy2_init( int i, string path, pyPropertyNode *config ) {
+    goldy2_imu_init( path, config );
+}
+static bool imu_goldy2_update( int i ) { return goldy2_imu_update(); }
+static void imu_goldy2_close( int i ) { goldy2_imu_close(); }
+
+static void imu_pika_init( int i, string path, pyPropertyNode *config ) {
+    pika_imu_init( path, config );
+}
+static bool imu_pika_update( int i ) { return pika_imu_update(); }
+static void imu_pika_close( int i ) { pika_imu_close(); }
+
+static void imu_vn100_init( int i, string path, pyPropertyNode *config ) {
+    imu_vn100_uart_init( path, config );
+}
+static bool imu_vn100_update( int i ) { return imu_vn100_uart_get(); }
+static void imu_vn100_close( int i ) { imu_vn100_uart_close(); }
+
+static void imu_vn100spi_init( int i, string path, pyPropertyNode *config ) {
+    imu_vn100_spi_init( path, config );
+}
+static bool imu_vn100spi_update( int i ) { return imu_vn100_spi_get(); }
+static void imu_vn100spi_close( int i ) { imu_vn100_spi_close(); }
+
+static const sensor_driver drivers[] = {
+    { "replay", 0,
+      imu_replay_init, imu_replay_update, NULL, NULL },
+    { "APM2", SENSOR_SYNC,
+      imu_APM2_init, imu_APM2_update, imu_APM2_close, NULL },
+    { "Aura3", SENSOR_SYNC,
+      imu_Aura3_init, imu_Aura3_update, imu_Aura3_close, NULL },
+    { "fgfs", SENSOR_SYNC,
+      imu_fgfs_init, imu_fgfs_update, imu_fgfs_close, NULL },
+    { "file", 0,
+      imu_file_init, imu_file_update, imu_file_close, NULL },
+    { "Goldy2", SENSOR_SYNC,
+      imu_goldy2_init, imu_goldy2_update, imu_goldy2_close, NULL },
+    { "pika", SENSOR_SYNC,
+      imu_pika_init, imu_pika_update, imu_pika_close, NULL },
+    { "vn100", SENSOR_SYNC,
+      imu_vn100_init, imu_vn100_update, imu_vn100_close, NULL },
+    { "vn100-spi", 0,
+      imu_vn100spi_init, imu_vn100spi_update, imu_vn100spi_close, NULL }
+};
+
+
 void IMU_init() {
     debug2a1.set_name("debug2a1 IMU read");
     debug2a2.set_name("debug2a2 IMU console link");
 
     imu_node = pyGetNode("/sensors/imu", true);
+    imu_timestamp = imu_node.getHandle<double>("timestamp");
 
-    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
     pyPropertyNode logging_node = pyGetNode("/config/logging", true);
-    remote_link_skip = remote_link_node.getDouble("imu_skip");
     logging_skip = logging_node.getDouble("imu_skip");
 
-    // traverse configured modules
-    pyPropertyNode group_node = pyGetNode("/config/sensors/imu_group", true);
-    vector<string>children = group_node.getChildren();
-    printf("Found %d imu sections\n", (int)children.size());
-    for ( unsigned int i = 0; i < children.size(); i++ ) {
-	pyPropertyNode section = group_node.getChild(children[i].c_str());
-	sections.push_back(section);
-	string source = section.getString("source");
-	bool enabled = section.getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	ostringstream output_path;
-	output_path << "/sensors/imu" << '[' << i << ']';
-	printf("imu: %d = %s\n", i, source.c_str());
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    APM2_imu_init( output_path.str(), &section );
-	} else if ( source == "Aura3" ) {
-	    Aura3_imu_init( output_path.str(), &section );
-	} else if ( source == "fgfs" ) {
-	    fgfs_imu_init( output_path.str(), &section );
-	} else if ( source == "file" ) {
-	    ugfile_imu_init( output_path.str(), &section );
-	} else if ( source == "Goldy2" ) {
-	    goldy2_imu_init( output_path.str(), &section );
-	} else if ( source == "pika" ) {
-	    pika_imu_init( output_path.str(), &section );
-	} else if ( source == "vn100" ) {
-	    imu_vn100_uart_init( output_path.str(), &section );
-	} else if ( source == "vn100-spi" ) {
-	    imu_vn100_spi_init( output_path.str(), &section );
-	} else {
-	    printf("Unknown imu source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    // traverse configured modules.  The first imu that is able to
+    // becomes the main loop sync source.
+    sections = sensor_drivers_init( "/config/sensors/imu_group", "imu",
+				    drivers,
+				    sizeof(drivers) / sizeof(drivers[0]),
+				    true );
 }
 
 
@@ -112,45 +161,16 @@ bool IMU_update() {
 
     bool fresh_data = false;
 
-    static int remote_link_count = 0;
     static int logging_count = 0;
 
     // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    fresh_data = APM2_imu_update();
-	} else if ( source == "Aura3" ) {
-	    fresh_data = Aura3_imu_update();
-	} else if ( source == "fgfs" ) {
-	    fresh_data = fgfs_imu_update();
-	} else if ( source == "file" ) {
-	    ugfile_read();
-	    fresh_data = ugfile_get_imu();
-	} else if ( source == "Goldy2" ) {
-	    fresh_data = goldy2_imu_update();
-	} else if ( source == "pika" ) {
-	    fresh_data = pika_imu_update();
-	} else if ( source == "vn100" ) {
-	    fresh_data = imu_vn100_uart_get();
-	} else if ( source == "vn100-spi" ) {
-	    fresh_data = imu_vn100_spi_get();
-	} else {
-	    printf("Unknown imu source = '%s' in config file\n",
-		   source.c_str());
-	}
+    for ( unsigned int k = 0; k < sections.size(); k++ ) {
+	int i = sections[k].index;
+	fresh_data = sections[k].driver->update( i );
 	if ( fresh_data ) {
-	    bool send_remote_link = false;
-	    if ( remote_link_count < 0 ) {
-		send_remote_link = true;
-		remote_link_count = remote_link_skip;
-	    }
+	    // the primary section goes out from the frame snapshot
+	    // (see comms/remote_link.hxx)
+	    bool send_remote_link = i > 0 && remote_link->is_open();
 	
 	    bool send_logging = false;
 	    if ( logging_count < 0 ) {
@@ -178,9 +198,8 @@ bool IMU_update() {
 
     if ( fresh_data ) {
 	// for computing imu data age
-	imu_last_time = imu_node.getDouble("timestamp");
+	imu_last_time = imu_timestamp.get();
 
-        remote_link_count--;
         logging_count--;
     }
     
@@ -191,38 +210,7 @@ bool IMU_update() {
 
 
 void IMU_close() {
-    // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	//printf("i = %d  name = %s source = %s\n",
-	//       i, name.c_str(), source.c_str());
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    APM2_imu_close();
-	} else if ( source == "Aura3" ) {
-	    Aura3_imu_close();
-	} else if ( source == "fgfs" ) {
-	    fgfs_imu_close();
-	} else if ( source == "file" ) {
-	    ugfile_close();
-	} else if ( source == "Goldy2" ) {
-	    goldy2_imu_close();
-	} else if ( source == "pika" ) {
-	    pika_imu_close();
-	} else if ( source == "vn100" ) {
-	    imu_vn100_uart_close();
-	} else if ( source == "vn100-spi" ) {
-	    imu_vn100_spi_close();
-	} else {
-	    printf("Unknown imu source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    sensor_drivers_close( sections );
 }
 
 
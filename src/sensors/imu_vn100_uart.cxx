@@ -16,10 +16,12 @@
 #include <termios.h>		// tcgetattr() et. al.
 #include <unistd.h>		// tcgetattr() et. al.
 #include <string.h>		// memset(), strerror()
+#include <sys/ioctl.h>		// ioctl()
 
 #include "include/globaldefs.h"
 
 #include "comms/display.hxx"
+#include "util/reactor.hxx"
 #include "util/strutils.hxx"
 #include "util/timing.h"
 
@@ -31,6 +33,9 @@ static pyPropertyNode imu_node;
 
 static int fd = -1;
 static string device_name = "/dev/ttyS0";
+static bool imu_fresh = false;
+
+static bool imu_vn100_uart_read_available( void *arg );
 
 
 // initialize gpsd input property nodes
@@ -197,6 +202,9 @@ void imu_vn100_uart_init( string output_path, pyPropertyNode *config ) {
     sleep(1);
     imu_vn100_uart_send_cmd( "VNWRG,06,253" ); // switch to CMV (raw sensor) output which wasn't documented
     imu_vn100_uart_send_cmd( "VNWRG,07,50" ); // switch to 50hz output
+
+    // imu messages drive the main loop
+    reactor.add( fd, imu_vn100_uart_read_available, NULL, true );
 }
 
 
@@ -383,18 +391,36 @@ static bool imu_vn100_uart_read() {
 }
 
 
-bool imu_vn100_uart_get() {
-    // scan for new messages
-    bool imu_data_valid = false;
+// Reactor handler: scan everything currently buffered on the uart.
+// Returns true if a fresh imu message was parsed.
+static bool imu_vn100_uart_read_available( void *arg ) {
+    bool fresh_data = false;
+    int bytes_available = 0;
+    do {
+	if ( imu_vn100_uart_read() ) {
+	    fresh_data = true;
+	}
+	ioctl(fd, FIONREAD, &bytes_available);
+    } while ( bytes_available > 0 );
 
-    while ( imu_vn100_uart_read() ) {
-	imu_data_valid = true;
+    if ( fresh_data ) {
+	imu_fresh = true;
     }
 
+    return fresh_data;
+}
+
+
+bool imu_vn100_uart_get() {
+    // report any new message parsed since the last call
+    bool imu_data_valid = imu_fresh;
+    imu_fresh = false;
+
     return imu_data_valid;
- }
+}
 
 
 void imu_vn100_uart_close() {
+    reactor.remove(fd);
     close(fd);
 }
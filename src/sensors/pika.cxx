@@ -27,6 +27,8 @@ using namespace Eigen;
 #include "comms/display.hxx"
 #include "comms/logging.hxx"
 #include "sensors/cal_temp.hxx"
+#include "util/reactor.hxx"
+#include "util/serial_framer.hxx"
 #include "util/strutils.hxx"
 #include "util/timing.h"
 
@@ -44,7 +46,13 @@ static pyPropertyNode imu_node;
 static pyPropertyNode gps_node;
 static pyPropertyNode pilot_node;
 
+// uart framing statistics
+static PropertyHandle<double> bytes_per_read_h;
+static PropertyHandle<long> resyncs_h;
+static PropertyHandle<long> cksum_errors_h;
+
 static int fd = -1;
+static SerialFramer framer;
 static string device_name = "/dev/ttyO4";
 
 static bool master_opened = false;
@@ -97,6 +105,9 @@ static void bind_act_nodes() {
 }
 
 
+static bool pika_read_available( void *arg );
+
+
 // open the uart
 static bool pika_open() {
     if ( master_opened ) {
@@ -147,6 +158,16 @@ static bool pika_open() {
     // Enable non-blocking IO (one more time for good measure)
     fcntl(fd, F_SETFL, O_NONBLOCK);
 
+    framer.init( fd, START_OF_MSG0, START_OF_MSG1, payloadSize );
+
+    pyPropertyNode pika_node = pyGetNode("/sensors/pika", true);
+    bytes_per_read_h = pika_node.getHandle<double>("serial_bytes_per_read");
+    resyncs_h = pika_node.getHandle<long>("serial_resyncs");
+    cksum_errors_h = pika_node.getHandle<long>("serial_cksum_errors");
+
+    // parse input as it arrives
+    reactor.add( fd, pika_read_available, NULL );
+
     master_opened = true;
 
     return true;
@@ -194,6 +215,9 @@ bool pika_imu_init( string output_path, pyPropertyNode *config ) {
 	return false;
     }
 
+    // sensor packets drive the main loop
+    reactor.add( fd, pika_read_available, NULL, true );
+
     bind_imu_output( output_path );
 
     if ( config->hasChild("reverse_imu_mount") ) {
@@ -318,117 +342,36 @@ void pika_airdata_init( string output_path, pyPropertyNode *config ) {
 }
 
 
+// Pull in everything waiting on the uart.  Each complete packet
+// overwrites the payload struct (the newest one wins.)  Returns true
+// if at least one new packet arrived.
 static bool pika_read() {
-    static int state = 0;
-    static int counter = 0;
-    static uint8_t cksum_A = 0, cksum_B = 0, cksum_lo = 0, cksum_hi = 0;
-    int len;
-    uint8_t input[512];
-    static uint8_t *payload_ptr;
-
-    //if ( display_on ) {
-    //    printf("read pika, entry state = %d\n", state);
-    //}
-
     bool new_data = false;
-
-    if ( state == 0 ) {
-	counter = 0;
-	payload_ptr = (uint8_t *)(&payload);
-	cksum_A = cksum_B = 0;
-	len = read( fd, input, 1 );
-	//printf( "state0: len = %d val = %2X (%c)\n", len, input[0] , input[0]);
-	
-	while ( len > 0 && input[0] != START_OF_MSG0 ) {
-	    //printf( "state0: len = %d val = %2X (%c)\n", len, input[0] , input[0]);
-	    len = read( fd, input, 1 );
-	}
-	if ( len > 0 && input[0] == START_OF_MSG0 ) {
-	    //printf( "read START_OF_MSG0\n");
-	    state++;
-	}
-    }
-    if ( state == 1 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    if ( input[0] == START_OF_MSG1 ) {
-		//printf( "read START_OF_MSG1\n");
-		state++;
-	    } else if ( input[0] == START_OF_MSG0 ) {
-		//fprintf( stderr, "read START_OF_MSG0\n");
-	    } else {
-		state = 0;
-	    }
-	}
-    }
-    if ( state == 2 ) {
-	len = read( fd, input, 1 );
-	while ( len > 0 ) {
-	    payload_ptr[counter++] = input[0];
-	    //printf( "%02X ", input[0] );
-	    cksum_A += input[0];
-	    cksum_B += cksum_A;
-	    if ( counter >= payloadSize ) {
-		break;
-	    }
-	    len = read( fd, input, 1 );
+    uint8_t pkt_id;
+    int pkt_len;
+    uint8_t *frame;
+
+    do {
+	framer.fill();
+	while ( framer.next( &pkt_id, &pkt_len, &frame ) ) {
+	    memcpy( &payload, frame, payloadSize );
+	    new_data = true;
 	}
+    } while ( framer.more() );
 
-	if ( counter >= payloadSize ) {
-	    state++;
-	    //printf( "\n" );
-	}
-    }
-    if ( state == 3 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    cksum_lo = input[0];
-	    state++;
-	}
-    }
-    if ( state == 4 ) {
-	len = read( fd, input, 1 );
-	if ( len > 0 ) {
-	    cksum_hi = input[0];
-	    if ( cksum_A == cksum_lo && cksum_B == cksum_hi ) {
-		//printf( "checksum passes\n" );
-		new_data = true;
-	    } else {
-		printf("checksum failed %d %d (computed) != %d %d (message)\n",
-		       cksum_A, cksum_B, cksum_lo, cksum_hi );
-	    }
-	    // this is the end of a record, reset state to 0 to start
-	    // looking for next record
-	    state = 0;
-	}
-    }
+    bytes_per_read_h.set( framer.get_bytes_per_read() );
+    resyncs_h.set( framer.get_resyncs() );
+    cksum_errors_h.set( framer.get_cksum_errors() );
 
-    if ( new_data ) {
-	return true;
-    } else {
-	return false;
-    }
+    return new_data;
 }
 
 
-// Read pika packets.
-// Returns the dt from the IMU perspective, not the localhost
-// perspective.  This should generally be far more accurate and
-// consistent.
-double pika_update() {
-    // read packets until the uart buffer is mostly empty. 
-    double last_time = imu_node.getDouble( "timestamp" );
-    int bytes_available = 0;
-    while ( true ) {
-        bool result = pika_read();
-        ioctl(fd, FIONREAD, &bytes_available);
-	if ( bytes_available < 64 ) {
-	    break;
-        }
-    }
-    double cur_time = imu_node.getDouble( "timestamp" );
-
-    return cur_time - last_time;
+// Reactor handler: parse everything currently buffered on the uart.
+// Every pika packet carries a full sensor sample, so any complete
+// packet counts as a new frame.
+static bool pika_read_available( void *arg ) {
+    return pika_read();
 }
 
 
@@ -18,8 +18,6 @@ using std::string;
 
 #include "include/globaldefs.h"
 
-double pika_update();
-
 bool pika_imu_init( string output_path, pyPropertyNode *config );
 bool pika_imu_update();
 void pika_imu_close();
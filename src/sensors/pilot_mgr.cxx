@@ -14,10 +14,8 @@
 #include <stdio.h>
 #include <string.h>
 
-#include <sstream>
 #include <string>
 #include <vector>
-using std::ostringstream;
 using std::string;
 using std::vector;
 
@@ -32,6 +30,8 @@ using std::vector;
 #include "FGFS.hxx"
 #include "Goldy2.hxx"
 #include "pika.hxx"
+#include "replay.hxx"
+#include "sensor_driver.hxx"
 
 #include "pilot_mgr.hxx"
 
@@ -44,54 +44,80 @@ static pyPropertyNode pilot_node;
 static pyPropertyNode flight_node;
 static pyPropertyNode engine_node;
 static pyPropertyNode ap_node;
-static vector<pyPropertyNode> sections;
+static vector<sensor_section> sections;
 
-static int remote_link_skip = 0;
 static int logging_skip = 0;
 
+
+//
+// Driver table
+//
+
+static void pilot_replay_init( int i, string path, pyPropertyNode *config ) {
+    replay_pilot_init( i, config );
+}
+static bool pilot_replay_update( int i ) { return replay_pilot_update( i ); }
+
+static void pilot_APM2_init( int i, string path, pyPropertyNode *config ) {
+    APM2_pilot_init( path, config );
+}
+static bool pilot_APM2_update( int i ) { return APM2_pilot_update(); }
+static void pilot_APM2_close( int i ) { APM2_pilot_close(); }
+
+static void pilot_Aura3_init( int i, string path, pyPropertyNode *config ) {
+    Aura3_pilot_init( path, config );
+}
+static bool pilot_Aura3_update( int i ) { return Aura3_pilot_update(); }
+static void pilot_Aura3_close( int i ) { Aura3_pilot_close(); }
+
+static void pilot_fgfs_init( int i, string path, pyPropertyNode *config ) {
+    fgfs_pilot_init( path, config );
+}
+static bool pilot_fgfs_update( int i ) { return fgfs_pilot_update(); }
+static void pilot_fgfs_close( int i ) { fgfs_pilot_close(); }
+
+static void pilot_goldy2_init( int i, string path, pyPropertyNode *config ) {
+    goldy2_pilot_init( path, config );
+}
+static bool pilot_goldy2_update( int i ) { return goldy2_pilot_update(); }
+static void pilot_goldy2_close( int i ) { goldy2_pilot_close(); }
+
+static void pilot_pika_init( int i, string path, pyPropertyNode *config ) {
+    pika_pilot_init( path, config );
+}
+static bool pilot_pika_update( int i ) { return pika_pilot_update(); }
+static void pilot_pika_close( int i ) { pika_pilot_close(); }
+
+static const sensor_driver drivers[] = {
+    { "replay", 0,
+      pilot_replay_init, pilot_replay_update, NULL, NULL },
+    { "APM2", 0,
+      pilot_APM2_init, pilot_APM2_update, pilot_APM2_close, NULL },
+    { "Aura3", 0,
+      pilot_Aura3_init, pilot_Aura3_update, pilot_Aura3_close, NULL },
+    { "fgfs", 0,
+      pilot_fgfs_init, pilot_fgfs_update, pilot_fgfs_close, NULL },
+    { "Goldy2", 0,
+      pilot_goldy2_init, pilot_goldy2_update, pilot_goldy2_close, NULL },
+    { "pika", 0,
+      pilot_pika_init, pilot_pika_update, pilot_pika_close, NULL }
+};
+
+
 void PilotInput_init() {
     pilot_node = pyGetNode("/sensors/pilot_input", true);
     flight_node = pyGetNode("/controls/flight", true);
     engine_node = pyGetNode("/controls/engine", true);
     ap_node = pyGetNode("/autopilot", true);
     
-    pyPropertyNode remote_link_node = pyGetNode("/config/remote_link", true);
     pyPropertyNode logging_node = pyGetNode("/config/logging", true);
-    remote_link_skip = remote_link_node.getDouble("pilot_skip");
     logging_skip = logging_node.getDouble("pilot_skip");
 
     // traverse configured modules
-    pyPropertyNode group_node = pyGetNode("/config/sensors/pilot_inputs", true);
-    vector<string> children = group_node.getChildren();
-    printf("Found %d pilot sections\n", (int)children.size());
-    for ( unsigned int i = 0; i < children.size(); i++ ) {
-	pyPropertyNode section = group_node.getChild(children[i].c_str());
-	sections.push_back(section);
-	string source = section.getString("source");
-	bool enabled = section.getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	ostringstream output_path;
-	output_path << "/sensors/pilot_input" << '[' << i << ']';
-	printf("pilot: %d = %s\n", i, source.c_str());
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    APM2_pilot_init( output_path.str(), &section );
-	} else if ( source == "Aura3" ) {
-	    Aura3_pilot_init( output_path.str(), &section );
-	} else if ( source == "fgfs" ) {
-	    fgfs_pilot_init( output_path.str(), &section );
-	} else if ( source == "Goldy2" ) {
-	    goldy2_pilot_init( output_path.str(), &section );
-	} else if ( source == "pika" ) {
-	    pika_pilot_init( output_path.str(), &section );
-	} else {
-	    printf("Unknown pilot input source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    sections = sensor_drivers_init( "/config/sensors/pilot_inputs",
+				    "pilot_input", drivers,
+				    sizeof(drivers) / sizeof(drivers[0]),
+				    false );
 }
 
 
@@ -100,38 +126,14 @@ bool PilotInput_update() {
 
     bool fresh_data = false;
 
-    static int remote_link_count = 0;
     static int logging_count = 0;
 
     // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    fresh_data = APM2_pilot_update();
-	} else if ( source == "Aura3" ) {
-	    fresh_data = Aura3_pilot_update();
-	} else if ( source == "fgfs" ) {
-	    fresh_data = fgfs_pilot_update();
-	} else if ( source == "Goldy2" ) {
-	    fresh_data = goldy2_pilot_update();
-	} else if ( source == "pika" ) {
-	    fresh_data = pika_pilot_update();
-	} else {
-	    printf("Unknown pilot input source = '%s' in config file\n",
-		   source.c_str());
-	}
+    for ( unsigned int k = 0; k < sections.size(); k++ ) {
+	int i = sections[k].index;
+	fresh_data = sections[k].driver->update( i );
 	if ( fresh_data ) {
-	    bool send_remote_link = false;
-	    if ( remote_link_count < 0 ) {
-		send_remote_link = true;
-		remote_link_count = remote_link_skip;
-	    }
+	    bool send_remote_link = remote_link->is_open();
 	
 	    bool send_logging = false;
 	    if ( logging_count < 0 ) {
@@ -176,7 +178,6 @@ bool PilotInput_update() {
 	    flight_node.setDouble( "flaps", pilot_node.getDouble("flaps") );
 	}
 
-        remote_link_count--;
         logging_count--;
     }
 
@@ -187,28 +188,5 @@ bool PilotInput_update() {
 
 
 void PilotInput_close() {
-    // traverse configured modules
-    for ( unsigned int i = 0; i < sections.size(); i++ ) {
-	string source = sections[i].getString("source");
-	bool enabled = sections[i].getBool("enable");
-	if ( !enabled ) {
-	    continue;
-	}
-	if ( source == "null" ) {
-	    // do nothing
-	} else if ( source == "APM2" ) {
-	    APM2_pilot_close();
-	} else if ( source == "Aura3" ) {
-	    Aura3_pilot_close();
-	} else if ( source == "fgfs" ) {
-	    fgfs_pilot_close();
-	} else if ( source == "Goldy2" ) {
-	    goldy2_pilot_close();
-	} else if ( source == "pika" ) {
-	    pika_pilot_close();
-	} else {
-	    printf("Unknown pilot input source = '%s' in config file\n",
-		   source.c_str());
-	}
-    }
+    sensor_drivers_close( sections );
 }
@@ -0,0 +1,299 @@
+//
+// FILE: replay.cxx
+// DESCRIPTION: feed the sensor packets of a recorded flight.dat.gz
+// back through the sensor managers (see main/replay.cxx.)
+//
+
+#include "python/pyprops.hxx"
+
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+#include "comms/packer.hxx"
+#include "comms/packet_id.hxx"
+#include "init/globals.hxx"
+#include "util/serial_framer.hxx"
+
+#include "replay.hxx"
+
+
+static const int NUM_PILOT_INPUTS = 8;
+
+static gzFile flog = NULL;
+static SerialFramer framer;
+static bool log_eof = true;
+
+// first packet of the next frame (already read from the log)
+static bool have_next = false;
+static uint8_t next_payload[256];
+static int next_len = 0;
+
+static double frame_time = 0.0;
+static PropertyHandle<double> imu0_timestamp;
+
+static unsigned long packets = 0;
+static unsigned long skipped = 0;
+static unsigned long errors = 0;
+
+// per section fresh data flags
+static vector<bool> imu_fresh;
+static vector<bool> gps_fresh;
+static vector<bool> airdata_fresh;
+static vector<bool> pilot_fresh;
+
+struct pilot_section {
+    pyPropertyNode node;
+    string mapping[NUM_PILOT_INPUTS];
+};
+static vector<pilot_section> pilot_sections;
+
+static pyPropertyNode vel_node;
+static vector<pyPropertyNode> gps_nodes;
+static vector<pyPropertyNode> airdata_nodes;
+
+
+static void mark( vector<bool> &fresh, int index ) {
+    if ( index < 0 ) {
+	errors++;
+	return;
+    }
+    if ( (int)fresh.size() <= index ) {
+	fresh.resize( index + 1, false );
+    }
+    fresh[index] = true;
+}
+
+static bool take( vector<bool> &fresh, int index ) {
+    if ( index < (int)fresh.size() && fresh[index] ) {
+	fresh[index] = false;
+	return true;
+    }
+    return false;
+}
+
+
+bool replay_open( const char *file ) {
+    flog = gzopen( file, "rb" );
+    if ( flog == NULL ) {
+	printf("replay: cannot open %s\n", file);
+	return false;
+    }
+    framer.init( -1, START_OF_MSG0, START_OF_MSG1 );
+    log_eof = false;
+    have_next = false;
+    vel_node = pyGetNode("/velocity", true);
+    imu0_timestamp
+	= pyGetNode("/sensors/imu[0]", true).getHandle<double>("timestamp");
+    return true;
+}
+
+
+void replay_close() {
+    if ( flog != NULL ) {
+	gzclose( flog );
+	flog = NULL;
+    }
+    log_eof = true;
+}
+
+
+// next valid packet from the log
+static bool next_packet( uint8_t *id, int *len, uint8_t **payload ) {
+    while ( true ) {
+	if ( framer.next( id, len, payload ) ) {
+	    packets++;
+	    return true;
+	}
+	if ( log_eof ) {
+	    return false;
+	}
+	uint8_t buf[1024];
+	int n = gzread( flog, buf, sizeof(buf) );
+	if ( n <= 0 ) {
+	    log_eof = true;
+	} else {
+	    framer.append( buf, n );
+	}
+    }
+}
+
+
+// unpack a sensor packet into the property tree.  Everything the
+// flight code computes (filter, actuators, ap status, ...) is skipped
+// since the replay regenerates it.
+static void apply_packet( uint8_t id, const uint8_t *payload, int len ) {
+    if ( id == IMU_PACKET_V3 ) {
+	mark( imu_fresh, packer->unpack_imu( payload, len ) );
+    } else if ( id == GPS_PACKET_V3 ) {
+	mark( gps_fresh, packer->unpack_gps( payload, len ) );
+    } else if ( id == AIRDATA_PACKET_V5 ) {
+	mark( airdata_fresh, packer->unpack_airdata( payload, len ) );
+    } else if ( id == PILOT_INPUT_PACKET_V2 ) {
+	mark( pilot_fresh, packer->unpack_pilot( payload, len ) );
+    } else {
+	skipped++;
+    }
+}
+
+
+bool replay_read_frame() {
+    bool have_imu = false;
+    if ( have_next ) {
+	apply_packet( IMU_PACKET_V3, next_payload, next_len );
+	frame_time = imu0_timestamp.get();
+	have_next = false;
+	have_imu = true;
+    }
+
+    uint8_t id;
+    int len;
+    uint8_t *payload;
+    while ( next_packet( &id, &len, &payload ) ) {
+	if ( id == IMU_PACKET_V3 && len > 0 && payload[0] == 0 ) {
+	    if ( have_imu ) {
+		// start of the following frame
+		memcpy( next_payload, payload, len );
+		next_len = len;
+		have_next = true;
+		return true;
+	    }
+	    apply_packet( id, payload, len );
+	    frame_time = imu0_timestamp.get();
+	    have_imu = true;
+	} else {
+	    apply_packet( id, payload, len );
+	}
+    }
+
+    return have_imu;
+}
+
+
+double replay_frame_time() {
+    return frame_time;
+}
+
+
+unsigned long replay_get_packets() {
+    return packets;
+}
+
+unsigned long replay_get_skipped() {
+    return skipped;
+}
+
+unsigned long replay_get_errors() {
+    return errors + framer.get_cksum_errors();
+}
+
+
+bool replay_imu_init( int index, pyPropertyNode *config ) {
+    mark( imu_fresh, index );
+    imu_fresh[index] = false;
+    return true;
+}
+
+bool replay_imu_update( int index ) {
+    return take( imu_fresh, index );
+}
+
+
+bool replay_gps_init( int index, pyPropertyNode *config ) {
+    mark( gps_fresh, index );
+    gps_fresh[index] = false;
+    while ( (int)gps_nodes.size() <= index ) {
+	ostringstream path;
+	path << "/sensors/gps" << '[' << gps_nodes.size() << ']';
+	gps_nodes.push_back( pyGetNode(path.str(), true) );
+    }
+    return true;
+}
+
+bool replay_gps_update( int index ) {
+    if ( ! take( gps_fresh, index ) ) {
+	return false;
+    }
+    // status isn't logged, derive it from the fix type like the ublox
+    // drivers do
+    if ( index < (int)gps_nodes.size() ) {
+	long fix = gps_nodes[index].getLong("fixType");
+	if ( fix == 0 ) {
+	    gps_nodes[index].setLong( "status", 0 );
+	} else if ( fix == 1 || fix == 2 ) {
+	    gps_nodes[index].setLong( "status", 1 );
+	} else {
+	    gps_nodes[index].setLong( "status", 2 );
+	}
+    }
+    return true;
+}
+
+
+bool replay_airdata_init( int index, pyPropertyNode *config ) {
+    mark( airdata_fresh, index );
+    airdata_fresh[index] = false;
+    while ( (int)airdata_nodes.size() <= index ) {
+	ostringstream path;
+	path << "/sensors/airdata" << '[' << airdata_nodes.size() << ']';
+	airdata_nodes.push_back( pyGetNode(path.str(), true) );
+    }
+    return true;
+}
+
+bool replay_airdata_update( int index ) {
+    if ( ! take( airdata_fresh, index ) ) {
+	return false;
+    }
+    // the raw airspeed isn't logged, the smoothed value is the best
+    // available input for the airdata manager
+    if ( index < (int)airdata_nodes.size() ) {
+	airdata_nodes[index].setDouble( "airspeed_kt",
+				vel_node.getDouble("airspeed_smoothed_kt") );
+    }
+    return true;
+}
+
+
+bool replay_pilot_init( int index, pyPropertyNode *config ) {
+    mark( pilot_fresh, index );
+    pilot_fresh[index] = false;
+    while ( (int)pilot_sections.size() <= index ) {
+	pilot_section s;
+	ostringstream path;
+	path << "/sensors/pilot_input" << '[' << pilot_sections.size() << ']';
+	s.node = pyGetNode(path.str(), true);
+	pilot_sections.push_back( s );
+    }
+    if ( config->hasChild("channel") ) {
+	for ( int i = 0; i < NUM_PILOT_INPUTS; i++ ) {
+	    pilot_sections[index].mapping[i] = config->getString("channel", i);
+	}
+    }
+    return true;
+}
+
+// the log only has the raw channels, apply the channel->name mapping
+// the same way the live driver does
+bool replay_pilot_update( int index ) {
+    if ( ! take( pilot_fresh, index ) ) {
+	return false;
+    }
+    if ( index < (int)pilot_sections.size() ) {
+	pilot_section &s = pilot_sections[index];
+	for ( int i = 0; i < NUM_PILOT_INPUTS; i++ ) {
+	    if ( s.mapping[i] != "" ) {
+		s.node.setDouble( s.mapping[i].c_str(),
+				  s.node.getDouble("channel", i) );
+	    }
+	}
+    }
+    return true;
+}
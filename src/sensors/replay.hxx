@@ -0,0 +1,47 @@
+//
+// FILE: replay.hxx
+// DESCRIPTION: feed the sensor packets of a recorded flight.dat.gz
+// back through the sensor managers (see main/replay.cxx.)  Log section
+// index i is written to /sensors/<type>[i], the same place the live
+// driver for section i writes.
+//
+
+#ifndef _AURA_REPLAY_HXX
+#define _AURA_REPLAY_HXX
+
+
+#include "python/pyprops.hxx"
+
+
+// log file
+bool replay_open( const char *file );
+void replay_close();
+
+// unpack the packets of the next frame (a primary imu packet and
+// everything logged after it up to the next one.)  Returns false at
+// the end of the log.
+bool replay_read_frame();
+
+// timestamp of the primary imu packet of the current frame
+double replay_frame_time();
+
+// statistics
+unsigned long replay_get_packets();
+unsigned long replay_get_skipped();
+unsigned long replay_get_errors();
+
+// function prototypes
+bool replay_imu_init( int index, pyPropertyNode *config );
+bool replay_imu_update( int index );
+
+bool replay_gps_init( int index, pyPropertyNode *config );
+bool replay_gps_update( int index );
+
+bool replay_airdata_init( int index, pyPropertyNode *config );
+bool replay_airdata_update( int index );
+
+bool replay_pilot_init( int index, pyPropertyNode *config );
+bool replay_pilot_update( int index );
+
+
+#endif // _AURA_REPLAY_HXX
@@ -0,0 +1,84 @@
+//
+// sensor_driver.cxx - common driver table for the sensor managers
+//
+// This code is released into the public domain.
+//
+
+#include "python/pyprops.hxx"
+
+#include <stdio.h>
+
+#include <sstream>
+using std::ostringstream;
+
+#include "util/reactor.hxx"
+
+#include "sensor_driver.hxx"
+
+
+vector<sensor_section> sensor_drivers_init( const char *group_path,
+					    const char *type,
+					    const sensor_driver *table,
+					    int count, bool want_sync )
+{
+    vector<sensor_section> sections;
+
+    pyPropertyNode group_node = pyGetNode(group_path, true);
+    vector<string> children = group_node.getChildren();
+    printf("Found %d %s sections\n", (int)children.size(), type);
+    for ( unsigned int i = 0; i < children.size(); i++ ) {
+	pyPropertyNode section = group_node.getChild(children[i].c_str());
+	string source = section.getString("source");
+	bool enabled = section.getBool("enable");
+	if ( !enabled ) {
+	    continue;
+	}
+	if ( source == "null" ) {
+	    // do nothing
+	    printf("%s: %d = %s\n", type, i, source.c_str());
+	    continue;
+	}
+	const sensor_driver *driver = NULL;
+	for ( int j = 0; j < count; j++ ) {
+	    if ( source == table[j].name ) {
+		driver = &table[j];
+		break;
+	    }
+	}
+	if ( driver == NULL ) {
+	    printf("Unknown %s source = '%s' in config file\n",
+		   type, source.c_str());
+	    continue;
+	}
+
+	bool sync = false;
+	if ( want_sync && (driver->flags & SENSOR_SYNC) ) {
+	    sync = true;
+	    want_sync = false;
+	}
+	printf("%s: %d = %s%s\n", type, i, source.c_str(),
+	       sync ? " (main loop sync)" : "");
+
+	ostringstream output_path;
+	output_path << "/sensors/" << type << '[' << i << ']';
+	reactor.accept_sync( sync );
+	driver->init( i, output_path.str(), &section );
+	reactor.accept_sync( true );
+
+	sensor_section s;
+	s.index = i;
+	s.driver = driver;
+	sections.push_back( s );
+    }
+
+    return sections;
+}
+
+
+void sensor_drivers_close( vector<sensor_section> &sections ) {
+    for ( unsigned int i = 0; i < sections.size(); i++ ) {
+	if ( sections[i].driver->close != NULL ) {
+	    sections[i].driver->close( sections[i].index );
+	}
+    }
+}
@@ -0,0 +1,58 @@
+//
+// sensor_driver.hxx - common driver table for the sensor managers
+//
+// Each sensor manager (imu, gps, airdata, pilot input) keeps a static
+// table of the drivers it knows about, keyed by the config "source"
+// name.  The config sections are resolved against the table once at
+// init time and the per-frame update only walks the resulting list of
+// enabled sections, with no property lookups or string compares.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_SENSOR_DRIVER_HXX
+#define _AURA_SENSOR_DRIVER_HXX
+
+
+#include "python/pyprops.hxx"
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+
+// driver capability flags
+const unsigned int SENSOR_SYNC = 0x01;	      // can be the main loop sync source
+const unsigned int SENSOR_RAVEN_PACKET = 0x02; // logs raven packets (airdata)
+
+struct sensor_driver {
+    const char *name;		// config "source" value
+    unsigned int flags;		// SENSOR_* capabilities
+    void (*init)( int index, string output_path, pyPropertyNode *config );
+    bool (*update)( int index );	// true if fresh data
+    void (*close)( int index );		// may be NULL
+    void (*calibrate)( int index );	// may be NULL
+};
+
+// an enabled config section bound to its driver
+struct sensor_section {
+    int index;			// section number (/sensors/<type>[index])
+    const sensor_driver *driver;
+};
+
+// Walk the sections of a sensor group (i.e. /config/sensors/imu_group),
+// look up each enabled section's source in the driver table and init
+// it with an output path of /sensors/<type>[i].  If want_sync is set
+// the first section whose driver has SENSOR_SYNC becomes the main loop
+// sync source; every other section is kept from claiming that role.
+vector<sensor_section> sensor_drivers_init( const char *group_path,
+					    const char *type,
+					    const sensor_driver *table,
+					    int count, bool want_sync );
+
+// close every section that has a close() entry point
+void sensor_drivers_close( vector<sensor_section> &sections );
+
+
+#endif // _AURA_SENSOR_DRIVER_HXX
@@ -1,19 +1,49 @@
 #include "python/pyprops.hxx"
 
 #include <stdio.h>
+#include <time.h>
 
 #include "comms/logging.hxx"
 #include "init/globals.hxx"
 #include "timing.h"
 #include "myprof.hxx"
 
+double myprofile::frame_budget = 0.01;
+
+static inline int64_t get_raw_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// the writer is the only thread that modifies a counter, so a relaxed
+// load/store pair is enough (no locked read-modify-write on the hot
+// path)
+template <class T>
+static inline void add_relaxed( std::atomic<T> &counter, T val ) {
+    counter.store( counter.load(std::memory_order_relaxed) + val,
+		   std::memory_order_relaxed );
+}
+
 myprofile::myprofile() {
+    enabled = false;
+    budget = 0.0;
+    start_ns = 0;
     init_time = 0.0;
     count = 0;
-    sum_time = 0.0;
-    max_interval = 0.0;
-    min_interval = 1000.0;
-    enabled = false;
+    sum_ns = 0;
+    min_ns = INT64_MAX;
+    max_ns = 0;
+    last_ns = 0;
+    for ( int i = 0; i < NUM_BUCKETS; i++ ) {
+	buckets[i] = 0;
+    }
+    overruns = 0;
+    slow_count = 0;
+    slow_start_ns = 0;
+    slow_ns = 0;
+    slow_reported = 0;
+    props_bound = false;
 }
 
 myprofile::~myprofile() {
@@ -23,56 +53,185 @@ void myprofile::set_name( const string _name ) {
     name = _name;
 }
 
+// values below SUB_COUNT get their own bucket, above that each power
+// of two gets SUB_COUNT linear sub-buckets
+int myprofile::bucket_index( uint64_t ns ) {
+    if ( ns < (uint64_t)SUB_COUNT ) {
+	return ns;
+    }
+    int msb = 63 - __builtin_clzll(ns);
+    int shift = msb - SUB_BITS;
+    int index = (shift + 1) * SUB_COUNT + ((ns >> shift) & (SUB_COUNT - 1));
+    if ( index >= NUM_BUCKETS ) {
+	index = NUM_BUCKETS - 1;
+    }
+    return index;
+}
+
+// midpoint of the bucket (nanoseconds)
+double myprofile::bucket_value( int index ) {
+    if ( index < SUB_COUNT ) {
+	return index;
+    }
+    int shift = index / SUB_COUNT - 1;
+    int sub = index % SUB_COUNT;
+    double low = (double)((uint64_t)(SUB_COUNT + sub) << shift);
+    double width = (double)((uint64_t)1 << shift);
+    return low + 0.5 * width;
+}
+
 void myprofile::start() {
     if ( !enabled ) {
 	return;
     }
-    
-    if ( init_time <= 0.0001 ) {
-	init_time = get_Time();
+
+    if ( init_time.load(std::memory_order_relaxed) <= 0.0001 ) {
+	init_time.store( get_Time(), std::memory_order_relaxed );
     }
-    start_time = get_Time();
-    count++;
+    start_ns = get_raw_ns();
+    add_relaxed<uint32_t>( count, 1 );
 }
 
 void myprofile::stop() {
     if ( !enabled ) {
 	return;
     }
-    
-    double stop_time = get_Time();
-    last_interval = stop_time - start_time;
-    sum_time += last_interval;
-    
-    // log situations where a module took longer that 0.10 sec to execute
-    if ( last_interval > 0.10 ) {
-	char msg[256];
-	snprintf(msg, 256, "t1 = %.3f t2 = %.3f int = %.3f",
-		 start_time, stop_time, last_interval);
-	events->log( name.c_str(), msg );
+
+    add_sample( start_ns, get_raw_ns() - start_ns );
+}
+
+// account for an interval measured by someone else (for instance the
+// per module times of the python tick)
+void myprofile::record( double interval ) {
+    if ( !enabled ) {
+	return;
+    }
+
+    int64_t interval_ns = (int64_t)(interval * 1000000000.0);
+    if ( init_time.load(std::memory_order_relaxed) <= 0.0001 ) {
+	init_time.store( get_Time() - interval, std::memory_order_relaxed );
+    }
+    int64_t start = get_raw_ns() - interval_ns;
+    add_relaxed<uint32_t>( count, 1 );
+    add_sample( start, interval_ns );
+}
+
+void myprofile::add_sample( int64_t start, int64_t interval_ns ) {
+    if ( interval_ns < 0 ) {
+	interval_ns = 0;
     }
+    last_ns.store( interval_ns, std::memory_order_relaxed );
+    add_relaxed<int64_t>( sum_ns, interval_ns );
 
-    if ( last_interval < min_interval ) {
-	min_interval = last_interval;
+    add_relaxed<uint32_t>( buckets[bucket_index(interval_ns)], 1 );
+    double limit = (budget > 0.0) ? budget : frame_budget;
+    if ( interval_ns > (int64_t)(limit * 1000000000.0) ) {
+	add_relaxed<uint32_t>( overruns, 1 );
     }
-    if ( last_interval > max_interval ) {
-	max_interval = last_interval;
+
+    // situations where a module took longer that 0.10 sec to execute
+    // are logged by publish() (the writer may not hold the
+    // interpreter lock)
+    if ( interval_ns > 100000000 ) {
+	slow_start_ns.store( start, std::memory_order_relaxed );
+	slow_ns.store( interval_ns, std::memory_order_relaxed );
+	slow_count.store( slow_count.load(std::memory_order_relaxed) + 1,
+			  std::memory_order_release );
+    }
+
+    if ( interval_ns < min_ns.load(std::memory_order_relaxed) ) {
+	min_ns.store( interval_ns, std::memory_order_relaxed );
+    }
+    if ( interval_ns > max_ns.load(std::memory_order_relaxed) ) {
+	max_ns.store( interval_ns, std::memory_order_relaxed );
     }
 }
 
+double myprofile::percentile( double fraction ) const {
+    uint64_t total = 0;
+    for ( int i = 0; i < NUM_BUCKETS; i++ ) {
+	total += buckets[i].load(std::memory_order_relaxed);
+    }
+    if ( total == 0 ) {
+	return 0.0;
+    }
+    uint64_t target = (uint64_t)(fraction * total + 0.5);
+    if ( target < 1 ) {
+	target = 1;
+    }
+    uint64_t sum = 0;
+    for ( int i = 0; i < NUM_BUCKETS; i++ ) {
+	sum += buckets[i].load(std::memory_order_relaxed);
+	if ( sum >= target ) {
+	    return bucket_value(i) / 1000000000.0;
+	}
+    }
+    return max_ns.load(std::memory_order_relaxed) / 1000000000.0;
+}
+
 void myprofile::stats() {
     if ( !enabled ) {
 	return;
     }
-    
-    double total_time = get_Time() - init_time;
+
+    uint32_t n = count.load(std::memory_order_relaxed);
+    double total_time = get_Time() - init_time.load();
     double avg_hz = 0.0;
     if ( total_time > 1.0 ) {
-	avg_hz = (double)count / total_time;
+	avg_hz = (double)n / total_time;
+    }
+    double avg_ms = 0.0;
+    if ( n > 0 ) {
+	avg_ms = sum_ns.load(std::memory_order_relaxed) / 1000000.0 / n;
+    }
+    printf( "%s (ms) avg: %.3f num: %u p50: %.3f p99: %.3f p99.9: %.3f max: %.3f over: %u hz: %.3f\n",
+	    name.c_str(), avg_ms, n,
+	    1000.0 * percentile(0.50), 1000.0 * percentile(0.99),
+	    1000.0 * percentile(0.999),
+	    max_ns.load(std::memory_order_relaxed) / 1000000.0,
+	    overruns.load(), avg_hz );
+}
+
+// export the current statistics to /status/profile/<name> (times in
+// milliseconds)
+void myprofile::publish() {
+    if ( !enabled ) {
+	return;
+    }
+
+    if ( !props_bound ) {
+	pyPropertyNode node = pyGetNode("/status/profile/" + name, true);
+	count_h = node.getHandle<long>("count");
+	p50_h = node.getHandle<double>("p50_ms");
+	p90_h = node.getHandle<double>("p90_ms");
+	p99_h = node.getHandle<double>("p99_ms");
+	p999_h = node.getHandle<double>("p999_ms");
+	max_h = node.getHandle<double>("max_ms");
+	overruns_h = node.getHandle<long>("overruns");
+	props_bound = true;
+    }
+
+    count_h.set( count.load(std::memory_order_relaxed) );
+    p50_h.set( percentile(0.50) * 1000.0 );
+    p90_h.set( percentile(0.90) * 1000.0 );
+    p99_h.set( percentile(0.99) * 1000.0 );
+    p999_h.set( percentile(0.999) * 1000.0 );
+    max_h.set( max_ns.load(std::memory_order_relaxed) / 1000000.0 );
+    overruns_h.set( overruns.load() );
+
+    uint32_t slow = slow_count.load(std::memory_order_acquire);
+    if ( slow != slow_reported ) {
+	// raw clock -> get_Time() for the message
+	int64_t start = slow_start_ns.load(std::memory_order_relaxed);
+	double interval = slow_ns.load(std::memory_order_relaxed)
+	    / 1000000000.0;
+	double t1 = get_Time() - (get_raw_ns() - start) / 1000000000.0;
+	char msg[256];
+	snprintf(msg, 256, "t1 = %.3f t2 = %.3f int = %.3f (%u slow)",
+		 t1, t1 + interval, interval, slow - slow_reported);
+	events->log( name.c_str(), msg );
+	slow_reported = slow;
     }
-    printf( "%s avg: %.4f num: %d tot: %.4f (range: %.4f-%.4f) hz: %.3f\n",
-	    name.c_str(), sum_time / (double)count,
-	    count, sum_time, min_interval, max_interval, avg_hz );
 }
 
 
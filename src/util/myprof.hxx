@@ -1,36 +1,93 @@
 #ifndef _AURA_MYPROF_H
 #define _AURA_MYPROF_H
 
+#include <stdint.h>
+
+#include <atomic>
 #include <string>
 
 using std::string;
 
+#include "props/props.hxx"
+
+
+// Section profiler.  Every start()/stop() interval is dropped into a
+// log bucketed (hdr style) histogram so we can report percentiles
+// and not just min/avg/max.  Each power of two is split into 16
+// linear sub-buckets which bounds the percentile error to about 3%.
+// Intervals are measured in nanoseconds with CLOCK_MONOTONIC_RAW.
+// Recording is one clock read per call and a few relaxed atomic
+// stores, there are no locks and no python: each profile has a single
+// writer thread and stats()/publish() can run on any other thread.
+// Slow intervals (> 0.1 sec) are only counted by the writer,
+// publish() turns them into event log messages.
 
 class myprofile {
 
 private:
 
-    int count;
-    double init_time;
-    double start_time;
-    double end_time;
-    double min_interval;
-    double max_interval;
-    double last_interval;
-    double sum_time;
+    static const int SUB_BITS = 4;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int NUM_BUCKETS = 32 * SUB_COUNT;
+
     string name;
     bool enabled;
+    double budget;
+
+    int64_t start_ns;		// writer only
+    std::atomic<double> init_time;	// get_Time() of the first sample
+    std::atomic<uint32_t> count;
+    std::atomic<int64_t> sum_ns;
+    std::atomic<int64_t> min_ns;
+    std::atomic<int64_t> max_ns;
+    std::atomic<int64_t> last_ns;
+    std::atomic<uint32_t> buckets[NUM_BUCKETS];
+    std::atomic<uint32_t> overruns;
+
+    // the most recent slow interval, reported by publish()
+    std::atomic<uint32_t> slow_count;
+    std::atomic<int64_t> slow_start_ns;
+    std::atomic<int64_t> slow_ns;
+    uint32_t slow_reported;	// publish() only
+
+    // exported values (/status/profile/<name>)
+    bool props_bound;
+    PropertyHandle<long> count_h;
+    PropertyHandle<double> p50_h, p90_h, p99_h, p999_h, max_h;
+    PropertyHandle<long> overruns_h;
+
+    void add_sample( int64_t start, int64_t interval_ns );
+
+    static int bucket_index( uint64_t ns );
+    static double bucket_value( int index );
 
 public:
 
+    // intervals longer than this count as overruns (default is the
+    // 100hz main loop frame time)
+    static double frame_budget;
+
     myprofile();
     ~myprofile();
 
     void set_name( const string _name );
+    // overrun threshold for a section that doesn't run every frame
+    // (sec, 0 = frame_budget)
+    inline void set_budget( double sec ) { budget = sec; }
     void start();
     void stop();
+    void record( double interval ); // interval timed elsewhere (sec)
     void stats();
-    inline double get_last_interval() { return last_interval; }
+    void publish();
+
+    // interval (sec) below which the given fraction (0-1) of the
+    // samples fall
+    double percentile( double fraction ) const;
+    inline uint32_t get_overruns() const { return overruns.load(); }
+
+    inline double get_last_interval() const {
+	return last_ns.load(std::memory_order_relaxed) / 1000000000.0;
+    }
     inline void enable() { enabled = true; }
     inline void disable() { enabled = false; }
 };
@@ -0,0 +1,147 @@
+//
+// reactor.cxx - epoll based event dispatch for the main loop
+//
+// This code is released into the public domain.
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "reactor.hxx"
+
+
+AuraReactor reactor;
+
+
+AuraReactor::AuraReactor():
+    epfd(-1),
+    num_ready(0),
+    sync_allowed(true)
+{
+}
+
+AuraReactor::~AuraReactor() {
+    if ( epfd >= 0 ) {
+	close( epfd );
+    }
+}
+
+bool AuraReactor::open() {
+    if ( epfd >= 0 ) {
+	return true;
+    }
+    epfd = epoll_create1( EPOLL_CLOEXEC );
+    if ( epfd < 0 ) {
+	printf("reactor: epoll_create1() failed: %s\n", strerror(errno));
+	return false;
+    }
+    return true;
+}
+
+bool AuraReactor::add( int fd, reactor_handler handler, void *arg,
+		       bool sync )
+{
+    if ( fd < 0 || ! open() ) {
+	return false;
+    }
+    sync = sync && sync_allowed;
+
+    for ( unsigned int i = 0; i < sources.size(); i++ ) {
+	if ( sources[i].fd == fd ) {
+	    sources[i].handler = handler;
+	    sources[i].arg = arg;
+	    sources[i].sync = sources[i].sync || sync;
+	    return true;
+	}
+    }
+
+    int flags = fcntl( fd, F_GETFL, 0 );
+    fcntl( fd, F_SETFL, flags | O_NONBLOCK );
+
+    struct epoll_event ev;
+    memset( &ev, 0, sizeof(ev) );
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if ( epoll_ctl( epfd, EPOLL_CTL_ADD, fd, &ev ) < 0 ) {
+	printf("reactor: cannot watch fd %d: %s\n", fd, strerror(errno));
+	return false;
+    }
+
+    source_t s;
+    s.fd = fd;
+    s.handler = handler;
+    s.arg = arg;
+    s.sync = sync;
+    sources.push_back( s );
+
+    return true;
+}
+
+bool AuraReactor::remove( int fd ) {
+    for ( unsigned int i = 0; i < sources.size(); i++ ) {
+	if ( sources[i].fd == fd ) {
+	    epoll_ctl( epfd, EPOLL_CTL_DEL, fd, NULL );
+	    sources.erase( sources.begin() + i );
+	    return true;
+	}
+    }
+    return false;
+}
+
+bool AuraReactor::has_sync() const {
+    for ( unsigned int i = 0; i < sources.size(); i++ ) {
+	if ( sources[i].sync ) {
+	    return true;
+	}
+    }
+    return false;
+}
+
+int AuraReactor::wait( int timeout_ms ) {
+    num_ready = 0;
+    if ( epfd < 0 ) {
+	return 0;
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    int n = epoll_wait( epfd, events, MAX_EVENTS, timeout_ms );
+    if ( n < 0 ) {
+	if ( errno != EINTR ) {
+	    printf("reactor: epoll_wait() failed: %s\n", strerror(errno));
+	}
+	return 0;
+    }
+    for ( int i = 0; i < n; i++ ) {
+	ready[i] = events[i].data.fd;
+    }
+    num_ready = n;
+    return n;
+}
+
+bool AuraReactor::dispatch() {
+    bool new_frame = false;
+    for ( int i = 0; i < num_ready; i++ ) {
+	// the source list is tiny, a linear scan beats a map here
+	for ( unsigned int j = 0; j < sources.size(); j++ ) {
+	    source_t *s = &sources[j];
+	    if ( s->fd == ready[i] ) {
+		if ( s->handler( s->arg ) && s->sync ) {
+		    new_frame = true;
+		}
+		break;
+	    }
+	}
+    }
+    num_ready = 0;
+
+    return new_frame;
+}
+
+bool AuraReactor::poll( int timeout_ms ) {
+    wait( timeout_ms );
+    return dispatch();
+}
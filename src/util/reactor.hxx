@@ -0,0 +1,85 @@
+//
+// reactor.hxx - epoll based event dispatch for the main loop
+//
+// Sensor drivers register their serial fd's and udp sockets along
+// with a handler that consumes whatever bytes are currently available
+// (non-blocking) and feeds them through the driver's parser.  The
+// main loop sleeps in poll() until the main imu (the sync source)
+// reports a fresh packet, so there is no busy spinning and no
+// blocking single byte reads, and the estimation/control pass starts
+// as soon as the imu packet has been parsed.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_REACTOR_HXX
+#define _AURA_REACTOR_HXX
+
+#include <vector>
+using std::vector;
+
+
+// handler called when fd becomes readable.  Should consume all the
+// available input and return true if a sync (imu) event was seen.
+typedef bool (*reactor_handler)( void *arg );
+
+
+class AuraReactor {
+
+public:
+
+    AuraReactor();
+    ~AuraReactor();
+
+    // register an fd (sets it non-blocking).  Registering the same fd
+    // again updates the handler and promotes it to a sync source if
+    // sync is true.
+    bool add( int fd, reactor_handler handler, void *arg,
+	      bool sync = false );
+    bool remove( int fd );
+
+    // while accept_sync(false) is in effect add() ignores the sync
+    // flag (the sensor managers use this to pick which driver owns
+    // the main loop sync role)
+    inline void accept_sync( bool accept ) { sync_allowed = accept; }
+
+    // true if any registered source can signal a new frame
+    bool has_sync() const;
+
+    // wait up to timeout_ms for input and dispatch the handlers of
+    // every ready fd.  Returns true if a sync source reported a new
+    // frame.
+    bool poll( int timeout_ms );
+
+    // poll() in two halves so a threaded caller can sleep in wait()
+    // without holding the interpreter lock and take it only for
+    // dispatch().  wait() returns the number of ready fd's.
+    int wait( int timeout_ms );
+    bool dispatch();
+
+private:
+
+    struct source_t {
+	int fd;
+	reactor_handler handler;
+	void *arg;
+	bool sync;
+    };
+
+    static const int MAX_EVENTS = 16;
+
+    int epfd;
+    vector<source_t> sources;
+    int num_ready;
+    int ready[MAX_EVENTS];
+    bool sync_allowed;
+
+    bool open();
+};
+
+
+// the main loop reactor
+extern AuraReactor reactor;
+
+
+#endif // _AURA_REACTOR_HXX
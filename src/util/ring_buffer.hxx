@@ -0,0 +1,58 @@
+//
+// ring_buffer.hxx - fixed capacity history of the last n values
+//
+// Index 0 is the most recent value pushed and index capacity()-1 the
+// oldest one still held.  Storage is allocated once by init();
+// push() overwrites the oldest slot so it never allocates or moves
+// the other values.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_RING_BUFFER_HXX
+#define _AURA_RING_BUFFER_HXX
+
+#include <vector>
+
+
+template <class T>
+class RingBuffer {
+
+public:
+
+    RingBuffer(): head(0) {}
+    ~RingBuffer() {}
+
+    // size the buffer and fill it with value
+    void init( unsigned int capacity, const T &value ) {
+	buf.assign( capacity, value );
+	head = 0;
+    }
+
+    inline unsigned int capacity() const { return buf.size(); }
+
+    inline void push( const T &value ) {
+	head = (head == 0) ? buf.size() - 1 : head - 1;
+	buf[head] = value;
+    }
+
+    // i values ago (0 = newest)
+    inline T &operator[]( unsigned int i ) {
+	unsigned int pos = head + i;
+	if ( pos >= buf.size() ) {
+	    pos -= buf.size();
+	}
+	return buf[pos];
+    }
+
+    inline T &newest() { return buf[head]; }
+    inline T &oldest() { return (*this)[buf.size() - 1]; }
+
+private:
+
+    std::vector<T> buf;
+    unsigned int head;
+};
+
+
+#endif // _AURA_RING_BUFFER_HXX
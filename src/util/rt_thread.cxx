@@ -0,0 +1,171 @@
+//
+// rt_thread.cxx - real time thread setup and deadline accounting
+//
+// This code is released into the public domain.
+//
+
+#include <alloca.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "rt_thread.hxx"
+
+
+// extra thread stack beyond the pre-faulted part (the python
+// interpreter and libc need some head room below it)
+static const int STACK_HEADROOM_KB = 64;
+
+
+void AuraThreadConfig::load( pyPropertyNode *node ) {
+    if ( node->hasChild("priority") ) {
+	priority = node->getLong("priority");
+    }
+    if ( node->hasChild("cpu") ) {
+	cpu = node->getLong("cpu");
+    }
+    if ( node->hasChild("stack_kb") ) {
+	stack_kb = node->getLong("stack_kb");
+    }
+    if ( node->hasChild("rate_hz") ) {
+	rate_hz = node->getDouble("rate_hz");
+    }
+}
+
+
+bool aura_lock_memory() {
+    if ( mlockall( MCL_CURRENT | MCL_FUTURE ) != 0 ) {
+	printf("threads: mlockall() failed: %s (memory not locked)\n",
+	       strerror(errno));
+	return false;
+    }
+    return true;
+}
+
+
+// touch every page of the next 'kb' of stack so the thread never
+// takes a page fault growing it later
+static void __attribute__((noinline)) prefault_stack( int kb ) {
+    volatile unsigned char *buf = (volatile unsigned char *)alloca( kb * 1024 );
+    for ( int i = 0; i < kb * 1024; i += 4096 ) {
+	buf[i] = 0;
+    }
+}
+
+
+bool aura_thread_setup( const AuraThreadConfig &config ) {
+    bool result = true;
+
+    if ( config.priority > 0 ) {
+	struct sched_param param;
+	memset( &param, 0, sizeof(param) );
+	param.sched_priority = config.priority;
+	int err = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+	if ( err != 0 ) {
+	    printf("threads: %s: cannot set SCHED_FIFO priority %d: %s\n",
+		   config.name.c_str(), config.priority, strerror(err));
+	    result = false;
+	}
+    }
+
+    if ( config.cpu >= 0 ) {
+	cpu_set_t cpus;
+	CPU_ZERO( &cpus );
+	CPU_SET( config.cpu, &cpus );
+	int err = pthread_setaffinity_np( pthread_self(), sizeof(cpus), &cpus );
+	if ( err != 0 ) {
+	    printf("threads: %s: cannot pin to cpu %d: %s\n",
+		   config.name.c_str(), config.cpu, strerror(err));
+	    result = false;
+	}
+    }
+
+    if ( config.stack_kb > 0 ) {
+	prefault_stack( config.stack_kb );
+    }
+
+    printf("threads: %s: priority %d cpu %d stack %d kb\n",
+	   config.name.c_str(), config.priority, config.cpu, config.stack_kb);
+
+    return result;
+}
+
+
+bool aura_thread_start( pthread_t *thread, const AuraThreadConfig &config,
+			void *(*func)(void *), void *arg )
+{
+    pthread_attr_t attr;
+    pthread_attr_init( &attr );
+    if ( config.stack_kb > 0 ) {
+	size_t size = (size_t)(config.stack_kb + STACK_HEADROOM_KB) * 1024;
+	if ( size < (size_t)PTHREAD_STACK_MIN ) {
+	    size = PTHREAD_STACK_MIN;
+	}
+	pthread_attr_setstacksize( &attr, size );
+    }
+    int err = pthread_create( thread, &attr, func, arg );
+    pthread_attr_destroy( &attr );
+    if ( err != 0 ) {
+	printf("threads: cannot create %s thread: %s\n",
+	       config.name.c_str(), strerror(err));
+	return false;
+    }
+    return true;
+}
+
+
+static inline int64_t get_mono_ns() {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+AuraThreadStats::AuraThreadStats():
+    deadline_ns(10000000),
+    start_ns(0),
+    frames(0),
+    misses(0),
+    last_ns(0),
+    max_ns(0),
+    props_bound(false)
+{
+}
+
+void AuraThreadStats::begin() {
+    start_ns = get_mono_ns();
+}
+
+// single writer, relaxed load/store pairs are enough
+void AuraThreadStats::end() {
+    int64_t interval = get_mono_ns() - start_ns;
+    last_ns.store( interval, std::memory_order_relaxed );
+    if ( interval > max_ns.load(std::memory_order_relaxed) ) {
+	max_ns.store( interval, std::memory_order_relaxed );
+    }
+    if ( interval > deadline_ns ) {
+	misses.store( misses.load(std::memory_order_relaxed) + 1,
+		      std::memory_order_relaxed );
+    }
+    frames.store( frames.load(std::memory_order_relaxed) + 1,
+		  std::memory_order_relaxed );
+}
+
+void AuraThreadStats::publish( const string &name ) {
+    if ( !props_bound ) {
+	pyPropertyNode node = pyGetNode("/status/threads/" + name, true);
+	frames_h = node.getHandle<long>("frames");
+	misses_h = node.getHandle<long>("deadline_misses");
+	last_h = node.getHandle<double>("last_ms");
+	max_h = node.getHandle<double>("max_ms");
+	props_bound = true;
+    }
+    frames_h.set( get_frames() );
+    misses_h.set( get_misses() );
+    last_h.set( last_ns.load(std::memory_order_relaxed) / 1000000.0 );
+    max_h.set( max_ns.load(std::memory_order_relaxed) / 1000000.0 );
+}
@@ -0,0 +1,96 @@
+//
+// rt_thread.hxx - real time thread setup and deadline accounting
+//
+// Scheduling (SCHED_FIFO priority, cpu pinning, locked and pre-faulted
+// memory) for the control thread and the lower priority main thread.
+// Everything here degrades gracefully: if the process lacks the
+// privileges for real time scheduling or locked memory a warning is
+// printed and the thread simply runs with the default policy.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_RT_THREAD_HXX
+#define _AURA_RT_THREAD_HXX
+
+#include "python/pyprops.hxx"
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+using std::string;
+
+
+struct AuraThreadConfig {
+    string name;
+    int priority;		// SCHED_FIFO priority, 0 = normal scheduling
+    int cpu;			// pin to this cpu, -1 = any
+    int stack_kb;		// stack to pre-fault (and thread stack size)
+    double rate_hz;		// expected iteration rate (deadline = 1/rate)
+
+    AuraThreadConfig():
+	priority(0), cpu(-1), stack_kb(256), rate_hz(100.0) {}
+
+    // fill in from a /config/threads/<name> node (missing values keep
+    // their defaults)
+    void load( pyPropertyNode *node );
+};
+
+
+// lock current and future pages in memory (mlockall)
+bool aura_lock_memory();
+
+// apply priority/affinity to the calling thread and pre-fault its
+// stack
+bool aura_thread_setup( const AuraThreadConfig &config );
+
+// start a thread with a stack of config.stack_kb (plus some head
+// room.)  The new thread should call aura_thread_setup() itself.
+bool aura_thread_start( pthread_t *thread, const AuraThreadConfig &config,
+			void *(*func)(void *), void *arg );
+
+
+// per thread iteration counters.  The owning thread calls begin() and
+// end() around each iteration, any thread may read the counters.
+class AuraThreadStats {
+
+public:
+
+    AuraThreadStats();
+
+    void set_deadline( double sec ) { deadline_ns = sec * 1.0e9; }
+
+    void begin();
+    void end();
+
+    inline unsigned long get_frames() const {
+	return frames.load(std::memory_order_relaxed);
+    }
+    inline unsigned long get_misses() const {
+	return misses.load(std::memory_order_relaxed);
+    }
+
+    // export to /status/threads/<name> (times in milliseconds)
+    void publish( const string &name );
+
+private:
+
+    int64_t deadline_ns;
+    int64_t start_ns;
+
+    std::atomic<unsigned long> frames;
+    std::atomic<unsigned long> misses;
+    std::atomic<int64_t> last_ns;
+    std::atomic<int64_t> max_ns;
+
+    bool props_bound;
+    PropertyHandle<long> frames_h;
+    PropertyHandle<long> misses_h;
+    PropertyHandle<double> last_h;
+    PropertyHandle<double> max_h;
+};
+
+
+#endif // _AURA_RT_THREAD_HXX
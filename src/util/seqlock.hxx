@@ -0,0 +1,84 @@
+//
+// seqlock.hxx - single writer sequence lock for small POD structures
+//
+// The writer never blocks or waits.  Readers never block the writer
+// and retry only if a store() overlapped their copy, so a reader
+// always gets a complete, consistent copy of one published value.
+// The payload is kept in an array of relaxed atomic words so the
+// concurrent copies are well defined (no torn reads of individual
+// fields, no data race as far as the compiler is concerned.)
+//
+// T must be trivially copyable.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_SEQLOCK_HXX
+#define _AURA_SEQLOCK_HXX
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+
+template <class T>
+class AuraSeqlock {
+
+public:
+
+    AuraSeqlock(): seq(0) {
+	for ( int i = 0; i < WORDS; i++ ) {
+	    data[i].store( 0, std::memory_order_relaxed );
+	}
+    }
+
+    // writer side (one thread only)
+    void store( const T &val ) {
+	uint64_t buf[WORDS];
+	buf[WORDS - 1] = 0;
+	memcpy( buf, &val, sizeof(T) );
+	uint32_t s = seq.load( std::memory_order_relaxed );
+	seq.store( s + 1, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+	for ( int i = 0; i < WORDS; i++ ) {
+	    data[i].store( buf[i], std::memory_order_relaxed );
+	}
+	seq.store( s + 2, std::memory_order_release );
+    }
+
+    // reader side (any thread.)  Returns the number of store()'s so
+    // far, so a reader can tell whether anything new was published.
+    uint32_t load( T *val ) const {
+	uint64_t buf[WORDS];
+	while ( true ) {
+	    uint32_t s0 = seq.load( std::memory_order_acquire );
+	    if ( s0 & 1 ) {
+		continue;	// store in progress
+	    }
+	    for ( int i = 0; i < WORDS; i++ ) {
+		buf[i] = data[i].load( std::memory_order_relaxed );
+	    }
+	    std::atomic_thread_fence( std::memory_order_acquire );
+	    if ( seq.load( std::memory_order_relaxed ) == s0 ) {
+		memcpy( val, buf, sizeof(T) );
+		return s0 / 2;
+	    }
+	}
+    }
+
+    // number of store()'s so far
+    inline uint32_t count() const {
+	return seq.load( std::memory_order_acquire ) / 2;
+    }
+
+private:
+
+    static const int WORDS = (sizeof(T) + 7) / 8;
+
+    std::atomic<uint32_t> seq;
+    std::atomic<uint64_t> data[WORDS];
+};
+
+
+#endif // _AURA_SEQLOCK_HXX
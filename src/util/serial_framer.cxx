@@ -0,0 +1,177 @@
+//
+// serial_framer.cxx - buffered packet framing for the sensor head uarts
+//
+// This code is released into the public domain.
+//
+
+#include <string.h>
+#include <unistd.h>
+
+#include "serial_framer.hxx"
+
+
+// Equivalent to the classic running form (A += b; B += A;) but
+// written as two independent sums so the compiler can vectorize it:
+// A = sum(b[i]), B = sum((n - i) * b[i]), both mod 256.
+void fletcher8( const uint8_t *buf, int size, uint8_t *cksum0,
+		uint8_t *cksum1 )
+{
+    uint32_t a = 0;
+    uint32_t b = 0;
+    for ( int i = 0; i < size; i++ ) {
+	a += buf[i];
+	b += (uint32_t)(size - i) * buf[i];
+    }
+    *cksum0 = (uint8_t)(a & 0xff);
+    *cksum1 = (uint8_t)(b & 0xff);
+}
+
+
+SerialFramer::SerialFramer():
+    fd(-1),
+    sync0(0),
+    sync1(0),
+    fixed_len(-1),
+    head(0),
+    tail(0),
+    last_fill_full(false),
+    bytes(0),
+    reads(0),
+    frames(0),
+    resyncs(0),
+    cksum_errors(0)
+{
+}
+
+void SerialFramer::init( int fd, uint8_t sync0, uint8_t sync1,
+			 int fixed_len )
+{
+    this->fd = fd;
+    this->sync0 = sync0;
+    this->sync1 = sync1;
+    this->fixed_len = fixed_len;
+    head = tail = 0;
+}
+
+// slide any partial frame down to make room
+void SerialFramer::compact() {
+    if ( head > 0 ) {
+	if ( tail > head ) {
+	    memmove( buf, buf + head, tail - head );
+	}
+	tail -= head;
+	head = 0;
+    }
+    if ( tail >= BUF_SIZE ) {
+	// buffer full of junk that never framed, start over
+	tail = 0;
+	resyncs++;
+    }
+}
+
+int SerialFramer::fill() {
+    compact();
+
+    int space = BUF_SIZE - tail;
+    int len = read( fd, buf + tail, space );
+    reads++;
+    if ( len > 0 ) {
+	tail += len;
+	bytes += len;
+    } else {
+	len = 0;
+    }
+    last_fill_full = (len == space);
+
+    return len;
+}
+
+int SerialFramer::append( const uint8_t *data, int len ) {
+    compact();
+
+    int space = BUF_SIZE - tail;
+    if ( len > space ) {
+	len = space;
+    }
+    memcpy( buf + tail, data, len );
+    tail += len;
+    bytes += len;
+    return len;
+}
+
+// advance head to the next sync0 sync1 pair.  Returns true if the
+// buffer now starts with a sync pair.
+bool SerialFramer::sync() {
+    bool skipped = false;
+    while ( tail - head >= 2 ) {
+	if ( buf[head] == sync0 && buf[head+1] == sync1 ) {
+	    if ( skipped ) {
+		resyncs++;
+	    }
+	    return true;
+	}
+	skipped = true;
+	uint8_t *p = (uint8_t *)memchr( buf + head + 1, sync0,
+					tail - head - 1 );
+	if ( p == NULL ) {
+	    head = tail;
+	} else {
+	    head = p - buf;
+	}
+    }
+    if ( skipped ) {
+	resyncs++;
+    }
+    return false;
+}
+
+bool SerialFramer::next( uint8_t *pkt_id, int *pkt_len, uint8_t **payload )
+{
+    const uint8_t *view;
+    if ( ! next_view( pkt_id, pkt_len, &view ) ) {
+	return false;
+    }
+    memcpy( frame.bytes, view, *pkt_len );
+    *payload = frame.bytes;
+    return true;
+}
+
+bool SerialFramer::next_view( uint8_t *pkt_id, int *pkt_len,
+			      const uint8_t **payload )
+{
+    while ( sync() ) {
+	int avail = tail - head;
+	int hdr_len = (fixed_len < 0) ? 4 : 2;
+	if ( avail < hdr_len ) {
+	    return false;
+	}
+	int len = (fixed_len < 0) ? buf[head+3] : fixed_len;
+	int total = hdr_len + len + 2;
+	if ( len > MAX_PAYLOAD ) {
+	    head++;		// bogus length, rescan
+	    continue;
+	}
+	if ( avail < total ) {
+	    return false;	// wait for the rest
+	}
+
+	uint8_t *span = buf + head + 2;
+	int span_len = hdr_len - 2 + len;
+	uint8_t cksum0, cksum1;
+	fletcher8( span, span_len, &cksum0, &cksum1 );
+	if ( cksum0 != span[span_len] || cksum1 != span[span_len+1] ) {
+	    cksum_errors++;
+	    head++;		// false sync or corrupt frame, rescan
+	    continue;
+	}
+
+	*pkt_id = (fixed_len < 0) ? buf[head+2] : 0;
+	*pkt_len = len;
+	*payload = buf + head + hdr_len;
+	head += total;
+	frames++;
+	return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,104 @@
+//
+// serial_framer.hxx - buffered packet framing for the sensor head uarts
+//
+// Shared by the APM2, Aura3 and pika drivers which all speak the same
+// basic framing:
+//
+//   sync0 sync1 [id len] payload cksum_A cksum_B
+//
+// The id/len header is omitted when a fixed payload length is given
+// (pika.)  The checksum is the 8 bit fletcher sum over everything
+// between the sync bytes and the checksum.
+//
+// Input is pulled in with large non-blocking reads instead of one
+// read() per byte, the sync bytes are located with memchr() and the
+// checksum is computed over the whole span at once.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_SERIAL_FRAMER_HXX
+#define _AURA_SERIAL_FRAMER_HXX
+
+#include <stdint.h>
+
+
+// 8 bit fletcher checksum over a span of bytes
+void fletcher8( const uint8_t *buf, int size, uint8_t *cksum0,
+		uint8_t *cksum1 );
+
+
+class SerialFramer {
+
+public:
+
+    SerialFramer();
+    ~SerialFramer() {}
+
+    // fixed_len < 0 means frames carry an id and a 1 byte length
+    void init( int fd, uint8_t sync0, uint8_t sync1, int fixed_len = -1 );
+
+    // pull in whatever is waiting on the fd (one read() call.)
+    // Returns the number of bytes read.
+    int fill();
+
+    // feed bytes from some other source (i.e. a log file) instead of
+    // reading the fd.  Returns the number of bytes accepted.
+    int append( const uint8_t *data, int len );
+
+    // true if the last fill() used all the free buffer space, so
+    // there may be more input pending.
+    inline bool more() const { return last_fill_full; }
+
+    // extract the next valid frame.  The payload is copied into an
+    // aligned buffer owned by the framer which stays valid until the
+    // next call.
+    bool next( uint8_t *pkt_id, int *pkt_len, uint8_t **payload );
+
+    // same as next() without the copy: the payload points into the
+    // receive buffer and stays valid until the next fill() or
+    // append() (for parsers that don't need aligned loads.)
+    bool next_view( uint8_t *pkt_id, int *pkt_len, const uint8_t **payload );
+
+    // statistics
+    inline unsigned long get_bytes() const { return bytes; }
+    inline unsigned long get_reads() const { return reads; }
+    inline unsigned long get_frames() const { return frames; }
+    inline unsigned long get_resyncs() const { return resyncs; }
+    inline unsigned long get_cksum_errors() const { return cksum_errors; }
+    inline double get_bytes_per_read() const {
+	return reads > 0 ? (double)bytes / (double)reads : 0.0;
+    }
+
+private:
+
+    static const int BUF_SIZE = 4096;
+    static const int MAX_PAYLOAD = 1024;
+
+    int fd;
+    uint8_t sync0, sync1;
+    int fixed_len;
+
+    uint8_t buf[BUF_SIZE];
+    int head;			// first unconsumed byte
+    int tail;			// one past the last valid byte
+    bool last_fill_full;
+
+    // frames are copied here so parsers can do aligned loads
+    union {
+	uint8_t bytes[MAX_PAYLOAD];
+	double align;
+    } frame;
+
+    unsigned long bytes;
+    unsigned long reads;
+    unsigned long frames;
+    unsigned long resyncs;
+    unsigned long cksum_errors;
+
+    void compact();
+    bool sync();
+};
+
+
+#endif // _AURA_SERIAL_FRAMER_HXX
@@ -0,0 +1,103 @@
+//
+// spsc_ring.cxx - single producer / single consumer message ring
+//
+// This code is released into the public domain.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "spsc_ring.hxx"
+
+
+SPSCRing::SPSCRing():
+    buf(NULL),
+    size(0),
+    mask(0),
+    head(0),
+    tail(0)
+{
+}
+
+SPSCRing::~SPSCRing() {
+    if ( buf != NULL ) {
+	free(buf);
+    }
+}
+
+bool SPSCRing::init( size_t capacity ) {
+    size = 1;
+    while ( size < capacity ) {
+	size <<= 1;
+    }
+    mask = size - 1;
+    buf = (uint8_t *)malloc(size);
+    if ( buf == NULL ) {
+	size = mask = 0;
+	return false;
+    }
+    head.store(0);
+    tail.store(0);
+    return true;
+}
+
+void SPSCRing::copy_in( size_t pos, const uint8_t *src, size_t len ) {
+    size_t start = pos & mask;
+    size_t first = size - start;
+    if ( first >= len ) {
+	memcpy(buf + start, src, len);
+    } else {
+	memcpy(buf + start, src, first);
+	memcpy(buf, src + first, len - first);
+    }
+}
+
+void SPSCRing::copy_out( size_t pos, uint8_t *dst, size_t len ) {
+    size_t start = pos & mask;
+    size_t first = size - start;
+    if ( first >= len ) {
+	memcpy(dst, buf + start, len);
+    } else {
+	memcpy(dst, buf + start, first);
+	memcpy(dst + first, buf, len - first);
+    }
+}
+
+bool SPSCRing::push( const uint8_t *msg, int len ) {
+    if ( len < 0 || len > 0xffff ) {
+	return false;
+    }
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_acquire);
+    if ( size - (h - t) < (size_t)len + 2 ) {
+	return false;		// full
+    }
+    uint8_t hdr[2] = { (uint8_t)(len & 0xff), (uint8_t)(len >> 8) };
+    copy_in(h, hdr, 2);
+    copy_in(h + 2, msg, len);
+    head.store(h + 2 + len, std::memory_order_release);
+    return true;
+}
+
+int SPSCRing::pop( uint8_t *msg, int max_len ) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    if ( h == t ) {
+	return 0;		// empty
+    }
+    uint8_t hdr[2];
+    copy_out(t, hdr, 2);
+    int len = hdr[0] | (hdr[1] << 8);
+    int result = -1;
+    if ( len <= max_len ) {
+	copy_out(t + 2, msg, len);
+	result = len;
+    }
+    tail.store(t + 2 + len, std::memory_order_release);
+    return result;
+}
+
+size_t SPSCRing::used() const {
+    return head.load(std::memory_order_acquire)
+	- tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,60 @@
+//
+// spsc_ring.hxx - single producer / single consumer message ring
+//
+// A lock free ring of variable length messages (up to 64Kb each.)
+// Exactly one thread may call push() and exactly one (other) thread
+// may call pop().  Each message is stored as a 2 byte length followed
+// by the payload and may wrap around the end of the buffer.  Neither
+// side ever blocks or allocates after init().
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_SPSC_RING_HXX
+#define _AURA_SPSC_RING_HXX
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+
+
+class SPSCRing {
+
+public:
+
+    SPSCRing();
+    ~SPSCRing();
+
+    // allocate the buffer (capacity is rounded up to a power of two)
+    bool init( size_t capacity );
+
+    // producer: append a message, returns false (and leaves the ring
+    // untouched) if there isn't room for it
+    bool push( const uint8_t *msg, int len );
+
+    // consumer: copy out the next message and return its length, or
+    // return 0 if the ring is empty.  Returns -1 if the next message
+    // is bigger than max_len (it is discarded.)
+    int pop( uint8_t *msg, int max_len );
+
+    // bytes currently queued (approximate when read by the other side)
+    size_t used() const;
+    inline size_t capacity() const { return size; }
+
+private:
+
+    uint8_t *buf;
+    size_t size;
+    size_t mask;
+
+    // free running byte counters (never wrapped to the buffer size)
+    std::atomic<size_t> head;	// written by the producer only
+    std::atomic<size_t> tail;	// written by the consumer only
+
+    void copy_in( size_t pos, const uint8_t *src, size_t len );
+    void copy_out( size_t pos, uint8_t *dst, size_t len );
+};
+
+
+#endif // _AURA_SPSC_RING_HXX
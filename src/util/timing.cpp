@@ -15,8 +15,21 @@ void print_Time_Resolution()
 	   res.tv_nsec);
 }
 
+static bool virtual_clock = false;
+static double virtual_time = 0.0;
+
+void set_Virtual_Time( double t )
+{
+    virtual_clock = true;
+    virtual_time = t;
+}
+
 double get_Time()
 {
+    if ( virtual_clock ) {
+	return virtual_time;
+    }
+
     static struct timespec tstart;
     static bool init = false;
    
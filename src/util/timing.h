@@ -9,4 +9,8 @@ void print_Time_Resolution();
 extern double get_Time();
 extern double get_RealTime();
 
+// switch get_Time() over to a clock that only moves when set (used by
+// the log replay tool so runs are repeatable and not paced.)
+extern void set_Virtual_Time( double t );
+
 #endif // _AURA_TIMING_H
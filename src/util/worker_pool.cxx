@@ -0,0 +1,95 @@
+//
+// worker_pool.cxx - small fixed pool of worker threads
+//
+// This code is released into the public domain.
+//
+
+#include <stdio.h>
+
+#include "worker_pool.hxx"
+
+
+AuraWorkerPool::AuraWorkerPool():
+    head(0),
+    count(0),
+    running(false)
+{
+    pthread_mutex_init( &lock, NULL );
+    pthread_cond_init( &cond, NULL );
+}
+
+AuraWorkerPool::~AuraWorkerPool() {
+    stop();
+    pthread_cond_destroy( &cond );
+    pthread_mutex_destroy( &lock );
+}
+
+bool AuraWorkerPool::start( int num_threads ) {
+    if ( running ) {
+	return true;
+    }
+    running = true;
+    for ( int i = 0; i < num_threads; i++ ) {
+	pthread_t thread;
+	if ( pthread_create( &thread, NULL, thread_main, this ) != 0 ) {
+	    printf("Worker pool: cannot create thread %d\n", i);
+	    break;
+	}
+	threads.push_back( thread );
+    }
+    if ( threads.empty() ) {
+	running = false;
+	return false;
+    }
+    return true;
+}
+
+void AuraWorkerPool::stop() {
+    pthread_mutex_lock( &lock );
+    running = false;
+    pthread_cond_broadcast( &cond );
+    pthread_mutex_unlock( &lock );
+    for ( unsigned int i = 0; i < threads.size(); i++ ) {
+	pthread_join( threads[i], NULL );
+    }
+    threads.clear();
+}
+
+bool AuraWorkerPool::submit( job_func func, void *arg ) {
+    bool result = false;
+    pthread_mutex_lock( &lock );
+    if ( running && count < MAX_JOBS ) {
+	job &j = queue[(head + count) % MAX_JOBS];
+	j.func = func;
+	j.arg = arg;
+	count++;
+	pthread_cond_signal( &cond );
+	result = true;
+    }
+    pthread_mutex_unlock( &lock );
+    return result;
+}
+
+void *AuraWorkerPool::thread_main( void *arg ) {
+    ((AuraWorkerPool *)arg)->run();
+    return NULL;
+}
+
+void AuraWorkerPool::run() {
+    pthread_mutex_lock( &lock );
+    while ( true ) {
+	while ( running && count == 0 ) {
+	    pthread_cond_wait( &cond, &lock );
+	}
+	if ( count == 0 ) {
+	    break;		// stopped and drained
+	}
+	job j = queue[head];
+	head = (head + 1) % MAX_JOBS;
+	count--;
+	pthread_mutex_unlock( &lock );
+	j.func( j.arg );
+	pthread_mutex_lock( &lock );
+    }
+    pthread_mutex_unlock( &lock );
+}
@@ -0,0 +1,64 @@
+//
+// worker_pool.hxx - small fixed pool of worker threads
+//
+// Jobs are plain function + argument pairs queued in a fixed size
+// ring (submit() never allocates.)  Completion is up to the job
+// itself, typically by storing to an atomic flag the submitter polls,
+// so the submitting thread never waits on a worker.
+//
+// This code is released into the public domain.
+//
+
+#ifndef _AURA_WORKER_POOL_HXX
+#define _AURA_WORKER_POOL_HXX
+
+#include <pthread.h>
+
+#include <vector>
+using std::vector;
+
+
+class AuraWorkerPool {
+
+public:
+
+    typedef void (*job_func)( void *arg );
+
+    AuraWorkerPool();
+    ~AuraWorkerPool();
+
+    // start/stop the worker threads.  stop() lets the workers finish
+    // everything already queued before joining them.
+    bool start( int num_threads );
+    void stop();
+
+    // queue a job, returns false if the pool isn't running or the
+    // queue is full (the caller should then run the job itself)
+    bool submit( job_func func, void *arg );
+
+    inline int size() const { return threads.size(); }
+
+private:
+
+    static const int MAX_JOBS = 32;
+
+    struct job {
+	job_func func;
+	void *arg;
+    };
+
+    job queue[MAX_JOBS];
+    int head;
+    int count;
+    bool running;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    vector<pthread_t> threads;
+
+    static void *thread_main( void *arg );
+    void run();
+};
+
+
+#endif // _AURA_WORKER_POOL_HXX
@@ -0,0 +1,144 @@
+// compact_bench.cxx - measure the compact telemetry encoding
+// (comms/compact.hxx) on a recorded flight log: every state packet
+// stream is sampled at the given rate, as the remote link would send
+// it, and the full and compact sizes are compared per packet type.
+// Keyframes are assumed received (no acks.)
+//
+// usage: compact_bench flight.dat.gz [rate_hz] [keyframe_sec]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <map>
+#include <utility>
+using std::map;
+using std::pair;
+
+#include "comms/compact.hxx"
+#include "comms/packet_id.hxx"
+#include "util/serial_framer.hxx"
+
+
+struct type_stats {
+    unsigned long packets;
+    unsigned long full_bytes;
+    unsigned long compact_bytes;
+};
+
+int main( int argc, char **argv ) {
+    if ( argc < 2 ) {
+	printf("usage: %s flight.dat.gz [rate_hz] [keyframe_sec]\n", argv[0]);
+	return 1;
+    }
+    double rate_hz = 10.0;
+    double keyframe_sec = 2.0;
+    if ( argc > 2 ) {
+	rate_hz = atof( argv[2] );
+    }
+    if ( argc > 3 ) {
+	keyframe_sec = atof( argv[3] );
+    }
+    if ( rate_hz <= 0.0 ) {
+	printf("rate must be positive\n");
+	return 1;
+    }
+
+    gzFile flog = gzopen( argv[1], "rb" );
+    if ( flog == NULL ) {
+	printf("cannot open %s\n", argv[1]);
+	return 1;
+    }
+
+    AuraCompactEncoder encoder;
+    encoder.set_ack( false );
+    encoder.set_keyframe_sec( keyframe_sec );
+
+    SerialFramer framer;
+    framer.init( -1, START_OF_MSG0, START_OF_MSG1 );
+
+    map<pair<int, int>, double> next_time;	// per id and section
+    map<int, type_stats> stats;
+    double now = -1.0;
+    uint8_t pkt[262];
+    uint8_t out[262];
+    bool eof = false;
+    while ( true ) {
+	uint8_t id;
+	int len;
+	const uint8_t *payload;
+	if ( ! framer.next_view( &id, &len, &payload ) ) {
+	    if ( eof ) {
+		break;
+	    }
+	    uint8_t buf[4096];
+	    int n = gzread( flog, buf, sizeof(buf) );
+	    if ( n <= 0 ) {
+		eof = true;
+	    } else {
+		framer.append( buf, n );
+	    }
+	    continue;
+	}
+
+	// the log has no clock of its own, go by the primary imu
+	if ( id == IMU_PACKET_V3 && len > 9 && payload[0] == 0 ) {
+	    memcpy( &now, payload + 1, sizeof(now) );
+	}
+	if ( now < 0.0 || len < 1 ) {
+	    continue;
+	}
+	pair<int, int> key( id, payload[0] );
+	if ( next_time.count(key) && now < next_time[key] ) {
+	    continue;
+	}
+	next_time[key] = now + 1.0 / rate_hz;
+
+	// back into a framed packet the way the remote link sees it
+	pkt[0] = START_OF_MSG0;
+	pkt[1] = START_OF_MSG1;
+	pkt[2] = id;
+	pkt[3] = len;
+	memcpy( pkt + 4, payload, len );
+	fletcher8( pkt + 2, len + 2, pkt + 4 + len, pkt + 5 + len );
+	int n = encoder.encode( pkt, len + 6, out, now );
+	if ( n > 0 ) {
+	    type_stats &s = stats[id];
+	    s.packets++;
+	    s.full_bytes += len + 6;
+	    s.compact_bytes += n;
+	} else if ( stats.count(id) ) {
+	    // a handled id the encoder couldn't shrink goes out as is
+	    type_stats &s = stats[id];
+	    s.packets++;
+	    s.full_bytes += len + 6;
+	    s.compact_bytes += len + 6;
+	}
+    }
+    gzclose( flog );
+
+    printf("%.1f hz per stream, keyframe every %.1f sec\n", rate_hz,
+	   keyframe_sec);
+    printf(" id  packets   full bytes  compact bytes  avg full  avg compact  ratio\n");
+    unsigned long full = 0, compact = 0;
+    for ( map<int, type_stats>::iterator it = stats.begin();
+	  it != stats.end(); ++it )
+    {
+	type_stats &s = it->second;
+	printf("%3d %8lu %12lu %14lu %9.1f %12.1f %6.2f\n", it->first,
+	       s.packets, s.full_bytes, s.compact_bytes,
+	       (double)s.full_bytes / s.packets,
+	       (double)s.compact_bytes / s.packets,
+	       (double)s.full_bytes / s.compact_bytes);
+	full += s.full_bytes;
+	compact += s.compact_bytes;
+    }
+    if ( compact == 0 ) {
+	printf("no state packets found\n");
+	return 1;
+    }
+    printf("total: %lu -> %lu bytes, ratio %.2f (%.2fx the state updates for the same link budget)\n",
+	   full, compact, (double)full / compact, (double)full / compact);
+    return 0;
+}
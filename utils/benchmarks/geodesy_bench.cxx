@@ -0,0 +1,222 @@
+// geodesy_bench.cxx - check the batch geodesy functions against the
+// scalar ones and measure their throughput (points/sec)
+//
+// usage: geodesy_bench [points] [passes]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+using std::vector;
+
+#include "math/SGMath.hxx"
+#include "math/SGGeodesy.hxx"
+
+
+static double get_time() {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static double urand( double min, double max ) {
+    return min + (max - min) * (random() / (double)RAND_MAX);
+}
+
+// angle difference folded into [0, 180]
+static double angle_diff( double a, double b ) {
+    double d = fabs(a - b);
+    while ( d > 180.0 ) {
+	d = fabs(d - 360.0);
+    }
+    return d;
+}
+
+static void report( const char *name, int n, int passes, double scalar_sec,
+		    double batch_sec )
+{
+    double points = (double)n * passes;
+    printf("%-8s scalar: %10.0f points/sec  batch: %10.0f points/sec  (x%.2f)\n",
+	   name, points / scalar_sec, points / batch_sec,
+	   scalar_sec / batch_sec);
+}
+
+int main( int argc, char **argv ) {
+    int n = 100000;
+    int passes = 10;
+    if ( argc > 1 ) {
+	n = atoi( argv[1] );
+    }
+    if ( argc > 2 ) {
+	passes = atoi( argv[2] );
+    }
+    if ( n < 1 || passes < 1 ) {
+	printf("usage: %s [points] [passes]\n", argv[0]);
+	return 1;
+    }
+    printf("geodesy batch functions: %s, %d points x %d passes\n",
+	   SGGeodesy::batchSimdName(), n, passes);
+
+    // mostly route sized legs in one flying area, every 8th point an
+    // arbitrary pair anywhere on the earth, plus some of the special
+    // cases the batch code hands to the scalar routines
+    srandom( 42 );
+    vector<double> lat1(n), lon1(n), lat2(n), lon2(n);
+    vector<double> crs(n), dist(n);
+    vector<double> x(n), y(n), z(n);
+    for ( int i = 0; i < n; i++ ) {
+	if ( i % 8 == 7 ) {
+	    lat1[i] = urand(-89.0, 89.0);
+	    lon1[i] = urand(-180.0, 180.0);
+	    lat2[i] = urand(-89.0, 89.0);
+	    lon2[i] = urand(-180.0, 180.0);
+	    dist[i] = urand(0.0, 10000000.0);
+	} else {
+	    lat1[i] = urand(44.9, 45.1);
+	    lon1[i] = urand(-93.3, -93.1);
+	    lat2[i] = lat1[i] + urand(-0.05, 0.05);
+	    lon2[i] = lon1[i] + urand(-0.05, 0.05);
+	    dist[i] = urand(0.0, 5000.0);
+	}
+	if ( i % 997 == 0 ) {
+	    lat2[i] = lat1[i];	// coincident
+	    lon2[i] = lon1[i];
+	    dist[i] = 0.0;
+	} else if ( i % 991 == 0 ) {
+	    lat1[i] = 90.0;	// polar
+	}
+	crs[i] = urand(0.0, 360.0);
+
+	SGVec3<double> cart;
+	SGGeodesy::SGGeodToCart( SGGeod::fromDegM(lon1[i], lat1[i],
+						  urand(-100.0, 5000.0)),
+				 cart );
+	x[i] = cart(0);
+	y[i] = cart(1);
+	z[i] = cart(2);
+    }
+
+    vector<double> c1(n), c2(n), d(n), b1(n), b2(n), bd(n);
+    vector<double> la(n), lo(n), el(n), bla(n), blo(n), bel(n);
+    int failures = 0;
+    double t0, scalar_sec, batch_sec;
+
+    // inverse
+    t0 = get_time();
+    for ( int p = 0; p < passes; p++ ) {
+	for ( int i = 0; i < n; i++ ) {
+	    SGGeodesy::inverse( SGGeod::fromDeg(lon1[i], lat1[i]),
+				SGGeod::fromDeg(lon2[i], lat2[i]),
+				c1[i], c2[i], d[i] );
+	}
+    }
+    scalar_sec = get_time() - t0;
+    t0 = get_time();
+    for ( int p = 0; p < passes; p++ ) {
+	SGGeodesy::inverseBatch( n, &lat1[0], &lon1[0], &lat2[0], &lon2[0],
+				 &b1[0], &b2[0], &bd[0] );
+    }
+    batch_sec = get_time() - t0;
+    double max_crs = 0.0, max_dist = 0.0;
+    for ( int i = 0; i < n; i++ ) {
+	// short legs have ill conditioned courses, so compare the
+	// course error as a sideways offset at the end of the leg
+	double ec = fmax( angle_diff(c1[i], b1[i]), angle_diff(c2[i], b2[i]) )
+	    * SGD_DEGREES_TO_RADIANS * d[i];
+	double ed = fabs(d[i] - bd[i]);
+	if ( !(ec <= 1e-6 && ed <= 1e-6) ) {
+	    if ( failures++ < 10 ) {
+		printf("inverse %d: %.9f %.9f -> %.9f %.9f: %.12f %.12f %.6f vs %.12f %.12f %.6f\n",
+		       i, lat1[i], lon1[i], lat2[i], lon2[i], c1[i], c2[i],
+		       d[i], b1[i], b2[i], bd[i]);
+	    }
+	}
+	if ( ec > max_crs ) max_crs = ec;
+	if ( ed > max_dist ) max_dist = ed;
+    }
+    printf("inverse  max course error: %.3g m (offset)  max distance error: %.3g m\n",
+	   max_crs, max_dist);
+    report( "inverse", n, passes, scalar_sec, batch_sec );
+
+    // direct
+    t0 = get_time();
+    for ( int p = 0; p < passes; p++ ) {
+	for ( int i = 0; i < n; i++ ) {
+	    SGGeod p2;
+	    SGGeodesy::direct( SGGeod::fromDeg(lon1[i], lat1[i]), crs[i],
+			       dist[i], p2, c2[i] );
+	    la[i] = p2.getLatitudeDeg();
+	    lo[i] = p2.getLongitudeDeg();
+	}
+    }
+    scalar_sec = get_time() - t0;
+    t0 = get_time();
+    for ( int p = 0; p < passes; p++ ) {
+	SGGeodesy::directBatch( n, &lat1[0], &lon1[0], &crs[0], &dist[0],
+				&bla[0], &blo[0], &b2[0] );
+    }
+    batch_sec = get_time() - t0;
+    double max_pos = 0.0;
+    max_crs = 0.0;
+    for ( int i = 0; i < n; i++ ) {
+	double ep = fmax( fabs(la[i] - bla[i]), angle_diff(lo[i], blo[i]) );
+	double ec = angle_diff( c2[i], b2[i] );
+	if ( !(ep <= 1e-10 && ec <= 1e-9) ) {
+	    if ( failures++ < 10 ) {
+		printf("direct %d: %.9f %.9f %.6f %.3f -> %.12f %.12f %.12f vs %.12f %.12f %.12f\n",
+		       i, lat1[i], lon1[i], crs[i], dist[i], la[i], lo[i],
+		       c2[i], bla[i], blo[i], b2[i]);
+	    }
+	}
+	if ( ep > max_pos ) max_pos = ep;
+	if ( ec > max_crs ) max_crs = ec;
+    }
+    printf("direct   max position error: %.3g deg  max course error: %.3g deg\n",
+	   max_pos, max_crs);
+    report( "direct", n, passes, scalar_sec, batch_sec );
+
+    // ecef -> geodetic
+    t0 = get_time();
+    for ( int p = 0; p < passes; p++ ) {
+	for ( int i = 0; i < n; i++ ) {
+	    SGGeod geod;
+	    SGGeodesy::SGCartToGeod( SGVec3<double>(x[i], y[i], z[i]), geod );
+	    lo[i] = geod.getLongitudeDeg();
+	    la[i] = geod.getLatitudeDeg();
+	    el[i] = geod.getElevationM();
+	}
+    }
+    scalar_sec = get_time() - t0;
+    t0 = get_time();
+    for ( int p = 0; p < passes; p++ ) {
+	SGGeodesy::SGCartToGeodBatch( n, &x[0], &y[0], &z[0],
+				      &blo[0], &bla[0], &bel[0] );
+    }
+    batch_sec = get_time() - t0;
+    double max_elev = 0.0;
+    max_pos = 0.0;
+    for ( int i = 0; i < n; i++ ) {
+	double ep = fmax( fabs(la[i] - bla[i]), angle_diff(lo[i], blo[i]) );
+	double ee = fabs( el[i] - bel[i] );
+	if ( !(ep <= 1e-10 && ee <= 1e-6) ) {
+	    if ( failures++ < 10 ) {
+		printf("cart2geod %d: %.3f %.3f %.3f -> %.12f %.12f %.6f vs %.12f %.12f %.6f\n",
+		       i, x[i], y[i], z[i], la[i], lo[i], el[i],
+		       bla[i], blo[i], bel[i]);
+	    }
+	}
+	if ( ep > max_pos ) max_pos = ep;
+	if ( ee > max_elev ) max_elev = ee;
+    }
+    printf("cart2geod max position error: %.3g deg  max elevation error: %.3g m\n",
+	   max_pos, max_elev);
+    report( "cart2geod", n, passes, scalar_sec, batch_sec );
+
+    if ( failures ) {
+	printf("%d results outside the tolerance\n", failures);
+	return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,710 @@
+// logexport.cxx - fast native export of a flight log (flight.dat.gz)
+// to per category columnar files
+//
+// The native counterpart of auralink/auraexport.py: log blocks are
+// decompressed in parallel (see comms/log_blocks.hxx), the packet
+// stream is cut into chunks at packet boundaries and a pool of worker
+// threads decodes and formats them, then every <category>-<index>
+// table is written out as
+//
+//   <category>-<index>.csv   header line plus one row per packet
+//   <category>-<index>.col   typed columns (layout below)
+//
+// Values come out in the units of the packer.py unpack functions
+// (scaled integers are expanded.)  Only the packet versions written
+// today are decoded, older versions are counted and skipped (use
+// auraexport.py for old logs.)
+//
+// .col layout, little endian: "AURACOL1", columns (u32), rows (u64),
+// then per column a type ('d' float64, 'q' int64, 's' string), the
+// name length (u8) and the name, followed by the data of each column
+// in turn: rows x 8 bytes for 'd' and 'q', rows end offsets (u32) and
+// the characters for 's'.
+//
+// usage: logexport [--out dir] [--threads n] [--start sec] [--end sec]
+//                  [--category name ...] [--no-csv] [--no-columns]
+//                  flight.dat.gz|flight_dir
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+using std::map;
+using std::string;
+using std::vector;
+
+#include "comms/log_blocks.hxx"
+#include "comms/packet_id.hxx"
+#include "util/serial_framer.hxx"
+#include "util/timing.h"
+
+
+static const int MAX_FIELDS = 20;
+
+// packets are handed out to the workers in chunks of about this size
+static const size_t CHUNK_SIZE = 256 * 1024;
+
+// struct layout (must match packer.py) and the columns of each packet
+// after the index byte: name, divisor applied to the raw value (0 for
+// none) and csv digits (-1 for integers.)  Column types follow from
+// the format: floats and scaled integers are 'd', plain integers 'q'
+// and 'p' (a length byte and that many characters) is a string.
+static const struct packet_format {
+    uint8_t id;
+    const char *category;
+    const char *fmt;
+    struct {
+	const char *name;
+	double div;
+	int digits;
+    } fields[MAX_FIELDS];
+} formats[] = {
+    { GPS_PACKET_V3, "gps", "<BdddfhhhdBHHHB",
+      { {"timestamp", 0, 4}, {"latitude_deg", 0, 10},
+	{"longitude_deg", 0, 10}, {"altitude_m", 0, 2},
+	{"vn_ms", 100, 4}, {"ve_ms", 100, 4}, {"vd_ms", 100, 4},
+	{"unix_time_sec", 0, 3}, {"satellites", 0, -1},
+	{"horiz_accuracy_m", 100, 2}, {"vert_accuracy_m", 100, 2},
+	{"pdop", 100, 2}, {"fixType", 0, -1} } },
+    { IMU_PACKET_V3, "imu", "<BdfffffffffhB",
+      { {"timestamp", 0, 4}, {"p_rad_sec", 0, 4}, {"q_rad_sec", 0, 4},
+	{"r_rad_sec", 0, 4}, {"ax_mps_sec", 0, 4}, {"ay_mps_sec", 0, 4},
+	{"az_mps_sec", 0, 4}, {"hx", 0, 3}, {"hy", 0, 3}, {"hz", 0, 3},
+	{"temp_C", 10, 1}, {"status", 0, -1} } },
+    { AIRDATA_PACKET_V5, "air", "<BdHhhffhHBBB",
+      { {"timestamp", 0, 4}, {"pressure_mbar", 10, 1},
+	{"temp_degC", 100, 1}, {"airspeed_smoothed_kt", 100, 1},
+	{"altitude_smoothed_m", 0, 2}, {"altitude_true_m", 0, 2},
+	{"vertical_speed_fpm", 10, 2}, {"wind_dir_deg", 100, 1},
+	{"wind_speed_kt", 4, 1}, {"pitot_scale_factor", 100, 2},
+	{"status", 0, -1} } },
+    { FILTER_PACKET_V3, "filter", "<BdddfhhhhhhhhhhhhBB",
+      { {"timestamp", 0, 4}, {"latitude_deg", 0, 10},
+	{"longitude_deg", 0, 10}, {"altitude_m", 0, 2},
+	{"vn_ms", 100, 4}, {"ve_ms", 100, 4}, {"vd_ms", 100, 4},
+	{"roll_deg", 10, 2}, {"pitch_deg", 10, 2}, {"heading_deg", 10, 2},
+	{"p_bias", 1000, 3}, {"q_bias", 1000, 3}, {"r_bias", 1000, 3},
+	{"ax_bias", 1000, 3}, {"ay_bias", 1000, 3}, {"az_bias", 1000, 3},
+	{"sequence_num", 0, -1}, {"status", 0, -1} } },
+    { ACTUATOR_PACKET_V2, "act", "<BdhhHhhhhhB",
+      { {"timestamp", 0, 4}, {"aileron", 20000, 3},
+	{"elevator", 20000, 3}, {"throttle", 60000, 3},
+	{"rudder", 20000, 3}, {"channel5", 20000, 3}, {"flaps", 20000, 3},
+	{"channel7", 20000, 3}, {"channel8", 20000, 3},
+	{"status", 0, -1} } },
+    { PILOT_INPUT_PACKET_V2, "pilot", "<BdhhhhhhhhB",
+      { {"timestamp", 0, 4}, {"channel0", 20000, 3},
+	{"channel1", 20000, 3}, {"channel2", 20000, 3},
+	{"channel3", 20000, 3}, {"channel4", 20000, 3},
+	{"channel5", 20000, 3}, {"channel6", 20000, 3},
+	{"channel7", 20000, 3}, {"status", 0, -1} } },
+    { AP_STATUS_PACKET_V5, "ap", "<BdBhhHHhhHHddHHB",
+      { {"timestamp", 0, 4}, {"flags", 0, -1},
+	{"groundtrack_deg", 10, 2}, {"roll_deg", 10, 2},
+	{"altitude_msl_ft", 0, -1}, {"altitude_ground_m", 0, -1},
+	{"pitch_deg", 10, 2}, {"airspeed_kt", 10, 1},
+	{"flight_timer", 0, -1}, {"target_waypoint_idx", 0, -1},
+	{"wp_longitude_deg", 0, 10}, {"wp_latitude_deg", 0, 10},
+	{"wp_index", 0, -1}, {"route_size", 0, -1},
+	{"sequence_num", 0, -1} } },
+    { SYSTEM_HEALTH_PACKET_V4, "health", "<BdHHHHHH",
+      { {"frame_time", 0, 4}, {"system_load_avg", 100, 2},
+	{"board_vcc", 1000, 2}, {"extern_volts", 1000, 2},
+	{"extern_cell_volts", 1000, 2}, {"extern_amps", 1000, 2},
+	{"extern_current_mah", 0.1, 0} } },	// logged in 10 mah
+    { PAYLOAD_PACKET_V2, "payload", "<BdH",
+      { {"timestamp", 0, 4}, {"trigger_num", 0, -1} } },
+    { RAVEN_PACKET_V1, "raven", "<BdHHHHHHHHHHffffB",
+      { {"timestamp", 0, 4}, {"pots0", 0, -1}, {"pots1", 0, -1},
+	{"pots2", 0, -1}, {"pots3", 0, -1}, {"pots4", 0, -1},
+	{"pots5", 0, -1}, {"pots6", 0, -1}, {"pots7", 0, -1},
+	{"pots8", 0, -1}, {"pots9", 0, -1}, {"diff_pa", 0, 4},
+	{"pressure_mbar", 0, 4}, {"rpm0", 0, 2}, {"rpm1", 0, 2},
+	{"status", 0, -1} } },
+    { EVENT_PACKET_V1, "event", "<Bdp",
+      { {"timestamp", 0, 4}, {"message", 0, 0} } },
+    { PROFILE_PACKET_V1, "profile", "<BdLHHHHHLp",
+      { {"timestamp", 0, 4}, {"count", 0, -1}, {"p50_ms", 1000, 3},
+	{"p90_ms", 1000, 3}, {"p99_ms", 1000, 3}, {"p999_ms", 1000, 3},
+	{"max_ms", 1000, 3}, {"overruns", 0, -1}, {"name", 0, 0} } }
+};
+static const int NUM_FORMATS = sizeof(formats) / sizeof(formats[0]);
+
+// packet id -> format (NULL if not exported)
+static const packet_format *format_by_id[256];
+
+
+struct column {
+    char type;
+    vector<double> d;
+    vector<int64_t> q;
+    vector<string> s;
+};
+
+// one <category>-<index> table, or the part of it found in one chunk
+struct table {
+    const packet_format *format;
+    int index;
+    size_t rows;
+    vector<column> columns;
+    string csv;
+};
+
+struct chunk {
+    int block;
+    size_t begin, end;
+    map<int, table> tables;	// by id * 256 + index
+    unsigned long packets;
+    unsigned long skipped;
+    unsigned long errors;
+};
+
+
+// options
+static string out_dir;
+static int num_threads = 0;
+static double start_time = -1.0e30;
+static double end_time = 1.0e30;
+static bool write_csv = true;
+static bool write_columns = true;
+
+static AuraLogReader reader;
+static vector<int> blocks;		// the ones in the time window
+static vector<string> block_data;
+static vector<chunk> chunks;
+static vector<int> table_keys;
+
+
+// run func(0 .. count-1) on the worker threads
+struct job {
+    std::atomic<int> next;
+    int count;
+    void (*func)( int i );
+};
+
+static void *job_main( void *arg ) {
+    job *j = (job *)arg;
+    int i;
+    while ( (i = j->next++) < j->count ) {
+	j->func( i );
+    }
+    return NULL;
+}
+
+static void run_parallel( int count, void (*func)( int i ) ) {
+    job j;
+    j.next = 0;
+    j.count = count;
+    j.func = func;
+    vector<pthread_t> threads( num_threads );
+    for ( int i = 0; i < num_threads; i++ ) {
+	pthread_create( &threads[i], NULL, job_main, &j );
+    }
+    for ( int i = 0; i < num_threads; i++ ) {
+	pthread_join( threads[i], NULL );
+    }
+}
+
+
+static int field_size( char c ) {
+    switch ( c ) {
+    case 'B': return 1;
+    case 'H': case 'h': return 2;
+    case 'L': case 'f': return 4;
+    case 'd': return 8;
+    }
+    return 0;
+}
+
+static char column_type( char c, double div ) {
+    if ( c == 'p' ) {
+	return 's';
+    } else if ( c == 'f' || c == 'd' || div != 0 ) {
+	return 'd';
+    }
+    return 'q';
+}
+
+static void init_table( table *t, const packet_format *f, int index ) {
+    t->format = f;
+    t->index = index;
+    t->rows = 0;
+    const char *types = f->fmt + 2;	// skip '<' and the index
+    for ( int i = 0; types[i]; i++ ) {
+	column c;
+	c.type = column_type( types[i], f->fields[i].div );
+	t->columns.push_back( c );
+    }
+}
+
+// integer as text
+static void append_int( string *csv, int64_t value ) {
+    char buf[24];
+    int n = sizeof(buf);
+    uint64_t u = value < 0 ? -(uint64_t)value : value;
+    do {
+	buf[--n] = '0' + u % 10;
+	u /= 10;
+    } while ( u );
+    if ( value < 0 ) {
+	buf[--n] = '-';
+    }
+    csv->append( buf + n, sizeof(buf) - n );
+}
+
+// same text as printf("%.*f"), which is the bulk of the export time
+// otherwise: values that scale to an integer range without being near
+// a rounding tie are formatted from that integer, the rest by printf
+static void append_fixed( string *csv, double value, int digits ) {
+    static const double pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10
+    };
+    if ( digits >= 0 && digits <= 10 ) {
+	double scaled = value * pow10[digits];
+	if ( fabs(scaled) < 4e12 ) {
+	    double r = nearbyint( scaled );
+	    if ( fabs(scaled - r) < 0.499 && ! (r == 0 && signbit(value)) ) {
+		char buf[32];
+		int n = sizeof(buf);
+		int64_t v = (int64_t)r;
+		uint64_t u = v < 0 ? -(uint64_t)v : v;
+		for ( int i = 0; i < digits; i++ ) {
+		    buf[--n] = '0' + u % 10;
+		    u /= 10;
+		}
+		if ( digits > 0 ) {
+		    buf[--n] = '.';
+		}
+		do {
+		    buf[--n] = '0' + u % 10;
+		    u /= 10;
+		} while ( u );
+		if ( v < 0 ) {
+		    buf[--n] = '-';
+		}
+		csv->append( buf + n, sizeof(buf) - n );
+		return;
+	    }
+	}
+    }
+    char buf[64];
+    int n = snprintf( buf, sizeof(buf), "%.*f", digits, value );
+    csv->append( buf, n );
+}
+
+// csv string field, quoted when it needs to be
+static void append_csv_string( string *csv, const string &s ) {
+    if ( s.find_first_of(",\"\n") == string::npos ) {
+	csv->append( s );
+	return;
+    }
+    csv->push_back( '"' );
+    for ( unsigned int i = 0; i < s.size(); i++ ) {
+	if ( s[i] == '"' ) {
+	    csv->push_back( '"' );
+	}
+	csv->push_back( s[i] );
+    }
+    csv->push_back( '"' );
+}
+
+// unpack one packet into a row of t (and the csv text).  False if the
+// packet is too short for its format.
+static bool decode( table *t, const uint8_t *payload, int len ) {
+    const packet_format *f = t->format;
+    const char *types = f->fmt + 2;
+    int pos = 1;
+    // check the length before touching the columns
+    for ( int i = 0; types[i]; i++ ) {
+	if ( types[i] == 'p' ) {
+	    if ( pos >= len ) {
+		return false;
+	    }
+	    pos += 1 + payload[pos];
+	} else {
+	    pos += field_size( types[i] );
+	}
+    }
+    if ( pos > len ) {
+	return false;
+    }
+
+    pos = 1;
+    for ( int i = 0; types[i]; i++ ) {
+	const uint8_t *p = payload + pos;
+	column &c = t->columns[i];
+	if ( i > 0 && write_csv ) {
+	    t->csv.push_back( ',' );
+	}
+	if ( types[i] == 'p' ) {
+	    string s( (const char *)p + 1, p[0] );
+	    if ( write_csv ) {
+		append_csv_string( &t->csv, s );
+	    }
+	    c.s.push_back( s );
+	    pos += 1 + p[0];
+	    continue;
+	}
+	double value = 0.0;
+	int64_t ivalue = 0;
+	switch ( types[i] ) {
+	case 'B': ivalue = p[0]; break;
+	case 'H': { uint16_t v; memcpy( &v, p, 2 ); ivalue = v; } break;
+	case 'h': { int16_t v; memcpy( &v, p, 2 ); ivalue = v; } break;
+	case 'L': { uint32_t v; memcpy( &v, p, 4 ); ivalue = v; } break;
+	case 'f': { float v; memcpy( &v, p, 4 ); value = v; } break;
+	case 'd': memcpy( &value, p, 8 ); break;
+	}
+	if ( types[i] != 'f' && types[i] != 'd' ) {
+	    value = (double)ivalue;
+	}
+	if ( f->fields[i].div != 0 ) {
+	    value /= f->fields[i].div;
+	}
+	if ( c.type == 'd' ) {
+	    c.d.push_back( value );
+	} else {
+	    c.q.push_back( ivalue );
+	}
+	if ( write_csv ) {
+	    if ( c.type == 'q' ) {
+		append_int( &t->csv, ivalue );
+	    } else {
+		append_fixed( &t->csv, value, f->fields[i].digits );
+	    }
+	}
+	pos += field_size( types[i] );
+    }
+    if ( write_csv ) {
+	t->csv.push_back( '\n' );
+    }
+    t->rows++;
+    return true;
+}
+
+
+static void decompress_block( int i ) {
+    if ( ! reader.read_block( blocks[i], &block_data[blocks[i]] ) ) {
+	printf("block %d: read or decompression error\n", blocks[i]);
+    }
+}
+
+// cut the blocks into chunks at packet starts (only the headers are
+// looked at, the workers check the frames)
+static void split_chunks() {
+    for ( unsigned int b = 0; b < block_data.size(); b++ ) {
+	const uint8_t *d = (const uint8_t *)block_data[b].data();
+	size_t size = block_data[b].size();
+	size_t begin = 0;
+	size_t pos = 0;
+	while ( pos + 4 <= size ) {
+	    if ( d[pos] != START_OF_MSG0 || d[pos+1] != START_OF_MSG1 ) {
+		pos++;
+		continue;
+	    }
+	    if ( pos - begin >= CHUNK_SIZE ) {
+		chunk c;
+		c.block = b;
+		c.begin = begin;
+		c.end = pos;
+		chunks.push_back( c );
+		begin = pos;
+	    }
+	    pos += 4 + d[pos+3] + 2;
+	}
+	if ( begin < size ) {
+	    chunk c;
+	    c.block = b;
+	    c.begin = begin;
+	    c.end = size;
+	    chunks.push_back( c );
+	}
+    }
+}
+
+static void decode_chunk( int i ) {
+    chunk &c = chunks[i];
+    c.packets = c.skipped = c.errors = 0;
+    const uint8_t *d = (const uint8_t *)block_data[c.block].data();
+    size_t size = block_data[c.block].size();
+    size_t pos = c.begin;
+    while ( pos < c.end && pos + 6 <= size ) {
+	if ( d[pos] != START_OF_MSG0 || d[pos+1] != START_OF_MSG1 ) {
+	    pos++;
+	    continue;
+	}
+	uint8_t id = d[pos+2];
+	int len = d[pos+3];
+	if ( pos + 6 + len > size ) {
+	    break;
+	}
+	uint8_t cksum0, cksum1;
+	fletcher8( d + pos + 2, len + 2, &cksum0, &cksum1 );
+	if ( cksum0 != d[pos+4+len] || cksum1 != d[pos+5+len] ) {
+	    c.errors++;
+	    pos++;
+	    continue;
+	}
+	const uint8_t *payload = d + pos + 4;
+	pos += 6 + len;
+
+	const packet_format *f = format_by_id[id];
+	if ( f == NULL || len < 9 ) {
+	    c.skipped++;
+	    continue;
+	}
+	// every exported packet has its timestamp after the index byte
+	double t;
+	memcpy( &t, payload + 1, 8 );
+	if ( t < start_time || t > end_time ) {
+	    continue;
+	}
+	int key = id * 256 + payload[0];
+	map<int, table>::iterator it = c.tables.find( key );
+	if ( it == c.tables.end() ) {
+	    it = c.tables.insert( std::make_pair(key, table()) ).first;
+	    init_table( &it->second, f, payload[0] );
+	}
+	if ( decode( &it->second, payload, len ) ) {
+	    c.packets++;
+	} else {
+	    c.errors++;
+	}
+    }
+}
+
+static string table_name( int key ) {
+    char buf[64];
+    snprintf( buf, sizeof(buf), "%s-%d",
+	      format_by_id[key / 256]->category, key % 256 );
+    return buf;
+}
+
+static void write_csv_file( int key ) {
+    string file = out_dir + "/" + table_name(key) + ".csv";
+    FILE *fp = fopen( file.c_str(), "w" );
+    if ( fp == NULL ) {
+	printf("Cannot open: %s\n", file.c_str());
+	return;
+    }
+    const packet_format *f = format_by_id[key / 256];
+    for ( int i = 0; f->fmt[i + 2]; i++ ) {
+	fprintf( fp, "%s%s", i > 0 ? "," : "", f->fields[i].name );
+    }
+    fprintf( fp, "\n" );
+    for ( unsigned int i = 0; i < chunks.size(); i++ ) {
+	map<int, table>::iterator it = chunks[i].tables.find( key );
+	if ( it != chunks[i].tables.end() ) {
+	    fwrite( it->second.csv.data(), it->second.csv.size(), 1, fp );
+	}
+    }
+    fclose( fp );
+}
+
+static void write_column_file( int key ) {
+    string file = out_dir + "/" + table_name(key) + ".col";
+    FILE *fp = fopen( file.c_str(), "wb" );
+    if ( fp == NULL ) {
+	printf("Cannot open: %s\n", file.c_str());
+	return;
+    }
+    // this table's part of every chunk, in log order
+    vector<table *> parts;
+    uint64_t rows = 0;
+    for ( unsigned int i = 0; i < chunks.size(); i++ ) {
+	map<int, table>::iterator it = chunks[i].tables.find( key );
+	if ( it != chunks[i].tables.end() ) {
+	    parts.push_back( &it->second );
+	    rows += it->second.rows;
+	}
+    }
+    const packet_format *f = format_by_id[key / 256];
+    const vector<column> &columns = parts[0]->columns;
+    uint32_t ncols = columns.size();
+    fwrite( "AURACOL1", 8, 1, fp );
+    fwrite( &ncols, 4, 1, fp );
+    fwrite( &rows, 8, 1, fp );
+    for ( unsigned int i = 0; i < ncols; i++ ) {
+	uint8_t len = strlen( f->fields[i].name );
+	fwrite( &columns[i].type, 1, 1, fp );
+	fwrite( &len, 1, 1, fp );
+	fwrite( f->fields[i].name, len, 1, fp );
+    }
+    for ( unsigned int i = 0; i < ncols; i++ ) {
+	if ( columns[i].type == 's' ) {
+	    uint32_t offset = 0;
+	    for ( unsigned int p = 0; p < parts.size(); p++ ) {
+		const vector<string> &s = parts[p]->columns[i].s;
+		for ( unsigned int r = 0; r < s.size(); r++ ) {
+		    offset += s[r].size();
+		    fwrite( &offset, 4, 1, fp );
+		}
+	    }
+	    for ( unsigned int p = 0; p < parts.size(); p++ ) {
+		const vector<string> &s = parts[p]->columns[i].s;
+		for ( unsigned int r = 0; r < s.size(); r++ ) {
+		    fwrite( s[r].data(), s[r].size(), 1, fp );
+		}
+	    }
+	} else {
+	    for ( unsigned int p = 0; p < parts.size(); p++ ) {
+		const column &c = parts[p]->columns[i];
+		if ( c.type == 'd' && ! c.d.empty() ) {
+		    fwrite( &c.d[0], 8, c.d.size(), fp );
+		} else if ( c.type == 'q' && ! c.q.empty() ) {
+		    fwrite( &c.q[0], 8, c.q.size(), fp );
+		}
+	    }
+	}
+    }
+    fclose( fp );
+}
+
+static void write_table( int i ) {
+    if ( write_csv ) {
+	write_csv_file( table_keys[i] );
+    }
+    if ( write_columns ) {
+	write_column_file( table_keys[i] );
+    }
+}
+
+
+static void usage( const char *name ) {
+    printf("usage: %s [options] flight.dat.gz|flight_dir\n", name);
+    printf("--out dir (default: the directory of the log)\n");
+    printf("--threads n (default: one per core)\n");
+    printf("--start sec, --end sec (log time window)\n");
+    printf("--category name (export only this category, may be repeated)\n");
+    printf("--no-csv, --no-columns (skip that output)\n");
+    exit(1);
+}
+
+int main( int argc, char **argv ) {
+    string file;
+    vector<string> categories;
+    for ( int i = 1; i < argc; i++ ) {
+	if ( !strcmp(argv[i], "--out") && i + 1 < argc ) {
+	    out_dir = argv[++i];
+	} else if ( !strcmp(argv[i], "--threads") && i + 1 < argc ) {
+	    num_threads = atoi( argv[++i] );
+	} else if ( !strcmp(argv[i], "--start") && i + 1 < argc ) {
+	    start_time = atof( argv[++i] );
+	} else if ( !strcmp(argv[i], "--end") && i + 1 < argc ) {
+	    end_time = atof( argv[++i] );
+	} else if ( !strcmp(argv[i], "--category") && i + 1 < argc ) {
+	    categories.push_back( argv[++i] );
+	} else if ( !strcmp(argv[i], "--no-csv") ) {
+	    write_csv = false;
+	} else if ( !strcmp(argv[i], "--no-columns") ) {
+	    write_columns = false;
+	} else if ( argv[i][0] != '-' && file == "" ) {
+	    file = argv[i];
+	} else {
+	    usage( argv[0] );
+	}
+    }
+    if ( file == "" ) {
+	usage( argv[0] );
+    }
+
+    struct stat st;
+    if ( stat(file.c_str(), &st) == 0 && S_ISDIR(st.st_mode) ) {
+	file += "/flight.dat.gz";
+    }
+    if ( out_dir == "" ) {
+	size_t slash = file.rfind( '/' );
+	out_dir = (slash == string::npos) ? "." : file.substr( 0, slash );
+    }
+    if ( num_threads < 1 ) {
+	num_threads = sysconf( _SC_NPROCESSORS_ONLN );
+	if ( num_threads < 1 ) {
+	    num_threads = 1;
+	}
+    }
+
+    for ( int i = 0; i < NUM_FORMATS; i++ ) {
+	bool wanted = categories.empty();
+	for ( unsigned int j = 0; j < categories.size(); j++ ) {
+	    if ( categories[j] == formats[i].category ) {
+		wanted = true;
+	    }
+	}
+	if ( wanted ) {
+	    format_by_id[formats[i].id] = &formats[i];
+	}
+    }
+
+    if ( ! reader.open( file ) ) {
+	return 1;
+    }
+
+    double t0 = get_Time();
+
+    // blocks in the time window, decompressed in parallel (a log from
+    // before the block format is one block)
+    int first = reader.find_block( start_time );
+    int last = reader.num_blocks();
+    if ( reader.is_indexed() ) {
+	while ( last > first && reader.get_block(last - 1).t0 > end_time ) {
+	    last--;
+	}
+    }
+    block_data.resize( reader.num_blocks() );
+    for ( int i = first; i < last; i++ ) {
+	blocks.push_back( i );
+    }
+    run_parallel( blocks.size(), decompress_block );
+    size_t bytes = 0;
+    for ( unsigned int i = 0; i < block_data.size(); i++ ) {
+	bytes += block_data[i].size();
+    }
+    double t1 = get_Time();
+
+    split_chunks();
+    run_parallel( chunks.size(), decode_chunk );
+    double t2 = get_Time();
+
+    map<int, uint64_t> rows;
+    unsigned long packets = 0, skipped = 0, errors = 0;
+    for ( unsigned int i = 0; i < chunks.size(); i++ ) {
+	packets += chunks[i].packets;
+	skipped += chunks[i].skipped;
+	errors += chunks[i].errors;
+	map<int, table>::iterator it;
+	for ( it = chunks[i].tables.begin(); it != chunks[i].tables.end();
+	      it++ )
+	{
+	    rows[it->first] += it->second.rows;
+	}
+    }
+    for ( map<int, uint64_t>::iterator it = rows.begin(); it != rows.end();
+	  it++ )
+    {
+	table_keys.push_back( it->first );
+    }
+    run_parallel( table_keys.size(), write_table );
+    double t3 = get_Time();
+
+    for ( unsigned int i = 0; i < table_keys.size(); i++ ) {
+	printf("%-12s %8lu records\n", table_name(table_keys[i]).c_str(),
+	       (unsigned long)rows[table_keys[i]]);
+    }
+    printf("%lu records (%lu skipped, %lu errors) from %.1f MB in %d blocks, %d threads\n",
+	   packets, skipped, errors, bytes / 1048576.0, (int)blocks.size(),
+	   num_threads);
+    printf("decompress %.3f sec, decode %.3f sec, write %.3f sec\n",
+	   t1 - t0, t2 - t1, t3 - t2);
+    printf("%.0f records/sec\n", packets / (t3 - t0));
+
+    return 0;
+}